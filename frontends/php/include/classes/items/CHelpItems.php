@@ -1071,6 +1071,10 @@ class CHelpItems {
 				[
 					'key' => 'db.odbc.discovery[<unique short description>,dsn]',
 					'description' => _('Transform SQL query result into a JSON object for low-level discovery.')
+				],
+				[
+					'key' => 'db.odbc.get[<unique short description>,dsn]',
+					'description' => _('Transform SQL query result into a JSON array of rows, to be used as master item value.')
 				]
 			],
 			ITEM_TYPE_JMX => [
@@ -140,6 +140,38 @@ int	zbx_tcp_listen(zbx_socket_t *s, const char *listen_ip, unsigned short listen
 int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept);
 void	zbx_tcp_unaccept(zbx_socket_t *s);
 
+#ifndef _WINDOWS
+typedef struct
+{
+	ZBX_SOCKET		socket;
+	int			deadline;	/* the time connection is closed if no data is received */
+	/* the following fields are set only for connections kept after processing a request */
+	char			*peer;
+	ZBX_SOCKADDR		peer_info;
+	unsigned int		connection_type;
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	zbx_tls_context_t	*tls_ctx;
+#endif
+}
+zbx_tcp_pending_conn_t;
+
+/* accepted connections waiting for data */
+typedef struct
+{
+	zbx_tcp_pending_conn_t	*conns;
+	struct pollfd		*pollfds;
+	int			num;
+	int			max;
+	unsigned char		nonblocking;	/* 1 if listening sockets were switched to non-blocking mode */
+}
+zbx_tcp_pending_t;
+
+void	zbx_tcp_pending_init(zbx_tcp_pending_t *pending, int max);
+void	zbx_tcp_pending_destroy(zbx_tcp_pending_t *pending);
+int	zbx_tcp_pending_keep(zbx_socket_t *s, zbx_tcp_pending_t *pending, int timeout);
+int	zbx_tcp_accept_pending(zbx_socket_t *s, zbx_tcp_pending_t *pending, unsigned int tls_accept, int idle_timeout);
+#endif
+
 #define ZBX_TCP_READ_UNTIL_CLOSE 0x01
 
 #define	zbx_tcp_recv(s)			SUCCEED_OR_FAIL(zbx_tcp_recv_ext(s, 0))
@@ -489,9 +489,12 @@ void	DBstatement_prepare(const char *sql);
 #endif
 int		DBexecute(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 int		DBexecute_once(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
+int		DBexecute_async(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 DB_RESULT	DBselect_once(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 DB_RESULT	DBselect(const char *fmt, ...) __zbx_attr_format_printf(1, 2);
 DB_RESULT	DBselectN(const char *query, int n);
+DB_RESULT	DBselectN_prepared(const char *query, const char **params, int params_num, int n);
+#define DBselect_prepared(query, params, params_num)	DBselectN_prepared(query, params, params_num, 0)
 DB_ROW		DBfetch(DB_RESULT result);
 int		DBis_null(const char *field);
 void		DBbegin(void);
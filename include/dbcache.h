@@ -38,7 +38,8 @@
 
 #define MAX_JAVA_ITEMS		32
 #define MAX_SNMP_ITEMS		128
-#define MAX_POLLER_ITEMS	128	/* MAX(MAX_JAVA_ITEMS, MAX_SNMP_ITEMS) */
+#define MAX_HTTPAGENT_ITEMS	64
+#define MAX_POLLER_ITEMS	128	/* MAX(MAX_JAVA_ITEMS, MAX_SNMP_ITEMS, MAX_HTTPAGENT_ITEMS) */
 #define MAX_PINGER_ITEMS	128
 
 #define ZBX_TRIGGER_DEPENDENCY_LEVELS_MAX	32
@@ -630,6 +631,8 @@ int	DCget_host_by_hostid(DC_HOST *host, zbx_uint64_t hostid);
 void	DCconfig_get_hosts_by_itemids(DC_HOST *hosts, const zbx_uint64_t *itemids, int *errcodes, size_t num);
 void	DCconfig_get_items_by_keys(DC_ITEM *items, zbx_host_key_t *keys, int *errcodes, size_t num);
 void	DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes, size_t num);
+void	DCconfig_get_history_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes,
+		size_t num);
 void	DCconfig_get_preprocessable_items(zbx_hashset_t *items, int *timestamp);
 void	DCconfig_get_functions_by_functionids(DC_FUNCTION *functions,
 		zbx_uint64_t *functionids, int *errcodes, size_t num);
@@ -771,7 +774,8 @@ void	zbx_dc_get_nested_hostgroupids_by_names(char **names, int names_num,
 		zbx_vector_uint64_t *nested_groupids);
 
 #define ZBX_HC_ITEM_STATUS_NORMAL	0
-#define ZBX_HC_ITEM_STATUS_BUSY		1
+#define ZBX_HC_ITEM_STATUS_BUSY		1	/* trigger is locked by other history syncer */
+#define ZBX_HC_ITEM_STATUS_DEFERRED	2	/* trigger is locked by another item of the same batch */
 
 #define ZBX_DC_FLAG_META	0x01	/* contains meta information (lastlogsize and mtime) */
 #define ZBX_DC_FLAG_NOVALUE	0x02	/* entry contains no value */
@@ -860,6 +864,7 @@ typedef struct
 zbx_data_session_t;
 
 const char	*zbx_dc_get_session_token(void);
+zbx_uint64_t	zbx_dc_get_active_checks_revision(zbx_uint64_t hostid);
 zbx_data_session_t	*zbx_dc_get_or_create_data_session(zbx_uint64_t hostid, const char *token);
 void	zbx_dc_cleanup_data_sessions(void);
 
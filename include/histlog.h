@@ -0,0 +1,56 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2020 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#ifndef ZABBIX_HISTLOG_H
+#define ZABBIX_HISTLOG_H
+
+/* proxy history record, the same fields as proxy_history table row */
+typedef struct
+{
+	zbx_uint64_t	id;
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	lastlogsize;
+	const char	*source;
+	const char	*value;
+	int		clock;
+	int		ns;
+	int		timestamp;
+	int		severity;
+	int		logeventid;
+	int		mtime;
+	unsigned char	state;
+	unsigned char	flags;
+}
+zbx_histlog_record_t;
+
+int	zbx_is_histlog_enabled(void);
+int	zbx_histlog_init(char **error);
+void	zbx_histlog_destroy(void);
+
+int	zbx_histlog_write(const zbx_histlog_record_t *records, int records_num);
+void	zbx_histlog_seek(zbx_uint64_t lastid);
+int	zbx_histlog_read(zbx_histlog_record_t *record);
+
+zbx_uint64_t	zbx_histlog_get_lastid(void);
+void	zbx_histlog_set_lastid(zbx_uint64_t lastid);
+int	zbx_histlog_get_count(void);
+int	zbx_histlog_housekeep(int keep_sent, int keep_unsent);
+
+#endif
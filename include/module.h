@@ -193,6 +193,9 @@ typedef struct
 }
 ZBX_HISTORY_LOG;
 
+/* History callbacks are called by history syncers with the values of one synchronization batch. The arrays and */
+/* the strings they point to are owned by the server and are valid only until the callback returns, so modules */
+/* must copy whatever they want to keep. Callbacks delay history synchronization and should return quickly.    */
 typedef struct
 {
 	void	(*history_float_cb)(const ZBX_HISTORY_FLOAT *history, int history_num);
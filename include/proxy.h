@@ -48,6 +48,9 @@ int	process_host_availability(struct zbx_json_parse *jp_data, char **error);
 int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more);
 int	proxy_get_dhis_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more);
 int	proxy_get_areg_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more);
+int	proxy_get_hist_data_ext(struct zbx_json *j, zbx_uint64_t id, zbx_uint64_t *lastid, int *more);
+int	proxy_get_dhis_data_ext(struct zbx_json *j, zbx_uint64_t id, zbx_uint64_t *lastid, int *more);
+int	proxy_get_areg_data_ext(struct zbx_json *j, zbx_uint64_t id, zbx_uint64_t *lastid, int *more);
 void	proxy_set_hist_lastid(const zbx_uint64_t lastid);
 void	proxy_set_dhis_lastid(const zbx_uint64_t lastid);
 void	proxy_set_areg_lastid(const zbx_uint64_t lastid);
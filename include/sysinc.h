@@ -204,6 +204,14 @@
 #	include <pwd.h>
 #endif
 
+#ifdef HAVE_POLL_H
+#	include <poll.h>
+#endif
+
+#ifdef HAVE_SPAWN_H
+#	include <spawn.h>
+#endif
+
 #ifdef HAVE_SIGNAL_H
 #	include <signal.h>
 #endif
@@ -87,6 +87,7 @@ int	zbx_db_rollback(void);
 int	zbx_db_txn_level(void);
 int	zbx_db_txn_error(void);
 int	zbx_db_txn_end_error(void);
+int	zbx_db_upsert_supported(void);
 const char	*zbx_db_last_strerr(void);
 
 #ifdef HAVE_ORACLE
@@ -114,8 +115,13 @@ void		zbx_db_clean_bind_context(zbx_db_bind_context_t *context);
 int		zbx_db_statement_execute(int iters);
 #endif
 int		zbx_db_vexecute(const char *fmt, va_list args);
+int		zbx_db_vexecute_async(const char *fmt, va_list args);
+#if defined(HAVE_POSTGRESQL)
+int		zbx_db_copy(const char *sql, const char *data, size_t data_len);
+#endif
 DB_RESULT	zbx_db_vselect(const char *fmt, va_list args);
 DB_RESULT	zbx_db_select_n(const char *query, int n);
+DB_RESULT	zbx_db_select_prepared(const char *query, const char **params, int params_num, int n);
 
 DB_ROW		zbx_db_fetch(DB_RESULT result);
 void		DBfree_result(DB_RESULT result);
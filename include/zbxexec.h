@@ -27,4 +27,9 @@ int	zbx_execute(const char *command, char **buffer, char *error, size_t max_erro
 		unsigned char flag);
 int	zbx_execute_nowait(const char *command);
 
+#ifndef _WINDOWS
+int	zbx_coprocess_open(const char *command, pid_t *pid, int *fd_write, int *fd_read);
+void	zbx_coprocess_close(pid_t pid, int fd_write, int fd_read);
+#endif
+
 #endif
@@ -96,6 +96,8 @@
 #define ZBX_PROTO_TAG_AVG		"avg"
 #define ZBX_PROTO_TAG_MAX		"max"
 #define ZBX_PROTO_TAG_SESSION		"session"
+#define ZBX_PROTO_TAG_KEEPALIVE		"keepalive"
+#define ZBX_PROTO_TAG_CONFIG_REVISION	"config_revision"
 #define ZBX_PROTO_TAG_ID		"id"
 #define ZBX_PROTO_TAG_PARAMS		"params"
 #define ZBX_PROTO_TAG_FROM		"from"
@@ -1286,61 +1286,26 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Function: zbx_tcp_accept                                                   *
+ * Function: tcp_accept_socket                                                *
  *                                                                            *
- * Purpose: permits an incoming connection attempt on a socket                *
+ * Purpose: completes accepting of an incoming connection - saves peer        *
+ *          address and detects or establishes TLS connection                 *
  *                                                                            *
- * Return value: SUCCEED - success                                            *
- *               FAIL - an error occurred                                     *
+ * Parameters: s               - [IN/OUT] the listening socket, on success    *
+ *                                        it is replaced with accepted one    *
+ *             accepted_socket - [IN] the accepted connection socket          *
+ *             tls_accept      - [IN] the allowed connection types            *
  *                                                                            *
- * Author: Eugene Grigorjev, Aleksandrs Saveljevs                             *
+ * Return value: SUCCEED - success                                            *
+ *               FAIL - an error occurred, the accepted socket is closed      *
  *                                                                            *
  ******************************************************************************/
-int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept)
+static int	tcp_accept_socket(zbx_socket_t *s, ZBX_SOCKET accepted_socket, unsigned int tls_accept)
 {
-	ZBX_SOCKADDR	serv_addr;
-	fd_set		sock_set;
-	ZBX_SOCKET	accepted_socket;
-	ZBX_SOCKLEN_T	nlen;
-	int		i, n = 0, ret = FAIL;
+	int		ret = FAIL;
 	ssize_t		res;
 	unsigned char	buf;	/* 1 byte buffer */
 
-	zbx_tcp_unaccept(s);
-
-	FD_ZERO(&sock_set);
-
-	for (i = 0; i < s->num_socks; i++)
-	{
-		FD_SET(s->sockets[i], &sock_set);
-#ifndef _WINDOWS
-		if (s->sockets[i] > n)
-			n = s->sockets[i];
-#endif
-	}
-
-	if (ZBX_PROTO_ERROR == select(n + 1, &sock_set, NULL, NULL, NULL))
-	{
-		zbx_set_socket_strerror("select() failed: %s", strerror_from_system(zbx_socket_last_error()));
-		return ret;
-	}
-
-	for (i = 0; i < s->num_socks; i++)
-	{
-		if (FD_ISSET(s->sockets[i], &sock_set))
-			break;
-	}
-
-	/* Since this socket was returned by select(), we know we have */
-	/* a connection waiting and that this accept() will not block. */
-	nlen = sizeof(serv_addr);
-	if (ZBX_SOCKET_ERROR == (accepted_socket = (ZBX_SOCKET)accept(s->sockets[i], (struct sockaddr *)&serv_addr,
-			&nlen)))
-	{
-		zbx_set_socket_strerror("accept() failed: %s", strerror_from_system(zbx_socket_last_error()));
-		return ret;
-	}
-
 	s->socket_orig = s->socket;	/* remember main socket */
 	s->socket = accepted_socket;	/* replace socket to accepted */
 	s->accepted = 1;
@@ -1409,6 +1374,401 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tcp_accept                                                   *
+ *                                                                            *
+ * Purpose: permits an incoming connection attempt on a socket                *
+ *                                                                            *
+ * Return value: SUCCEED - success                                            *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ * Author: Eugene Grigorjev, Aleksandrs Saveljevs                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept(zbx_socket_t *s, unsigned int tls_accept)
+{
+	ZBX_SOCKADDR	serv_addr;
+	fd_set		sock_set;
+	ZBX_SOCKET	accepted_socket;
+	ZBX_SOCKLEN_T	nlen;
+	int		i, n = 0;
+
+	zbx_tcp_unaccept(s);
+
+	FD_ZERO(&sock_set);
+
+	for (i = 0; i < s->num_socks; i++)
+	{
+		FD_SET(s->sockets[i], &sock_set);
+#ifndef _WINDOWS
+		if (s->sockets[i] > n)
+			n = s->sockets[i];
+#endif
+	}
+
+	if (ZBX_PROTO_ERROR == select(n + 1, &sock_set, NULL, NULL, NULL))
+	{
+		zbx_set_socket_strerror("select() failed: %s", strerror_from_system(zbx_socket_last_error()));
+		return FAIL;
+	}
+
+	for (i = 0; i < s->num_socks; i++)
+	{
+		if (FD_ISSET(s->sockets[i], &sock_set))
+			break;
+	}
+
+	/* Since this socket was returned by select(), we know we have */
+	/* a connection waiting and that this accept() will not block. */
+	nlen = sizeof(serv_addr);
+	if (ZBX_SOCKET_ERROR == (accepted_socket = (ZBX_SOCKET)accept(s->sockets[i], (struct sockaddr *)&serv_addr,
+			&nlen)))
+	{
+		zbx_set_socket_strerror("accept() failed: %s", strerror_from_system(zbx_socket_last_error()));
+		return FAIL;
+	}
+
+	return tcp_accept_socket(s, accepted_socket, tls_accept);
+}
+
+#ifndef _WINDOWS
+/* the maximum number of accepted connections without data each process waits on */
+#define ZBX_TCP_PENDING_NEW_MAX	16
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tcp_pending_init                                             *
+ *                                                                            *
+ * Purpose: initializes list of accepted connections waiting for data         *
+ *                                                                            *
+ * Parameters: pending - [OUT] the pending connection list                    *
+ *             max     - [IN] the maximum number of pending connections       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tcp_pending_init(zbx_tcp_pending_t *pending, int max)
+{
+	pending->conns = (zbx_tcp_pending_conn_t *)zbx_malloc(NULL, sizeof(zbx_tcp_pending_conn_t) * max);
+	pending->pollfds = (struct pollfd *)zbx_malloc(NULL, sizeof(struct pollfd) * (max + ZBX_SOCKET_COUNT));
+	pending->num = 0;
+	pending->max = max;
+	pending->nonblocking = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: tcp_pending_close                                                *
+ *                                                                            *
+ * Purpose: closes pending connection                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	tcp_pending_close(zbx_tcp_pending_conn_t *conn)
+{
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (NULL != conn->tls_ctx)
+	{
+		zbx_socket_t	s;
+
+		s.socket = conn->socket;
+		s.tls_ctx = conn->tls_ctx;
+		s.timeout = 0;
+		strscpy(s.peer, conn->peer);
+		zbx_tls_close(&s);
+	}
+#endif
+	if (NULL != conn->peer)
+		shutdown(conn->socket, 2);
+
+	zbx_socket_close(conn->socket);
+	zbx_free(conn->peer);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tcp_pending_destroy                                          *
+ *                                                                            *
+ * Purpose: closes pending connections and frees the list                     *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_tcp_pending_destroy(zbx_tcp_pending_t *pending)
+{
+	int	i;
+
+	for (i = 0; i < pending->num; i++)
+		tcp_pending_close(&pending->conns[i]);
+
+	zbx_free(pending->pollfds);
+	zbx_free(pending->conns);
+}
+
+static void	tcp_pending_remove(zbx_tcp_pending_t *pending, int index)
+{
+	pending->conns[index] = pending->conns[--pending->num];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: tcp_pending_reserve                                              *
+ *                                                                            *
+ * Purpose: gets free slot in pending connection list, closing the kept       *
+ *          connection closest to its timeout if the list is full             *
+ *                                                                            *
+ * Return value: the free slot or NULL if the list is full of new connections *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_tcp_pending_conn_t	*tcp_pending_reserve(zbx_tcp_pending_t *pending)
+{
+	int	i, index = -1;
+
+	if (pending->num < pending->max)
+		return &pending->conns[pending->num++];
+
+	for (i = 0; i < pending->num; i++)
+	{
+		if (NULL == pending->conns[i].peer)
+			continue;
+
+		if (-1 == index || pending->conns[i].deadline < pending->conns[index].deadline)
+			index = i;
+	}
+
+	if (-1 == index)
+		return NULL;
+
+	tcp_pending_close(&pending->conns[index]);
+
+	return &pending->conns[index];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tcp_pending_keep                                             *
+ *                                                                            *
+ * Purpose: moves processed connection back to pending connection list to     *
+ *          wait for the next request                                         *
+ *                                                                            *
+ * Parameters: s       - [IN/OUT] the accepted socket, on success it is       *
+ *                                detached from the connection                *
+ *             pending - [IN/OUT] the pending connection list                 *
+ *             timeout - [IN] the number of seconds to wait for the next      *
+ *                            request                                         *
+ *                                                                            *
+ * Return value: SUCCEED - the connection was kept                            *
+ *               FAIL - the list is full, the socket must be unaccepted       *
+ *                                                                            *
+ * Comments: Connections are kept only for clients that wait for a response   *
+ *           before sending the next request, so no request data can be       *
+ *           buffered in the socket or TLS context.                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_pending_keep(zbx_socket_t *s, zbx_tcp_pending_t *pending, int timeout)
+{
+	zbx_tcp_pending_conn_t	*conn;
+
+	if (0 == s->accepted || pending->num == pending->max)
+		return FAIL;
+
+	conn = &pending->conns[pending->num++];
+	conn->socket = s->socket;
+	conn->deadline = (int)time(NULL) + timeout;
+	conn->connection_type = s->connection_type;
+	conn->peer_info = s->peer_info;
+	conn->peer = zbx_strdup(NULL, s->peer);
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	conn->tls_ctx = s->tls_ctx;
+	s->tls_ctx = NULL;
+#endif
+	zbx_socket_free(s);
+
+	s->socket = s->socket_orig;
+	s->socket_orig = ZBX_SOCKET_ERROR;
+	s->accepted = 0;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: tcp_pending_restore                                              *
+ *                                                                            *
+ * Purpose: attaches kept connection to the listening socket                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	tcp_pending_restore(zbx_socket_t *s, zbx_tcp_pending_conn_t *conn)
+{
+	s->socket_orig = s->socket;
+	s->socket = conn->socket;
+	s->accepted = 1;
+	s->connection_type = conn->connection_type;
+	s->peer_info = conn->peer_info;
+	strscpy(s->peer, conn->peer);
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	s->tls_ctx = conn->tls_ctx;
+#endif
+	zbx_free(conn->peer);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tcp_accept_pending                                           *
+ *                                                                            *
+ * Purpose: accepts incoming connections without waiting for their data and   *
+ *          returns the first connection that has data to read                *
+ *                                                                            *
+ * Parameters: s            - [IN/OUT] the listening socket, on success it is *
+ *                                     replaced with accepted one             *
+ *             pending      - [IN/OUT] the accepted connections waiting for   *
+ *                                     data                                   *
+ *             tls_accept   - [IN] the allowed connection types               *
+ *             idle_timeout - [IN] new connections without data for this      *
+ *                                 number of seconds are closed               *
+ *                                                                            *
+ * Return value: SUCCEED - a connection with data was accepted                *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ * Comments: A process waiting on many connections at once does not block     *
+ *           on clients that are slow to send their requests. Connections     *
+ *           with data are served before new connections are accepted and new *
+ *           connections are accepted only while the pending list is not      *
+ *           full and the process waits on less than ZBX_TCP_PENDING_NEW_MAX  *
+ *           new connections, so other processes listening on the same socket *
+ *           get them. Kept connections give way to new ones when the list is *
+ *           full. Connections are closed on timeout only if poll() reports   *
+ *           no events for them.                                              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_accept_pending(zbx_socket_t *s, zbx_tcp_pending_t *pending, unsigned int tls_accept, int idle_timeout)
+{
+	ZBX_SOCKADDR		serv_addr;
+	ZBX_SOCKET		accepted_socket;
+	ZBX_SOCKLEN_T		nlen;
+	zbx_tcp_pending_conn_t	*conn, conn_local;
+	int			i, ret, now, listen_num, pollfds_num, flags, new_num;
+
+	zbx_tcp_unaccept(s);
+
+	/* the listening sockets are shared with other processes, */
+	/* a connection signaled by poll() might be taken by them  */
+	if (0 == pending->nonblocking)
+	{
+		for (i = 0; i < s->num_socks; i++)
+		{
+			if (-1 != (flags = fcntl(s->sockets[i], F_GETFL)))
+				fcntl(s->sockets[i], F_SETFL, flags | O_NONBLOCK);
+		}
+
+		pending->nonblocking = 1;
+	}
+
+	while (1)
+	{
+		new_num = 0;
+
+		for (i = 0; i < pending->num; i++)
+		{
+			if (NULL == pending->conns[i].peer)
+				new_num++;
+		}
+
+		pollfds_num = 0;
+
+		/* leave new connections in the listen queue for other processes when this one already has */
+		/* enough of them, as each of them will be served by this process only                      */
+		if (ZBX_TCP_PENDING_NEW_MAX > new_num && (pending->num < pending->max || new_num != pending->num))
+		{
+			for (i = 0; i < s->num_socks; i++)
+			{
+				pending->pollfds[pollfds_num].fd = s->sockets[i];
+				pending->pollfds[pollfds_num++].events = POLLIN;
+			}
+		}
+
+		listen_num = pollfds_num;
+
+		for (i = 0; i < pending->num; i++)
+		{
+			pending->pollfds[pollfds_num].fd = pending->conns[i].socket;
+			pending->pollfds[pollfds_num++].events = POLLIN;
+		}
+
+		/* wake up every second to close idle connections */
+		if (-1 == (ret = poll(pending->pollfds, pollfds_num, 0 != pending->num ? 1000 : -1)))
+		{
+			zbx_set_socket_strerror("poll() failed: %s", strerror_from_system(zbx_socket_last_error()));
+			return FAIL;
+		}
+
+		now = (int)time(NULL);
+
+		/* expire connections only after poll() to not close the ones whose data has just arrived */
+		for (i = pollfds_num - 1; i >= listen_num; i--)
+		{
+			if (0 != pending->pollfds[i].revents || pending->conns[i - listen_num].deadline > now)
+				continue;
+
+			tcp_pending_close(&pending->conns[i - listen_num]);
+			tcp_pending_remove(pending, i - listen_num);
+			pending->pollfds[i] = pending->pollfds[listen_num + pending->num];
+		}
+
+		if (0 == ret)
+			continue;
+
+		for (i = listen_num; i < listen_num + pending->num; i++)
+		{
+			if (0 == pending->pollfds[i].revents)
+				continue;
+
+			conn_local = pending->conns[i - listen_num];
+			tcp_pending_remove(pending, i - listen_num);
+
+			if (NULL != conn_local.peer)
+			{
+				tcp_pending_restore(s, &conn_local);
+				return SUCCEED;
+			}
+
+			return tcp_accept_socket(s, conn_local.socket, tls_accept);
+		}
+
+		for (i = 0; i < listen_num; i++)
+		{
+			if (0 == (pending->pollfds[i].revents & POLLIN))
+				continue;
+
+			nlen = sizeof(serv_addr);
+			if (ZBX_SOCKET_ERROR == (accepted_socket = (ZBX_SOCKET)accept(s->sockets[i],
+					(struct sockaddr *)&serv_addr, &nlen)))
+			{
+				if (EAGAIN == errno || EWOULDBLOCK == errno || ECONNABORTED == errno)
+					continue;
+
+				zbx_set_socket_strerror("accept() failed: %s",
+						strerror_from_system(zbx_socket_last_error()));
+				return FAIL;
+			}
+
+			/* some systems inherit non-blocking mode from the listening socket */
+			if (-1 != (flags = fcntl(accepted_socket, F_GETFL)))
+				fcntl(accepted_socket, F_SETFL, flags & ~O_NONBLOCK);
+
+			if (NULL == (conn = tcp_pending_reserve(pending)))
+			{
+				zbx_socket_close(accepted_socket);
+				continue;
+			}
+
+			conn->socket = accepted_socket;
+			conn->deadline = now + idle_timeout;
+			conn->peer = NULL;
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+			conn->tls_ctx = NULL;
+#endif
+		}
+	}
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_tcp_unaccept                                                 *
@@ -1668,6 +2028,7 @@ ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout)
 	zbx_uint32_t	expected_len = 16 * ZBX_MEBIBYTE, reserved = 0;
 	unsigned char	expect = ZBX_TCP_EXPECT_HEADER;
 	int		protocol_version;
+	zbx_uncompress_stream_t	*stream = NULL;
 
 	if (0 != timeout)
 		zbx_socket_timeout_set(s, timeout);
@@ -1687,7 +2048,12 @@ ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout)
 		else
 		{
 			if (buf_dyn_bytes + nbytes <= expected_len)
-				memcpy(s->buffer + buf_dyn_bytes, s->buf_stat, nbytes);
+			{
+				if (NULL == stream)
+					memcpy(s->buffer + buf_dyn_bytes, s->buf_stat, nbytes);
+				else if (SUCCEED != zbx_uncompress_stream_write(stream, s->buf_stat, nbytes))
+					goto uncompress_error;
+			}
 			buf_dyn_bytes += nbytes;
 		}
 
@@ -1769,7 +2135,25 @@ ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout)
 				goto out;
 			}
 
-			if (sizeof(s->buf_stat) > expected_len)
+			if (0 != (protocol_version & ZBX_TCP_COMPRESS))
+			{
+				/* uncompress data as it arrives, without buffering the compressed message */
+				s->buf_type = ZBX_BUF_TYPE_DYN;
+				s->buffer = (char *)zbx_malloc(NULL, reserved + 1);
+
+				if (NULL == (stream = zbx_uncompress_stream_create(s->buffer, reserved)))
+					goto uncompress_error;
+
+				buf_dyn_bytes = buf_stat_bytes - offset;
+				buf_stat_bytes = 0;
+
+				if (SUCCEED != zbx_uncompress_stream_write(stream, s->buf_stat + offset,
+						MIN(buf_dyn_bytes, expected_len)))
+				{
+					goto uncompress_error;
+				}
+			}
+			else if (sizeof(s->buf_stat) > expected_len)
 			{
 				buf_stat_bytes -= offset;
 				memmove(s->buf_stat, s->buf_stat + offset, buf_stat_bytes);
@@ -1794,33 +2178,20 @@ ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout)
 	{
 		if (buf_stat_bytes + buf_dyn_bytes == expected_len)
 		{
-			if (0 != (protocol_version & ZBX_TCP_COMPRESS))
+			if (NULL != stream)
 			{
-				char	*out;
-				size_t	out_size = reserved;
+				size_t	out_size;
 
-				out = (char *)zbx_malloc(NULL, reserved + 1);
-				if (FAIL == zbx_uncompress(s->buffer, buf_stat_bytes + buf_dyn_bytes, out, &out_size))
-				{
-					zbx_free(out);
-					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
-					nbytes = ZBX_PROTO_ERROR;
-					goto out;
-				}
+				if (SUCCEED != zbx_uncompress_stream_finish(stream, &out_size))
+					goto uncompress_error;
 
 				if (out_size != reserved)
 				{
-					zbx_free(out);
 					zbx_set_socket_strerror("size of uncompressed data is less than expected");
 					nbytes = ZBX_PROTO_ERROR;
 					goto out;
 				}
 
-				if (ZBX_BUF_TYPE_DYN == s->buf_type)
-					zbx_free(s->buffer);
-
-				s->buf_type = ZBX_BUF_TYPE_DYN;
-				s->buffer = out;
 				s->read_bytes = reserved;
 
 				zabbix_log(LOG_LEVEL_TRACE, "%s(): received " ZBX_FS_SIZE_T " bytes with"
@@ -1876,7 +2247,15 @@ ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout)
 		s->read_bytes = 0;
 		s->buffer[s->read_bytes] = '\0';
 	}
+
+	goto out;
+uncompress_error:
+	zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+	nbytes = ZBX_PROTO_ERROR;
 out:
+	if (NULL != stream)
+		zbx_uncompress_stream_free(stream);
+
 	if (0 != timeout)
 		zbx_socket_timeout_cleanup(s);
 
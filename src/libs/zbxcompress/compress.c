@@ -126,6 +126,138 @@ int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
 	return SUCCEED;
 }
 
+struct zbx_uncompress_stream
+{
+	z_stream	zs;
+	int		finished;
+};
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_uncompress_stream_create                                     *
+ *                                                                            *
+ * Purpose: creates stream to uncompress data received in parts               *
+ *                                                                            *
+ * Parameters: out      - [OUT] the buffer for uncompressed data              *
+ *             size_out - [IN] the buffer size                                *
+ *                                                                            *
+ * Return value: the stream or NULL if it could not be initialized            *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(char *out, size_t size_out)
+{
+	zbx_uncompress_stream_t	*stream;
+
+	stream = (zbx_uncompress_stream_t *)zbx_malloc(NULL, sizeof(zbx_uncompress_stream_t));
+	memset(stream, 0, sizeof(zbx_uncompress_stream_t));
+
+	stream->zs.next_out = (Bytef *)out;
+	stream->zs.avail_out = size_out;
+
+	if (Z_OK != (zbx_zlib_errno = inflateInit(&stream->zs)))
+	{
+		zbx_free(stream);
+		return NULL;
+	}
+
+	return stream;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_uncompress_stream_write                                      *
+ *                                                                            *
+ * Purpose: uncompresses next part of data                                    *
+ *                                                                            *
+ * Parameters: stream  - [IN] the uncompression stream                        *
+ *             in      - [IN] the compressed data                             *
+ *             size_in - [IN] the compressed data size                        *
+ *                                                                            *
+ * Return value: SUCCEED - the data was uncompressed successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_write(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
+{
+	if (0 == size_in)
+		return SUCCEED;
+
+	/* data after the end of compressed stream */
+	if (0 != stream->finished)
+	{
+		zbx_zlib_errno = Z_DATA_ERROR;
+		return FAIL;
+	}
+
+	stream->zs.next_in = (Bytef *)in;
+	stream->zs.avail_in = size_in;
+
+	switch (zbx_zlib_errno = inflate(&stream->zs, Z_NO_FLUSH))
+	{
+		case Z_STREAM_END:
+			stream->finished = 1;
+			ZBX_FALLTHROUGH;
+		case Z_OK:
+			break;
+		case Z_BUF_ERROR:
+			/* no progress is possible only when output buffer is full */
+			if (0 == stream->zs.avail_out)
+				return FAIL;
+			break;
+		case Z_NEED_DICT:
+			zbx_zlib_errno = Z_DATA_ERROR;
+			ZBX_FALLTHROUGH;
+		default:
+			return FAIL;
+	}
+
+	/* input left unprocessed either does not fit output buffer or follows the end of stream */
+	if (0 != stream->zs.avail_in)
+	{
+		zbx_zlib_errno = (0 == stream->finished ? Z_BUF_ERROR : Z_DATA_ERROR);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_uncompress_stream_finish                                     *
+ *                                                                            *
+ * Purpose: checks that all compressed data was received                      *
+ *                                                                            *
+ * Parameters: stream   - [IN] the uncompression stream                       *
+ *             size_out - [OUT] the uncompressed data size                    *
+ *                                                                            *
+ * Return value: SUCCEED - the compressed data ended correctly                *
+ *               FAIL    - the compressed data is incomplete                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream, size_t *size_out)
+{
+	if (0 == stream->finished)
+	{
+		zbx_zlib_errno = Z_DATA_ERROR;
+		return FAIL;
+	}
+
+	*size_out = stream->zs.total_out;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_uncompress_stream_free                                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream)
+{
+	inflateEnd(&stream->zs);
+	zbx_free(stream);
+}
+
 #else
 
 int zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
@@ -151,4 +283,31 @@ const char	*zbx_compress_strerror(void)
 	return "";
 }
 
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(char *out, size_t size_out)
+{
+	ZBX_UNUSED(out);
+	ZBX_UNUSED(size_out);
+	return NULL;
+}
+
+int	zbx_uncompress_stream_write(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
+{
+	ZBX_UNUSED(stream);
+	ZBX_UNUSED(in);
+	ZBX_UNUSED(size_in);
+	return FAIL;
+}
+
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream, size_t *size_out)
+{
+	ZBX_UNUSED(stream);
+	ZBX_UNUSED(size_out);
+	return FAIL;
+}
+
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream)
+{
+	ZBX_UNUSED(stream);
+}
+
 #endif
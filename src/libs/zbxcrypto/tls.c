@@ -23,7 +23,9 @@
 
 #include "comms.h"
 #include "threads.h"
+#include "mutexs.h"
 #include "log.h"
+#include "md5.h"
 #include "tls.h"
 #include "tls_tcp.h"
 #include "tls_tcp_active.h"
@@ -182,6 +184,7 @@ struct zbx_tls_context
 	gnutls_psk_server_credentials_t	psk_server_creds;
 #elif defined(HAVE_OPENSSL)
 	SSL				*ctx;
+	md5_byte_t			session_key[MD5_DIGEST_SIZE];	/* key in TLS session cache */
 #endif
 };
 
@@ -260,10 +263,44 @@ static int					init_done 		= 0;
 ZBX_THREAD_LOCAL static int			incoming_connection_has_psk = 0;
 ZBX_THREAD_LOCAL static char			incoming_connection_psk_id[PSK_MAX_IDENTITY_LEN + 1];
 #endif
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* OpenSSL 1.1.1 or newer */
+/* variable for capturing valid session ticket from ticket decryption callback function */
+ZBX_THREAD_LOCAL static int			incoming_connection_has_ticket = 0;
+#endif
 /* buffer for messages produced by zbx_openssl_info_cb() */
 ZBX_THREAD_LOCAL char				info_buf[256];
 #endif
 
+#define ZBX_TLS_SESSION_DATA_MAX	4096	/* maximum size of serialized session */
+#define ZBX_TLS_SESSION_TIMEOUT		300	/* lifetime of resumable session, in seconds */
+#define ZBX_TLS_TICKET_KEYS_MAX		80	/* session ticket name, HMAC and AES keys */
+
+/* session of outgoing connection stored for resumption in shared memory */
+typedef struct
+{
+	md5_byte_t	key[MD5_DIGEST_SIZE];	/* hash of peer address and connection parameters */
+	int		len;			/* length of serialized session, 0 - slot is empty */
+	unsigned char	data[ZBX_TLS_SESSION_DATA_MAX];
+}
+zbx_tls_session_slot_t;
+
+typedef struct
+{
+	zbx_tls_stats_t		stats;
+
+	/* keys for encrypting and decrypting session tickets, shared by all processes so that a session */
+	/* established with one process can be resumed by any other */
+	unsigned char		ticket_keys[ZBX_TLS_TICKET_KEYS_MAX];
+
+	/* direct-mapped cache of outgoing connection sessions, 0 slots - session resumption is disabled */
+	int			slots_num;
+	zbx_tls_session_slot_t	*slots;
+}
+zbx_tls_cache_t;
+
+static zbx_tls_cache_t	*tls_cache = NULL;
+static zbx_mutex_t	tls_cache_lock = ZBX_MUTEX_NULL;
+
 #if defined(HAVE_POLARSSL)
 /**********************************************************************************
  *                                                                                *
@@ -1670,9 +1707,14 @@ static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned c
 
 	ZBX_UNUSED(ssl);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "%s() requested PSK identity \"%s\"", __function_name, identity);
+	/* with TLS 1.3 session ticket offered by client is passed here as PSK identity before it is decrypted */
+	if (SUCCEED != zbx_is_utf8(identity))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() requested PSK identity is not a valid UTF-8 string", __function_name);
+		return 0;
+	}
 
-	incoming_connection_has_psk = 1;
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() requested PSK identity \"%s\"", __function_name, identity);
 
 	/* try PSK from configuration file first (it is already in binary form) */
 
@@ -1722,12 +1764,12 @@ static unsigned int	zbx_psk_server_cb(SSL *ssl, const char *identity, unsigned c
 		}
 
 		memcpy(psk, psk_loc, psk_len);
+		incoming_connection_has_psk = 1;
 		zbx_strlcpy(incoming_connection_psk_id, identity, sizeof(incoming_connection_psk_id));
 
 		return (unsigned int)psk_len;	/* success */
 	}
 fail:
-	incoming_connection_psk_id[0] = '\0';
 	return 0;	/* PSK not found */
 }
 #endif
@@ -2884,6 +2926,137 @@ void	zbx_tls_init_parent(void)
 #endif
 }
 
+#if !defined(_WINDOWS)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_init_cache                                               *
+ *                                                                            *
+ * Purpose: allocate shared memory for TLS handshake statistics and the cache *
+ *          of sessions for resuming outgoing connections                     *
+ *                                                                            *
+ * Parameters: cache_size - [IN] number of cached sessions, 0 disables        *
+ *                               session resumption                           *
+ *             error      - [OUT] the error message                           *
+ *                                                                            *
+ * Return value: SUCCEED - the cache was initialized successfully             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: must be called in parent process before forking child processes  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tls_init_cache(int cache_size, char **error)
+{
+	const char	*__function_name = "zbx_tls_init_cache";
+	int		shm_id, ret = FAIL;
+	size_t		sz;
+	void		*p;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() size:%d", __function_name, cache_size);
+
+	if (SUCCEED != zbx_mutex_create(&tls_cache_lock, ZBX_MUTEX_TLS, error))
+		goto out;
+
+	sz = sizeof(zbx_tls_cache_t) + sizeof(zbx_tls_session_slot_t) * (size_t)cache_size;
+
+	if (-1 == (shm_id = shmget(IPC_PRIVATE, sz, 0600)))
+	{
+		*error = zbx_strdup(*error, "cannot allocate shared memory for TLS session cache");
+		goto out;
+	}
+
+	if ((void *)(-1) == (p = shmat(shm_id, NULL, 0)))
+	{
+		*error = zbx_dsprintf(*error, "cannot attach shared memory for TLS session cache: %s",
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	if (-1 == shmctl(shm_id, IPC_RMID, NULL))
+		zbx_error("cannot mark shared memory %d for destruction: %s", shm_id, zbx_strerror(errno));
+
+	memset(p, 0, sz);
+
+	tls_cache = (zbx_tls_cache_t *)p;
+	tls_cache->slots_num = cache_size;
+	tls_cache->slots = (zbx_tls_session_slot_t *)(tls_cache + 1);
+#if defined(HAVE_OPENSSL)
+	if (0 != cache_size && 1 != RAND_bytes(tls_cache->ticket_keys, sizeof(tls_cache->ticket_keys)))
+	{
+		*error = zbx_strdup(*error, "cannot generate TLS session ticket keys");
+		tls_cache = NULL;
+		goto out;
+	}
+#endif
+	ret = SUCCEED;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_get_stats                                                *
+ *                                                                            *
+ * Purpose: get TLS handshake statistics of all processes                     *
+ *                                                                            *
+ * Parameters: stats - [OUT] the handshake statistics                         *
+ *                                                                            *
+ * Return value: SUCCEED - the statistics were retrieved                      *
+ *               FAIL    - the statistics are not collected                   *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tls_get_stats(zbx_tls_stats_t *stats)
+{
+	if (NULL == tls_cache)
+		return FAIL;
+
+	zbx_mutex_lock(tls_cache_lock);
+	*stats = tls_cache->stats;
+	zbx_mutex_unlock(tls_cache_lock);
+
+	return SUCCEED;
+}
+
+#if defined(HAVE_OPENSSL)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_update_stats                                             *
+ *                                                                            *
+ * Purpose: account TLS handshake in the shared statistics                    *
+ *                                                                            *
+ * Parameters: result     - [IN] SUCCEED - handshake was successful           *
+ *             resumed    - [IN] 1 - previous session was resumed             *
+ *             time_spent - [IN] time spent in handshake, in seconds          *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_tls_update_stats(int result, int resumed, double time_spent)
+{
+	if (NULL == tls_cache)
+		return;
+
+	zbx_mutex_lock(tls_cache_lock);
+
+	if (SUCCEED != result)
+	{
+		tls_cache->stats.failed++;
+	}
+	else if (1 == resumed)
+	{
+		tls_cache->stats.resumed++;
+		tls_cache->stats.resumed_time += time_spent;
+	}
+	else
+	{
+		tls_cache->stats.full++;
+		tls_cache->stats.full_time += time_spent;
+	}
+
+	zbx_mutex_unlock(tls_cache_lock);
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_tls_init_child                                               *
@@ -3374,6 +3547,331 @@ static const char	*zbx_ctx_name(SSL_CTX *param)
 	return ZBX_NULL2STR(NULL);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_session_slot                                             *
+ *                                                                            *
+ * Purpose: get session cache slot for the specified session key              *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_tls_session_slot_t	*zbx_tls_session_slot(const md5_byte_t *key)
+{
+	unsigned int	index;
+
+	memcpy(&index, key, sizeof(index));
+
+	return &tls_cache->slots[index % (unsigned int)tls_cache->slots_num];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_session_new_cb                                           *
+ *                                                                            *
+ * Purpose: store new session of outgoing connection in shared cache          *
+ *                                                                            *
+ * Return value: 0 - the session reference is not kept by the callback        *
+ *                                                                            *
+ * Comments:                                                                  *
+ *     A callback function, its arguments are defined in OpenSSL.             *
+ *     With TLS 1.3 it is called when a session ticket arrives, which can     *
+ *     happen after the handshake, while reading the response.                *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_tls_session_new_cb(SSL *ssl, SSL_SESSION *session)
+{
+	zbx_tls_context_t	*tls_ctx;
+	zbx_tls_session_slot_t	*slot;
+	unsigned char		*ptr;
+	int			len;
+
+	/* only outgoing connections have session key set */
+	if (NULL == (tls_ctx = (zbx_tls_context_t *)SSL_get_app_data(ssl)))
+		return 0;
+
+	if (0 >= (len = i2d_SSL_SESSION(session, NULL)) || ZBX_TLS_SESSION_DATA_MAX < len)
+		return 0;
+
+	slot = zbx_tls_session_slot(tls_ctx->session_key);
+
+	zbx_mutex_lock(tls_cache_lock);
+
+	ptr = slot->data;
+	i2d_SSL_SESSION(session, &ptr);
+	memcpy(slot->key, tls_ctx->session_key, MD5_DIGEST_SIZE);
+	slot->len = len;
+
+	zbx_mutex_unlock(tls_cache_lock);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_session_restore                                          *
+ *                                                                            *
+ * Purpose: prepare outgoing connection for resuming previously cached        *
+ *          session with the same peer and connection parameters              *
+ *                                                                            *
+ * Parameters: s           - [IN] socket with opened connection               *
+ *             tls_connect - [IN] how to connect                              *
+ *             tls_arg1    - [IN] issuer or PSK identity                      *
+ *             tls_arg2    - [IN] subject or PSK                              *
+ *                                                                            *
+ * Return value: the offered session (must be freed by caller) or NULL        *
+ *                                                                            *
+ * Comments: the PSK (either from database or from configuration file) is     *
+ *           included in the session key, so a session is never resumed       *
+ *           after the PSK has been changed                                   *
+ *                                                                            *
+ ******************************************************************************/
+static SSL_SESSION	*zbx_tls_session_restore(zbx_socket_t *s, unsigned int tls_connect, const char *tls_arg1,
+		const char *tls_arg2)
+{
+	md5_state_t		state;
+	ZBX_SOCKADDR		sa;
+	ZBX_SOCKLEN_T		sz = sizeof(sa);
+	zbx_tls_session_slot_t	*slot;
+	SSL_SESSION		*session = NULL;
+	const unsigned char	*ptr;
+
+	memset(&sa, 0, sizeof(sa));
+
+	zbx_md5_init(&state);
+
+	if (ZBX_PROTO_ERROR != getpeername(s->socket, (struct sockaddr *)&sa, &sz))
+		zbx_md5_append(&state, (const md5_byte_t *)&sa, (int)sz);
+
+	zbx_md5_append(&state, (const md5_byte_t *)&tls_connect, sizeof(tls_connect));
+
+#if defined(HAVE_OPENSSL_WITH_PSK)
+	if (ZBX_TCP_SEC_TLS_PSK == tls_connect)
+	{
+		/* tls_arg1 and tls_arg2 are NULL when PSK comes from configuration file, use the PSK identity */
+		/* and PSK which will be passed to the PSK client callback instead */
+		if (NULL != psk_identity_for_cb)
+		{
+			zbx_md5_append(&state, (const md5_byte_t *)psk_identity_for_cb,
+					(int)strlen(psk_identity_for_cb) + 1);
+		}
+
+		if (NULL != psk_for_cb)
+		{
+			zbx_md5_append(&state, (const md5_byte_t *)&psk_len_for_cb, sizeof(psk_len_for_cb));
+			zbx_md5_append(&state, (const md5_byte_t *)psk_for_cb, (int)psk_len_for_cb);
+		}
+	}
+	else
+#endif
+	{
+		/* include terminating '\0' to separate the arguments */
+		if (NULL != tls_arg1)
+			zbx_md5_append(&state, (const md5_byte_t *)tls_arg1, (int)strlen(tls_arg1) + 1);
+
+		if (NULL != tls_arg2)
+			zbx_md5_append(&state, (const md5_byte_t *)tls_arg2, (int)strlen(tls_arg2) + 1);
+	}
+
+	zbx_md5_finish(&state, s->tls_ctx->session_key);
+
+	SSL_set_app_data(s->tls_ctx->ctx, s->tls_ctx);
+
+	slot = zbx_tls_session_slot(s->tls_ctx->session_key);
+
+	zbx_mutex_lock(tls_cache_lock);
+
+	if (0 != slot->len && 0 == memcmp(slot->key, s->tls_ctx->session_key, MD5_DIGEST_SIZE))
+	{
+		ptr = slot->data;
+		session = d2i_SSL_SESSION(NULL, &ptr, slot->len);
+	}
+
+	zbx_mutex_unlock(tls_cache_lock);
+
+	if (NULL != session && 1 != SSL_set_session(s->tls_ctx->ctx, session))
+	{
+		SSL_SESSION_free(session);
+		session = NULL;
+	}
+
+	return session;
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* OpenSSL 1.1.1 or newer */
+/* session ticket application data tells how the original connection was authenticated */
+#define ZBX_TLS_TICKET_CERT	'C'
+#define ZBX_TLS_TICKET_PSK	'P'
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_ticket_gen_cb                                            *
+ *                                                                            *
+ * Purpose: store authentication type and PSK identity of incoming            *
+ *          connection in session ticket                                      *
+ *                                                                            *
+ * Comments:                                                                  *
+ *     A callback function, its arguments are defined in OpenSSL.             *
+ *     TLS 1.3 sessions established with external PSK do not keep the PSK     *
+ *     identity, so the ticket carries it for resumed connections.            *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_tls_ticket_gen_cb(SSL *ssl, void *arg)
+{
+	SSL_SESSION	*session;
+	void		*data;
+	size_t		len;
+	char		appdata[PSK_MAX_IDENTITY_LEN + 2];
+
+	ZBX_UNUSED(arg);
+
+	session = SSL_get_session(ssl);
+
+	/* tickets issued for resumed connections carry data from the original session */
+	if (1 == SSL_SESSION_get0_ticket_appdata(session, &data, &len) && 0 != len)
+		return 1;
+
+#if defined(HAVE_OPENSSL_WITH_PSK)
+	if (1 == incoming_connection_has_psk)
+	{
+		appdata[0] = ZBX_TLS_TICKET_PSK;
+		len = zbx_strlcpy(appdata + 1, incoming_connection_psk_id, sizeof(appdata) - 1) + 1;
+	}
+	else
+#endif
+	{
+		appdata[0] = ZBX_TLS_TICKET_CERT;
+		len = 1;
+	}
+
+	return SSL_SESSION_set1_ticket_appdata(session, appdata, len);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_ticket_dec_cb                                            *
+ *                                                                            *
+ * Purpose: remember that incoming connection offered a valid session ticket  *
+ *                                                                            *
+ * Comments:                                                                  *
+ *     A callback function, its arguments are defined in OpenSSL.             *
+ *     Returns the same values as OpenSSL does without the callback.          *
+ *                                                                            *
+ ******************************************************************************/
+static SSL_TICKET_RETURN	zbx_tls_ticket_dec_cb(SSL *ssl, SSL_SESSION *session, const unsigned char *keyname,
+		size_t keyname_len, SSL_TICKET_STATUS status, void *arg)
+{
+	ZBX_UNUSED(ssl);
+	ZBX_UNUSED(session);
+	ZBX_UNUSED(keyname);
+	ZBX_UNUSED(keyname_len);
+	ZBX_UNUSED(arg);
+
+	switch (status)
+	{
+		case SSL_TICKET_SUCCESS:
+			incoming_connection_has_ticket = 1;
+			return SSL_TICKET_RETURN_USE;
+		case SSL_TICKET_SUCCESS_RENEW:
+			incoming_connection_has_ticket = 1;
+			return SSL_TICKET_RETURN_USE_RENEW;
+		case SSL_TICKET_EMPTY:
+		case SSL_TICKET_NO_DECRYPT:
+			return SSL_TICKET_RETURN_IGNORE_RENEW;
+		default:
+			return SSL_TICKET_RETURN_ABORT;
+	}
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_tls_accept_resumed                                           *
+ *                                                                            *
+ * Purpose: check if incoming connection resumed a session and restore its    *
+ *          PSK identity                                                      *
+ *                                                                            *
+ * Return value: 1 - the connection resumed a session issued by any process   *
+ *               0 - full handshake was performed                             *
+ *                                                                            *
+ * Comments: PSK server callback is not called when session is resumed        *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_tls_accept_resumed(SSL *ssl)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* OpenSSL 1.1.1 or newer */
+	void		*data;
+	size_t		len;
+
+	/* TLS 1.3 reports external PSK handshakes as reused sessions too */
+	if (1 != SSL_session_reused(ssl) || 0 == incoming_connection_has_ticket ||
+			1 != SSL_SESSION_get0_ticket_appdata(SSL_get_session(ssl), &data, &len) || 0 == len)
+	{
+		return 0;
+	}
+#if defined(HAVE_OPENSSL_WITH_PSK)
+	if (ZBX_TLS_TICKET_PSK == *(const char *)data)
+	{
+		incoming_connection_has_psk = 1;
+		zbx_strlcpy(incoming_connection_psk_id, (const char *)data + 1,
+				MIN(len, sizeof(incoming_connection_psk_id)));
+	}
+	else
+		incoming_connection_has_psk = 0;
+#endif
+#else
+#if defined(HAVE_OPENSSL_WITH_PSK)
+	const char	*identity;
+#endif
+	if (1 != SSL_session_reused(ssl))
+		return 0;
+#if defined(HAVE_OPENSSL_WITH_PSK)
+	if (NULL != (identity = SSL_get_psk_identity(ssl)))
+	{
+		incoming_connection_has_psk = 1;
+		zbx_strlcpy(incoming_connection_psk_id, identity, sizeof(incoming_connection_psk_id));
+	}
+#endif
+#endif
+	return 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_set_session_resumption                                       *
+ *                                                                            *
+ * Purpose: enable session tickets and caching of outgoing connection         *
+ *          sessions if TLS session cache is configured                       *
+ *                                                                            *
+ * Return value: SUCCEED - session resumption is enabled or not configured    *
+ *               FAIL    - session ticket keys cannot be set                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_set_session_resumption(SSL_CTX *ctx)
+{
+	long	keys_len;
+
+	if (NULL == tls_cache || 0 == tls_cache->slots_num)
+		return SUCCEED;
+
+	/* ticket key length depends on OpenSSL version */
+	if (0 >= (keys_len = SSL_CTX_get_tlsext_ticket_keys(ctx, NULL, 0)) || ZBX_TLS_TICKET_KEYS_MAX < keys_len ||
+			1 != SSL_CTX_set_tlsext_ticket_keys(ctx, tls_cache->ticket_keys, keys_len))
+	{
+		return FAIL;
+	}
+
+	SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+	SSL_CTX_set_timeout(ctx, ZBX_TLS_SESSION_TIMEOUT);
+
+	/* sessions of outgoing connections are kept in shared cache instead of per-process internal one */
+	SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(ctx, zbx_tls_session_new_cb);
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* OpenSSL 1.1.1 or newer */
+	SSL_CTX_set_num_tickets(ctx, 1);
+	SSL_CTX_set_session_ticket_cb(ctx, zbx_tls_ticket_gen_cb, zbx_tls_ticket_dec_cb, NULL);
+#endif
+	return SUCCEED;
+}
+
 static int	zbx_set_ecdhe_parameters(SSL_CTX *ctx)
 {
 	const char	*__function_name = "zbx_set_ecdhe_parameters";
@@ -3689,9 +4187,16 @@ void	zbx_tls_init_child(void)
 		/* do not connect to unpatched servers */
 		SSL_CTX_clear_options(ctx_cert, SSL_OP_LEGACY_SERVER_CONNECT);
 
-		/* disable session caching */
+		/* disable session caching unless TLS session cache is configured */
 		SSL_CTX_set_session_cache_mode(ctx_cert, SSL_SESS_CACHE_OFF);
 
+		if (SUCCEED != zbx_set_session_resumption(ctx_cert))
+		{
+			zbx_snprintf_alloc(&error, &error_alloc, &error_offset, "cannot set TLS session ticket keys"
+					" for %s:", zbx_ctx_name(ctx_cert));
+			goto out;
+		}
+
 		/* try to enable ECDH ciphersuites */
 		if (SUCCEED == zbx_set_ecdhe_parameters(ctx_cert))
 			ciphers = ZBX_CIPHERS_CERT_ECDHE ZBX_CIPHERS_CERT;
@@ -3769,6 +4274,13 @@ void	zbx_tls_init_child(void)
 		SSL_CTX_clear_options(ctx_psk, SSL_OP_LEGACY_SERVER_CONNECT);
 		SSL_CTX_set_session_cache_mode(ctx_psk, SSL_SESS_CACHE_OFF);
 
+		if (SUCCEED != zbx_set_session_resumption(ctx_psk))
+		{
+			zbx_snprintf_alloc(&error, &error_alloc, &error_offset, "cannot set TLS session ticket keys"
+					" for %s:", zbx_ctx_name(ctx_psk));
+			goto out;
+		}
+
 		if ('\0' != *ZBX_CIPHERS_PSK_ECDHE && SUCCEED == zbx_set_ecdhe_parameters(ctx_psk))
 			ciphers = ZBX_CIPHERS_PSK_ECDHE ZBX_CIPHERS_PSK;
 		else
@@ -3844,6 +4356,13 @@ void	zbx_tls_init_child(void)
 		SSL_CTX_clear_options(ctx_all, SSL_OP_LEGACY_SERVER_CONNECT);
 		SSL_CTX_set_session_cache_mode(ctx_all, SSL_SESS_CACHE_OFF);
 
+		if (SUCCEED != zbx_set_session_resumption(ctx_all))
+		{
+			zbx_snprintf_alloc(&error, &error_alloc, &error_offset, "cannot set TLS session ticket keys"
+					" for %s:", zbx_ctx_name(ctx_all));
+			goto out;
+		}
+
 		if (SUCCEED == zbx_set_ecdhe_parameters(ctx_all))
 			ciphers = ZBX_CIPHERS_CERT_ECDHE ZBX_CIPHERS_CERT ":" ZBX_CIPHERS_PSK_ECDHE ZBX_CIPHERS_PSK;
 		else
@@ -4620,6 +5139,9 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 	const char	*__function_name = "zbx_tls_connect";
 	int		ret = FAIL, res;
 	size_t		error_alloc = 0, error_offset = 0;
+	double		time_start;
+	SSL_SESSION	*session = NULL;
+	int		resumed;
 #if defined(_WINDOWS)
 	double		sec;
 #endif
@@ -4722,6 +5244,9 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 		goto out;
 	}
 
+	if (NULL != tls_cache && 0 != tls_cache->slots_num)
+		session = zbx_tls_session_restore(s, tls_connect, tls_arg1, tls_arg2);
+
 	/* TLS handshake */
 
 	info_buf[0] = '\0';	/* empty buffer for zbx_openssl_info_cb() messages */
@@ -4729,10 +5254,21 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 	zbx_alarm_flag_clear();
 	sec = zbx_time();
 #endif
-	if (1 != (res = SSL_connect(s->tls_ctx->ctx)))
+	time_start = zbx_time();
+	res = SSL_connect(s->tls_ctx->ctx);
+
+	/* a new session object is created unless the offered one is resumed */
+	resumed = (NULL != session && session == SSL_get_session(s->tls_ctx->ctx) ? 1 : 0);
+
+	if (NULL != session)
+		SSL_SESSION_free(session);
+
+	if (1 != res)
 	{
 		int	result_code;
 
+		zbx_tls_update_stats(FAIL, 0, 0);
+
 #if defined(_WINDOWS)
 		if (s->timeout < zbx_time() - sec)
 			zbx_alarm_flag_set();
@@ -4811,6 +5347,8 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 		}
 	}
 
+	zbx_tls_update_stats(SUCCEED, resumed, zbx_time() - time_start);
+
 	if (ZBX_TCP_SEC_TLS_CERT == tls_connect)
 	{
 		long	verify_result;
@@ -4837,8 +5375,9 @@ int	zbx_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char *tls_a
 
 	s->connection_type = tls_connect;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s)", __function_name,
-			SSL_get_version(s->tls_ctx->ctx), SSL_get_cipher(s->tls_ctx->ctx));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s%s)", __function_name,
+			SSL_get_version(s->tls_ctx->ctx), SSL_get_cipher(s->tls_ctx->ctx),
+			1 == resumed ? ", resumed" : "");
 
 	return SUCCEED;
 
@@ -5345,12 +5884,12 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	int		ret = FAIL, res;
 	size_t		error_alloc = 0, error_offset = 0;
 	long		verify_result;
+	double		time_start;
+	int		resumed;
 #if defined(_WINDOWS)
 	double		sec;
 #endif
-#if OPENSSL_VERSION_NUMBER >= 0x1010100fL	/* OpenSSL 1.1.1 or newer, or LibreSSL */
 	const unsigned char	session_id_context[] = {'Z', 'b', 'x'};
-#endif
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
 	s->tls_ctx = zbx_malloc(s->tls_ctx, sizeof(zbx_tls_context_t));
@@ -5358,6 +5897,9 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 
 #if defined(HAVE_OPENSSL_WITH_PSK)
 	incoming_connection_has_psk = 0;	/* assume certificate-based connection by default */
+#endif
+#if OPENSSL_VERSION_NUMBER >= 0x1010100fL && !defined(LIBRESSL_VERSION_NUMBER)	/* OpenSSL 1.1.1 or newer */
+	incoming_connection_has_ticket = 0;
 #endif
 	if ((ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK) == (tls_accept & (ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK)))
 	{
@@ -5468,11 +6010,16 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 
 #if OPENSSL_VERSION_NUMBER >= 0x1010100fL	/* OpenSSL 1.1.1 or newer, or LibreSSL */
 	if (1 != SSL_set_session_id_context(s->tls_ctx->ctx, session_id_context, sizeof(session_id_context)))
+#else
+	/* session id context is required for resuming sessions with peer certificate verification */
+	if (NULL != tls_cache && 0 != tls_cache->slots_num &&
+			1 != SSL_set_session_id_context(s->tls_ctx->ctx, session_id_context, sizeof(session_id_context)))
+#endif
 	{
 		*error = zbx_strdup(*error, "cannot set session_id_context");
 		goto out;
 	}
-#endif
+
 	if (1 != SSL_set_fd(s->tls_ctx->ctx, s->socket))
 	{
 		*error = zbx_strdup(*error, "cannot set socket for TLS context");
@@ -5486,10 +6033,14 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 	zbx_alarm_flag_clear();
 	sec = zbx_time();
 #endif
+	time_start = zbx_time();
+
 	if (1 != (res = SSL_accept(s->tls_ctx->ctx)))
 	{
 		int	result_code;
 
+		zbx_tls_update_stats(FAIL, 0, 0);
+
 #if defined(_WINDOWS)
 		if (s->timeout < zbx_time() - sec)
 			zbx_alarm_flag_set();
@@ -5528,6 +6079,8 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		goto out;
 	}
 
+	resumed = zbx_tls_accept_resumed(s->tls_ctx->ctx);
+	zbx_tls_update_stats(SUCCEED, resumed, zbx_time() - time_start);
 	/* Is this TLS conection using certificate or PSK? */
 
 	cipher_name = SSL_get_cipher(s->tls_ctx->ctx);
@@ -5564,8 +6117,8 @@ int	zbx_tls_accept(zbx_socket_t *s, unsigned int tls_accept, char **error)
 		return FAIL;
 	}
 #endif
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s)", __function_name,
-			SSL_get_version(s->tls_ctx->ctx), cipher_name);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():SUCCEED (established %s %s%s)", __function_name,
+			SSL_get_version(s->tls_ctx->ctx), cipher_name, 1 == resumed ? ", resumed" : "");
 
 	return SUCCEED;
 
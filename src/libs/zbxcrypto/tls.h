@@ -75,6 +75,17 @@ void	zbx_tls_pass_vars(ZBX_THREAD_SENDVAL_TLS_ARGS *args);
 void	zbx_tls_take_vars(ZBX_THREAD_SENDVAL_TLS_ARGS *args);
 #endif	/* #if defined(_WINDOWS) */
 
+/* TLS handshake statistics */
+typedef struct
+{
+	zbx_uint64_t	full;		/* number of full handshakes */
+	zbx_uint64_t	resumed;	/* number of abbreviated handshakes resuming previous session */
+	zbx_uint64_t	failed;		/* number of failed handshakes */
+	double		full_time;	/* total time spent in full handshakes, in seconds */
+	double		resumed_time;	/* total time spent in abbreviated handshakes, in seconds */
+}
+zbx_tls_stats_t;
+
 void	zbx_tls_validate_config(void);
 void	zbx_tls_library_deinit(void);
 void	zbx_tls_init_parent(void);
@@ -82,6 +93,10 @@ void	zbx_tls_init_child(void);
 void	zbx_tls_free(void);
 void	zbx_tls_free_on_signal(void);
 void	zbx_tls_version(void);
+#if !defined(_WINDOWS)
+int	zbx_tls_init_cache(int cache_size, char **error);
+#endif
+int	zbx_tls_get_stats(zbx_tls_stats_t *stats);
 
 #endif	/* #if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL) */
 
@@ -80,6 +80,7 @@ static int	txn_end_error = ZBX_DB_OK;	/* transaction result */
 static char	*last_db_strerror = NULL;	/* last database error message */
 
 extern int	CONFIG_LOG_SLOW_QUERIES;
+extern int	CONFIG_DB_PREPARED_STATEMENTS;
 
 #if defined(HAVE_IBM_DB2)
 typedef struct
@@ -116,10 +117,31 @@ static zbx_oracle_db_handle_t	oracle;
 static ub4	OCI_DBserver_status(void);
 
 #elif defined(HAVE_POSTGRESQL)
+#include "zbxalgo.h"
+
+/* the maximum number of prepared statements per connection */
+#define ZBX_PG_PREPARED_MAX	256
+
+/* prepared statement of the current connection */
+typedef struct
+{
+	/* the statement text with $<n> parameter placeholders, used as cache key */
+	char	*sql;
+	/* the prepared statement name */
+	char	name[16];
+}
+zbx_pg_prepared_t;
+
 static PGconn			*conn = NULL;
 static unsigned int		ZBX_PG_BYTEAOID = 0;
 static int			ZBX_PG_SVERSION = 0;
 char				ZBX_PG_ESCAPE_BACKSLASH = 1;
+static zbx_hashset_t		pg_prepared;
+static int			pg_prepared_num = 0;
+static char			*pg_async_sql = NULL;	/* the statement sent without waiting for its result */
+static double			pg_async_sec;
+
+static int	zbx_db_pg_async_wait(void);
 #elif defined(HAVE_SQLITE3)
 static sqlite3			*conn = NULL;
 static zbx_mutex_t		sqlite_access = ZBX_MUTEX_NULL;
@@ -299,6 +321,21 @@ static int	zbx_db_execute(const char *fmt, ...)
 	return ret;
 }
 
+#if defined(HAVE_POSTGRESQL)
+__zbx_attr_format_printf(1, 2)
+static int	zbx_db_execute_async(const char *fmt, ...)
+{
+	va_list	args;
+	int	ret;
+
+	va_start(args, fmt);
+	ret = zbx_db_vexecute_async(fmt, args);
+	va_end(args);
+
+	return ret;
+}
+#endif
+
 __zbx_attr_format_printf(1, 2)
 static DB_RESULT	zbx_db_select(const char *fmt, ...)
 {
@@ -861,6 +898,22 @@ void	zbx_db_close(void)
 		PQfinish(conn);
 		conn = NULL;
 	}
+
+	zbx_free(pg_async_sql);
+
+	/* prepared statements are released by server together with the connection */
+	if (0 != pg_prepared.num_slots)
+	{
+		zbx_hashset_iter_t	iter;
+		zbx_pg_prepared_t	*prepared;
+
+		zbx_hashset_iter_reset(&pg_prepared, &iter);
+
+		while (NULL != (prepared = (zbx_pg_prepared_t *)zbx_hashset_iter_next(&iter)))
+			zbx_free(prepared->sql);
+
+		zbx_hashset_destroy(&pg_prepared);
+	}
 #elif defined(HAVE_SQLITE3)
 	if (NULL != conn)
 	{
@@ -911,8 +964,11 @@ int	zbx_db_begin(void)
 		rc = (SQL_CD_TRUE == IBM_DB2server_status() ? ZBX_DB_FAIL : ZBX_DB_DOWN);
 	}
 
-#elif defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+#elif defined(HAVE_MYSQL)
 	rc = zbx_db_execute("begin;");
+#elif defined(HAVE_POSTGRESQL)
+	/* the next statement is sent right after begin without extra round trip */
+	rc = zbx_db_execute_async("begin;");
 #elif defined(HAVE_SQLITE3)
 	zbx_mutex_lock(sqlite_access);
 	rc = zbx_db_execute("begin;");
@@ -947,6 +1003,10 @@ int	zbx_db_commit(void)
 		assert(0);
 	}
 
+#if defined(HAVE_POSTGRESQL)
+	if (ZBX_DB_DOWN == zbx_db_pg_async_wait())
+		txn_error = ZBX_DB_DOWN;
+#endif
 	if (ZBX_DB_OK != txn_error)
 		return ZBX_DB_FAIL; /* commit called on failed transaction */
 
@@ -1008,6 +1068,9 @@ int	zbx_db_rollback(void)
 		assert(0);
 	}
 
+#if defined(HAVE_POSTGRESQL)
+	zbx_db_pg_async_wait();
+#endif
 	last_txn_error = txn_error;
 
 	/* allow rollback of failed transaction */
@@ -1067,6 +1130,30 @@ int	zbx_db_txn_end_error(void)
 	return txn_end_error;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_upsert_supported                                          *
+ *                                                                            *
+ * Purpose: check if the connected database can merge conflicting rows within *
+ *          an insert statement                                               *
+ *                                                                            *
+ * Return value: SUCCEED - insert ... on conflict (PostgreSQL 9.5 and newer)  *
+ *                         or insert ... on duplicate key update (MySQL) can  *
+ *                         be used                                            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_upsert_supported(void)
+{
+#if defined(HAVE_MYSQL)
+	return SUCCEED;
+#elif defined(HAVE_POSTGRESQL)
+	return 90500 <= ZBX_PG_SVERSION ? SUCCEED : FAIL;
+#else
+	return FAIL;
+#endif
+}
+
 #ifdef HAVE_ORACLE
 static sword	zbx_oracle_statement_prepare(const char *sql)
 {
@@ -1329,6 +1416,254 @@ out:
 }
 #endif
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_pg_async_wait                                             *
+ *                                                                            *
+ * Purpose: waits for the result of statement sent by zbx_db_vexecute_async() *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on         *
+ *               recoverable error)                                           *
+ *                                                                            *
+ * Comments: Must be called before sending any other statement. Failure of    *
+ *           the asynchronous statement fails the current transaction.        *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pg_async_wait(void)
+{
+	PGresult	*result;
+	char		*error = NULL;
+	int		ret = ZBX_DB_OK;
+
+	if (NULL == pg_async_sql)
+		return ZBX_DB_OK;
+
+	/* multiple statements return a result for each statement followed by NULL */
+	while (NULL != (result = PQgetResult(conn)))
+	{
+		if (ZBX_DB_OK == ret && PGRES_COMMAND_OK != PQresultStatus(result) &&
+				PGRES_TUPLES_OK != PQresultStatus(result))
+		{
+			zbx_postgresql_error(&error, result);
+			zbx_db_errlog(ERR_Z3005, 0, error, pg_async_sql);
+			zbx_free(error);
+
+			ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+		}
+
+		PQclear(result);
+	}
+
+	if (ZBX_DB_OK == ret && CONNECTION_OK != PQstatus(conn))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), pg_async_sql);
+		ret = ZBX_DB_DOWN;
+	}
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		pg_async_sec = zbx_time() - pg_async_sec;
+		if (pg_async_sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", pg_async_sec,
+					pg_async_sql);
+		}
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", pg_async_sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	zbx_free(pg_async_sql);
+
+	return ret;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_vexecute_async                                            *
+ *                                                                            *
+ * Purpose: Send SQL statement without waiting for its result. For            *
+ *          non-select statements only.                                       *
+ *                                                                            *
+ * Return value: ZBX_DB_OK (statement was sent), ZBX_DB_FAIL (on error) or    *
+ *               ZBX_DB_DOWN (on recoverable error)                           *
+ *                                                                            *
+ * Comments: The statement is executed by database while the caller prepares  *
+ *           the next one. Its result is checked before the next statement is *
+ *           sent, failure sets the current transaction as failed, so it is   *
+ *           reported by commit. The number of affected rows is not           *
+ *           available. Statements are executed synchronously on databases    *
+ *           other than PostgreSQL.                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_vexecute_async(const char *fmt, va_list args)
+{
+#if defined(HAVE_POSTGRESQL)
+	char	*sql;
+	int	ret;
+
+	if (ZBX_DB_OK != (ret = zbx_db_pg_async_wait()))
+		return ret;
+
+	sql = zbx_dvsprintf(NULL, fmt, args);
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
+		zbx_free(sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query async [txnlev:%d] [%s]", txn_level, sql);
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		pg_async_sec = zbx_time();
+
+	if (1 != PQsendQuery(conn, sql))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		zbx_free(sql);
+
+		if (CONNECTION_OK != PQstatus(conn))
+			return ZBX_DB_DOWN;
+
+		if (0 < txn_level)
+			txn_error = ZBX_DB_FAIL;
+
+		return ZBX_DB_FAIL;
+	}
+
+	pg_async_sql = sql;
+
+	return ZBX_DB_OK;
+#else
+	return zbx_db_vexecute(fmt, args);
+#endif
+}
+
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_copy                                                      *
+ *                                                                            *
+ * Purpose: load rows into table with COPY ... FROM STDIN statement           *
+ *                                                                            *
+ * Parameters: sql      - [IN] the COPY statement                             *
+ *             data     - [IN] the rows in COPY text format                   *
+ *             data_len - [IN] the data length                                *
+ *                                                                            *
+ * Return value: ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on recoverable error) *
+ *               or number of rows loaded (on success)                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_db_copy(const char *sql, const char *data, size_t data_len)
+{
+	PGresult	*result;
+	char		*error = NULL;
+	int		ret = ZBX_DB_OK;
+	double		sec = 0;
+
+	if (ZBX_DB_DOWN == zbx_db_pg_async_wait())
+		return ZBX_DB_DOWN;
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	if (0 == txn_level)
+		zabbix_log(LOG_LEVEL_DEBUG, "query without transaction detected");
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
+		return ZBX_DB_FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] [%s]", txn_level, sql, data);
+
+	result = PQexec(conn, sql);
+
+	if (NULL == result)
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+		goto out;
+	}
+
+	if (PGRES_COPY_IN != PQresultStatus(result))
+	{
+		zbx_postgresql_error(&error, result);
+		zbx_db_errlog(ERR_Z3005, 0, error, sql);
+		zbx_free(error);
+
+		ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+		PQclear(result);
+		goto out;
+	}
+
+	PQclear(result);
+
+	if (1 != PQputCopyData(conn, data, (int)data_len))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		ret = ZBX_DB_DOWN;
+
+		PQputCopyEnd(conn, "cannot send data");
+	}
+	else if (1 != PQputCopyEnd(conn, NULL))
+	{
+		zbx_db_errlog(ERR_Z3005, 0, PQerrorMessage(conn), sql);
+		ret = ZBX_DB_DOWN;
+	}
+
+	/* the COPY command result is followed by a NULL result */
+	while (NULL != (result = PQgetResult(conn)))
+	{
+		if (PGRES_COPY_IN == PQresultStatus(result))
+		{
+			/* the copy could not be ended, connection is broken */
+			PQclear(result);
+			break;
+		}
+
+		if (ZBX_DB_OK == ret && PGRES_COMMAND_OK != PQresultStatus(result))
+		{
+			zbx_postgresql_error(&error, result);
+			zbx_db_errlog(ERR_Z3005, 0, error, sql);
+			zbx_free(error);
+
+			ret = (SUCCEED == is_recoverable_postgresql_error(conn, result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+		}
+		else if (ZBX_DB_OK == ret)
+			ret = atoi(PQcmdTuples(result));
+
+		PQclear(result);
+	}
+out:
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (ZBX_DB_FAIL == ret && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+
+	return ret;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_db_vexecute                                                  *
@@ -1361,6 +1696,10 @@ int	zbx_db_vexecute(const char *fmt, va_list args)
 	char		*error = NULL;
 #endif
 
+#if defined(HAVE_POSTGRESQL)
+	if (ZBX_DB_DOWN == zbx_db_pg_async_wait())
+		return ZBX_DB_DOWN;
+#endif
 	if (0 != CONFIG_LOG_SLOW_QUERIES)
 		sec = zbx_time();
 
@@ -1540,6 +1879,140 @@ clean:
 	return ret;
 }
 
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_pg_result                                                 *
+ *                                                                            *
+ * Purpose: wraps PostgreSQL select statement result                          *
+ *                                                                            *
+ * Parameters: pg_result - [IN] the statement result                          *
+ *             sql       - [IN] the statement, used for error reporting       *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (DB_RESULT)ZBX_DB_DOWN              *
+ *                                                                            *
+ ******************************************************************************/
+static DB_RESULT	zbx_db_pg_result(PGresult *pg_result, const char *sql)
+{
+	DB_RESULT	result;
+	char		*error = NULL;
+
+	result = zbx_malloc(NULL, sizeof(struct zbx_db_result));
+	result->pg_result = pg_result;
+	result->values = NULL;
+	result->cursor = 0;
+	result->row_num = 0;
+
+	if (NULL == result->pg_result)
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+
+	if (PGRES_TUPLES_OK != PQresultStatus(result->pg_result))
+	{
+		zbx_postgresql_error(&error, result->pg_result);
+		zbx_db_errlog(ERR_Z3005, 0, error, sql);
+		zbx_free(error);
+
+		if (SUCCEED == is_recoverable_postgresql_error(conn, result->pg_result))
+		{
+			DBfree_result(result);
+			result = (DB_RESULT)ZBX_DB_DOWN;
+		}
+		else
+		{
+			DBfree_result(result);
+			result = NULL;
+		}
+	}
+	else	/* init rownum */
+		result->row_num = PQntuples(result->pg_result);
+
+	return result;
+}
+
+static zbx_hash_t	zbx_pg_prepared_hash_func(const void *data)
+{
+	const char	*sql = ((const zbx_pg_prepared_t *)data)->sql;
+
+	return ZBX_DEFAULT_STRING_HASH_ALGO(sql, strlen(sql), ZBX_DEFAULT_HASH_SEED);
+}
+
+static int	zbx_pg_prepared_compare_func(const void *d1, const void *d2)
+{
+	return strcmp(((const zbx_pg_prepared_t *)d1)->sql, ((const zbx_pg_prepared_t *)d2)->sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_pg_prepare                                                *
+ *                                                                            *
+ * Purpose: finds prepared statement in cache or prepares a new one           *
+ *                                                                            *
+ * Parameters: sql        - [IN] the statement with $<n> placeholders         *
+ *             params_num - [IN] the number of statement parameters           *
+ *             prepared   - [OUT] the prepared statement, NULL if the cache   *
+ *                                is full                                     *
+ *                                                                            *
+ * Return value: ZBX_DB_OK, ZBX_DB_FAIL (on error) or ZBX_DB_DOWN (on         *
+ *               recoverable error)                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_pg_prepare(const char *sql, int params_num, zbx_pg_prepared_t **prepared)
+{
+	zbx_pg_prepared_t	prepared_local;
+	PGresult		*pg_result;
+	char			*error = NULL;
+	int			ret = ZBX_DB_OK;
+
+	if (0 == pg_prepared.num_slots)
+	{
+		zbx_hashset_create(&pg_prepared, 16, zbx_pg_prepared_hash_func, zbx_pg_prepared_compare_func);
+	}
+	else
+	{
+		prepared_local.sql = (char *)sql;
+
+		if (NULL != (*prepared = (zbx_pg_prepared_t *)zbx_hashset_search(&pg_prepared, &prepared_local)))
+			return ZBX_DB_OK;
+	}
+
+	*prepared = NULL;
+
+	if (ZBX_PG_PREPARED_MAX <= pg_prepared.num_data)
+		return ZBX_DB_OK;
+
+	/* statement names must be unique only within the connection, but counter is never reset for simplicity */
+	zbx_snprintf(prepared_local.name, sizeof(prepared_local.name), "zbx_%d", ++pg_prepared_num);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "prepare [%s] [%s]", prepared_local.name, sql);
+
+	pg_result = PQprepare(conn, prepared_local.name, sql, params_num, NULL);
+
+	if (NULL == pg_result)
+	{
+		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
+		ret = (CONNECTION_OK == PQstatus(conn) ? ZBX_DB_FAIL : ZBX_DB_DOWN);
+	}
+	else if (PGRES_COMMAND_OK != PQresultStatus(pg_result))
+	{
+		zbx_postgresql_error(&error, pg_result);
+		zbx_db_errlog(ERR_Z3005, 0, error, sql);
+		zbx_free(error);
+
+		ret = (SUCCEED == is_recoverable_postgresql_error(conn, pg_result) ? ZBX_DB_DOWN : ZBX_DB_FAIL);
+	}
+	else
+	{
+		prepared_local.sql = zbx_strdup(NULL, sql);
+		*prepared = (zbx_pg_prepared_t *)zbx_hashset_insert(&pg_prepared, &prepared_local,
+				sizeof(prepared_local));
+	}
+
+	PQclear(pg_result);
+
+	return ret;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_db_vselect                                                   *
@@ -1560,13 +2033,15 @@ DB_RESULT	zbx_db_vselect(const char *fmt, va_list args)
 #elif defined(HAVE_ORACLE)
 	sword		err = OCI_SUCCESS;
 	ub4		prefetch_rows = 200, counter;
-#elif defined(HAVE_POSTGRESQL)
-	char		*error = NULL;
 #elif defined(HAVE_SQLITE3)
 	int		ret = FAIL;
 	char		*error = NULL;
 #endif
 
+#if defined(HAVE_POSTGRESQL)
+	if (ZBX_DB_DOWN == zbx_db_pg_async_wait())
+		return (DB_RESULT)ZBX_DB_DOWN;
+#endif
 	if (0 != CONFIG_LOG_SLOW_QUERIES)
 		sec = zbx_time();
 
@@ -1804,34 +2279,7 @@ error:
 		result = (ZBX_DB_DOWN == server_status ? (DB_RESULT)(intptr_t)server_status : NULL);
 	}
 #elif defined(HAVE_POSTGRESQL)
-	result = zbx_malloc(NULL, sizeof(struct zbx_db_result));
-	result->pg_result = PQexec(conn, sql);
-	result->values = NULL;
-	result->cursor = 0;
-	result->row_num = 0;
-
-	if (NULL == result->pg_result)
-		zbx_db_errlog(ERR_Z3005, 0, "result is NULL", sql);
-
-	if (PGRES_TUPLES_OK != PQresultStatus(result->pg_result))
-	{
-		zbx_postgresql_error(&error, result->pg_result);
-		zbx_db_errlog(ERR_Z3005, 0, error, sql);
-		zbx_free(error);
-
-		if (SUCCEED == is_recoverable_postgresql_error(conn, result->pg_result))
-		{
-			DBfree_result(result);
-			result = (DB_RESULT)ZBX_DB_DOWN;
-		}
-		else
-		{
-			DBfree_result(result);
-			result = NULL;
-		}
-	}
-	else	/* init rownum */
-		result->row_num = PQntuples(result->pg_result);
+	result = zbx_db_pg_result(PQexec(conn, sql), sql);
 #elif defined(HAVE_SQLITE3)
 	if (0 == txn_level)
 		zbx_mutex_lock(sqlite_access);
@@ -1885,6 +2333,137 @@ clean:
 	return result;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_select_prepared                                           *
+ *                                                                            *
+ * Purpose: execute a parameterized select statement                          *
+ *                                                                            *
+ * Parameters: query      - [IN] the statement with '?' parameter             *
+ *                               placeholders                                 *
+ *             params     - [IN] the parameter values                         *
+ *             params_num - [IN] the number of parameters                     *
+ *             n          - [IN] the maximum number of rows to select,        *
+ *                               0 - no limit                                 *
+ *                                                                            *
+ * Return value: data, NULL (on error) or (DB_RESULT)ZBX_DB_DOWN              *
+ *                                                                            *
+ * Comments: Only numeric parameter values are supported. On PostgreSQL the   *
+ *           statements are prepared once per connection and cached by the    *
+ *           statement text unless named prepared statements are disabled     *
+ *           with DBPreparedStatements=0, then unnamed statements are used.   *
+ *           On other databases the parameter values are substituted into the *
+ *           statement text.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+DB_RESULT	zbx_db_select_prepared(const char *query, const char **params, int params_num, int n)
+{
+	char		*sql = NULL;
+	size_t		sql_alloc = 0, sql_offset = 0;
+	const char	*ptr;
+	int		i = 0;
+	DB_RESULT	result = NULL;
+#if defined(HAVE_POSTGRESQL)
+	zbx_pg_prepared_t	*prepared;
+	const char		**values;
+	char			limit[MAX_ID_LEN + 1];
+	double			sec = 0;
+	int			rc, j;
+
+	if (ZBX_DB_DOWN == zbx_db_pg_async_wait())
+		return (DB_RESULT)ZBX_DB_DOWN;
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+		sec = zbx_time();
+
+	values = (const char **)zbx_malloc(NULL, sizeof(char *) * (params_num + 1));
+
+	for (ptr = query; '\0' != *ptr; ptr++)
+	{
+		if ('?' == *ptr && i < params_num)
+		{
+			values[i] = params[i];
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "$%d", ++i);
+		}
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, *ptr);
+	}
+
+	if (0 != n)
+	{
+		zbx_snprintf(limit, sizeof(limit), "%d", n);
+		values[i] = limit;
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " limit $%d", ++i);
+	}
+
+	if (ZBX_DB_OK != txn_error)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "ignoring query [txnlev:%d] [%s] within failed transaction", txn_level, sql);
+		goto clean;
+	}
+
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
+	{
+		char	*str = NULL;
+		size_t	str_alloc = 0, str_offset = 0;
+
+		for (j = 0; j < i; j++)
+		{
+			if (0 != j)
+				zbx_chrcpy_alloc(&str, &str_alloc, &str_offset, ',');
+			zbx_strcpy_alloc(&str, &str_alloc, &str_offset, values[j]);
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s] [%s]", txn_level, sql, ZBX_NULL2EMPTY_STR(str));
+		zbx_free(str);
+	}
+
+	prepared = NULL;
+
+	if (0 != CONFIG_DB_PREPARED_STATEMENTS && ZBX_DB_OK != (rc = zbx_db_pg_prepare(sql, i, &prepared)))
+	{
+		result = (ZBX_DB_DOWN == rc ? (DB_RESULT)ZBX_DB_DOWN : NULL);
+	}
+	else if (NULL != prepared)
+	{
+		result = zbx_db_pg_result(PQexecPrepared(conn, prepared->name, i, values, NULL, NULL, 0), sql);
+	}
+	else
+		result = zbx_db_pg_result(PQexecParams(conn, sql, i, NULL, values, NULL, NULL, 0), sql);
+
+	if (0 != CONFIG_LOG_SLOW_QUERIES)
+	{
+		sec = zbx_time() - sec;
+		if (sec > (double)CONFIG_LOG_SLOW_QUERIES / 1000.0)
+			zabbix_log(LOG_LEVEL_WARNING, "slow query: " ZBX_FS_DBL " sec, \"%s\"", sec, sql);
+	}
+
+	if (NULL == result && 0 < txn_level)
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "query [%s] failed, setting transaction as failed", sql);
+		txn_error = ZBX_DB_FAIL;
+	}
+clean:
+	zbx_free(values);
+#else
+	for (ptr = query; '\0' != *ptr; ptr++)
+	{
+		if ('?' == *ptr && i < params_num)
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, params[i++]);
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, *ptr);
+	}
+
+	if (0 != n)
+		result = zbx_db_select_n(sql, n);
+	else
+		result = zbx_db_select("%s", sql);
+#endif
+	zbx_free(sql);
+
+	return result;
+}
+
 /*
  * Execute SQL statement. For select statements only.
  */
@@ -34,6 +34,7 @@
 #include "zbxmodules.h"
 #include "module.h"
 #include "export.h"
+#include "histlog.h"
 #include "zbxjson.h"
 #include "zbxhistory.h"
 
@@ -73,6 +74,9 @@ extern unsigned char	program_type;
 /* the minimum processed item percentage of item candidates to continue synchronizing */
 #define ZBX_HC_SYNC_MIN_PCNT	10
 
+/* the time spent in a single loadable module history callback after which a warning is logged */
+#define ZBX_MODULE_SYNC_WARNING_TIME	1
+
 /* the maximum number of characters for history cache values */
 #define ZBX_HISTORY_VALUE_LEN	(1024 * 64)
 
@@ -161,6 +165,7 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num);
 static void	hc_pop_items(zbx_vector_ptr_t *history_items);
 static void	hc_get_item_values(ZBX_DC_HISTORY *history, zbx_vector_ptr_t *history_items);
 static void	hc_push_items(zbx_vector_ptr_t *history_items);
+static void	hc_push_busy_items(zbx_vector_ptr_t *history_items);
 static void	hc_free_item_values(ZBX_DC_HISTORY *history, int history_num);
 static void	hc_queue_item(zbx_hc_item_t *item);
 static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
@@ -415,6 +420,126 @@ static void	dc_insert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigne
 	zbx_db_insert_clean(&db_insert);
 }
 
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+#	if defined(HAVE_POSTGRESQL)
+#		define ZBX_TRENDS_UPSERT	" on conflict (itemid,clock) do update set"
+#		define ZBX_TRENDS_NEW(col)	"excluded." col
+#	else
+#		define ZBX_TRENDS_UPSERT	" on duplicate key update"
+#		define ZBX_TRENDS_NEW(col)	"values(" col ")"
+#	endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_upsert_trends_execute                                         *
+ *                                                                            *
+ * Purpose: helper function for dc_upsert_trends_in_db                        *
+ *                                                                            *
+ * Comments: Appends the merge clause to the buffered insert statement and    *
+ *           executes it. The clause adds the new values to an existing row   *
+ *           of the same hour. MySQL applies the assignments from left to     *
+ *           right, so the number of values must be updated last.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_upsert_trends_execute(unsigned char value_type, const char *table_name, size_t *sql_offset)
+{
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+	{
+		zbx_snprintf_alloc(&sql, &sql_alloc, sql_offset, ZBX_TRENDS_UPSERT
+				" value_avg=(%s.value_avg*%s.num+" ZBX_TRENDS_NEW("value_avg") "*"
+					ZBX_TRENDS_NEW("num") ")/(%s.num+" ZBX_TRENDS_NEW("num") "),",
+				table_name, table_name, table_name);
+	}
+	else
+	{
+		/* avoid 64-bit integer overflow when multiplying the average by the number of values */
+		zbx_snprintf_alloc(&sql, &sql_alloc, sql_offset, ZBX_TRENDS_UPSERT
+				" value_avg=floor((cast(%s.value_avg as decimal(40,0))*%s.num+"
+					"cast(" ZBX_TRENDS_NEW("value_avg") " as decimal(40,0))*"
+					ZBX_TRENDS_NEW("num") ")/(%s.num+" ZBX_TRENDS_NEW("num") ")),",
+				table_name, table_name, table_name);
+	}
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, sql_offset,
+			"value_min=least(%s.value_min," ZBX_TRENDS_NEW("value_min") "),"
+			"value_max=greatest(%s.value_max," ZBX_TRENDS_NEW("value_max") "),"
+			"num=%s.num+" ZBX_TRENDS_NEW("num") ";\n",
+			table_name, table_name, table_name);
+
+	DBexecute_async("%s", sql);
+
+	*sql_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_upsert_trends_in_db                                           *
+ *                                                                            *
+ * Purpose: helper function for DCflush trends                                *
+ *                                                                            *
+ * Comments: Writes the trends without reading the stored rows first. Values  *
+ *           for an hour that is already in the database (late data or a      *
+ *           second flush of the same hour) are merged into the stored row by *
+ *           the database.                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_upsert_trends_in_db(ZBX_DC_TREND *trends, int trends_num, unsigned char value_type,
+		const char *table_name, int clock)
+{
+	ZBX_DC_TREND	*trend;
+	int		i;
+	size_t		sql_offset = 0;
+
+	for (i = 0; i < trends_num; i++)
+	{
+		trend = &trends[i];
+
+		if (0 == trend->itemid)
+			continue;
+
+		if (clock != trend->clock || value_type != trend->value_type)
+			continue;
+
+		if (0 == sql_offset)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					"insert into %s (itemid,clock,num,value_min,value_avg,value_max) values ",
+					table_name);
+		}
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					"(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_DBL "," ZBX_FS_DBL "," ZBX_FS_DBL ")",
+					trend->itemid, trend->clock, trend->num, trend->value_min.dbl,
+					trend->value_avg.dbl, trend->value_max.dbl);
+		}
+		else
+		{
+			zbx_uint128_t	avg;
+
+			/* calculate the trend average value */
+			udiv128_64(&avg, &trend->value_avg.ui64, trend->num);
+
+			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+					"(" ZBX_FS_UI64 ",%d,%d," ZBX_FS_UI64 "," ZBX_FS_UI64 "," ZBX_FS_UI64 ")",
+					trend->itemid, trend->clock, trend->num, trend->value_min.ui64, avg.lo,
+					trend->value_max.ui64);
+		}
+
+		trend->itemid = 0;
+
+		if (ZBX_MAX_SQL_SIZE < sql_offset)
+			dc_upsert_trends_execute(value_type, table_name, &sql_offset);
+	}
+
+	if (0 != sql_offset)
+		dc_upsert_trends_execute(value_type, table_name, &sql_offset);
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Function: dc_remove_updated_trends                                         *
@@ -620,7 +745,7 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 	DBend_multiple_update(&sql, &sql_alloc, &sql_offset);
 
 	if (sql_offset > 16)	/* In ORACLE always present begin..end; */
-		DBexecute("%s", sql);
+		DBexecute_async("%s", sql);
 }
 
 /******************************************************************************
@@ -635,7 +760,8 @@ static void	dc_trends_fetch_and_update(ZBX_DC_TREND *trends, int trends_num, zbx
 static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uint64_pair_t *trends_diff)
 {
 	const char	*__function_name = "DBflush_trends";
-	int		num, i, clock, inserts_num = 0, itemids_alloc, itemids_num = 0, trends_to = *trends_num;
+	int		num, i, clock, inserts_num = 0, itemids_alloc, itemids_num = 0, trends_to = *trends_num,
+			upsert;
 	unsigned char	value_type;
 	zbx_uint64_t	*itemids = NULL;
 	ZBX_DC_TREND	*trend = NULL;
@@ -658,6 +784,8 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 			assert(0);
 	}
 
+	upsert = zbx_db_upsert_supported();
+
 	itemids_alloc = MIN(ZBX_HC_SYNC_MAX, *trends_num);
 	itemids = (zbx_uint64_t *)zbx_malloc(itemids, itemids_alloc * sizeof(zbx_uint64_t));
 
@@ -682,29 +810,33 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 		}
 	}
 
-	if (0 != itemids_num)
+	/* when the database can merge the rows itself the stored trends are not read back */
+	if (SUCCEED != upsert)
 	{
-		dc_remove_updated_trends(trends, trends_to, table_name, value_type, itemids,
-				&itemids_num, clock);
-	}
+		if (0 != itemids_num)
+		{
+			dc_remove_updated_trends(trends, trends_to, table_name, value_type, itemids,
+					&itemids_num, clock);
+		}
 
-	for (i = 0; i < trends_to; i++)
-	{
-		trend = &trends[i];
+		for (i = 0; i < trends_to; i++)
+		{
+			trend = &trends[i];
 
-		if (clock != trend->clock || value_type != trend->value_type)
-			continue;
+			if (clock != trend->clock || value_type != trend->value_type)
+				continue;
 
-		if (0 != trend->disable_from && clock >= trend->disable_from)
-			continue;
+			if (0 != trend->disable_from && clock >= trend->disable_from)
+				continue;
 
-		uint64_array_add(&itemids, &itemids_alloc, &itemids_num, trend->itemid, 64);
-	}
+			uint64_array_add(&itemids, &itemids_alloc, &itemids_num, trend->itemid, 64);
+		}
 
-	if (0 != itemids_num)
-	{
-		dc_trends_fetch_and_update(trends, trends_to, itemids, itemids_num,
-				&inserts_num, value_type, table_name, clock);
+		if (0 != itemids_num)
+		{
+			dc_trends_fetch_and_update(trends, trends_to, itemids, itemids_num,
+					&inserts_num, value_type, table_name, clock);
+		}
 	}
 
 	zbx_free(itemids);
@@ -733,7 +865,14 @@ static void	DBflush_trends(ZBX_DC_TREND *trends, int *trends_num, zbx_vector_uin
 	}
 
 	if (0 != inserts_num)
-		dc_insert_trends_in_db(trends, trends_to, value_type, table_name, clock);
+	{
+#if defined(HAVE_MYSQL) || defined(HAVE_POSTGRESQL)
+		if (SUCCEED == upsert)
+			dc_upsert_trends_in_db(trends, trends_to, value_type, table_name, clock);
+		else
+#endif
+			dc_insert_trends_in_db(trends, trends_to, value_type, table_name, clock);
+	}
 
 	/* clean trends */
 	for (i = 0, num = 0; i < *trends_num; i++)
@@ -917,13 +1056,31 @@ static void	DBmass_update_trends(const ZBX_DC_TREND *trends, int trends_num,
 	}
 }
 
+/* host groups, item names and applications are cached by the exporting */
+/* process and re-read from database when they are older than this      */
+#define ZBX_EXPORT_INFO_TTL	SEC_PER_MIN
+
 typedef struct
 {
 	zbx_uint64_t		hostid;
 	zbx_vector_ptr_t	groups;
+	int			lastcheck;
 }
 zbx_host_info_t;
 
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	char			*name;
+	zbx_vector_ptr_t	applications;
+	int			lastcheck;
+}
+zbx_item_info_t;
+
+static zbx_hashset_t	export_hosts_info;
+static zbx_hashset_t	export_items_info;
+static int		export_info_lastclean = 0;
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_host_info_clean                                              *
@@ -939,6 +1096,22 @@ static void	zbx_host_info_clean(zbx_host_info_t *host_info)
 	zbx_vector_ptr_destroy(&host_info->groups);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_item_info_clean                                              *
+ *                                                                            *
+ * Purpose: frees resources allocated to store item applications and name     *
+ *                                                                            *
+ * Parameters: item_info - [IN] item information                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_item_info_clean(zbx_item_info_t *item_info)
+{
+	zbx_vector_ptr_clear_ext(&item_info->applications, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&item_info->applications);
+	zbx_free(item_info->name);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: db_get_hosts_info_by_hostid                                      *
@@ -948,6 +1121,9 @@ static void	zbx_host_info_clean(zbx_host_info_t *host_info)
  * Parameters: hosts_info - [IN/OUT] output names of host groups for a host   *
  *             hostids    - [IN] hosts identifiers                            *
  *                                                                            *
+ * Comments: the hosts must already be present in hosts_info, their old group *
+ *           names are replaced                                               *
+ *                                                                            *
  ******************************************************************************/
 static void	db_get_hosts_info_by_hostid(zbx_hashset_t *hosts_info, const zbx_vector_uint64_t *hostids)
 {
@@ -958,10 +1134,10 @@ static void	db_get_hosts_info_by_hostid(zbx_hashset_t *hosts_info, const zbx_vec
 
 	for (i = 0; i < hostids->values_num; i++)
 	{
-		zbx_host_info_t	host_info = {.hostid = hostids->values[i]};
+		zbx_host_info_t	*host_info;
 
-		zbx_vector_ptr_create(&host_info.groups);
-		zbx_hashset_insert(hosts_info, &host_info, sizeof(host_info));
+		if (NULL != (host_info = (zbx_host_info_t *)zbx_hashset_search(hosts_info, &hostids->values[i])))
+			zbx_vector_ptr_clear_ext(&host_info->groups, zbx_ptr_free);
 	}
 
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
@@ -992,33 +1168,44 @@ static void	db_get_hosts_info_by_hostid(zbx_hashset_t *hosts_info, const zbx_vec
 	DBfree_result(result);
 }
 
-typedef struct
-{
-	zbx_uint64_t		itemid;
-	char			*name;
-	DC_ITEM			*item;
-	zbx_vector_ptr_t	applications;
-}
-zbx_item_info_t;
-
 /******************************************************************************
  *                                                                            *
  * Function: db_get_items_info_by_itemid                                      *
  *                                                                            *
  * Purpose: get items name and applications                                   *
  *                                                                            *
- * Parameters: items_info - [IN/OUT] output item name and applications        *
- *             itemids    - [IN] the item identifiers                         *
+ * Parameters: items_info   - [IN/OUT] output item name and applications      *
+ *             info_itemids - [IN] the identifiers of items to read           *
+ *             itemids      - [IN] the item identifiers                       *
+ *                                 (used for item lookup)                     *
+ *             items        - [IN] the items                                  *
+ *                                                                            *
+ * Comments: the items must already be present in items_info, their old name  *
+ *           and applications are replaced                                    *
  *                                                                            *
  ******************************************************************************/
-static void	db_get_items_info_by_itemid(zbx_hashset_t *items_info, const zbx_vector_uint64_t *itemids)
+static void	db_get_items_info_by_itemid(zbx_hashset_t *items_info, const zbx_vector_uint64_t *info_itemids,
+		const zbx_vector_uint64_t *itemids, DC_ITEM *items)
 {
+	int		i, index;
 	size_t		sql_offset = 0;
 	DB_RESULT	result;
 	DB_ROW		row;
 
+	for (i = 0; i < info_itemids->values_num; i++)
+	{
+		zbx_item_info_t	*item_info;
+
+		if (NULL != (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &info_itemids->values[i])))
+		{
+			zbx_vector_ptr_clear_ext(&item_info->applications, zbx_ptr_free);
+			zbx_free(item_info->name);
+		}
+	}
+
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select itemid,name from items where");
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", itemids->values, itemids->values_num);
+	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", info_itemids->values,
+			info_itemids->values_num);
 
 	result = DBselect("%s", sql);
 
@@ -1029,13 +1216,15 @@ static void	db_get_items_info_by_itemid(zbx_hashset_t *items_info, const zbx_vec
 
 		ZBX_DBROW2UINT64(itemid, row[0]);
 
-		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &itemid)))
+		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &itemid)) ||
+				FAIL == (index = zbx_vector_uint64_bsearch(itemids, itemid,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
 			continue;
 		}
 
-		zbx_substitute_item_name_macros(item_info->item, row[1], &item_info->name);
+		zbx_substitute_item_name_macros(&items[index], row[1], &item_info->name);
 	}
 	DBfree_result(result);
 
@@ -1046,7 +1235,8 @@ static void	db_get_items_info_by_itemid(zbx_hashset_t *items_info, const zbx_vec
 			" where a.applicationid=i.applicationid"
 				" and");
 
-	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "i.itemid", itemids->values, itemids->values_num);
+	DBadd_condition_alloc(&sql, &sql_alloc, &sql_offset, "i.itemid", info_itemids->values,
+			info_itemids->values_num);
 
 	result = DBselect("%s", sql);
 
@@ -1070,18 +1260,67 @@ static void	db_get_items_info_by_itemid(zbx_hashset_t *items_info, const zbx_vec
 
 /******************************************************************************
  *                                                                            *
- * Function: zbx_item_info_clean                                              *
+ * Function: export_get_item                                                  *
  *                                                                            *
- * Purpose: frees resources allocated to store item applications and name     *
+ * Purpose: finds exported item and its cached host and item information      *
  *                                                                            *
- * Parameters: item_info - [IN] item information                              *
+ * Parameters: itemid    - [IN] the item identifier                           *
+ *             itemids   - [IN] the item identifiers (used for item lookup)   *
+ *             items     - [IN] the items                                     *
+ *             errcodes  - [IN] item error codes                              *
+ *             host_info - [OUT] the host groups names                        *
+ *             item_info - [OUT] the item name and applications               *
+ *                                                                            *
+ * Return value: the item or NULL if the item must not be exported            *
  *                                                                            *
  ******************************************************************************/
-static void	zbx_item_info_clean(zbx_item_info_t *item_info)
+static const DC_ITEM	*export_get_item(zbx_uint64_t itemid, const zbx_vector_uint64_t *itemids,
+		const DC_ITEM *items, const int *errcodes, zbx_host_info_t **host_info, zbx_item_info_t **item_info)
 {
-	zbx_vector_ptr_clear_ext(&item_info->applications, zbx_ptr_free);
-	zbx_vector_ptr_destroy(&item_info->applications);
-	zbx_free(item_info->name);
+	int	index;
+
+	if (FAIL == (index = zbx_vector_uint64_bsearch(itemids, itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return NULL;
+	}
+
+	if (SUCCEED != errcodes[index])
+		return NULL;
+
+	if (NULL == (*item_info = (zbx_item_info_t *)zbx_hashset_search(&export_items_info, &itemid)))
+		return NULL;
+
+	if (NULL == (*host_info = (zbx_host_info_t *)zbx_hashset_search(&export_hosts_info,
+			&items[index].host.hostid)))
+	{
+		return NULL;
+	}
+
+	return &items[index];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: export_add_record                                                *
+ *                                                                            *
+ * Purpose: appends JSON record to the export batch                           *
+ *                                                                            *
+ * Parameters: buf        - [IN/OUT] the export batch                         *
+ *             buf_alloc  - [IN/OUT] the batch buffer size                    *
+ *             buf_offset - [IN/OUT] the batch length                         *
+ *             json       - [IN] the record                                   *
+ *                                                                            *
+ * Comments: records are separated by newline, the newline after the last     *
+ *           record is added when the batch is written to export file         *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_add_record(char **buf, size_t *buf_alloc, size_t *buf_offset, const struct zbx_json *json)
+{
+	if (0 != *buf_offset)
+		zbx_chrcpy_alloc(buf, buf_alloc, buf_offset, '\n');
+
+	zbx_strncpy_alloc(buf, buf_alloc, buf_offset, json->buffer, json->buffer_size);
 }
 
 /******************************************************************************
@@ -1092,12 +1331,13 @@ static void	zbx_item_info_clean(zbx_item_info_t *item_info)
  *                                                                            *
  * Parameters: trends     - [IN] trends from cache                            *
  *             trends_num - [IN] number of trends                             *
- *             hosts_info - [IN] hosts groups names                           *
- *             items_info - [IN] item names and applications                  *
+ *             itemids    - [IN] the item identifiers (used for item lookup)  *
+ *             items      - [IN] the items                                    *
+ *             errcodes   - [IN] item error codes                             *
  *                                                                            *
  ******************************************************************************/
-static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hashset_t *hosts_info,
-		zbx_hashset_t *items_info)
+static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, const zbx_vector_uint64_t *itemids,
+		const DC_ITEM *items, const int *errcodes)
 {
 	struct zbx_json		json;
 	const ZBX_DC_TREND	*trend = NULL;
@@ -1106,6 +1346,8 @@ static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hash
 	zbx_host_info_t		*host_info;
 	zbx_item_info_t		*item_info;
 	zbx_uint128_t		avg;	/* calculate the trend average value */
+	char			*buf = NULL;
+	size_t			buf_alloc = 0, buf_offset = 0;
 
 	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
 
@@ -1113,16 +1355,8 @@ static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hash
 	{
 		trend = &trends[i];
 
-		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &trend->itemid)))
-			continue;
-
-		item = item_info->item;
-
-		if (NULL == (host_info = (zbx_host_info_t *)zbx_hashset_search(hosts_info, &item->host.hostid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
+		if (NULL == (item = export_get_item(trend->itemid, itemids, items, errcodes, &host_info, &item_info)))
 			continue;
-		}
 
 		zbx_json_clean(&json);
 		zbx_json_addstring(&json, ZBX_PROTO_TAG_HOST, item->host.name, ZBX_JSON_TYPE_STRING);
@@ -1164,10 +1398,16 @@ static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hash
 				THIS_SHOULD_NEVER_HAPPEN;
 		}
 
-		zbx_trends_export_write(json.buffer, json.buffer_size);
+		export_add_record(&buf, &buf_alloc, &buf_offset, &json);
+	}
+
+	if (0 != buf_offset)
+	{
+		zbx_trends_export_write(buf, buf_offset);
+		zbx_trends_export_flush();
 	}
 
-	zbx_trends_export_flush();
+	zbx_free(buf);
 	zbx_json_free(&json);
 }
 
@@ -1179,12 +1419,13 @@ static void	DCexport_trends(const ZBX_DC_TREND *trends, int trends_num, zbx_hash
  *                                                                            *
  * Parameters: history     - [IN/OUT] array of history data                   *
  *             history_num - [IN] number of history structures                *
- *             hosts_info  - [IN] hosts groups names                          *
- *             items_info  - [IN] item names and applications                 *
+ *             itemids     - [IN] the item identifiers (used for item lookup) *
+ *             items       - [IN] the items                                   *
+ *             errcodes    - [IN] item error codes                            *
  *                                                                            *
  ******************************************************************************/
-static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx_hashset_t *hosts_info,
-		zbx_hashset_t *items_info)
+static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, const zbx_vector_uint64_t *itemids,
+		const DC_ITEM *items, const int *errcodes)
 {
 	const ZBX_DC_HISTORY	*h;
 	const DC_ITEM		*item;
@@ -1192,6 +1433,8 @@ static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx
 	zbx_host_info_t		*host_info;
 	zbx_item_info_t		*item_info;
 	struct zbx_json		json;
+	char			*buf = NULL;
+	size_t			buf_alloc = 0, buf_offset = 0;
 
 	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
 
@@ -1202,19 +1445,8 @@ static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx
 		if (0 != (ZBX_DC_FLAGS_NOT_FOR_MODULES & h->flags))
 			continue;
 
-		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &h->itemid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			continue;
-		}
-
-		item = item_info->item;
-
-		if (NULL == (host_info = (zbx_host_info_t *)zbx_hashset_search(hosts_info, &item->host.hostid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
+		if (NULL == (item = export_get_item(h->itemid, itemids, items, errcodes, &host_info, &item_info)))
 			continue;
-		}
 
 		zbx_json_clean(&json);
 		zbx_json_addstring(&json, ZBX_PROTO_TAG_HOST, item->host.name, ZBX_JSON_TYPE_STRING);
@@ -1266,13 +1498,104 @@ static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx
 				THIS_SHOULD_NEVER_HAPPEN;
 		}
 
-		zbx_history_export_write(json.buffer, json.buffer_size);
+		export_add_record(&buf, &buf_alloc, &buf_offset, &json);
 	}
 
-	zbx_history_export_flush();
+	if (0 != buf_offset)
+	{
+		zbx_history_export_write(buf, buf_offset);
+		zbx_history_export_flush();
+	}
+
+	zbx_free(buf);
 	zbx_json_free(&json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: export_prepare_item_info                                         *
+ *                                                                            *
+ * Purpose: makes sure cached host and item information of exported item is   *
+ *          present and schedules outdated information for update             *
+ *                                                                            *
+ * Parameters: item         - [IN] the exported item                          *
+ *             now          - [IN] the current time                           *
+ *             hostids      - [OUT] the hosts to update                       *
+ *             info_itemids - [OUT] the items to update                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_prepare_item_info(const DC_ITEM *item, int now, zbx_vector_uint64_t *hostids,
+		zbx_vector_uint64_t *info_itemids)
+{
+	zbx_host_info_t	*host_info;
+	zbx_item_info_t	*item_info;
+
+	if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(&export_items_info, &item->itemid)))
+	{
+		zbx_item_info_t	item_info_local = {.itemid = item->itemid};
+
+		zbx_vector_ptr_create(&item_info_local.applications);
+		item_info = (zbx_item_info_t *)zbx_hashset_insert(&export_items_info, &item_info_local,
+				sizeof(item_info_local));
+	}
+
+	if (ZBX_EXPORT_INFO_TTL <= now - item_info->lastcheck)
+	{
+		item_info->lastcheck = now;
+		zbx_vector_uint64_append(info_itemids, item->itemid);
+	}
+
+	if (NULL == (host_info = (zbx_host_info_t *)zbx_hashset_search(&export_hosts_info, &item->host.hostid)))
+	{
+		zbx_host_info_t	host_info_local = {.hostid = item->host.hostid};
+
+		zbx_vector_ptr_create(&host_info_local.groups);
+		host_info = (zbx_host_info_t *)zbx_hashset_insert(&export_hosts_info, &host_info_local,
+				sizeof(host_info_local));
+	}
+
+	if (ZBX_EXPORT_INFO_TTL <= now - host_info->lastcheck)
+	{
+		host_info->lastcheck = now;
+		zbx_vector_uint64_append(hostids, item->host.hostid);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: export_clean_info                                                *
+ *                                                                            *
+ * Purpose: removes outdated host and item information from export cache      *
+ *                                                                            *
+ * Parameters: now - [IN] the current time                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_clean_info(int now)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_host_info_t		*host_info;
+	zbx_item_info_t		*item_info;
+
+	if (ZBX_EXPORT_INFO_TTL > now - export_info_lastclean)
+		return;
+
+	zbx_hashset_iter_reset(&export_items_info, &iter);
+	while (NULL != (item_info = (zbx_item_info_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (ZBX_EXPORT_INFO_TTL <= now - item_info->lastcheck)
+			zbx_hashset_iter_remove(&iter);
+	}
+
+	zbx_hashset_iter_reset(&export_hosts_info, &iter);
+	while (NULL != (host_info = (zbx_host_info_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (ZBX_EXPORT_INFO_TTL <= now - host_info->lastcheck)
+			zbx_hashset_iter_remove(&iter);
+	}
+
+	export_info_lastclean = now;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: DCexport_history_and_trends                                      *
@@ -1288,25 +1611,36 @@ static void	DCexport_history(const ZBX_DC_HISTORY *history, int history_num, zbx
  *             trends      - [IN] trends from cache                           *
  *             trends_num  - [IN] number of trends                            *
  *                                                                            *
+ * Comments: host groups, item names and applications are kept between calls  *
+ *           and read from database only for new items or once per            *
+ *           ZBX_EXPORT_INFO_TTL seconds                                      *
+ *                                                                            *
  ******************************************************************************/
 static void	DCexport_history_and_trends(const ZBX_DC_HISTORY *history, int history_num,
 		const zbx_vector_uint64_t *itemids, DC_ITEM *items, const int *errcodes, const ZBX_DC_TREND *trends,
 		int trends_num)
 {
 	const char		*__function_name = "DCexport_history_and_trends";
-	int			i, index;
-	zbx_vector_uint64_t	hostids, item_info_ids;
-	zbx_hashset_t		hosts_info, items_info;
-	DC_ITEM			*item;
-	zbx_item_info_t		item_info;
+	int			i, index, now;
+	zbx_vector_uint64_t	hostids, info_itemids;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d trends_num:%d", __function_name, history_num, trends_num);
 
+	if (NULL == export_items_info.slots)
+	{
+		zbx_hashset_create_ext(&export_items_info, ZBX_HC_SYNC_MAX, ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)zbx_item_info_clean,
+				ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+		zbx_hashset_create_ext(&export_hosts_info, ZBX_HC_SYNC_MAX, ZBX_DEFAULT_UINT64_HASH_FUNC,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)zbx_host_info_clean,
+				ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	}
+
+	now = (int)time(NULL);
+	export_clean_info(now);
+
 	zbx_vector_uint64_create(&hostids);
-	zbx_vector_uint64_create(&item_info_ids);
-	zbx_hashset_create_ext(&items_info, itemids->values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)zbx_item_info_clean,
-			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_vector_uint64_create(&info_itemids);
 
 	for (i = 0; i < history_num; i++)
 	{
@@ -1324,16 +1658,7 @@ static void	DCexport_history_and_trends(const ZBX_DC_HISTORY *history, int histo
 		if (SUCCEED != errcodes[index])
 			continue;
 
-		item = &items[index];
-
-		zbx_vector_uint64_append(&hostids, item->host.hostid);
-		zbx_vector_uint64_append(&item_info_ids, item->itemid);
-
-		item_info.itemid = item->itemid;
-		item_info.name = NULL;
-		item_info.item = item;
-		zbx_vector_ptr_create(&item_info.applications);
-		zbx_hashset_insert(&items_info, &item_info, sizeof(item_info));
+		export_prepare_item_info(&items[index], now, &hostids, &info_itemids);
 	}
 
 	if (0 == history_num)
@@ -1352,47 +1677,33 @@ static void	DCexport_history_and_trends(const ZBX_DC_HISTORY *history, int histo
 			if (SUCCEED != errcodes[index])
 				continue;
 
-			item = &items[index];
-
-			zbx_vector_uint64_append(&hostids, item->host.hostid);
-			zbx_vector_uint64_append(&item_info_ids, item->itemid);
-
-			item_info.itemid = item->itemid;
-			item_info.name = NULL;
-			item_info.item = item;
-			zbx_vector_ptr_create(&item_info.applications);
-			zbx_hashset_insert(&items_info, &item_info, sizeof(item_info));
+			export_prepare_item_info(&items[index], now, &hostids, &info_itemids);
 		}
 	}
 
-	if (0 == item_info_ids.values_num)
-		goto clean;
-
-	zbx_vector_uint64_sort(&item_info_ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-	zbx_vector_uint64_sort(&hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-	zbx_vector_uint64_uniq(&hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-
-	zbx_hashset_create_ext(&hosts_info, hostids.values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
-			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)zbx_host_info_clean,
-			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
-
-	db_get_hosts_info_by_hostid(&hosts_info, &hostids);
+	if (0 != hostids.values_num)
+	{
+		zbx_vector_uint64_sort(&hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		db_get_hosts_info_by_hostid(&export_hosts_info, &hostids);
+	}
 
-	db_get_items_info_by_itemid(&items_info, &item_info_ids);
+	if (0 != info_itemids.values_num)
+	{
+		zbx_vector_uint64_sort(&info_itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		db_get_items_info_by_itemid(&export_items_info, &info_itemids, itemids, items);
+	}
 
 	if (0 != history_num)
-		DCexport_history(history, history_num, &hosts_info, &items_info);
+		DCexport_history(history, history_num, itemids, items, errcodes);
 
 	if (0 != trends_num)
-		DCexport_trends(trends, trends_num, &hosts_info, &items_info);
+		DCexport_trends(trends, trends_num, itemids, items, errcodes);
 
-	zbx_hashset_destroy(&hosts_info);
-clean:
-	zbx_hashset_destroy(&items_info);
-	zbx_vector_uint64_destroy(&item_info_ids);
-	zbx_vector_uint64_destroy(&hostids);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() hosts updated:%d items updated:%d", __function_name,
+			hostids.values_num, info_itemids.values_num);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+	zbx_vector_uint64_destroy(&info_itemids);
+	zbx_vector_uint64_destroy(&hostids);
 }
 
 /******************************************************************************
@@ -2090,7 +2401,7 @@ static void	DBmass_update_items(const zbx_vector_ptr_t *item_diff, const zbx_vec
 		DBend_multiple_update(&sql, &sql_alloc, &sql_offset);
 
 		if (sql_offset > 16)	/* In ORACLE always present begin..end; */
-			DBexecute("%s", sql);
+			DBexecute_async("%s", sql);
 
 		DCconfig_update_inventory_values(inventory_values);
 	}
@@ -2440,6 +2751,116 @@ static void	dc_add_proxy_history_notsupported(ZBX_DC_HISTORY *history, int histo
 	zbx_db_insert_clean(&db_insert);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: dc_add_proxy_histlog                                             *
+ *                                                                            *
+ * Purpose: appends history data to proxy history log                         *
+ *                                                                            *
+ * Parameters: history     - array of history data                            *
+ *             history_num - number of history structures                     *
+ *                                                                            *
+ * Comments: this function is used instead of DCmass_proxy_add_history() when *
+ *           history log is enabled, the records are prepared in the same way *
+ *           as proxy_history table rows. It must be called only after the    *
+ *           item updates of the same batch are committed.                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	dc_add_proxy_histlog(ZBX_DC_HISTORY *history, int history_num)
+{
+#define ZBX_HISTLOG_NUMBER_LEN	64
+
+	const char		*__function_name = "dc_add_proxy_histlog";
+	int			i, records_num = 0;
+	char			*numbers;
+	zbx_histlog_record_t	*records, *record;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	records = (zbx_histlog_record_t *)zbx_malloc(NULL, sizeof(zbx_histlog_record_t) * history_num);
+	numbers = (char *)zbx_malloc(NULL, ZBX_HISTLOG_NUMBER_LEN * history_num);
+
+	for (i = 0; i < history_num; i++)
+	{
+		const ZBX_DC_HISTORY	*h = &history[i];
+		char			*buffer = numbers + ZBX_HISTLOG_NUMBER_LEN * i;
+
+		record = &records[records_num];
+		memset(record, 0, sizeof(zbx_histlog_record_t));
+		record->itemid = h->itemid;
+		record->clock = h->ts.sec;
+		record->ns = h->ts.ns;
+		record->source = "";
+		record->value = "";
+
+		if (ITEM_STATE_NOTSUPPORTED == h->state)
+		{
+			record->value = ZBX_NULL2EMPTY_STR(h->value.err);
+			record->state = h->state;
+			records_num++;
+			continue;
+		}
+
+		if (ITEM_VALUE_TYPE_LOG != h->value_type && 0 != (h->flags & ZBX_DC_FLAG_UNDEF))
+			continue;
+
+		if (0 != (h->flags & ZBX_DC_FLAG_META))
+		{
+			record->flags = PROXY_HISTORY_FLAG_META;
+			record->lastlogsize = h->lastlogsize;
+			record->mtime = h->mtime;
+		}
+
+		if (0 != (h->flags & ZBX_DC_FLAG_NOVALUE))
+		{
+			if (0 == (h->flags & ZBX_DC_FLAG_META))
+				continue;
+
+			record->flags |= PROXY_HISTORY_FLAG_NOVALUE;
+			records_num++;
+			continue;
+		}
+
+		switch (h->value_type)
+		{
+			case ITEM_VALUE_TYPE_FLOAT:
+				zbx_snprintf(buffer, ZBX_HISTLOG_NUMBER_LEN, ZBX_FS_DBL, h->value.dbl);
+				record->value = buffer;
+				break;
+			case ITEM_VALUE_TYPE_UINT64:
+				zbx_snprintf(buffer, ZBX_HISTLOG_NUMBER_LEN, ZBX_FS_UI64, h->value.ui64);
+				record->value = buffer;
+				break;
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+				record->value = h->value.str;
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				record->timestamp = h->value.log->timestamp;
+				record->source = ZBX_NULL2EMPTY_STR(h->value.log->source);
+				record->severity = h->value.log->severity;
+				record->value = h->value.log->value;
+				record->logeventid = h->value.log->logeventid;
+				break;
+			default:
+				THIS_SHOULD_NEVER_HAPPEN;
+				continue;
+		}
+
+		records_num++;
+	}
+
+	if (0 != records_num)
+		zbx_histlog_write(records, records_num);
+
+	zbx_free(numbers);
+	zbx_free(records);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() records:%d", __function_name, records_num);
+
+#undef ZBX_HISTLOG_NUMBER_LEN
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: DCmass_proxy_add_history                                         *
@@ -2686,6 +3107,33 @@ static void	DCmodule_prepare_history(ZBX_DC_HISTORY *history, int history_num, Z
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: DCmodule_check_sync_time                                         *
+ *                                                                            *
+ * Purpose: warn about loadable module slowing down history synchronization   *
+ *                                                                            *
+ * Parameters: module     - [IN] the module                                   *
+ *             type       - [IN] the history value type name                  *
+ *             values_num - [IN] the number of values passed to module        *
+ *             sec        - [IN] the time spent in module callback            *
+ *                                                                            *
+ * Comments: history callbacks are called by history syncers, every second    *
+ *           spent in module is a second other values wait in history cache   *
+ *                                                                            *
+ ******************************************************************************/
+static void	DCmodule_check_sync_time(const zbx_module_t *module, const char *type, int values_num, double sec)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "... module \"%s\" synced %d %s values in " ZBX_FS_DBL " sec", module->name,
+			values_num, type, sec);
+
+	if (ZBX_MODULE_SYNC_WARNING_TIME <= sec)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "module \"%s\" spent " ZBX_FS_DBL " sec processing %d %s values,"
+				" history synchronization is delayed", module->name, sec, values_num, type);
+	}
+}
+
 static void	DCmodule_sync_history(int history_float_num, int history_integer_num, int history_string_num,
 		int history_text_num, int history_log_num, ZBX_HISTORY_FLOAT *history_float,
 		ZBX_HISTORY_INTEGER *history_integer, ZBX_HISTORY_STRING *history_string,
@@ -2694,13 +3142,16 @@ static void	DCmodule_sync_history(int history_float_num, int history_integer_num
 	if (0 != history_float_num)
 	{
 		int	i;
+		double	sec;
 
 		zabbix_log(LOG_LEVEL_DEBUG, "syncing float history data with modules...");
 
 		for (i = 0; NULL != history_float_cbs[i].module; i++)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "... module \"%s\"", history_float_cbs[i].module->name);
+			sec = zbx_time();
 			history_float_cbs[i].history_float_cb(history_float, history_float_num);
+			DCmodule_check_sync_time(history_float_cbs[i].module, "float", history_float_num,
+					zbx_time() - sec);
 		}
 
 		zabbix_log(LOG_LEVEL_DEBUG, "synced %d float values with modules", history_float_num);
@@ -2709,13 +3160,16 @@ static void	DCmodule_sync_history(int history_float_num, int history_integer_num
 	if (0 != history_integer_num)
 	{
 		int	i;
+		double	sec;
 
 		zabbix_log(LOG_LEVEL_DEBUG, "syncing integer history data with modules...");
 
 		for (i = 0; NULL != history_integer_cbs[i].module; i++)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "... module \"%s\"", history_integer_cbs[i].module->name);
+			sec = zbx_time();
 			history_integer_cbs[i].history_integer_cb(history_integer, history_integer_num);
+			DCmodule_check_sync_time(history_integer_cbs[i].module, "integer", history_integer_num,
+					zbx_time() - sec);
 		}
 
 		zabbix_log(LOG_LEVEL_DEBUG, "synced %d integer values with modules", history_integer_num);
@@ -2724,13 +3178,16 @@ static void	DCmodule_sync_history(int history_float_num, int history_integer_num
 	if (0 != history_string_num)
 	{
 		int	i;
+		double	sec;
 
 		zabbix_log(LOG_LEVEL_DEBUG, "syncing string history data with modules...");
 
 		for (i = 0; NULL != history_string_cbs[i].module; i++)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "... module \"%s\"", history_string_cbs[i].module->name);
+			sec = zbx_time();
 			history_string_cbs[i].history_string_cb(history_string, history_string_num);
+			DCmodule_check_sync_time(history_string_cbs[i].module, "string", history_string_num,
+					zbx_time() - sec);
 		}
 
 		zabbix_log(LOG_LEVEL_DEBUG, "synced %d string values with modules", history_string_num);
@@ -2739,13 +3196,16 @@ static void	DCmodule_sync_history(int history_float_num, int history_integer_num
 	if (0 != history_text_num)
 	{
 		int	i;
+		double	sec;
 
 		zabbix_log(LOG_LEVEL_DEBUG, "syncing text history data with modules...");
 
 		for (i = 0; NULL != history_text_cbs[i].module; i++)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "... module \"%s\"", history_text_cbs[i].module->name);
+			sec = zbx_time();
 			history_text_cbs[i].history_text_cb(history_text, history_text_num);
+			DCmodule_check_sync_time(history_text_cbs[i].module, "text", history_text_num,
+					zbx_time() - sec);
 		}
 
 		zabbix_log(LOG_LEVEL_DEBUG, "synced %d text values with modules", history_text_num);
@@ -2754,13 +3214,16 @@ static void	DCmodule_sync_history(int history_float_num, int history_integer_num
 	if (0 != history_log_num)
 	{
 		int	i;
+		double	sec;
 
 		zabbix_log(LOG_LEVEL_DEBUG, "syncing log history data with modules...");
 
 		for (i = 0; NULL != history_log_cbs[i].module; i++)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "... module \"%s\"", history_log_cbs[i].module->name);
+			sec = zbx_time();
 			history_log_cbs[i].history_log_cb(history_log, history_log_num);
+			DCmodule_check_sync_time(history_log_cbs[i].module, "log", history_log_num,
+					zbx_time() - sec);
 		}
 
 		zabbix_log(LOG_LEVEL_DEBUG, "synced %d log values with modules", history_log_num);
@@ -2769,7 +3232,7 @@ static void	DCmodule_sync_history(int history_float_num, int history_integer_num
 
 static void	sync_proxy_history(int *total_num, int *more)
 {
-	int			history_num;
+	int			history_num, histlog, txn_error;
 	time_t			sync_start;
 	zbx_vector_ptr_t	history_items;
 	ZBX_DC_HISTORY		history[ZBX_HC_SYNC_MAX];
@@ -2795,14 +3258,24 @@ static void	sync_proxy_history(int *total_num, int *more)
 
 		hc_get_item_values(history, &history_items);	/* copy item data from history cache */
 
+		histlog = zbx_is_histlog_enabled();
+
 		do
 		{
 			DBbegin();
 
-			DCmass_proxy_add_history(history, history_num);
+			if (SUCCEED != histlog)
+				DCmass_proxy_add_history(history, history_num);
+
 			DCmass_proxy_update_items(history, history_num);
 		}
-		while (ZBX_DB_DOWN == DBcommit());
+		while (ZBX_DB_DOWN == (txn_error = DBcommit()));
+
+		/* History log is not transactional. It is written only after the item updates are committed, */
+		/* so the values are dropped together with the updates if the transaction fails, the same as  */
+		/* with proxy_history table.                                                                  */
+		if (SUCCEED == histlog && ZBX_DB_OK == txn_error)
+			dc_add_proxy_histlog(history, history_num);
 
 		LOCK_CACHE;
 
@@ -2916,7 +3389,7 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 	do
 	{
 		DC_ITEM			*items;
-		int			*errcodes, trends_num = 0, timers_num = 0, ret = SUCCEED;
+		int			*errcodes, trends_num = 0, timers_num = 0, ret = SUCCEED, candidates_num;
 		zbx_vector_uint64_t	itemids;
 		ZBX_DC_TREND		*trends = NULL;
 
@@ -2926,7 +3399,7 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 		hc_pop_items(&history_items);		/* select and take items out of history cache */
 		UNLOCK_CACHE;
 
-		if (0 != history_items.values_num)
+		if (0 != (candidates_num = history_items.values_num))
 		{
 			if (0 == (history_num = DCconfig_lock_triggers_by_history_items(&history_items, &triggerids)))
 			{
@@ -2935,6 +3408,15 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 				UNLOCK_CACHE;
 				zbx_vector_ptr_clear(&history_items);
 			}
+			else if (history_num != candidates_num)
+			{
+				/* return items with triggers locked by other syncers right away instead of */
+				/* keeping them out of the queue until this batch is processed, items with  */
+				/* triggers locked by this batch are returned after it is processed         */
+				LOCK_CACHE;
+				hc_push_busy_items(&history_items);
+				UNLOCK_CACHE;
+			}
 		}
 		else
 			history_num = 0;
@@ -3051,7 +3533,7 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 				/* Otherwise better to wait a bit for other syncers to unlock      */
 				/* items rather than trying and failing to sync locked items over  */
 				/* and over again.                                                 */
-				if (ZBX_HC_SYNC_MIN_PCNT <= history_num * 100 / history_items.values_num)
+				if (ZBX_HC_SYNC_MIN_PCNT <= history_num * 100 / candidates_num)
 					*more = ZBX_SYNC_MORE;
 			}
 
@@ -3062,7 +3544,8 @@ static void	sync_server_history(int *values_num, int *triggers_num, int *more)
 
 		if (FAIL != ret)
 		{
-			if (0 != history_num)
+			if (0 != history_num && (NULL != history_float_cbs || NULL != history_integer_cbs ||
+					NULL != history_string_cbs || NULL != history_text_cbs || NULL != history_log_cbs))
 			{
 				DCmodule_prepare_history(history, history_num, history_float, &history_float_num,
 						history_integer, &history_integer_num, history_string,
@@ -4121,7 +4604,7 @@ static void	hc_get_item_values(ZBX_DC_HISTORY *history, zbx_vector_ptr_t *histor
 	{
 		item = (zbx_hc_item_t *)history_items->values[i];
 
-		if (ZBX_HC_ITEM_STATUS_BUSY == item->status)
+		if (ZBX_HC_ITEM_STATUS_NORMAL != item->status)
 			continue;
 
 		hc_copy_history_data(&history[history_num++], item->itemid, item->tail);
@@ -4155,6 +4638,7 @@ void	hc_push_items(zbx_vector_ptr_t *history_items)
 		switch (item->status)
 		{
 			case ZBX_HC_ITEM_STATUS_BUSY:
+			case ZBX_HC_ITEM_STATUS_DEFERRED:
 				/* reset item status before returning it to queue */
 				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
 				hc_queue_item(item);
@@ -4172,6 +4656,48 @@ void	hc_push_items(zbx_vector_ptr_t *history_items)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: hc_push_busy_items                                               *
+ *                                                                            *
+ * Purpose: push back the busy history items into history queue               *
+ *                                                                            *
+ * Parameters: history_items - [IN/OUT] the history items, on output only     *
+ *                                      the available and deferred items are  *
+ *                                      left                                  *
+ *                                                                            *
+ * Comments: Busy items have triggers locked by other history syncers. They   *
+ *           are returned to queue before the rest of the batch is processed, *
+ *           so any syncer can take them as soon as the triggers are          *
+ *           unlocked.                                                        *
+ *           Deferred items have triggers locked by an earlier item of the    *
+ *           same batch. They are kept until the batch is processed, because  *
+ *           other syncers would only find their triggers locked and return   *
+ *           them to the queue again.                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_push_busy_items(zbx_vector_ptr_t *history_items)
+{
+	int		i, j;
+	zbx_hc_item_t	*item;
+
+	for (i = 0, j = 0; i < history_items->values_num; i++)
+	{
+		item = (zbx_hc_item_t *)history_items->values[i];
+
+		if (ZBX_HC_ITEM_STATUS_BUSY == item->status)
+		{
+			item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+			hc_queue_item(item);
+			continue;
+		}
+
+		history_items->values[j++] = item;
+	}
+
+	history_items->values_num = j;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: hc_queue_get_size                                                *
@@ -1032,6 +1032,7 @@ static void	DCsync_hosts(zbx_dbsync_t *sync)
 		ZBX_STR2UCHAR(status, row[22]);
 
 		host = (ZBX_DC_HOST *)DCfind_id(&config->hosts, hostid, sizeof(ZBX_DC_HOST), &found);
+		host->active_checks_revision = ++config->active_checks_revision;
 
 		/* see whether we should and can update 'hosts_h' and 'hosts_p' indexes at this point */
 
@@ -2340,6 +2341,9 @@ static void	DCsync_items(zbx_dbsync_t *sync, int flags)
 
 		item = (ZBX_DC_ITEM *)DCfind_id(&config->items, itemid, sizeof(ZBX_DC_ITEM), &found);
 
+		if (ITEM_TYPE_ZABBIX_ACTIVE == type || (0 != found && ITEM_TYPE_ZABBIX_ACTIVE == item->type))
+			host->active_checks_revision = ++config->active_checks_revision;
+
 		if (0 != found && ITEM_TYPE_SNMPTRAP == item->type)
 			dc_interface_snmpitems_remove(item);
 
@@ -2851,6 +2855,12 @@ static void	DCsync_items(zbx_dbsync_t *sync, int flags)
 			dc_host_update_agent_stats(host, item->type, -1);
 		}
 
+		if (ITEM_TYPE_ZABBIX_ACTIVE == item->type &&
+				NULL != (host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &item->hostid)))
+		{
+			host->active_checks_revision = ++config->active_checks_revision;
+		}
+
 		itemid = item->itemid;
 
 		if (ITEM_TYPE_SNMPTRAP == item->type)
@@ -4992,6 +5002,18 @@ void	DCsync_configuration(unsigned char mode)
 	DCsync_expressions(&expr_sync);
 	expr_sec2 = zbx_time() - sec;
 
+	/* macros, interfaces, global regular expressions and refresh of unsupported items */
+	/* affect active check lists of all hosts                                        */
+	if (0 != (flags & ZBX_REFRESH_UNSUPPORTED_CHANGED) ||
+			0 != htmpl_sync.add_num + htmpl_sync.update_num + htmpl_sync.remove_num ||
+			0 != gmacro_sync.add_num + gmacro_sync.update_num + gmacro_sync.remove_num ||
+			0 != hmacro_sync.add_num + hmacro_sync.update_num + hmacro_sync.remove_num ||
+			0 != if_sync.add_num + if_sync.update_num + if_sync.remove_num ||
+			0 != expr_sync.add_num + expr_sync.update_num + expr_sync.remove_num)
+	{
+		config->active_checks_global_revision = ++config->active_checks_revision;
+	}
+
 	sec = zbx_time();
 	DCsync_actions(&action_sync);
 	action_sec2 = zbx_time() - sec;
@@ -5802,6 +5824,10 @@ int	init_configuration_cache(char **error)
 	config->sync_ts = 0;
 	config->item_sync_ts = 0;
 
+	/* start revisions from the startup time so they are not reused after restart */
+	config->active_checks_revision = (zbx_uint64_t)time(NULL) << 32;
+	config->active_checks_global_revision = config->active_checks_revision;
+
 	config->internal_actions = 0;
 
 	/* maintenance data are used only when timers are defined (server) */
@@ -6654,6 +6680,88 @@ void	DCconfig_get_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids,
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: DCconfig_get_history_items_by_itemids                            *
+ *                                                                            *
+ * Purpose: get items with only the data required to process received         *
+ *          history values                                                    *
+ *                                                                            *
+ * Parameters: items    - [OUT] pointer to DC_ITEM structures                 *
+ *             itemids  - [IN] array of item IDs                              *
+ *             errcodes - [OUT] SUCCEED if item found, otherwise FAIL         *
+ *             num      - [IN] number of elements                             *
+ *                                                                            *
+ * Comments: Lightweight alternative of DCconfig_get_items_by_itemids() for   *
+ *           processing history data uploaded by proxies. Only item           *
+ *           identification, type, value type, status, state, flags, log time *
+ *           format and host identification, status and maintenance data are  *
+ *           copied, so the configuration cache lock is held for a much       *
+ *           shorter time. The items must be freed with                       *
+ *           DCconfig_clean_items().                                          *
+ *                                                                            *
+ ******************************************************************************/
+void	DCconfig_get_history_items_by_itemids(DC_ITEM *items, const zbx_uint64_t *itemids, int *errcodes,
+		size_t num)
+{
+	size_t			i;
+	const ZBX_DC_ITEM	*dc_item;
+	const ZBX_DC_HOST	*dc_host;
+	const ZBX_DC_LOGITEM	*dc_logitem;
+	DC_ITEM			*item;
+
+	RDLOCK_CACHE;
+
+	for (i = 0; i < num; i++)
+	{
+		if (NULL == (dc_item = (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemids[i])) ||
+				NULL == (dc_host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &dc_item->hostid)))
+		{
+			errcodes[i] = FAIL;
+			continue;
+		}
+
+		item = &items[i];
+
+		item->host.hostid = dc_host->hostid;
+		item->host.proxy_hostid = dc_host->proxy_hostid;
+		strscpy(item->host.host, dc_host->host);
+		item->host.maintenance_status = dc_host->maintenance_status;
+		item->host.maintenance_type = dc_host->maintenance_type;
+		item->host.maintenance_from = dc_host->maintenance_from;
+		item->host.status = dc_host->status;
+
+		item->itemid = dc_item->itemid;
+		item->type = dc_item->type;
+		item->value_type = dc_item->value_type;
+		item->status = dc_item->status;
+		item->state = dc_item->state;
+		item->flags = dc_item->flags;
+		strscpy(item->key_orig, dc_item->key);
+		item->key = NULL;
+
+		if (ITEM_VALUE_TYPE_LOG == dc_item->value_type && NULL != (dc_logitem =
+				(ZBX_DC_LOGITEM *)zbx_hashset_search(&config->logitems, &dc_item->itemid)))
+		{
+			strscpy(item->logtimefmt, dc_logitem->logtimefmt);
+		}
+		else
+			*item->logtimefmt = '\0';
+
+		/* dynamic fields freed by DCconfig_clean_items() */
+		item->units = NULL;
+		item->params = NULL;
+		item->headers = NULL;
+		item->posts = NULL;
+		item->delay = NULL;
+		item->error = NULL;
+
+		errcodes[i] = SUCCEED;
+	}
+
+	UNLOCK_CACHE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: dc_preproc_item_init                                             *
@@ -6921,9 +7029,11 @@ void	DCconfig_clean_triggers(DC_TRIGGER *triggers, int *errcodes, size_t num)
  *                                                                            *
  * Parameters: history_items - [IN/OUT] list of history items history syncer  *
  *                                    wishes to take for processing; on       *
- *                                    output, the item locked field is set    *
- *                                    to 0 if the corresponding item cannot   *
- *                                    be taken                                *
+ *                                    output, the status of items that cannot *
+ *                                    be taken is set to BUSY if the trigger  *
+ *                                    is locked by other process or DEFERRED  *
+ *                                    if it was locked for another item of    *
+ *                                    the list                                *
  *             triggerids  - [OUT] list of trigger IDs that this function has *
  *                                 locked for processing; unlock those using  *
  *                                 DCconfig_unlock_triggers() function        *
@@ -6947,7 +7057,7 @@ void	DCconfig_clean_triggers(DC_TRIGGER *triggers, int *errcodes, size_t num)
  ******************************************************************************/
 int	DCconfig_lock_triggers_by_history_items(zbx_vector_ptr_t *history_items, zbx_vector_uint64_t *triggerids)
 {
-	int			i, j, locked_num = 0;
+	int			i, j, locked_num = 0, triggerids_num = triggerids->values_num;
 	const ZBX_DC_ITEM	*dc_item;
 	ZBX_DC_TRIGGER		*dc_trigger;
 	zbx_hc_item_t		*history_item;
@@ -6972,25 +7082,36 @@ int	DCconfig_lock_triggers_by_history_items(zbx_vector_ptr_t *history_items, zbx
 			if (TRIGGER_STATUS_ENABLED != dc_trigger->status)
 				continue;
 
-			if (1 == dc_trigger->locked)
+			if (0 != dc_trigger->locked)
 			{
 				locked_num++;
-				history_item->status = ZBX_HC_ITEM_STATUS_BUSY;
+				history_item->status = (1 == dc_trigger->locked ? ZBX_HC_ITEM_STATUS_BUSY :
+						ZBX_HC_ITEM_STATUS_DEFERRED);
 				goto next;
 			}
 		}
 
+		/* triggers locked by this call are marked with 2 until all items are checked */
 		for (j = 0; NULL != (dc_trigger = dc_item->triggers[j]); j++)
 		{
 			if (TRIGGER_STATUS_ENABLED != dc_trigger->status)
 				continue;
 
-			dc_trigger->locked = 1;
+			dc_trigger->locked = 2;
 			zbx_vector_uint64_append(triggerids, dc_trigger->triggerid);
 		}
 next:;
 	}
 
+	for (i = triggerids_num; i < triggerids->values_num; i++)
+	{
+		if (NULL != (dc_trigger = (ZBX_DC_TRIGGER *)zbx_hashset_search(&config->triggers,
+				&triggerids->values[i])))
+		{
+			dc_trigger->locked = 1;
+		}
+	}
+
 	UNLOCK_CACHE;
 
 	return history_items->values_num - locked_num;
@@ -7652,9 +7773,9 @@ static void	dc_requeue_item_at(ZBX_DC_ITEM *dc_item, ZBX_DC_HOST *dc_host, int n
  *           always return the items they have taken using DCrequeue_items()  *
  *           or DCpoller_requeue_items().                                     *
  *                                                                            *
- *           Currently batch polling is supported only for JMX, SNMP and      *
- *           icmpping* simple checks. In other cases only single item is      *
- *           retrieved.                                                       *
+ *           Currently batch polling is supported only for JMX, SNMP, HTTP    *
+ *           agent and icmpping* simple checks. In other cases only single    *
+ *           item is retrieved.                                               *
  *                                                                            *
  *           IPMI poller queue are handled by DCconfig_get_ipmi_poller_items()*
  *           function.                                                        *
@@ -7713,6 +7834,11 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM *items)
 				if (0 != __config_java_item_compare(dc_item_prev, dc_item))
 					break;
 			}
+			else if (ITEM_TYPE_HTTPAGENT == dc_item_prev->type)
+			{
+				if (ITEM_TYPE_HTTPAGENT != dc_item->type)
+					break;
+			}
 		}
 
 		zbx_binary_heap_remove_min(queue);
@@ -7779,6 +7905,10 @@ int	DCconfig_get_poller_items(unsigned char poller_type, DC_ITEM *items)
 				max_items = DCconfig_get_suggested_snmp_vars_nolock(dc_item->interfaceid, NULL);
 			}
 		}
+
+		/* HTTP agent items of any hosts are retrieved concurrently, see get_values_http() */
+		if (1 == num && ZBX_POLLER_TYPE_NORMAL == poller_type && ITEM_TYPE_HTTPAGENT == dc_item->type)
+			max_items = MAX_HTTPAGENT_ITEMS;
 	}
 
 	UNLOCK_CACHE;
@@ -11456,6 +11586,7 @@ void	DCconfig_items_apply_changes(const zbx_vector_ptr_t *item_diff)
 	int			i;
 	const zbx_item_diff_t	*diff;
 	ZBX_DC_ITEM		*dc_item;
+	ZBX_DC_HOST		*dc_host;
 
 	if (0 == item_diff->values_num)
 		return;
@@ -11479,7 +11610,17 @@ void	DCconfig_items_apply_changes(const zbx_vector_ptr_t *item_diff)
 			DCstrpool_replace(1, &dc_item->error, diff->error);
 
 		if (0 != (ZBX_FLAGS_ITEM_DIFF_UPDATE_STATE & diff->flags))
+		{
+			/* not supported items are excluded from the list of active checks */
+			if (ITEM_TYPE_ZABBIX_ACTIVE == dc_item->type && dc_item->state != diff->state &&
+					NULL != (dc_host = (ZBX_DC_HOST *)zbx_hashset_search(&config->hosts,
+					&dc_item->hostid)))
+			{
+				dc_host->active_checks_revision = ++config->active_checks_revision;
+			}
+
 			dc_item->state = diff->state;
+		}
 
 		if (0 != (ZBX_FLAGS_ITEM_DIFF_UPDATE_LASTCLOCK & diff->flags))
 			dc_item->lastclock = diff->lastclock;
@@ -11776,6 +11917,37 @@ void	zbx_dc_get_proxy_lastaccess(zbx_vector_uint64_pair_t *lastaccess)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_dc_get_active_checks_revision                                *
+ *                                                                            *
+ * Purpose: returns revision of the host active check list                    *
+ *                                                                            *
+ * Parameters: hostid - [IN] the host identifier                              *
+ *                                                                            *
+ * Return value: the revision or 0 if the host was not found                  *
+ *                                                                            *
+ * Comments: The revision changes whenever configuration affecting the list   *
+ *           of host active checks is synced, so the list does not have to be *
+ *           rebuilt and sent to agents that already have it. The revision    *
+ *           must be taken before building the list.                          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_dc_get_active_checks_revision(zbx_uint64_t hostid)
+{
+	const ZBX_DC_HOST	*host;
+	zbx_uint64_t		revision = 0;
+
+	RDLOCK_CACHE;
+
+	if (NULL != (host = (const ZBX_DC_HOST *)zbx_hashset_search(&config->hosts, &hostid)))
+		revision = MAX(host->active_checks_revision, config->active_checks_global_revision);
+
+	UNLOCK_CACHE;
+
+	return revision;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_dc_get_session_token                                         *
@@ -321,6 +321,9 @@ typedef struct
 	/* flag to force update for all items */
 	unsigned char	update_items;
 
+	/* revision of host specific data in the list of active checks */
+	zbx_uint64_t	active_checks_revision;
+
 	/* 'tls_connect' and 'tls_accept' must be respected even if encryption support is not compiled in */
 	unsigned char	tls_connect;
 	unsigned char	tls_accept;
@@ -691,6 +694,10 @@ typedef struct
 	int			sync_ts;
 	int			item_sync_ts;
 
+	/* active check list revisions, see zbx_dc_get_active_checks_revision() */
+	zbx_uint64_t		active_checks_revision;		/* the last assigned revision */
+	zbx_uint64_t		active_checks_global_revision;	/* revision of data common to all hosts */
+
 	unsigned int		internal_actions;		/* number of enabled internal actions */
 
 	/* maintenance processing management */
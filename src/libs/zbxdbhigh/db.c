@@ -50,6 +50,11 @@ zbx_autoreg_host_t;
 extern char	ZBX_PG_ESCAPE_BACKSLASH;
 #endif
 
+#if defined(HAVE_POSTGRESQL)
+/* the minimum number of rows to use COPY instead of insert statement for bulk inserts */
+#define ZBX_DB_COPY_ROWS_MIN	16
+#endif
+
 static int	connection_failure;
 
 void	DBclose(void)
@@ -298,6 +303,44 @@ int	DBexecute(const char *fmt, ...)
 	return rc;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: DBexecute_async                                                  *
+ *                                                                            *
+ * Purpose: send a non-select statement without waiting for its result        *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *           The statement result is checked when the next statement is       *
+ *           executed, see zbx_db_vexecute_async().                           *
+ *                                                                            *
+ ******************************************************************************/
+int	DBexecute_async(const char *fmt, ...)
+{
+	va_list	args;
+	int	rc;
+
+	va_start(args, fmt);
+
+	rc = zbx_db_vexecute_async(fmt, args);
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		DBclose();
+		DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_vexecute_async(fmt, args)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	va_end(args);
+
+	return rc;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: __zbx_DBexecute_once                                             *
@@ -419,6 +462,45 @@ DB_RESULT	DBselectN(const char *query, int n)
 	return rc;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: DBselectN_prepared                                               *
+ *                                                                            *
+ * Purpose: execute a parameterized select statement and get the first N      *
+ *          entries                                                           *
+ *                                                                            *
+ * Parameters: query      - [IN] the statement with '?' parameter             *
+ *                               placeholders                                 *
+ *             params     - [IN] the numeric parameter values                 *
+ *             params_num - [IN] the number of parameters                     *
+ *             n          - [IN] the maximum number of rows to select,        *
+ *                               0 - no limit                                 *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+DB_RESULT	DBselectN_prepared(const char *query, const char **params, int params_num, int n)
+{
+	DB_RESULT	rc;
+
+	rc = zbx_db_select_prepared(query, params, params_num, n);
+
+	while ((DB_RESULT)ZBX_DB_DOWN == rc)
+	{
+		DBclose();
+		DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+		if ((DB_RESULT)ZBX_DB_DOWN == (rc = zbx_db_select_prepared(query, params, params_num, n)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+
 int	DBget_row_count(const char *table_name)
 {
 	const char	*__function_name = "DBget_row_count";
@@ -2591,7 +2673,8 @@ void	zbx_db_insert_add_values_dyn(zbx_db_insert_t *self, const zbx_db_value_t **
 			case ZBX_TYPE_CHAR:
 			case ZBX_TYPE_TEXT:
 			case ZBX_TYPE_SHORTTEXT:
-#ifdef HAVE_ORACLE
+#if defined(HAVE_ORACLE) || defined(HAVE_POSTGRESQL)
+				/* PostgreSQL values are escaped when executing, depending on the chosen insert method */
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_OFF);
 #else
 				row[i].str = DBdyn_escape_field_len(field, value->str, ESCAPE_SEQUENCE_ON);
@@ -2673,6 +2756,179 @@ void	zbx_db_insert_add_values(zbx_db_insert_t *self, ...)
 	zbx_vector_ptr_destroy(&values);
 }
 
+#ifdef HAVE_POSTGRESQL
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_copy_strcpy_alloc                                         *
+ *                                                                            *
+ * Purpose: appends string value escaped for COPY text format                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_db_copy_strcpy_alloc(char **data, size_t *data_alloc, size_t *data_offset, const char *src)
+{
+	size_t	len;
+
+	while ('\0' != *src)
+	{
+		if (0 != (len = strcspn(src, "\\\t\n\r")))
+		{
+			zbx_strncpy_alloc(data, data_alloc, data_offset, src, len);
+			src += len;
+			continue;
+		}
+
+		switch (*src++)
+		{
+			case '\\':
+				zbx_strcpy_alloc(data, data_alloc, data_offset, "\\\\");
+				break;
+			case '\t':
+				zbx_strcpy_alloc(data, data_alloc, data_offset, "\\t");
+				break;
+			case '\n':
+				zbx_strcpy_alloc(data, data_alloc, data_offset, "\\n");
+				break;
+			case '\r':
+				zbx_strcpy_alloc(data, data_alloc, data_offset, "\\r");
+				break;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: DBcopy                                                           *
+ *                                                                            *
+ * Purpose: load rows in COPY text format into database                       *
+ *                                                                            *
+ * Comments: retry until DB is up                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBcopy(const char *sql, const char *data, size_t data_len)
+{
+	int	rc;
+
+	rc = zbx_db_copy(sql, data, data_len);
+
+	while (ZBX_DB_DOWN == rc)
+	{
+		DBclose();
+		DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+		if (ZBX_DB_DOWN == (rc = zbx_db_copy(sql, data, data_len)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "database is down: retrying in %d seconds", ZBX_DB_WAIT_DOWN);
+			connection_failure = 1;
+			sleep(ZBX_DB_WAIT_DOWN);
+		}
+	}
+
+	return rc;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_db_insert_copy                                               *
+ *                                                                            *
+ * Purpose: executes the prepared database bulk insert operation with         *
+ *          COPY ... FROM STDIN statements                                    *
+ *                                                                            *
+ * Parameters: self - [IN] the bulk insert data                               *
+ *                                                                            *
+ * Return value: Returns SUCCEED if the operation completed successfully or   *
+ *               FAIL otherwise.                                              *
+ *                                                                            *
+ * Comments: COPY avoids parsing of large multi-row insert statements and     *
+ *           string literal escaping. Rows are sent in batches limited by     *
+ *           ZBX_MAX_SQL_SIZE.                                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_db_insert_copy(const zbx_db_insert_t *self)
+{
+	int		ret = SUCCEED, i, j;
+	const ZBX_FIELD	*field;
+	char		*sql = NULL, *data;
+	size_t		sql_alloc = 0, sql_offset = 0, data_alloc = 16 * ZBX_KIBIBYTE, data_offset = 0;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "copy %s (", self->table->table);
+
+	for (i = 0; i < self->fields.values_num; i++)
+	{
+		field = (const ZBX_FIELD *)self->fields.values[i];
+
+		if (0 != i)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, field->name);
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ") from stdin");
+
+	data = (char *)zbx_malloc(NULL, data_alloc);
+
+	for (i = 0; i < self->rows.values_num; i++)
+	{
+		const zbx_db_value_t	*values = (const zbx_db_value_t *)self->rows.values[i];
+
+		for (j = 0; j < self->fields.values_num; j++)
+		{
+			const zbx_db_value_t	*value = &values[j];
+
+			field = (const ZBX_FIELD *)self->fields.values[j];
+
+			if (0 != j)
+				zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\t');
+
+			switch (field->type)
+			{
+				case ZBX_TYPE_CHAR:
+				case ZBX_TYPE_TEXT:
+				case ZBX_TYPE_SHORTTEXT:
+				case ZBX_TYPE_LONGTEXT:
+					zbx_db_copy_strcpy_alloc(&data, &data_alloc, &data_offset, value->str);
+					break;
+				case ZBX_TYPE_INT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, "%d", value->i32);
+					break;
+				case ZBX_TYPE_FLOAT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_DBL, value->dbl);
+					break;
+				case ZBX_TYPE_UINT:
+					zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				case ZBX_TYPE_ID:
+					if (0 == value->ui64)
+						zbx_strcpy_alloc(&data, &data_alloc, &data_offset, "\\N");
+					else
+						zbx_snprintf_alloc(&data, &data_alloc, &data_offset, ZBX_FS_UI64, value->ui64);
+					break;
+				default:
+					THIS_SHOULD_NEVER_HAPPEN;
+					exit(EXIT_FAILURE);
+			}
+		}
+
+		zbx_chrcpy_alloc(&data, &data_alloc, &data_offset, '\n');
+
+		if (ZBX_MAX_SQL_SIZE < data_offset || i == self->rows.values_num - 1)
+		{
+			if (ZBX_DB_OK > DBcopy(sql, data, data_offset))
+			{
+				ret = FAIL;
+				break;
+			}
+
+			data_offset = 0;
+		}
+	}
+
+	zbx_free(data);
+	zbx_free(sql);
+
+	return ret;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_db_insert_execute                                            *
@@ -2700,6 +2956,9 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 	char		*sql_values = NULL;
 	size_t		sql_values_alloc = 0, sql_values_offset = 0;
 #	endif
+#	ifdef HAVE_POSTGRESQL
+	char		*str_esc;
+#	endif
 #else
 	zbx_db_bind_context_t	*contexts;
 	int			rc, tries = 0;
@@ -2723,6 +2982,11 @@ int	zbx_db_insert_execute(zbx_db_insert_t *self)
 		}
 	}
 
+#ifdef HAVE_POSTGRESQL
+	if (ZBX_DB_COPY_ROWS_MIN <= self->rows.values_num)
+		return zbx_db_insert_copy(self);
+#endif
+
 #ifndef HAVE_ORACLE
 	sql = (char *)zbx_malloc(NULL, sql_alloc);
 #endif
@@ -2858,7 +3122,13 @@ retry_oracle:
 				case ZBX_TYPE_SHORTTEXT:
 				case ZBX_TYPE_LONGTEXT:
 					zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
+#	ifdef HAVE_POSTGRESQL
+					str_esc = DBdyn_escape_string(value->str);
+					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, str_esc);
+					zbx_free(str_esc);
+#	else
 					zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, value->str);
+#	endif
 					zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, '\'');
 					break;
 				case ZBX_TYPE_INT:
@@ -0,0 +1,1244 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2020 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+
+#include "common.h"
+#include "log.h"
+#include "mutexs.h"
+#include "zbxalgo.h"
+#include "histlog.h"
+
+#include <sys/mman.h>
+
+/******************************************************************************
+ *                                                                            *
+ * Proxy history log - an alternative to proxy_history table.                 *
+ *                                                                            *
+ * History values are appended to fixed size memory mapped segment files      *
+ * named by the identifier of their first record. Each record is framed with  *
+ * its size and CRC32 checksum so that a partially written tail can be        *
+ * detected and dropped during recovery. The next record identifier, the      *
+ * identifier of the last record sent to server and the write position are    *
+ * kept in a memory mapped state file shared by all proxy processes.          *
+ *                                                                            *
+ * Housekeeping removes whole segments instead of deleting rows one by one.   *
+ *                                                                            *
+ * Each writing process allocates the disk space of its next segment in a     *
+ * spare file before the current segment fills up, so that switching to a     *
+ * new segment under the history log lock needs only to write the header and  *
+ * rename the spare file. Spare files are not prepared for segments larger    *
+ * than ZBX_HISTLOG_SPARE_SIZE_MAX to limit the disk space reserved by every  *
+ * writer.                                                                    *
+ *                                                                            *
+ * The written segment range is synchronized to disk before the write         *
+ * position and the next record identifier are advanced, so records reported  *
+ * as written survive a system crash.                                         *
+ *                                                                            *
+ ******************************************************************************/
+
+extern char		*CONFIG_HISTORY_LOG_DIR;
+extern zbx_uint64_t	CONFIG_HISTORY_LOG_SEGMENT_SIZE;
+
+#define ZBX_HISTLOG_MAGIC		"ZBXHLOG1"
+#define ZBX_HISTLOG_STATE_FILE		"histlog.state"
+#define ZBX_HISTLOG_SEGMENT_SUFFIX	".hlog"
+#define ZBX_HISTLOG_SEGMENT_TMP_SUFFIX	".tmp"
+#define ZBX_HISTLOG_SPARE_SUFFIX	".spare"
+
+#define ZBX_HISTLOG_ALIGN(size)		(((size) + 7) & ~(size_t)7)
+
+#define ZBX_HISTLOG_SPARE_SIZE_MAX	(64 * ZBX_MEBIBYTE)
+
+/* segment file header, the record frames follow it */
+typedef struct
+{
+	char		magic[8];
+	zbx_uint64_t	firstid;	/* identifier of the first record in segment */
+	zbx_uint64_t	lastid;		/* identifier of the last record in segment  */
+	int		clock;		/* timestamp of the newest record in segment */
+	int		reserved;
+}
+zbx_histlog_header_t;
+
+/* record frame, zero size marks the end of written data in segment */
+typedef struct
+{
+	zbx_uint32_t	size;		/* payload size */
+	zbx_uint32_t	crc;		/* payload CRC32 checksum */
+}
+zbx_histlog_frame_t;
+
+/* record payload, followed by source and value strings */
+typedef struct
+{
+	zbx_uint64_t	id;
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	lastlogsize;
+	int		clock;
+	int		ns;
+	int		timestamp;
+	int		severity;
+	int		logeventid;
+	int		mtime;
+	zbx_uint32_t	source_len;
+	zbx_uint32_t	value_len;
+	unsigned char	state;
+	unsigned char	flags;
+}
+zbx_histlog_entry_t;
+
+/* history log state shared between processes */
+typedef struct
+{
+	char		magic[8];
+	zbx_uint64_t	nextid;		/* identifier of the next record to write      */
+	zbx_uint64_t	lastid;		/* identifier of the last record sent to server */
+	zbx_uint64_t	segmentid;	/* the segment being written, 0 - none          */
+	zbx_uint64_t	offset;		/* write offset in the segment being written    */
+}
+zbx_histlog_state_t;
+
+/* memory mapped segment */
+typedef struct
+{
+	zbx_uint64_t	segmentid;
+	unsigned char	*data;
+	size_t		size;
+}
+zbx_histlog_segment_t;
+
+static char			*histlog_dir = NULL;
+static zbx_histlog_state_t	*histlog_state = NULL;
+static zbx_mutex_t		histlog_lock = ZBX_MUTEX_NULL;
+static zbx_uint32_t		crc_table[256];
+
+static zbx_histlog_segment_t	writer_segment = {0, NULL, 0};
+
+/* the preallocated file of the next segment of this process, NULL if not prepared */
+static char			*writer_spare = NULL;
+
+static zbx_histlog_segment_t	reader_segment = {0, NULL, 0};
+static zbx_uint64_t		reader_nextid = 0;
+static size_t			reader_offset = 0;
+
+#define LOCK_HISTLOG	zbx_mutex_lock(histlog_lock)
+#define UNLOCK_HISTLOG	zbx_mutex_unlock(histlog_lock)
+
+static void	histlog_crc_init(void)
+{
+	zbx_uint32_t	i, j, crc;
+
+	for (i = 0; i < ARRSIZE(crc_table); i++)
+	{
+		crc = i;
+
+		for (j = 0; j < 8; j++)
+			crc = (0 != (crc & 1) ? 0xEDB88320 ^ (crc >> 1) : crc >> 1);
+
+		crc_table[i] = crc;
+	}
+}
+
+static zbx_uint32_t	histlog_crc(const unsigned char *data, size_t size)
+{
+	zbx_uint32_t	crc = 0xFFFFFFFF;
+
+	while (0 != size--)
+		crc = crc_table[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+
+	return crc ^ 0xFFFFFFFF;
+}
+
+static char	*histlog_segment_path(zbx_uint64_t segmentid, const char *suffix)
+{
+	return zbx_dsprintf(NULL, "%s/" ZBX_FS_UI64 "%s", histlog_dir, segmentid, suffix);
+}
+
+static void	histlog_segment_unmap(zbx_histlog_segment_t *segment)
+{
+	if (NULL != segment->data)
+	{
+		munmap(segment->data, segment->size);
+		segment->data = NULL;
+	}
+
+	segment->segmentid = 0;
+	segment->size = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_segment_map                                              *
+ *                                                                            *
+ * Purpose: maps existing segment file into memory                            *
+ *                                                                            *
+ * Parameters: segment   - [OUT] the mapped segment                           *
+ *             segmentid - [IN] the segment identifier                        *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the segment was mapped                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	histlog_segment_map(zbx_histlog_segment_t *segment, zbx_uint64_t segmentid, char **error)
+{
+	char			*path;
+	int			fd, ret = FAIL;
+	struct stat		st;
+	void			*data;
+	zbx_histlog_header_t	*header;
+
+	histlog_segment_unmap(segment);
+
+	path = histlog_segment_path(segmentid, ZBX_HISTLOG_SEGMENT_SUFFIX);
+
+	if (-1 == (fd = open(path, O_RDWR)))
+	{
+		*error = zbx_dsprintf(*error, "cannot open \"%s\": %s", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	if (0 != fstat(fd, &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot stat \"%s\": %s", path, zbx_strerror(errno));
+		goto close;
+	}
+
+	if ((off_t)sizeof(zbx_histlog_header_t) > st.st_size)
+	{
+		*error = zbx_dsprintf(*error, "invalid size of \"%s\"", path);
+		goto close;
+	}
+
+	if (MAP_FAILED == (data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)))
+	{
+		*error = zbx_dsprintf(*error, "cannot map \"%s\": %s", path, zbx_strerror(errno));
+		goto close;
+	}
+
+	header = (zbx_histlog_header_t *)data;
+
+	if (0 != memcmp(header->magic, ZBX_HISTLOG_MAGIC, sizeof(header->magic)) || header->firstid != segmentid)
+	{
+		*error = zbx_dsprintf(*error, "invalid header of \"%s\"", path);
+		munmap(data, (size_t)st.st_size);
+		goto close;
+	}
+
+	segment->segmentid = segmentid;
+	segment->data = (unsigned char *)data;
+	segment->size = (size_t)st.st_size;
+
+	ret = SUCCEED;
+close:
+	close(fd);
+out:
+	zbx_free(path);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_file_allocate                                            *
+ *                                                                            *
+ * Purpose: creates segment sized file filled with zeroes                     *
+ *                                                                            *
+ * Parameters: path  - [IN] the file path                                     *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the file was created                               *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The file space is allocated by writing zeroes so that running    *
+ *           out of disk space cannot fault writes to the mapped memory.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	histlog_file_allocate(const char *path, char **error)
+{
+	static const char	zeroes[ZBX_KIBIBYTE * 64];
+	int			fd;
+	zbx_uint64_t		offset;
+
+	if (-1 == (fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0640)))
+	{
+		*error = zbx_dsprintf(*error, "cannot create \"%s\": %s", path, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	for (offset = 0; offset < CONFIG_HISTORY_LOG_SEGMENT_SIZE; offset += sizeof(zeroes))
+	{
+		size_t	size = (size_t)MIN(sizeof(zeroes), CONFIG_HISTORY_LOG_SEGMENT_SIZE - offset);
+
+		if ((ssize_t)size != write(fd, zeroes, size))
+			goto fail;
+	}
+
+	if (0 == close(fd))
+		return SUCCEED;
+
+	fd = -1;
+fail:
+	*error = zbx_dsprintf(*error, "cannot initialize \"%s\": %s", path, zbx_strerror(errno));
+
+	if (-1 != fd)
+		close(fd);
+
+	unlink(path);
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_spare_prepare                                            *
+ *                                                                            *
+ * Purpose: preallocates the next segment file of this process                *
+ *                                                                            *
+ * Comments: Called without history log lock, the spare file name is unique   *
+ *           to the process and is not recognized as a segment. Larger        *
+ *           segments are allocated under the lock when they are created.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	histlog_spare_prepare(void)
+{
+	char	*path, *error = NULL;
+
+	if (NULL != writer_spare || ZBX_HISTLOG_SPARE_SIZE_MAX < CONFIG_HISTORY_LOG_SEGMENT_SIZE)
+		return;
+
+	path = zbx_dsprintf(NULL, "%s/%d" ZBX_HISTLOG_SPARE_SUFFIX, histlog_dir, (int)getpid());
+
+	if (SUCCEED != histlog_file_allocate(path, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot preallocate history log segment: %s", error);
+		zbx_free(error);
+		zbx_free(path);
+		return;
+	}
+
+	writer_spare = path;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_segment_create                                           *
+ *                                                                            *
+ * Purpose: creates new segment file and maps it into memory                  *
+ *                                                                            *
+ * Parameters: segment   - [OUT] the mapped segment                           *
+ *             segmentid - [IN] the segment identifier (first record id)      *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the segment was created                            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The preallocated spare file is used if it is available,          *
+ *           otherwise the file is allocated here. The segment is prepared    *
+ *           under other name and renamed only when fully initialized, so     *
+ *           readers never see a partial file.                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	histlog_segment_create(zbx_histlog_segment_t *segment, zbx_uint64_t segmentid, char **error)
+{
+	char			*path, *path_tmp;
+	int			fd, ret = FAIL;
+	zbx_histlog_header_t	header;
+
+	path = histlog_segment_path(segmentid, ZBX_HISTLOG_SEGMENT_SUFFIX);
+
+	if (NULL != writer_spare)
+	{
+		path_tmp = writer_spare;
+		writer_spare = NULL;
+	}
+	else
+	{
+		path_tmp = histlog_segment_path(segmentid, ZBX_HISTLOG_SEGMENT_TMP_SUFFIX);
+
+		if (SUCCEED != histlog_file_allocate(path_tmp, error))
+			goto out;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ZBX_HISTLOG_MAGIC, sizeof(header.magic));
+	header.firstid = segmentid;
+	header.lastid = segmentid - 1;
+
+	if (-1 == (fd = open(path_tmp, O_WRONLY)))
+		goto fail;
+
+	if (sizeof(header) != pwrite(fd, &header, sizeof(header), 0))
+	{
+		close(fd);
+		goto fail;
+	}
+
+	if (0 != close(fd) || 0 != rename(path_tmp, path))
+		goto fail;
+
+	ret = histlog_segment_map(segment, segmentid, error);
+	goto out;
+fail:
+	*error = zbx_dsprintf(*error, "cannot initialize \"%s\": %s", path_tmp, zbx_strerror(errno));
+	unlink(path_tmp);
+out:
+	zbx_free(path_tmp);
+	zbx_free(path);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_get_segmentids                                           *
+ *                                                                            *
+ * Purpose: gets sorted identifiers of existing segments                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	histlog_get_segmentids(zbx_vector_uint64_t *segmentids)
+{
+	DIR		*dir;
+	struct dirent	*entry;
+	size_t		len, suffix_len = sizeof(ZBX_HISTLOG_SEGMENT_SUFFIX) - 1;
+	zbx_uint64_t	segmentid;
+
+	if (NULL == (dir = opendir(histlog_dir)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open history log directory \"%s\": %s", histlog_dir,
+				zbx_strerror(errno));
+		return;
+	}
+
+	while (NULL != (entry = readdir(dir)))
+	{
+		if (suffix_len >= (len = strlen(entry->d_name)))
+			continue;
+
+		if (0 != strcmp(entry->d_name + len - suffix_len, ZBX_HISTLOG_SEGMENT_SUFFIX))
+			continue;
+
+		if (SUCCEED == is_uint64_n(entry->d_name, len - suffix_len, &segmentid) && 0 != segmentid)
+			zbx_vector_uint64_append(segmentids, segmentid);
+	}
+
+	closedir(dir);
+
+	zbx_vector_uint64_sort(segmentids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+static int	histlog_has_suffix(const char *name, size_t len, const char *suffix)
+{
+	size_t	suffix_len = strlen(suffix);
+
+	if (suffix_len >= len || 0 != strcmp(name + len - suffix_len, suffix))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_remove_unused                                            *
+ *                                                                            *
+ * Purpose: removes spare and partially created segment files left by         *
+ *          previous run                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	histlog_remove_unused(void)
+{
+	DIR		*dir;
+	struct dirent	*entry;
+	size_t		len;
+	char		*path = NULL;
+
+	if (NULL == (dir = opendir(histlog_dir)))
+		return;
+
+	while (NULL != (entry = readdir(dir)))
+	{
+		len = strlen(entry->d_name);
+
+		if (SUCCEED != histlog_has_suffix(entry->d_name, len, ZBX_HISTLOG_SPARE_SUFFIX) &&
+				SUCCEED != histlog_has_suffix(entry->d_name, len, ZBX_HISTLOG_SEGMENT_TMP_SUFFIX))
+		{
+			continue;
+		}
+
+		path = zbx_dsprintf(path, "%s/%s", histlog_dir, entry->d_name);
+
+		if (0 != unlink(path))
+			zabbix_log(LOG_LEVEL_WARNING, "cannot remove \"%s\": %s", path, zbx_strerror(errno));
+	}
+
+	closedir(dir);
+	zbx_free(path);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_frame_get                                                *
+ *                                                                            *
+ * Purpose: gets record frame at the specified segment offset                 *
+ *                                                                            *
+ * Return value: the record frame or NULL if there are no more records        *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_histlog_frame_t	*histlog_frame_get(const zbx_histlog_segment_t *segment, size_t offset)
+{
+	const zbx_histlog_frame_t	*frame;
+
+	if (offset + sizeof(zbx_histlog_frame_t) + sizeof(zbx_histlog_entry_t) > segment->size)
+		return NULL;
+
+	frame = (const zbx_histlog_frame_t *)(segment->data + offset);
+
+	if (0 == frame->size || offset + sizeof(zbx_histlog_frame_t) + frame->size > segment->size)
+		return NULL;
+
+	return frame;
+}
+
+static size_t	histlog_frame_size(const zbx_histlog_frame_t *frame)
+{
+	return ZBX_HISTLOG_ALIGN(sizeof(zbx_histlog_frame_t) + frame->size);
+}
+
+static const zbx_histlog_entry_t	*histlog_frame_entry(const zbx_histlog_frame_t *frame)
+{
+	return (const zbx_histlog_entry_t *)(frame + 1);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_frame_validate                                           *
+ *                                                                            *
+ * Purpose: checks record checksum and string lengths                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	histlog_frame_validate(const zbx_histlog_frame_t *frame)
+{
+	const zbx_histlog_entry_t	*entry = histlog_frame_entry(frame);
+	const char			*strings = (const char *)(entry + 1);
+
+	if (frame->crc != histlog_crc((const unsigned char *)entry, frame->size))
+		return FAIL;
+
+	if (sizeof(zbx_histlog_entry_t) + entry->source_len + entry->value_len != frame->size)
+		return FAIL;
+
+	if (0 == entry->source_len || '\0' != strings[entry->source_len - 1])
+		return FAIL;
+
+	if (0 == entry->value_len || '\0' != strings[entry->source_len + entry->value_len - 1])
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_recover                                                  *
+ *                                                                            *
+ * Purpose: restores write position from the last segment, dropping records   *
+ *          that were not completely written                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	histlog_recover(char **error)
+{
+	const char			*__function_name = "histlog_recover";
+
+	zbx_vector_uint64_t		segmentids;
+	zbx_histlog_segment_t		segment = {0, NULL, 0};
+	zbx_histlog_header_t		*header;
+	const zbx_histlog_frame_t	*frame;
+	size_t				offset;
+	zbx_uint64_t			nextid;
+	int				ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	zbx_vector_uint64_create(&segmentids);
+	histlog_get_segmentids(&segmentids);
+
+	if (0 == segmentids.values_num)
+	{
+		histlog_state->segmentid = 0;
+		histlog_state->offset = 0;
+
+		if (histlog_state->nextid <= histlog_state->lastid)
+			histlog_state->nextid = histlog_state->lastid + 1;
+
+		ret = SUCCEED;
+		goto out;
+	}
+
+	if (SUCCEED != histlog_segment_map(&segment, segmentids.values[segmentids.values_num - 1], error))
+		goto out;
+
+	header = (zbx_histlog_header_t *)segment.data;
+	nextid = segment.segmentid;
+	offset = sizeof(zbx_histlog_header_t);
+
+	while (NULL != (frame = histlog_frame_get(&segment, offset)))
+	{
+		if (SUCCEED != histlog_frame_validate(frame) || nextid != histlog_frame_entry(frame)->id)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "dropping corrupted history log records starting from"
+					" record " ZBX_FS_UI64, nextid);
+			break;
+		}
+
+		nextid++;
+		offset += histlog_frame_size(frame);
+	}
+
+	if (offset < segment.size)
+		memset(segment.data + offset, 0, segment.size - offset);
+
+	header->lastid = nextid - 1;
+
+	if (nextid <= histlog_state->lastid)
+	{
+		/* the log tail was lost, but the identifiers of records sent to server must not be */
+		/* reused - continue with a new segment starting after the last sent record        */
+		histlog_state->nextid = histlog_state->lastid + 1;
+		histlog_state->segmentid = 0;
+		histlog_state->offset = 0;
+	}
+	else
+	{
+		histlog_state->nextid = nextid;
+		histlog_state->segmentid = segment.segmentid;
+		histlog_state->offset = offset;
+	}
+
+	histlog_segment_unmap(&segment);
+
+	ret = SUCCEED;
+out:
+	zbx_vector_uint64_destroy(&segmentids);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s nextid:" ZBX_FS_UI64 " lastid:" ZBX_FS_UI64, __function_name,
+			zbx_result_string(ret), histlog_state->nextid, histlog_state->lastid);
+
+	return ret;
+}
+
+int	zbx_is_histlog_enabled(void)
+{
+	if (NULL == CONFIG_HISTORY_LOG_DIR)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_histlog_init                                                 *
+ *                                                                            *
+ * Purpose: opens history log, must be called before forking child processes  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_histlog_init(char **error)
+{
+	struct stat	fs;
+	char		*path;
+	int		fd, ret = FAIL;
+	void		*data;
+
+	if (FAIL == zbx_is_histlog_enabled())
+		return SUCCEED;
+
+	if (0 != stat(CONFIG_HISTORY_LOG_DIR, &fs))
+	{
+		*error = zbx_dsprintf(*error, "Failed to stat the specified path \"%s\": %s.", CONFIG_HISTORY_LOG_DIR,
+				zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (0 == S_ISDIR(fs.st_mode))
+	{
+		*error = zbx_dsprintf(*error, "The specified path \"%s\" is not a directory.", CONFIG_HISTORY_LOG_DIR);
+		return FAIL;
+	}
+
+	if (0 != access(CONFIG_HISTORY_LOG_DIR, W_OK | R_OK))
+	{
+		*error = zbx_dsprintf(*error, "Cannot access path \"%s\": %s.", CONFIG_HISTORY_LOG_DIR,
+				zbx_strerror(errno));
+		return FAIL;
+	}
+
+	histlog_dir = zbx_strdup(NULL, CONFIG_HISTORY_LOG_DIR);
+
+	if ('/' == histlog_dir[strlen(histlog_dir) - 1])
+		histlog_dir[strlen(histlog_dir) - 1] = '\0';
+
+	histlog_crc_init();
+
+	path = zbx_dsprintf(NULL, "%s/%s", histlog_dir, ZBX_HISTLOG_STATE_FILE);
+
+	if (-1 == (fd = open(path, O_RDWR | O_CREAT, 0640)))
+	{
+		*error = zbx_dsprintf(*error, "Cannot open \"%s\": %s.", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	if (0 != ftruncate(fd, sizeof(zbx_histlog_state_t)))
+	{
+		*error = zbx_dsprintf(*error, "Cannot resize \"%s\": %s.", path, zbx_strerror(errno));
+		close(fd);
+		goto out;
+	}
+
+	data = mmap(NULL, sizeof(zbx_histlog_state_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (MAP_FAILED == data)
+	{
+		*error = zbx_dsprintf(*error, "Cannot map \"%s\": %s.", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	histlog_state = (zbx_histlog_state_t *)data;
+
+	if (0 != memcmp(histlog_state->magic, ZBX_HISTLOG_MAGIC, sizeof(histlog_state->magic)))
+	{
+		memset(histlog_state, 0, sizeof(zbx_histlog_state_t));
+		memcpy(histlog_state->magic, ZBX_HISTLOG_MAGIC, sizeof(histlog_state->magic));
+		histlog_state->nextid = 1;
+	}
+
+	histlog_remove_unused();
+
+	if (SUCCEED != histlog_recover(error))
+		goto out;
+
+	ret = zbx_mutex_create(&histlog_lock, ZBX_MUTEX_PROXY_HISTLOG, error);
+out:
+	zbx_free(path);
+
+	return ret;
+}
+
+void	zbx_histlog_destroy(void)
+{
+	if (NULL == histlog_state)
+		return;
+
+	histlog_segment_unmap(&writer_segment);
+	histlog_segment_unmap(&reader_segment);
+
+	if (NULL != writer_spare)
+	{
+		unlink(writer_spare);
+		zbx_free(writer_spare);
+	}
+
+	msync(histlog_state, sizeof(zbx_histlog_state_t), MS_SYNC);
+	munmap(histlog_state, sizeof(zbx_histlog_state_t));
+	histlog_state = NULL;
+
+	zbx_mutex_destroy(&histlog_lock);
+	zbx_free(histlog_dir);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_segment_sync                                             *
+ *                                                                            *
+ * Purpose: writes the specified range of mapped segment to disk              *
+ *                                                                            *
+ * Parameters: segment - [IN] the mapped segment                              *
+ *             start   - [IN] the range start offset                          *
+ *             end     - [IN] the range end offset                            *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ * Return value: SUCCEED - the range was written to disk                      *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	histlog_segment_sync(const zbx_histlog_segment_t *segment, size_t start, size_t end, char **error)
+{
+	size_t	page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+	start -= start % page_size;
+
+	if (0 != msync(segment->data + start, end - start, MS_SYNC))
+	{
+		*error = zbx_dsprintf(*error, "cannot synchronize history log segment " ZBX_FS_UI64 ": %s",
+				segment->segmentid, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_writer_flush                                             *
+ *                                                                            *
+ * Purpose: writes records appended to the current segment to disk and        *
+ *          advances the write position                                       *
+ *                                                                            *
+ * Parameters: offset - [IN] the segment offset after the appended records    *
+ *             nextid - [IN] the identifier of the next record                *
+ *             error  - [OUT] the error message                               *
+ *                                                                            *
+ * Return value: SUCCEED - the records were written to disk                   *
+ *               FAIL    - otherwise, the appended records are discarded      *
+ *                                                                            *
+ * Comments: Must be called with history log lock. The header is written      *
+ *           after the records, so its last record identifier never points    *
+ *           past the records on disk.                                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	histlog_writer_flush(size_t offset, zbx_uint64_t nextid, char **error)
+{
+	zbx_histlog_header_t	*header = (zbx_histlog_header_t *)writer_segment.data;
+
+	if (nextid == histlog_state->nextid)
+		return SUCCEED;
+
+	if (SUCCEED != histlog_segment_sync(&writer_segment, histlog_state->offset, offset, error))
+	{
+		memset(writer_segment.data + histlog_state->offset, 0, offset - histlog_state->offset);
+		return FAIL;
+	}
+
+	header->lastid = nextid - 1;
+
+	if (SUCCEED != histlog_segment_sync(&writer_segment, 0, sizeof(zbx_histlog_header_t), error))
+		return FAIL;
+
+	histlog_state->offset = offset;
+	histlog_state->nextid = nextid;
+	msync(histlog_state, sizeof(zbx_histlog_state_t), MS_SYNC);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_histlog_write                                                *
+ *                                                                            *
+ * Purpose: appends records to history log                                    *
+ *                                                                            *
+ * Parameters: records     - [IN] the records to append, their identifiers    *
+ *                                are assigned by history log                 *
+ *             records_num - [IN] the number of records                       *
+ *                                                                            *
+ * Return value: SUCCEED - the records were written                           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The records are written to disk when the current segment is      *
+ *           full and before returning, with one synchronization per segment. *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_histlog_write(const zbx_histlog_record_t *records, int records_num)
+{
+	const char		*__function_name = "zbx_histlog_write";
+
+	int			i, first = 0, ret = SUCCEED;
+	char			*error = NULL;
+	zbx_histlog_header_t	*header;
+	zbx_histlog_frame_t	*frame;
+	zbx_histlog_entry_t	*entry;
+	size_t			source_len, value_len, payload_size, size, offset;
+	zbx_uint64_t		nextid;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() records:%d", __function_name, records_num);
+
+	/* the write position is checked without lock, at worst the spare is prepared earlier or later */
+	if (0 == histlog_state->segmentid || histlog_state->offset > CONFIG_HISTORY_LOG_SEGMENT_SIZE / 2)
+		histlog_spare_prepare();
+
+	LOCK_HISTLOG;
+
+	if (0 != histlog_state->segmentid && writer_segment.segmentid != histlog_state->segmentid &&
+			SUCCEED != histlog_segment_map(&writer_segment, histlog_state->segmentid, &error))
+	{
+		/* continue with a new segment if the current one cannot be mapped */
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open history log segment: %s", error);
+		zbx_free(error);
+		histlog_state->segmentid = 0;
+	}
+
+	offset = histlog_state->offset;
+	nextid = histlog_state->nextid;
+
+	for (i = 0; i < records_num; i++)
+	{
+		const zbx_histlog_record_t	*record = &records[i];
+
+		source_len = strlen(record->source) + 1;
+		value_len = strlen(record->value) + 1;
+		payload_size = sizeof(zbx_histlog_entry_t) + source_len + value_len;
+		size = ZBX_HISTLOG_ALIGN(sizeof(zbx_histlog_frame_t) + payload_size);
+
+		if (size > CONFIG_HISTORY_LOG_SEGMENT_SIZE - sizeof(zbx_histlog_header_t))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "value of item [itemid:" ZBX_FS_UI64 "] is too large for"
+					" history log segment, skipping", record->itemid);
+			continue;
+		}
+
+		if (0 == histlog_state->segmentid || offset + size > writer_segment.size)
+		{
+			if (0 != histlog_state->segmentid)
+			{
+				if (SUCCEED != histlog_writer_flush(offset, nextid, &error))
+				{
+					zabbix_log(LOG_LEVEL_ERR, "cannot write %d value(s) to history log: %s",
+							records_num - first, error);
+					zbx_free(error);
+					ret = FAIL;
+					goto unlock;
+				}
+
+				first = i;
+			}
+
+			if (SUCCEED != histlog_segment_create(&writer_segment, nextid, &error))
+			{
+				zabbix_log(LOG_LEVEL_ERR, "cannot write %d value(s) to history log: %s",
+						records_num - first, error);
+				zbx_free(error);
+				histlog_state->segmentid = 0;
+				ret = FAIL;
+				break;
+			}
+
+			histlog_state->segmentid = writer_segment.segmentid;
+			histlog_state->offset = offset = sizeof(zbx_histlog_header_t);
+		}
+
+		header = (zbx_histlog_header_t *)writer_segment.data;
+		frame = (zbx_histlog_frame_t *)(writer_segment.data + offset);
+		entry = (zbx_histlog_entry_t *)(frame + 1);
+
+		memset(entry, 0, sizeof(zbx_histlog_entry_t));
+		entry->id = nextid;
+		entry->itemid = record->itemid;
+		entry->lastlogsize = record->lastlogsize;
+		entry->clock = record->clock;
+		entry->ns = record->ns;
+		entry->timestamp = record->timestamp;
+		entry->severity = record->severity;
+		entry->logeventid = record->logeventid;
+		entry->mtime = record->mtime;
+		entry->source_len = (zbx_uint32_t)source_len;
+		entry->value_len = (zbx_uint32_t)value_len;
+		entry->state = record->state;
+		entry->flags = record->flags;
+		memcpy(entry + 1, record->source, source_len);
+		memcpy((char *)(entry + 1) + source_len, record->value, value_len);
+
+		/* the frame size is set last, it marks the record as written */
+		frame->crc = histlog_crc((const unsigned char *)entry, payload_size);
+		frame->size = (zbx_uint32_t)payload_size;
+
+		if (header->clock < record->clock)
+			header->clock = record->clock;
+
+		offset += size;
+		nextid++;
+	}
+
+	if (0 != histlog_state->segmentid && SUCCEED != histlog_writer_flush(offset, nextid, &error))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot write %d value(s) to history log: %s", records_num - first,
+				error);
+		zbx_free(error);
+		ret = FAIL;
+	}
+unlock:
+	UNLOCK_HISTLOG;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s nextid:" ZBX_FS_UI64, __function_name, zbx_result_string(ret),
+			histlog_state->nextid);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: histlog_reader_open                                              *
+ *                                                                            *
+ * Purpose: maps the segment containing the specified record                  *
+ *                                                                            *
+ * Parameters: id      - [IN] the record identifier                           *
+ *             afterid - [IN] the segment to open must start after this       *
+ *                            segment identifier                              *
+ *                                                                            *
+ * Return value: SUCCEED - a segment was mapped, reader_nextid is adjusted    *
+ *                         if the requested record was already removed        *
+ *               FAIL    - there are no matching segments                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	histlog_reader_open(zbx_uint64_t id, zbx_uint64_t afterid)
+{
+	zbx_vector_uint64_t		segmentids;
+	const zbx_histlog_frame_t	*frame;
+	zbx_uint64_t			segmentid = 0;
+	char				*error = NULL;
+	int				i;
+
+	histlog_segment_unmap(&reader_segment);
+
+	zbx_vector_uint64_create(&segmentids);
+	histlog_get_segmentids(&segmentids);
+
+	for (i = 0; i < segmentids.values_num; i++)
+	{
+		if (segmentids.values[i] <= afterid)
+			continue;
+
+		/* use the first segment if the requested record was already removed by housekeeper */
+		if (0 != segmentid && segmentids.values[i] > id)
+			break;
+
+		segmentid = segmentids.values[i];
+	}
+
+	zbx_vector_uint64_destroy(&segmentids);
+
+	if (0 == segmentid)
+		return FAIL;
+
+	if (SUCCEED != histlog_segment_map(&reader_segment, segmentid, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot open history log segment: %s", error);
+		zbx_free(error);
+		return FAIL;
+	}
+
+	reader_offset = sizeof(zbx_histlog_header_t);
+
+	if (id < segmentid)
+		id = segmentid;
+
+	/* skip records up to the requested one */
+	while (NULL != (frame = histlog_frame_get(&reader_segment, reader_offset)) &&
+			histlog_frame_entry(frame)->id < id)
+	{
+		reader_offset += histlog_frame_size(frame);
+	}
+
+	reader_nextid = id;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_histlog_seek                                                 *
+ *                                                                            *
+ * Purpose: positions reader after the specified record                       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_histlog_seek(zbx_uint64_t lastid)
+{
+	if (NULL != reader_segment.data && reader_nextid == lastid + 1)
+		return;
+
+	reader_nextid = lastid + 1;
+
+	if (SUCCEED != histlog_reader_open(reader_nextid, 0))
+		histlog_segment_unmap(&reader_segment);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_histlog_read                                                 *
+ *                                                                            *
+ * Purpose: reads the next record                                             *
+ *                                                                            *
+ * Parameters: record - [OUT] the record, its strings are valid until the     *
+ *                            next call of zbx_histlog_read/zbx_histlog_seek  *
+ *                                                                            *
+ * Return value: SUCCEED - the record was read                                *
+ *               FAIL    - there are no more written records                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_histlog_read(zbx_histlog_record_t *record)
+{
+	zbx_uint64_t			nextid;
+	const zbx_histlog_frame_t	*frame;
+	const zbx_histlog_entry_t	*entry;
+
+	LOCK_HISTLOG;
+	nextid = histlog_state->nextid;
+	UNLOCK_HISTLOG;
+
+	if (reader_nextid >= nextid)
+		return FAIL;
+
+	if (NULL == reader_segment.data && SUCCEED != histlog_reader_open(reader_nextid, 0))
+		return FAIL;
+
+	while (NULL == (frame = histlog_frame_get(&reader_segment, reader_offset)) ||
+			SUCCEED != histlog_frame_validate(frame))
+	{
+		if (NULL != frame)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "skipping corrupted history log segment " ZBX_FS_UI64
+					" starting from record " ZBX_FS_UI64, reader_segment.segmentid, reader_nextid);
+		}
+
+		if (SUCCEED != histlog_reader_open(reader_nextid, reader_segment.segmentid))
+			return FAIL;
+
+		if (reader_nextid >= nextid)
+			return FAIL;
+	}
+
+	entry = histlog_frame_entry(frame);
+
+	record->id = entry->id;
+	record->itemid = entry->itemid;
+	record->lastlogsize = entry->lastlogsize;
+	record->clock = entry->clock;
+	record->ns = entry->ns;
+	record->timestamp = entry->timestamp;
+	record->severity = entry->severity;
+	record->logeventid = entry->logeventid;
+	record->mtime = entry->mtime;
+	record->state = entry->state;
+	record->flags = entry->flags;
+	record->source = (const char *)(entry + 1);
+	record->value = record->source + entry->source_len;
+
+	reader_offset += histlog_frame_size(frame);
+	reader_nextid = entry->id + 1;
+
+	return SUCCEED;
+}
+
+zbx_uint64_t	zbx_histlog_get_lastid(void)
+{
+	zbx_uint64_t	lastid;
+
+	LOCK_HISTLOG;
+	lastid = histlog_state->lastid;
+	UNLOCK_HISTLOG;
+
+	return lastid;
+}
+
+void	zbx_histlog_set_lastid(zbx_uint64_t lastid)
+{
+	LOCK_HISTLOG;
+	histlog_state->lastid = lastid;
+	UNLOCK_HISTLOG;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_histlog_get_count                                            *
+ *                                                                            *
+ * Purpose: gets the number of records not sent to server                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_histlog_get_count(void)
+{
+	zbx_uint64_t	count;
+
+	LOCK_HISTLOG;
+	count = histlog_state->nextid - histlog_state->lastid - 1;
+	UNLOCK_HISTLOG;
+
+	return (int)MIN(count, INT_MAX);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_histlog_housekeep                                            *
+ *                                                                            *
+ * Purpose: removes outdated history log segments                             *
+ *                                                                            *
+ * Parameters: sent_clock - [IN] remove segments with all records sent to     *
+ *                               server and older than this timestamp         *
+ *             min_clock  - [IN] remove segments older than this timestamp    *
+ *                                                                            *
+ * Return value: the number of removed records                                *
+ *                                                                            *
+ * Comments: the segment being written is never removed                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_histlog_housekeep(int sent_clock, int min_clock)
+{
+	const char		*__function_name = "zbx_histlog_housekeep";
+
+	zbx_vector_uint64_t	segmentids;
+	zbx_uint64_t		lastid, segmentid;
+	zbx_histlog_header_t	header;
+	char			*path;
+	int			i, fd, records = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() sent_clock:%d min_clock:%d", __function_name, sent_clock, min_clock);
+
+	LOCK_HISTLOG;
+	lastid = histlog_state->lastid;
+	segmentid = histlog_state->segmentid;
+	UNLOCK_HISTLOG;
+
+	zbx_vector_uint64_create(&segmentids);
+	histlog_get_segmentids(&segmentids);
+
+	for (i = 0; i < segmentids.values_num; i++)
+	{
+		if (0 != segmentid && segmentids.values[i] >= segmentid)
+			break;
+
+		path = histlog_segment_path(segmentids.values[i], ZBX_HISTLOG_SEGMENT_SUFFIX);
+
+		if (-1 == (fd = open(path, O_RDONLY)))
+			goto next;
+
+		if (sizeof(header) != read(fd, &header, sizeof(header)))
+		{
+			close(fd);
+			goto next;
+		}
+
+		close(fd);
+
+		if (header.clock >= min_clock && (header.lastid > lastid || header.clock >= sent_clock))
+			goto next;
+
+		if (0 != unlink(path))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot remove history log segment \"%s\": %s", path,
+					zbx_strerror(errno));
+			goto next;
+		}
+
+		records += (int)(header.lastid - header.firstid + 1);
+next:
+		zbx_free(path);
+	}
+
+	zbx_vector_uint64_destroy(&segmentids);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, records);
+
+	return records;
+}
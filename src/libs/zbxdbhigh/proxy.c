@@ -29,6 +29,7 @@
 #include "discovery.h"
 #include "zbxalgo.h"
 #include "preproc.h"
+#include "histlog.h"
 #include "../zbxcrypto/tls_tcp_active.h"
 
 extern char	*CONFIG_SERVER;
@@ -1906,7 +1907,10 @@ static void	proxy_set_lastid(const char *table_name, const char *lastidfield, co
 
 void	proxy_set_hist_lastid(const zbx_uint64_t lastid)
 {
-	proxy_set_lastid("proxy_history", "history_lastid", lastid);
+	if (SUCCEED == zbx_is_histlog_enabled())
+		zbx_histlog_set_lastid(lastid);
+	else
+		proxy_set_lastid("proxy_history", "history_lastid", lastid);
 }
 
 void	proxy_set_dhis_lastid(const zbx_uint64_t lastid)
@@ -2054,8 +2058,9 @@ static void	proxy_get_history_data(struct zbx_json *j, zbx_uint64_t *lastid, zbx
 	static size_t			data_alloc = 0;
 	size_t				data_num = 0, i;
 	DC_ITEM				*dc_items;
-	int				*errcodes, retries = 1, records_num_last = *records_num;
+	int				*errcodes, retries = 1, records_num_last = *records_num, histlog;
 	zbx_history_data_t		*hd;
+	zbx_histlog_record_t		record;
 	struct timespec			t_sleep = { 0, 100000000L }, t_rem;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
@@ -2065,42 +2070,77 @@ static void	proxy_get_history_data(struct zbx_json *j, zbx_uint64_t *lastid, zbx
 
 	*more = ZBX_PROXY_DATA_DONE;
 
+	if (SUCCEED == (histlog = zbx_is_histlog_enabled()))
+	{
+		zbx_histlog_seek(*id);
+		result = NULL;
+	}
+	else
+	{
 try_again:
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-			"select id,itemid,clock,ns,timestamp,source,severity,"
-				"value,logeventid,state,lastlogsize,mtime,flags"
-			" from proxy_history"
-			" where id>" ZBX_FS_UI64
-			" order by id",
-			*id);
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+				"select id,itemid,clock,ns,timestamp,source,severity,"
+					"value,logeventid,state,lastlogsize,mtime,flags"
+				" from proxy_history"
+				" where id>" ZBX_FS_UI64
+				" order by id",
+				*id);
 
-	result = DBselectN(sql, ZBX_MAX_HRECORDS);
+		result = DBselectN(sql, ZBX_MAX_HRECORDS);
 
-	zbx_free(sql);
+		zbx_free(sql);
+	}
 
-	while (NULL != (row = DBfetch(result)))
+	while (1)
 	{
-		ZBX_STR2UINT64(*lastid, row[0]);
+		if (SUCCEED == histlog)
+		{
+			if (ZBX_MAX_HRECORDS == data_num || SUCCEED != zbx_histlog_read(&record))
+				break;
 
-		if (1 < *lastid - *id)
+			*lastid = record.id;
+		}
+		else
 		{
-			/* At least one record is missing. It can happen if some DB syncer process has */
-			/* started but not yet committed a transaction or a rollback occurred in a DB syncer. */
-			if (0 < retries--)
-			{
-				DBfree_result(result);
-				zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing."
-						" Waiting " ZBX_FS_DBL " sec, retrying.",
-						__function_name, *lastid - *id - 1,
-						t_sleep.tv_sec + t_sleep.tv_nsec / 1e9);
-				nanosleep(&t_sleep, &t_rem);
-				goto try_again;
-			}
-			else
+			if (NULL == (row = DBfetch(result)))
+				break;
+
+			ZBX_STR2UINT64(*lastid, row[0]);
+
+			if (1 < *lastid - *id)
 			{
-				zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing. No more retries.",
-						__function_name, *lastid - *id - 1);
+				/* At least one record is missing. It can happen if some DB syncer process has */
+				/* started but not yet committed a transaction or a rollback occurred in a DB syncer. */
+				if (0 < retries--)
+				{
+					DBfree_result(result);
+					zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing."
+							" Waiting " ZBX_FS_DBL " sec, retrying.",
+							__function_name, *lastid - *id - 1,
+							t_sleep.tv_sec + t_sleep.tv_nsec / 1e9);
+					nanosleep(&t_sleep, &t_rem);
+					goto try_again;
+				}
+				else
+				{
+					zabbix_log(LOG_LEVEL_DEBUG, "%s() " ZBX_FS_UI64 " record(s) missing."
+							" No more retries.", __function_name, *lastid - *id - 1);
+				}
 			}
+
+			record.id = *lastid;
+			ZBX_STR2UINT64(record.itemid, row[1]);
+			record.clock = atoi(row[2]);
+			record.ns = atoi(row[3]);
+			record.timestamp = atoi(row[4]);
+			record.source = row[5];
+			record.severity = atoi(row[6]);
+			record.value = row[7];
+			record.logeventid = atoi(row[8]);
+			ZBX_STR2UCHAR(record.state, row[9]);
+			ZBX_STR2UINT64(record.lastlogsize, row[10]);
+			record.mtime = atoi(row[11]);
+			ZBX_STR2UCHAR(record.flags, row[12]);
 		}
 
 		if (data_alloc == data_num)
@@ -2110,23 +2150,23 @@ try_again:
 			itemids = (zbx_uint64_t *)zbx_realloc(itemids, sizeof(zbx_uint64_t) * data_alloc);
 		}
 
-		ZBX_STR2UINT64(itemids[data_num], row[1]);
+		itemids[data_num] = record.itemid;
 
 		hd = &data[data_num++];
 
-		hd->id = *lastid;
-		hd->clock = atoi(row[2]);
-		hd->ns = atoi(row[3]);
-		hd->timestamp = atoi(row[4]);
-		hd->severity = atoi(row[6]);
-		hd->logeventid = atoi(row[8]);
-		ZBX_STR2UCHAR(hd->state, row[9]);
-		ZBX_STR2UINT64(hd->lastlogsize, row[10]);
-		hd->mtime = atoi(row[11]);
-		ZBX_STR2UCHAR(hd->flags, row[12]);
+		hd->id = record.id;
+		hd->clock = record.clock;
+		hd->ns = record.ns;
+		hd->timestamp = record.timestamp;
+		hd->severity = record.severity;
+		hd->logeventid = record.logeventid;
+		hd->state = record.state;
+		hd->lastlogsize = record.lastlogsize;
+		hd->mtime = record.mtime;
+		hd->flags = record.flags;
 
-		len1 = strlen(row[5]) + 1;
-		len2 = strlen(row[7]) + 1;
+		len1 = strlen(record.source) + 1;
+		len2 = strlen(record.value) + 1;
 
 		if (string_buffer_alloc < string_buffer_offset + len1 + len2)
 		{
@@ -2137,10 +2177,10 @@ try_again:
 		}
 
 		hd->psource = string_buffer_offset;
-		memcpy(&string_buffer[string_buffer_offset], row[5], len1);
+		memcpy(&string_buffer[string_buffer_offset], record.source, len1);
 		string_buffer_offset += len1;
 		hd->pvalue = string_buffer_offset;
-		memcpy(&string_buffer[string_buffer_offset], row[7], len2);
+		memcpy(&string_buffer[string_buffer_offset], record.value, len2);
 		string_buffer_offset += len2;
 
 		*id = *lastid;
@@ -2227,12 +2267,26 @@ try_again:
 			*lastid, *more, (zbx_fs_size_t)j->buffer_offset);
 }
 
-int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
+/******************************************************************************
+ *                                                                            *
+ * Function: proxy_get_hist_data_ext                                          *
+ *                                                                            *
+ * Purpose: gets history data starting after the specified record             *
+ *                                                                            *
+ * Parameters: j      - [OUT] the json to add data to                         *
+ *             id     - [IN] identifier of the last record already sent       *
+ *             lastid - [OUT] identifier of the last added record             *
+ *             more   - [OUT] ZBX_PROXY_DATA_MORE if there are more records   *
+ *                                                                            *
+ * Return value: the number of added records                                  *
+ *                                                                            *
+ * Comments: Allows reading the next batch before the lastid of the current   *
+ *           batch is stored, proxy_get_hist_data() reads after stored lastid *
+ *                                                                            *
+ ******************************************************************************/
+int	proxy_get_hist_data_ext(struct zbx_json *j, zbx_uint64_t id, zbx_uint64_t *lastid, int *more)
 {
-	int		records_num = 0;
-	zbx_uint64_t	id;
-
-	proxy_get_lastid("proxy_history", "history_lastid", &id);
+	int	records_num = 0;
 
 	/* get history data in batches by ZBX_MAX_HRECORDS records and stop if: */
 	/*   1) there are no more data to read                                  */
@@ -2252,12 +2306,21 @@ int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
 	return records_num;
 }
 
-int	proxy_get_dhis_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
+int	proxy_get_hist_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
 {
-	int		records_num = 0;
 	zbx_uint64_t	id;
 
-	proxy_get_lastid(dht.table, dht.lastidfield, &id);
+	if (SUCCEED == zbx_is_histlog_enabled())
+		id = zbx_histlog_get_lastid();
+	else
+		proxy_get_lastid("proxy_history", "history_lastid", &id);
+
+	return proxy_get_hist_data_ext(j, id, lastid, more);
+}
+
+int	proxy_get_dhis_data_ext(struct zbx_json *j, zbx_uint64_t id, zbx_uint64_t *lastid, int *more)
+{
+	int	records_num = 0;
 
 	/* get history data in batches by ZBX_MAX_HRECORDS records and stop if: */
 	/*   1) there are no more data to read                                  */
@@ -2277,12 +2340,18 @@ int	proxy_get_dhis_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
 	return records_num;
 }
 
-int	proxy_get_areg_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
+int	proxy_get_dhis_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
 {
-	int		records_num = 0;
 	zbx_uint64_t	id;
 
-	proxy_get_lastid(areg.table, areg.lastidfield, &id);
+	proxy_get_lastid(dht.table, dht.lastidfield, &id);
+
+	return proxy_get_dhis_data_ext(j, id, lastid, more);
+}
+
+int	proxy_get_areg_data_ext(struct zbx_json *j, zbx_uint64_t id, zbx_uint64_t *lastid, int *more)
+{
+	int	records_num = 0;
 
 	/* get history data in batches by ZBX_MAX_HRECORDS records and stop if: */
 	/*   1) there are no more data to read                                  */
@@ -2303,6 +2372,15 @@ int	proxy_get_areg_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
 	return records_num;
 }
 
+int	proxy_get_areg_data(struct zbx_json *j, zbx_uint64_t *lastid, int *more)
+{
+	zbx_uint64_t	id;
+
+	proxy_get_lastid(areg.table, areg.lastidfield, &id);
+
+	return proxy_get_areg_data_ext(j, id, lastid, more);
+}
+
 void	calc_timestamp(const char *line, int *timestamp, const char *format)
 {
 	const char	*__function_name = "calc_timestamp";
@@ -3656,6 +3734,9 @@ int	proxy_get_history_count(void)
 	zbx_uint64_t	id;
 	int		count = 0;
 
+	if (SUCCEED == zbx_is_histlog_enabled())
+		return zbx_histlog_get_count();
+
 	proxy_get_lastid("proxy_history", "history_lastid", &id);
 
 	result = DBselect(
@@ -3724,6 +3805,15 @@ int	zbx_get_protocol_version(struct zbx_json_parse *jp)
  *                                                                            *
  * Comments: This function is used to parse the new proxy history data        *
  *           protocol introduced in Zabbix v3.3.                              *
+ *           The values are processed in chunks by the trapper that received  *
+ *           them. Chunks are not handed out to other processes over an IPC   *
+ *           service (see zbxipcservice, used by the preprocessing and IPMI   *
+ *           managers): the values are already passed to the preprocessing    *
+ *           manager and processed by its workers, while duplicate detection  *
+ *           against the data session and the response to proxy require the   *
+ *           chunks to be handled in order by the receiving trapper. Only the *
+ *           item data needed to process values is copied from configuration  *
+ *           cache to keep this serial part short.                            *
  *                                                                            *
  ******************************************************************************/
 static void	process_proxy_history_data_33(const DC_PROXY *proxy, struct zbx_json_parse *jp_data,
@@ -3749,7 +3839,8 @@ static void	process_proxy_history_data_33(const DC_PROXY *proxy, struct zbx_json
 	while (SUCCEED == parse_history_data_33(jp_data, &pnext, values, itemids, &values_num, &read_num,
 			unique_shift, &error) && 0 != values_num)
 	{
-		DCconfig_get_items_by_itemids(items, itemids, errcodes, values_num);
+		/* only the data needed to process values is copied from configuration cache */
+		DCconfig_get_history_items_by_itemids(items, itemids, errcodes, values_num);
 
 		for (i = 0; i < values_num; i++)
 		{
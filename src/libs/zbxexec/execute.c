@@ -119,6 +119,89 @@ static int	zbx_read_from_pipe(HANDLE hRead, char **buf, size_t *buf_size, size_t
 
 #else	/* not _WINDOWS */
 
+#ifdef HAVE_SPAWN_H
+extern char	**environ;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_spawn                                                        *
+ *                                                                            *
+ * Purpose: start a shell command in a new process group without forking the *
+ *          calling process                                                   *
+ *                                                                            *
+ * Parameters: pid     - [OUT] child process PID                              *
+ *             command - [IN] a shell command line                            *
+ *             fd_in   - [IN] descriptor to become child's stdin, -1 to keep  *
+ *             fd_out  - [IN] descriptor to become child's stdout, -1 to keep *
+ *             fd_err  - [IN] descriptor to become child's stderr, -1 to keep *
+ *                                                                            *
+ * Return value: SUCCEED - the process was started                            *
+ *               FAIL    - otherwise, errno is set appropriately              *
+ *                                                                            *
+ * Comments: posix_spawn() is normally implemented with vfork() or clone(),   *
+ *           so the cost of starting a script does not grow with the size of  *
+ *           the calling process address space as it does with fork()         *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_spawn(pid_t *pid, const char *command, int fd_in, int fd_out, int fd_err)
+{
+	posix_spawn_file_actions_t	actions;
+	posix_spawnattr_t		attr;
+	char				*argv[] = {"sh", "-c", NULL, NULL};
+	int				fds[3] = {fd_in, fd_out, fd_err}, i, j, rc;
+
+	argv[2] = (char *)command;
+
+	if (0 != (rc = posix_spawn_file_actions_init(&actions)))
+		goto out;
+
+	if (0 != (rc = posix_spawnattr_init(&attr)))
+	{
+		posix_spawn_file_actions_destroy(&actions);
+		goto out;
+	}
+
+	/* set the child as the process group leader, otherwise orphans may be left after timeout */
+	if (0 != (rc = posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP)) ||
+			0 != (rc = posix_spawnattr_setpgroup(&attr, 0)))
+	{
+		goto clean;
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		if (-1 != fds[i] && i != fds[i] && 0 != (rc = posix_spawn_file_actions_adddup2(&actions, fds[i], i)))
+			goto clean;
+	}
+
+	/* close every original descriptor once, after all of them have been duplicated */
+	for (i = 0; i < 3; i++)
+	{
+		if (-1 == fds[i] || STDERR_FILENO >= fds[i])
+			continue;
+
+		for (j = 0; j < i && fds[j] != fds[i]; j++)
+			;
+
+		if (j == i && 0 != (rc = posix_spawn_file_actions_addclose(&actions, fds[i])))
+			goto clean;
+	}
+
+	rc = posix_spawn(pid, "/bin/sh", &actions, &attr, argv, environ);
+clean:
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
+out:
+	if (0 != rc)
+	{
+		errno = rc;
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_popen                                                        *
@@ -139,13 +222,35 @@ static int	zbx_read_from_pipe(HANDLE hRead, char **buf, size_t *buf_size, size_t
 static int	zbx_popen(pid_t *pid, const char *command)
 {
 	const char	*__function_name = "zbx_popen";
-	int		fd[2], stdout_orig, stderr_orig;
+	int		fd[2];
+#ifndef HAVE_SPAWN_H
+	int		stdout_orig, stderr_orig;
+#endif
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() command:'%s'", __function_name, command);
 
 	if (-1 == pipe(fd))
 		return -1;
 
+#ifdef HAVE_SPAWN_H
+	fcntl(fd[0], F_SETFD, FD_CLOEXEC);
+
+	if (SUCCEED != zbx_spawn(pid, command, -1, fd[1], fd[1]))
+	{
+		int	errno_orig = errno;
+
+		close(fd[0]);
+		close(fd[1]);
+		errno = errno_orig;
+		return -1;
+	}
+
+	close(fd[1]);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __function_name, fd[0]);
+
+	return fd[0];
+#else
 	if (-1 == (*pid = zbx_fork()))
 	{
 		close(fd[0]);
@@ -213,6 +318,7 @@ static int	zbx_popen(pid_t *pid, const char *command)
 
 	/* execl() returns only when an error occurs, let parent process know about it */
 	exit(EXIT_FAILURE);
+#endif
 }
 
 /******************************************************************************
@@ -635,3 +741,120 @@ int	zbx_execute_nowait(const char *command)
 	exit(EXIT_SUCCESS);
 #endif
 }
+
+#ifndef _WINDOWS
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_coprocess_open                                               *
+ *                                                                            *
+ * Purpose: start a long running command connected to the caller with a pair *
+ *          of pipes                                                          *
+ *                                                                            *
+ * Parameters: command  - [IN] a shell command line                           *
+ *             pid      - [OUT] child process PID (process group leader)      *
+ *             fd_write - [OUT] descriptor connected to child's stdin         *
+ *             fd_read  - [OUT] descriptor connected to child's stdout        *
+ *                                                                            *
+ * Return value: SUCCEED - the process was started                            *
+ *               FAIL    - otherwise, errno is set appropriately              *
+ *                                                                            *
+ * Comments: child's stderr is left untouched so that diagnostics written by  *
+ *           the command end up in the log file instead of the data stream    *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_coprocess_open(const char *command, pid_t *pid, int *fd_write, int *fd_read)
+{
+	const char	*__function_name = "zbx_coprocess_open";
+	int		in[2], out[2], ret = FAIL, errno_orig;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() command:'%s'", __function_name, command);
+
+	if (-1 == pipe(in))
+		goto out;
+
+	if (-1 == pipe(out))
+	{
+		errno_orig = errno;
+		close(in[0]);
+		close(in[1]);
+		errno = errno_orig;
+		goto out;
+	}
+
+	/* parent ends of the pipes must not leak into this or any other child */
+	fcntl(in[1], F_SETFD, FD_CLOEXEC);
+	fcntl(out[0], F_SETFD, FD_CLOEXEC);
+
+#ifdef HAVE_SPAWN_H
+	ret = zbx_spawn(pid, command, in[0], out[1], -1);
+#else
+	if (-1 == (*pid = zbx_fork()))
+	{
+		ret = FAIL;
+	}
+	else if (0 == *pid)
+	{
+		/* child process */
+
+		setpgid(0, 0);
+
+		dup2(in[0], STDIN_FILENO);
+		dup2(out[1], STDOUT_FILENO);
+		close(in[0]);
+		close(out[1]);
+
+		execl("/bin/sh", "sh", "-c", command, NULL);
+
+		/* execl() returns only when an error occurs */
+		zabbix_log(LOG_LEVEL_WARNING, "execl() failed for [%s]: %s", command, zbx_strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	else
+		ret = SUCCEED;
+#endif
+	errno_orig = errno;
+
+	close(in[0]);
+	close(out[1]);
+
+	if (SUCCEED == ret)
+	{
+		*fd_write = in[1];
+		*fd_read = out[0];
+	}
+	else
+	{
+		close(in[1]);
+		close(out[0]);
+	}
+
+	errno = errno_orig;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_coprocess_close                                              *
+ *                                                                            *
+ * Purpose: stop a command started by zbx_coprocess_open()                    *
+ *                                                                            *
+ * Parameters: pid      - [IN] child process PID                              *
+ *             fd_write - [IN] descriptor connected to child's stdin          *
+ *             fd_read  - [IN] descriptor connected to child's stdout         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_coprocess_close(pid_t pid, int fd_write, int fd_read)
+{
+	close(fd_write);
+	close(fd_read);
+
+	/* kill the whole process group, pid must be the leader */
+	if (-1 == kill(-pid, SIGKILL))
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot kill process group %d: %s", (int)pid, zbx_strerror(errno));
+
+	zbx_waitpid(pid, NULL);
+}
+#endif
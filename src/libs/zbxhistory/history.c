@@ -29,6 +29,7 @@ ZBX_VECTOR_IMPL(history_record, zbx_history_record_t)
 
 extern char	*CONFIG_HISTORY_STORAGE_URL;
 extern char	*CONFIG_HISTORY_STORAGE_OPTS;
+extern char	*CONFIG_HISTORY_STORAGE_DIR;
 
 zbx_history_iface_t	history_ifaces[ITEM_VALUE_TYPE_MAX];
 
@@ -40,7 +41,8 @@ zbx_history_iface_t	history_ifaces[ITEM_VALUE_TYPE_MAX];
  *                                                                                  *
  * Comments: History interfaces are created for all values types based on           *
  *           configuration. Every value type can have different history storage     *
- *           backend.                                                               *
+ *           backend. Numeric value types are stored in the local columnar storage  *
+ *           if its directory is configured.                                        *
  *                                                                                  *
  ************************************************************************************/
 int	zbx_history_init(char **error)
@@ -53,7 +55,9 @@ int	zbx_history_init(char **error)
 
 	for (i = 0; i < ITEM_VALUE_TYPE_MAX; i++)
 	{
-		if (NULL == CONFIG_HISTORY_STORAGE_URL || NULL == strstr(CONFIG_HISTORY_STORAGE_OPTS, opts[i]))
+		if (NULL != CONFIG_HISTORY_STORAGE_DIR && (ITEM_VALUE_TYPE_FLOAT == i || ITEM_VALUE_TYPE_UINT64 == i))
+			ret = zbx_history_columnar_init(&history_ifaces[i], i, error);
+		else if (NULL == CONFIG_HISTORY_STORAGE_URL || NULL == strstr(CONFIG_HISTORY_STORAGE_OPTS, opts[i]))
 			ret = zbx_history_sql_init(&history_ifaces[i], i, error);
 		else
 			ret = zbx_history_elastic_init(&history_ifaces[i], i, error);
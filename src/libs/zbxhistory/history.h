@@ -22,6 +22,7 @@
 
 #define ZBX_HISTORY_IFACE_SQL		0
 #define ZBX_HISTORY_IFACE_ELASTIC	1
+#define ZBX_HISTORY_IFACE_COLUMNAR	2
 
 typedef struct zbx_history_iface zbx_history_iface_t;
 
@@ -49,4 +50,23 @@ int	zbx_history_sql_init(zbx_history_iface_t *hist, unsigned char value_type, ch
 /* elastic hist */
 int	zbx_history_elastic_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
 
+/* columnar hist */
+#define ZBX_COL_BLOCK_VALUES_MAX	128
+#define ZBX_COL_BLOCK_MAGIC		0x3242435a	/* "ZCB2" */
+
+/* columnar history file block header, followed by encoded values and block length trailer */
+typedef struct
+{
+	zbx_uint32_t	magic;
+	zbx_uint32_t	size;		/* encoded values size in bytes */
+	int		num;		/* number of values */
+	int		clock_min;
+	int		clock_max;
+	int		clock_max_all;	/* the largest value timestamp of this and all preceding blocks */
+	zbx_uint32_t	offset;		/* the block offset in file */
+}
+zbx_col_block_t;
+
+int	zbx_history_columnar_init(zbx_history_iface_t *hist, unsigned char value_type, char **error);
+
 #endif
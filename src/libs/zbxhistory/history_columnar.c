@@ -0,0 +1,1197 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2020 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "common.h"
+#include "log.h"
+#include "zbxalgo.h"
+#include "dbcache.h"
+#include "zbxhistory.h"
+#include "history.h"
+
+extern char	*CONFIG_HISTORY_STORAGE_DIR;
+
+/* Local columnar storage of numeric history.                                             */
+/*                                                                                        */
+/* The values are stored in <HistoryStorageDir>/<dbl|uint>/<partition>/<itemid> files,    */
+/* where partition is the start of the day the values belong to. Each file is a sequence  */
+/* of blocks with up to ZBX_COL_BLOCK_VALUES_MAX values:                                  */
+/*   zbx_col_block_t header, encoded values, block length (header + values) trailer       */
+/* New values are merged into the last block until it is full. The merged block is first  */
+/* written after the end of the file, then copied over the last block and the file is     */
+/* truncated after it, so the values of the last block are not lost if the write is       */
+/* interrupted. Such staged copy is recognized by its offset field not matching its       */
+/* position and the copy is completed by the next writer. Invalid tail left by other      */
+/* interrupted writes is truncated by the next writer.                                    */
+/*                                                                                        */
+/* The trailer allows to find the last block without walking the file. Readers walk the   */
+/* blocks starting with the newest, skip blocks outside the requested period without      */
+/* decoding them and stop when the largest timestamp of the remaining blocks (stored in   */
+/* each block header) is older than the requested values.                                 */
+/*                                                                                        */
+/* Value encoding (one after another, the previous value is zero for the first value):    */
+/*   seconds - varint of zigzag encoded difference from the previous value                */
+/*   ns      - varint                                                                     */
+/*   uint    - varint of zigzag encoded difference from the previous value                */
+/*   dbl     - the number of trailing zero bytes of the value XOR previous value,         */
+/*             followed by the varint of the remaining bytes (omitted for equal values)   */
+/*                                                                                        */
+/* Each partition also has "expires" file with the largest value timestamp + item history */
+/* storage period. The partition is removed when it expires.                              */
+
+#define ZBX_COL_PARTITION_PERIOD	SEC_PER_DAY
+
+/* the maximum encoded value size - seconds (10), ns (5), value (1 + 10) */
+#define ZBX_COL_VALUE_SIZE_MAX		26
+
+/* the maximum block size with header and trailer */
+#define ZBX_COL_BLOCK_SIZE_MAX		(sizeof(zbx_col_block_t) + ZBX_COL_BLOCK_VALUES_MAX * ZBX_COL_VALUE_SIZE_MAX + \
+		sizeof(zbx_uint32_t))
+
+#define ZBX_COL_EXPIRES_FILE		"expires"
+
+typedef struct
+{
+	/* the value type directory */
+	char			*path;
+
+	/* the history values to be written by flush */
+	zbx_vector_ptr_t	history;
+
+	/* the last updated partition and its expiry time, used to skip unnecessary updates */
+	int			expires_partition;
+	int			expires;
+
+	/* the sorted list of partitions and the time it was read, 0 if it must be read again */
+	zbx_vector_uint64_t	partitions;
+	int			partitions_time;
+}
+zbx_col_data_t;
+
+#define COL_ZIGZAG_ENCODE(v)	(((zbx_uint64_t)(v) << 1) ^ (zbx_uint64_t)((v) >> 63))
+#define COL_ZIGZAG_DECODE(v)	((zbx_int64_t)(((v) >> 1) ^ (~((v) & 1) + 1)))
+
+static void	col_encode_varint(unsigned char **ptr, zbx_uint64_t value)
+{
+	while (0x80 <= value)
+	{
+		*(*ptr)++ = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+
+	*(*ptr)++ = (unsigned char)value;
+}
+
+static int	col_decode_varint(const unsigned char **ptr, const unsigned char *end, zbx_uint64_t *value)
+{
+	int	shift;
+
+	*value = 0;
+
+	for (shift = 0; *ptr < end && 64 > shift; shift += 7)
+	{
+		unsigned char	c = *(*ptr)++;
+
+		*value |= (zbx_uint64_t)(c & 0x7f) << shift;
+
+		if (0 == (c & 0x80))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_encode_values                                                *
+ *                                                                            *
+ * Purpose: encodes history values into block data                            *
+ *                                                                            *
+ * Parameters: values     - [IN] the values to encode                         *
+ *             num        - [IN] the number of values                         *
+ *             value_type - [IN] the value type                               *
+ *             buf        - [OUT] the output buffer, must have space for at   *
+ *                                least num * ZBX_COL_VALUE_SIZE_MAX bytes    *
+ *                                                                            *
+ * Return value: the number of bytes written                                  *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	col_encode_values(const zbx_history_record_t *values, int num, unsigned char value_type,
+		unsigned char *buf)
+{
+	unsigned char	*ptr = buf;
+	int		i, sec_prev = 0;
+	zbx_uint64_t	prev = 0, value;
+
+	for (i = 0; i < num; i++)
+	{
+		col_encode_varint(&ptr, COL_ZIGZAG_ENCODE((zbx_int64_t)values[i].timestamp.sec - sec_prev));
+		col_encode_varint(&ptr, (zbx_uint64_t)values[i].timestamp.ns);
+		sec_prev = values[i].timestamp.sec;
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			value = values[i].value.ui64;
+			col_encode_varint(&ptr, COL_ZIGZAG_ENCODE((zbx_int64_t)(value - prev)));
+		}
+		else
+		{
+			zbx_uint64_t	diff;
+			unsigned char	shift = 0;
+
+			memcpy(&value, &values[i].value.dbl, sizeof(value));
+
+			if (0 == (diff = value ^ prev))
+			{
+				*ptr++ = sizeof(diff);
+			}
+			else
+			{
+				for (; 0 == (diff & 0xff); shift++)
+					diff >>= 8;
+
+				*ptr++ = shift;
+				col_encode_varint(&ptr, diff);
+			}
+		}
+
+		prev = value;
+	}
+
+	return ptr - buf;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_decode_values                                                *
+ *                                                                            *
+ * Purpose: decodes block data into history values                            *
+ *                                                                            *
+ * Parameters: buf        - [IN] the block data                               *
+ *             size       - [IN] the block data size                          *
+ *             num        - [IN] the number of values in block                *
+ *             value_type - [IN] the value type                               *
+ *             values     - [OUT] the decoded values, must have space for     *
+ *                                num values                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the values were decoded                            *
+ *               FAIL    - the block data is corrupted                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_decode_values(const unsigned char *buf, size_t size, int num, unsigned char value_type,
+		zbx_history_record_t *values)
+{
+	const unsigned char	*ptr = buf, *end = buf + size;
+	int			i, sec_prev = 0;
+	zbx_uint64_t		prev = 0, value;
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != col_decode_varint(&ptr, end, &value))
+			return FAIL;
+
+		values[i].timestamp.sec = sec_prev + (int)COL_ZIGZAG_DECODE(value);
+		sec_prev = values[i].timestamp.sec;
+
+		if (SUCCEED != col_decode_varint(&ptr, end, &value))
+			return FAIL;
+
+		values[i].timestamp.ns = (int)value;
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			if (SUCCEED != col_decode_varint(&ptr, end, &value))
+				return FAIL;
+
+			prev += (zbx_uint64_t)COL_ZIGZAG_DECODE(value);
+			values[i].value.ui64 = prev;
+		}
+		else
+		{
+			unsigned char	shift;
+
+			if (ptr >= end || sizeof(value) < (shift = *ptr++))
+				return FAIL;
+
+			if (sizeof(value) != shift)
+			{
+				if (SUCCEED != col_decode_varint(&ptr, end, &value))
+					return FAIL;
+
+				prev ^= value << (shift * 8);
+			}
+
+			memcpy(&values[i].value.dbl, &prev, sizeof(prev));
+		}
+	}
+
+	return ptr == end ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_lock                                                         *
+ *                                                                            *
+ * Purpose: locks whole file for reading or writing                           *
+ *                                                                            *
+ * Parameters: fd   - [IN] the file descriptor                                *
+ *             type - [IN] the lock type - F_RDLCK or F_WRLCK                 *
+ *                                                                            *
+ * Return value: SUCCEED - the file was locked                                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The lock is released when the file is closed.                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_lock(int fd, short type)
+{
+	struct flock	lock;
+
+	memset(&lock, 0, sizeof(lock));
+	lock.l_type = type;
+	lock.l_whence = SEEK_SET;
+
+	while (-1 == fcntl(fd, F_SETLKW, &lock))
+	{
+		if (EINTR != errno)
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_check_block                                                  *
+ *                                                                            *
+ * Purpose: validates block header                                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_check_block(const zbx_col_block_t *block)
+{
+	if (ZBX_COL_BLOCK_MAGIC != block->magic || 0 >= block->num || ZBX_COL_BLOCK_VALUES_MAX < block->num ||
+			(size_t)block->num * ZBX_COL_VALUE_SIZE_MAX < block->size)
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_read_block                                                   *
+ *                                                                            *
+ * Purpose: reads and validates block header at the specified offset          *
+ *                                                                            *
+ * Parameters: fd     - [IN] the file descriptor                              *
+ *             offset - [IN] the block offset                                 *
+ *             size   - [IN] the file size                                    *
+ *             block  - [OUT] the block header                                *
+ *                                                                            *
+ * Return value: SUCCEED - a valid block header was read                      *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_read_block(int fd, off_t offset, off_t size, zbx_col_block_t *block)
+{
+	if (offset + (off_t)(sizeof(zbx_col_block_t) + sizeof(zbx_uint32_t)) > size)
+		return FAIL;
+
+	if (sizeof(zbx_col_block_t) != pread(fd, block, sizeof(zbx_col_block_t), offset))
+		return FAIL;
+
+	if (SUCCEED != col_check_block(block) || offset != (off_t)block->offset)
+		return FAIL;
+
+	if (offset + (off_t)(sizeof(zbx_col_block_t) + block->size + sizeof(zbx_uint32_t)) > size)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_read_last_block                                              *
+ *                                                                            *
+ * Purpose: reads the block ending at the specified offset                    *
+ *                                                                            *
+ * Parameters: fd     - [IN] the file descriptor                              *
+ *             end    - [IN] the offset of the block end                      *
+ *             buf    - [OUT] the buffer of ZBX_COL_BLOCK_SIZE_MAX bytes      *
+ *             offset - [OUT] the block offset                                *
+ *             block  - [OUT] the block header                                *
+ *             data   - [OUT] the block (header, values and trailer) in buf   *
+ *                                                                            *
+ * Return value: SUCCEED - a valid block was read                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The block is read with a single pread() call. The offset field   *
+ *           of the returned block is less than the block offset if it is a   *
+ *           staged copy of merged last block.                                *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_read_last_block(int fd, off_t end, unsigned char *buf, off_t *offset, zbx_col_block_t *block,
+		unsigned char **data)
+{
+	zbx_uint32_t	length;
+	size_t		size;
+
+	size = (size_t)MIN(end, (off_t)ZBX_COL_BLOCK_SIZE_MAX);
+
+	if ((ssize_t)size != pread(fd, buf, size, end - (off_t)size))
+		return FAIL;
+
+	memcpy(&length, buf + size - sizeof(length), sizeof(length));
+
+	if (sizeof(zbx_col_block_t) > length || length > size - sizeof(length))
+		return FAIL;
+
+	*data = buf + size - sizeof(length) - length;
+	memcpy(block, *data, sizeof(zbx_col_block_t));
+
+	if (SUCCEED != col_check_block(block) || sizeof(zbx_col_block_t) + block->size != length)
+		return FAIL;
+
+	*offset = end - (off_t)(sizeof(length) + length);
+
+	if ((off_t)block->offset > *offset)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_encode_block                                                 *
+ *                                                                            *
+ * Purpose: encodes values as a block to be written at the specified offset   *
+ *                                                                            *
+ * Parameters: buf           - [OUT] the buffer of ZBX_COL_BLOCK_SIZE_MAX     *
+ *                                   bytes                                    *
+ *             offset        - [IN] the block offset                          *
+ *             values        - [IN] the values to encode                      *
+ *             num           - [IN] the number of values                      *
+ *             value_type    - [IN] the value type                            *
+ *             clock_max_all - [IN/OUT] the largest value timestamp of the    *
+ *                                      preceding blocks, updated with the    *
+ *                                      block values                          *
+ *                                                                            *
+ * Return value: the block size with header and trailer                       *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	col_encode_block(unsigned char *buf, off_t offset, const zbx_history_record_t *values, int num,
+		unsigned char value_type, int *clock_max_all)
+{
+	zbx_col_block_t	block;
+	zbx_uint32_t	length;
+	int		i;
+
+	block.magic = ZBX_COL_BLOCK_MAGIC;
+	block.num = num;
+	block.clock_min = values[0].timestamp.sec;
+	block.clock_max = values[0].timestamp.sec;
+
+	for (i = 1; i < num; i++)
+	{
+		if (values[i].timestamp.sec < block.clock_min)
+			block.clock_min = values[i].timestamp.sec;
+		else if (values[i].timestamp.sec > block.clock_max)
+			block.clock_max = values[i].timestamp.sec;
+	}
+
+	if (block.clock_max > *clock_max_all)
+		*clock_max_all = block.clock_max;
+
+	block.clock_max_all = *clock_max_all;
+	block.offset = (zbx_uint32_t)offset;
+	block.size = col_encode_values(values, num, value_type, buf + sizeof(zbx_col_block_t));
+	memcpy(buf, &block, sizeof(block));
+
+	length = sizeof(zbx_col_block_t) + block.size;
+	memcpy(buf + length, &length, sizeof(length));
+
+	return length + sizeof(length);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_recover                                                      *
+ *                                                                            *
+ * Purpose: finds the end of the last valid block in a damaged file           *
+ *                                                                            *
+ * Parameters: fd            - [IN] the file descriptor                       *
+ *             size          - [IN] the file size                             *
+ *             clock_max_all - [OUT] the largest value timestamp of the valid *
+ *                                   blocks (optional)                        *
+ *                                                                            *
+ * Return value: the end offset of the last valid block                       *
+ *                                                                            *
+ ******************************************************************************/
+static off_t	col_recover(int fd, off_t size, int *clock_max_all)
+{
+	off_t		offset = 0;
+	zbx_col_block_t	block;
+
+	if (NULL != clock_max_all)
+		*clock_max_all = 0;
+
+	while (SUCCEED == col_read_block(fd, offset, size, &block))
+	{
+		offset += sizeof(zbx_col_block_t) + block.size + sizeof(zbx_uint32_t);
+
+		if (NULL != clock_max_all)
+			*clock_max_all = block.clock_max_all;
+	}
+
+	return offset;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_remove_partition                                             *
+ *                                                                            *
+ * Purpose: removes partition directory with all its files                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	col_remove_partition(const char *path)
+{
+	DIR		*dir;
+	struct dirent	*d;
+	char		*file = NULL;
+
+	if (NULL == (dir = opendir(path)))
+		return;
+
+	while (NULL != (d = readdir(dir)))
+	{
+		if ('.' == *d->d_name)
+			continue;
+
+		file = zbx_dsprintf(file, "%s/%s", path, d->d_name);
+
+		if (0 != unlink(file))
+			zabbix_log(LOG_LEVEL_WARNING, "cannot remove \"%s\": %s", file, zbx_strerror(errno));
+	}
+
+	closedir(dir);
+	zbx_free(file);
+
+	if (0 != rmdir(path))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot remove \"%s\": %s", path, zbx_strerror(errno));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_read_expires                                                 *
+ *                                                                            *
+ * Purpose: reads partition expiry time                                       *
+ *                                                                            *
+ * Return value: the partition expiry time or 0 if it is not known            *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_read_expires(int fd)
+{
+	char	buf[MAX_ID_LEN + 1];
+	ssize_t	n;
+
+	if (0 >= (n = pread(fd, buf, sizeof(buf) - 1, 0)))
+		return 0;
+
+	buf[n] = '\0';
+
+	return atoi(buf);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_get_partitions                                               *
+ *                                                                            *
+ * Purpose: gets sorted list of the existing partitions                       *
+ *                                                                            *
+ * Comments: The list is cached and read again only when the value type       *
+ *           directory is modified, which happens when partitions are created *
+ *           or removed.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_vector_uint64_t	*col_get_partitions(zbx_col_data_t *data)
+{
+	DIR		*dir;
+	struct dirent	*d;
+	struct stat	st;
+	zbx_uint64_t	partition;
+
+	if (0 != data->partitions_time && 0 == stat(data->path, &st) && st.st_mtime < data->partitions_time)
+		return &data->partitions;
+
+	zbx_vector_uint64_clear(&data->partitions);
+	data->partitions_time = (int)time(NULL);
+
+	if (NULL == (dir = opendir(data->path)))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot open directory \"%s\": %s", data->path, zbx_strerror(errno));
+		data->partitions_time = 0;
+		return &data->partitions;
+	}
+
+	while (NULL != (d = readdir(dir)))
+	{
+		if (SUCCEED == is_uint64(d->d_name, &partition))
+			zbx_vector_uint64_append(&data->partitions, partition);
+	}
+
+	closedir(dir);
+
+	zbx_vector_uint64_sort(&data->partitions, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	return &data->partitions;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_remove_expired_partitions                                    *
+ *                                                                            *
+ * Purpose: removes partitions with all values past their storage period      *
+ *                                                                            *
+ ******************************************************************************/
+static void	col_remove_expired_partitions(zbx_col_data_t *data, int now)
+{
+	const char			*__function_name = "col_remove_expired_partitions";
+
+	const zbx_vector_uint64_t	*partitions;
+	char				*path = NULL;
+	int				i, fd, expires, removed = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() path:%s", __function_name, data->path);
+
+	data->partitions_time = 0;
+	partitions = col_get_partitions(data);
+
+	for (i = 0; i < partitions->values_num; i++)
+	{
+		path = zbx_dsprintf(path, "%s/" ZBX_FS_UI64 "/" ZBX_COL_EXPIRES_FILE, data->path,
+				partitions->values[i]);
+
+		if (-1 == (fd = open(path, O_RDONLY)))
+			continue;
+
+		expires = col_read_expires(fd);
+		close(fd);
+
+		if (0 == expires || expires >= now)
+			continue;
+
+		path = zbx_dsprintf(path, "%s/" ZBX_FS_UI64, data->path, partitions->values[i]);
+		col_remove_partition(path);
+		removed++;
+	}
+
+	zbx_free(path);
+
+	if (0 != removed)
+		data->partitions_time = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() removed:%d", __function_name, removed);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_update_expires                                               *
+ *                                                                            *
+ * Purpose: updates partition expiry time if the new values expire later      *
+ *                                                                            *
+ ******************************************************************************/
+static void	col_update_expires(zbx_col_data_t *data, int partition, int expires)
+{
+	char	*path, buf[MAX_ID_LEN + 1];
+	int	fd, len;
+
+	if (partition == data->expires_partition && expires <= data->expires)
+		return;
+
+	path = zbx_dsprintf(NULL, "%s/%d/" ZBX_COL_EXPIRES_FILE, data->path, partition);
+
+	if (-1 == (fd = open(path, O_RDWR | O_CREAT, 0640)))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot open \"%s\": %s", path, zbx_strerror(errno));
+		goto out;
+	}
+
+	if (SUCCEED == col_lock(fd, F_WRLCK))
+	{
+		int	expires_old;
+
+		if (expires > (expires_old = col_read_expires(fd)))
+		{
+			len = zbx_snprintf(buf, sizeof(buf), "%d", expires);
+
+			if (len != pwrite(fd, buf, len, 0) || 0 != ftruncate(fd, len))
+				zabbix_log(LOG_LEVEL_ERR, "cannot write \"%s\": %s", path, zbx_strerror(errno));
+		}
+		else
+			expires = expires_old;
+
+		data->expires_partition = partition;
+		data->expires = expires;
+	}
+
+	close(fd);
+out:
+	zbx_free(path);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_open                                                         *
+ *                                                                            *
+ * Purpose: opens item history file for writing, creating the partition if    *
+ *          necessary                                                         *
+ *                                                                            *
+ * Comments: The process creating the partition of the current day removes    *
+ *           the expired partitions.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_open(zbx_col_data_t *data, int partition, zbx_uint64_t itemid)
+{
+	char	*path;
+	int	fd, now;
+
+	path = zbx_dsprintf(NULL, "%s/%d/" ZBX_FS_UI64, data->path, partition, itemid);
+
+	if (-1 == (fd = open(path, O_RDWR | O_CREAT, 0640)) && ENOENT == errno)
+	{
+		path = zbx_dsprintf(path, "%s/%d", data->path, partition);
+
+		if (0 == mkdir(path, 0750))
+		{
+			now = (int)time(NULL);
+
+			if (partition >= now - now % ZBX_COL_PARTITION_PERIOD)
+				col_remove_expired_partitions(data, now);
+		}
+		else if (EEXIST != errno)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot create directory \"%s\": %s", path, zbx_strerror(errno));
+			goto out;
+		}
+
+		path = zbx_dsprintf(path, "%s/%d/" ZBX_FS_UI64, data->path, partition, itemid);
+		fd = open(path, O_RDWR | O_CREAT, 0640);
+	}
+
+	if (-1 == fd)
+		zabbix_log(LOG_LEVEL_ERR, "cannot open \"%s\": %s", path, zbx_strerror(errno));
+out:
+	zbx_free(path);
+
+	return fd;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_append                                                       *
+ *                                                                            *
+ * Purpose: appends item values to the history file of a partition            *
+ *                                                                            *
+ * Parameters: data       - [IN] the columnar storage data                    *
+ *             value_type - [IN] the value type                               *
+ *             itemid     - [IN] the item identifier                          *
+ *             partition  - [IN] the partition of the values                  *
+ *             history    - [IN] the values to append                         *
+ *             num        - [IN] the number of values                         *
+ *                                                                            *
+ * Return value: SUCCEED - the values were appended                           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The values are merged into the last block if it is not full,     *
+ *           the rest are written as new blocks. The merged block is staged   *
+ *           after the end of the file before it replaces the last block, so  *
+ *           an interrupted write cannot damage the already written values.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_append(zbx_col_data_t *data, unsigned char value_type, zbx_uint64_t itemid, int partition,
+		ZBX_DC_HISTORY **history, int num)
+{
+	int			fd, i, expires = 0, tail_num = 0, clock_max_all = 0, tail_ret = FAIL, ret = FAIL;
+	struct stat		st;
+	off_t			size, offset;
+	size_t			length;
+	zbx_col_block_t		block;
+	zbx_history_record_t	*values;
+	unsigned char		*buf, *tail;
+
+	if (-1 == (fd = col_open(data, partition, itemid)))
+		return FAIL;
+
+	values = (zbx_history_record_t *)zbx_malloc(NULL, (ZBX_COL_BLOCK_VALUES_MAX + num) * sizeof(*values));
+	buf = (unsigned char *)zbx_malloc(NULL, ZBX_COL_BLOCK_SIZE_MAX);
+
+	if (SUCCEED != col_lock(fd, F_WRLCK) || 0 != fstat(fd, &st))
+		goto out;
+
+	offset = size = st.st_size;
+
+	if (0 != size && SUCCEED != (tail_ret = col_read_last_block(fd, size, buf, &offset, &block, &tail)))
+	{
+		size = col_recover(fd, st.st_size, &clock_max_all);
+
+		zabbix_log(LOG_LEVEL_WARNING, "damaged history file of item \"" ZBX_FS_UI64 "\" in partition"
+				" %d, truncating it from " ZBX_FS_UI64 " to " ZBX_FS_UI64 " bytes", itemid,
+				partition, (zbx_uint64_t)st.st_size, (zbx_uint64_t)size);
+
+		if (0 != ftruncate(fd, size))
+			goto out;
+
+		offset = size;
+
+		if (0 != size)
+			tail_ret = col_read_last_block(fd, size, buf, &offset, &block, &tail);
+	}
+
+	if (SUCCEED == tail_ret)
+	{
+		length = sizeof(zbx_col_block_t) + block.size + sizeof(zbx_uint32_t);
+
+		/* complete the merged last block copy interrupted by the previous writer */
+		if ((off_t)block.offset != offset)
+		{
+			offset = block.offset;
+
+			if ((ssize_t)length != pwrite(fd, tail, length, offset) || 0 != ftruncate(fd, offset + length))
+				goto out;
+
+			size = offset + length;
+		}
+
+		clock_max_all = block.clock_max_all;
+
+		if (ZBX_COL_BLOCK_VALUES_MAX > block.num && SUCCEED == col_decode_values(tail +
+				sizeof(zbx_col_block_t), block.size, block.num, value_type, values))
+		{
+			tail_num = block.num;
+		}
+		else
+			offset = size;
+	}
+
+	for (i = 0; i < num; i++)
+	{
+		values[tail_num + i].timestamp = history[i]->ts;
+		values[tail_num + i].value = history[i]->value;
+
+		if (history[i]->ts.sec + history[i]->ttl > expires)
+			expires = history[i]->ts.sec + history[i]->ttl;
+	}
+
+	num += tail_num;
+
+	for (i = 0; i < num; i += ZBX_COL_BLOCK_VALUES_MAX)
+	{
+		length = col_encode_block(buf, offset, values + i, MIN(ZBX_COL_BLOCK_VALUES_MAX, num - i), value_type,
+				&clock_max_all);
+
+		if (0 == i && 0 != tail_num)
+		{
+			/* stage the merged block where it overlaps neither the last block nor its new place */
+			if ((ssize_t)length != pwrite(fd, buf, length, MAX(size, offset + (off_t)length)) ||
+					(ssize_t)length != pwrite(fd, buf, length, offset) ||
+					0 != ftruncate(fd, offset + (off_t)length))
+			{
+				goto out;
+			}
+		}
+		else if ((ssize_t)length != pwrite(fd, buf, length, offset))
+			goto out;
+
+		offset += length;
+	}
+
+	ret = SUCCEED;
+out:
+	if (SUCCEED != ret)
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot write history of item \"" ZBX_FS_UI64 "\" in partition %d: %s",
+				itemid, partition, zbx_strerror(errno));
+	}
+
+	close(fd);
+
+	zbx_free(buf);
+	zbx_free(values);
+
+	if (SUCCEED == ret)
+		col_update_expires(data, partition, expires);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: col_read                                                         *
+ *                                                                            *
+ * Purpose: reads item values in ]start,end] period from the history file of  *
+ *          a partition                                                       *
+ *                                                                            *
+ * Parameters: data       - [IN] the columnar storage data                    *
+ *             value_type - [IN] the value type                               *
+ *             itemid     - [IN] the item identifier                          *
+ *             partition  - [IN] the partition to read                        *
+ *             start      - [IN] the period start timestamp                   *
+ *             count      - [IN] the number of newest values to read, 0 to    *
+ *                               read all values of the period                *
+ *             end        - [IN] the period end timestamp                     *
+ *             values     - [OUT] the values                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the values were read                               *
+ *               FAIL    - the file could not be read                         *
+ *                                                                            *
+ * Comments: Blocks are read starting with the newest. Blocks outside the     *
+ *           period are skipped without decoding their values. When count     *
+ *           values are read, the blocks older than the second of the oldest  *
+ *           of them are skipped and reading stops when no remaining block    *
+ *           can have newer values.                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	col_read(const zbx_col_data_t *data, unsigned char value_type, zbx_uint64_t itemid,
+		zbx_uint64_t partition, int start, int count, int end, zbx_vector_history_record_t *values)
+{
+	char			*path;
+	int			fd, i, pos, clock = 0, ret = FAIL;
+	struct stat		st;
+	off_t			tail, offset;
+	zbx_col_block_t		block;
+	zbx_history_record_t	*block_values = NULL;
+	unsigned char		*buf = NULL, *ptr;
+
+	path = zbx_dsprintf(NULL, "%s/" ZBX_FS_UI64 "/" ZBX_FS_UI64, data->path, partition, itemid);
+
+	if (-1 == (fd = open(path, O_RDONLY)))
+	{
+		if (ENOENT == errno)
+			ret = SUCCEED;
+		else
+			zabbix_log(LOG_LEVEL_ERR, "cannot open \"%s\": %s", path, zbx_strerror(errno));
+
+		goto out;
+	}
+
+	if (SUCCEED != col_lock(fd, F_RDLCK) || 0 != fstat(fd, &st))
+	{
+		zabbix_log(LOG_LEVEL_ERR, "cannot read \"%s\": %s", path, zbx_strerror(errno));
+		goto close;
+	}
+
+	buf = (unsigned char *)zbx_malloc(NULL, ZBX_COL_BLOCK_SIZE_MAX);
+	block_values = (zbx_history_record_t *)zbx_malloc(NULL, ZBX_COL_BLOCK_VALUES_MAX * sizeof(zbx_history_record_t));
+	pos = values->values_num;
+
+	for (tail = st.st_size; 0 < tail; tail = offset)
+	{
+		if (SUCCEED != col_read_last_block(fd, tail, buf, &offset, &block, &ptr))
+		{
+			/* continue with the valid blocks before the tail left by an interrupted write */
+			if (tail == st.st_size && tail > (offset = col_recover(fd, st.st_size, NULL)))
+				continue;
+
+			zabbix_log(LOG_LEVEL_WARNING, "damaged history file \"%s\" at offset " ZBX_FS_UI64, path,
+					(zbx_uint64_t)tail);
+			break;
+		}
+
+		/* staged copy of merged last block replaces the blocks starting at its offset field */
+		if ((off_t)block.offset != offset)
+		{
+			if (tail != st.st_size)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "damaged history file \"%s\" at offset " ZBX_FS_UI64,
+						path, (zbx_uint64_t)offset);
+				break;
+			}
+
+			offset = block.offset;
+		}
+
+		if (block.clock_max_all <= start || block.clock_max_all < clock)
+			break;
+
+		if (block.clock_max <= start || block.clock_min > end || block.clock_max < clock)
+			continue;
+
+		if (SUCCEED != col_decode_values(ptr + sizeof(zbx_col_block_t), block.size, block.num, value_type,
+				block_values))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "damaged history file \"%s\" at offset " ZBX_FS_UI64, path,
+					(zbx_uint64_t)offset);
+			break;
+		}
+
+		for (i = 0; i < block.num; i++)
+		{
+			if (block_values[i].timestamp.sec > start && block_values[i].timestamp.sec <= end)
+				zbx_vector_history_record_append_ptr(values, &block_values[i]);
+		}
+
+		if (0 < count && count <= values->values_num - pos)
+		{
+			qsort(values->values + pos, values->values_num - pos, sizeof(zbx_history_record_t),
+					(zbx_compare_func_t)zbx_history_record_compare_desc_func);
+			clock = values->values[pos + count - 1].timestamp.sec;
+		}
+	}
+
+	ret = SUCCEED;
+close:
+	close(fd);
+out:
+	zbx_free(block_values);
+	zbx_free(buf);
+	zbx_free(path);
+
+	return ret;
+}
+
+static int	col_history_compare_func(const void *d1, const void *d2)
+{
+	const ZBX_DC_HISTORY	*h1 = *(const ZBX_DC_HISTORY **)d1;
+	const ZBX_DC_HISTORY	*h2 = *(const ZBX_DC_HISTORY **)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(h1->itemid, h2->itemid);
+	ZBX_RETURN_IF_NOT_EQUAL(h1->ts.sec, h2->ts.sec);
+	ZBX_RETURN_IF_NOT_EQUAL(h1->ts.ns, h2->ts.ns);
+
+	return 0;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * history interface support                                                                                      *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: columnar_destroy                                                       *
+ *                                                                                  *
+ * Purpose: destroys history storage interface                                      *
+ *                                                                                  *
+ * Parameters:  hist - [IN] the history storage interface                           *
+ *                                                                                  *
+ ************************************************************************************/
+static void	columnar_destroy(zbx_history_iface_t *hist)
+{
+	zbx_col_data_t	*data = (zbx_col_data_t *)hist->data;
+
+	zbx_vector_ptr_destroy(&data->history);
+	zbx_vector_uint64_destroy(&data->partitions);
+	zbx_free(data->path);
+	zbx_free(data);
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: columnar_get_values                                                    *
+ *                                                                                  *
+ * Purpose: gets item history data from history storage                             *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              itemid  - [IN] the itemid                                           *
+ *              start   - [IN] the period start timestamp                           *
+ *              count   - [IN] the number of values to read                         *
+ *              end     - [IN] the period end timestamp                             *
+ *              values  - [OUT] the item history data values                        *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function reads <count> values from ]<start>,<end>] interval or    *
+ *           all values from the specified interval if count is zero.               *
+ *           As with SQL storage, all values of the second of the oldest returned   *
+ *           value are returned when reading <count> values.                        *
+ *                                                                                  *
+ ************************************************************************************/
+static int	columnar_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int count, int end,
+		zbx_vector_history_record_t *values)
+{
+	zbx_col_data_t			*data = (zbx_col_data_t *)hist->data;
+	const zbx_vector_uint64_t	*partitions;
+	int				i, pos, sec, ret = SUCCEED;
+
+	partitions = col_get_partitions(data);
+
+	pos = values->values_num;
+
+	/* read partitions starting with the newest until the requested number of values is read */
+	for (i = partitions->values_num - 1; 0 <= i; i--)
+	{
+		if ((zbx_uint64_t)end < partitions->values[i])
+			continue;
+
+		if (partitions->values[i] + ZBX_COL_PARTITION_PERIOD <= (zbx_uint64_t)start)
+			break;
+
+		if (SUCCEED != (ret = col_read(data, hist->value_type, itemid, partitions->values[i], start,
+				0 < count ? count - (values->values_num - pos) : 0, end, values)))
+		{
+			break;
+		}
+
+		if (0 < count && count <= values->values_num - pos)
+			break;
+	}
+
+	qsort(values->values + pos, values->values_num - pos, sizeof(zbx_history_record_t),
+			(zbx_compare_func_t)zbx_history_record_compare_desc_func);
+
+	if (0 < count && count < values->values_num - pos)
+	{
+		sec = values->values[pos + count - 1].timestamp.sec;
+
+		for (i = pos + count; i < values->values_num && values->values[i].timestamp.sec == sec; i++)
+			;
+
+		values->values_num = i;
+	}
+
+	return ret;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: columnar_add_values                                                    *
+ *                                                                                  *
+ * Purpose: sends history data to the storage                                       *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *              history - [IN] the history data vector (may have mixed value types) *
+ *                                                                                  *
+ ************************************************************************************/
+static int	columnar_add_values(zbx_history_iface_t *hist, const zbx_vector_ptr_t *history)
+{
+	zbx_col_data_t	*data = (zbx_col_data_t *)hist->data;
+	int		i;
+
+	for (i = 0; i < history->values_num; i++)
+	{
+		ZBX_DC_HISTORY	*h = (ZBX_DC_HISTORY *)history->values[i];
+
+		if (h->value_type == hist->value_type)
+			zbx_vector_ptr_append(&data->history, h);
+	}
+
+	return data->history.values_num;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: columnar_flush                                                         *
+ *                                                                                  *
+ * Purpose: flushes the history data to storage                                     *
+ *                                                                                  *
+ * Parameters:  hist    - [IN] the history storage interface                        *
+ *                                                                                  *
+ * Comments: The values are written to the item files grouped by item and           *
+ *           partition.                                                             *
+ *                                                                                  *
+ ************************************************************************************/
+static int	columnar_flush(zbx_history_iface_t *hist)
+{
+	const char	*__function_name = "columnar_flush";
+
+	zbx_col_data_t	*data = (zbx_col_data_t *)hist->data;
+	ZBX_DC_HISTORY	**history;
+	int		i, j, partition, ret = SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() values:%d", __function_name, data->history.values_num);
+
+	zbx_vector_ptr_sort(&data->history, col_history_compare_func);
+	history = (ZBX_DC_HISTORY **)data->history.values;
+
+	for (i = 0; i < data->history.values_num; i = j)
+	{
+		partition = history[i]->ts.sec - history[i]->ts.sec % ZBX_COL_PARTITION_PERIOD;
+
+		for (j = i + 1; j < data->history.values_num && history[j]->itemid == history[i]->itemid &&
+				history[j]->ts.sec < partition + ZBX_COL_PARTITION_PERIOD; j++)
+			;
+
+		if (SUCCEED != col_append(data, hist->value_type, history[i]->itemid, partition, history + i, j - i))
+			ret = FAIL;
+	}
+
+	zbx_vector_ptr_clear(&data->history);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+/************************************************************************************
+ *                                                                                  *
+ * Function: zbx_history_columnar_init                                              *
+ *                                                                                  *
+ * Purpose: initializes history storage interface                                   *
+ *                                                                                  *
+ * Parameters:  hist       - [IN] the history storage interface                     *
+ *              value_type - [IN] the target value type                             *
+ *              error      - [OUT] the error message                                *
+ *                                                                                  *
+ * Return value: SUCCEED - the history storage interface was initialized            *
+ *               FAIL    - otherwise                                                *
+ *                                                                                  *
+ ************************************************************************************/
+int	zbx_history_columnar_init(zbx_history_iface_t *hist, unsigned char value_type, char **error)
+{
+	zbx_col_data_t	*data;
+	char		*path;
+
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			path = zbx_dsprintf(NULL, "%s/dbl", CONFIG_HISTORY_STORAGE_DIR);
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			path = zbx_dsprintf(NULL, "%s/uint", CONFIG_HISTORY_STORAGE_DIR);
+			break;
+		default:
+			*error = zbx_strdup(*error, "columnar history storage supports only numeric values");
+			return FAIL;
+	}
+
+	if (0 != mkdir(path, 0750) && EEXIST != errno)
+	{
+		*error = zbx_dsprintf(*error, "cannot create directory \"%s\": %s", path, zbx_strerror(errno));
+		zbx_free(path);
+		return FAIL;
+	}
+
+	data = (zbx_col_data_t *)zbx_malloc(NULL, sizeof(zbx_col_data_t));
+	memset(data, 0, sizeof(zbx_col_data_t));
+	data->path = path;
+	zbx_vector_ptr_create(&data->history);
+	zbx_vector_uint64_create(&data->partitions);
+
+	hist->value_type = value_type;
+	hist->data = data;
+	hist->destroy = columnar_destroy;
+	hist->add_values = columnar_add_values;
+	hist->flush = columnar_flush;
+	hist->get_values = columnar_get_values;
+	hist->requires_trends = 1;
+
+	return SUCCEED;
+}
@@ -34,6 +34,9 @@
 #define		ZBX_IDX_JSON_ALLOCATE		256
 #define		ZBX_JSON_ALLOCATE		2048
 
+/* the maximum number of hits returned in one response, the default index.max_result_window value */
+#define		ZBX_ELASTIC_PAGE_SIZE		10000
+
 
 const char	*value_type_str[] = {"dbl", "str", "log", "uint", "text"};
 
@@ -641,6 +644,8 @@ static void	elastic_destroy(zbx_history_iface_t *hist)
  *                                                                                  *
  * Comments: This function reads <count> values from ]<start>,<end>] interval or    *
  *           all values from the specified interval if count is zero.               *
+ *           Requests not fitting into one page of ZBX_ELASTIC_PAGE_SIZE hits are   *
+ *           read with a scroll query, others with a single search request.         *
  *                                                                                  *
  ************************************************************************************/
 static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, int start, int count, int end,
@@ -650,7 +655,7 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 
 	zbx_elastic_data_t	*data = (zbx_elastic_data_t *)hist->data;
 	size_t			url_alloc = 0, url_offset = 0, id_alloc = 0, scroll_alloc = 0, scroll_offset = 0;
-	int			total, empty, ret;
+	int			total, empty, ret, scroll;
 	CURLcode		err;
 	struct zbx_json		query;
 	struct curl_slist	*curl_headers = NULL;
@@ -668,34 +673,60 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 		return FAIL;
 	}
 
-	zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/%s*/values/_search?scroll=10s", data->base_url,
-			value_type_str[hist->value_type]);
+	/* a scroll context is needed only if the requested values do not fit into a single page */
+	scroll = (0 == count || ZBX_ELASTIC_PAGE_SIZE < count);
+
+	zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/%s*/values/_search?%s"
+			"filter_path=_scroll_id,hits.hits._source", data->base_url, value_type_str[hist->value_type],
+			0 != scroll ? "scroll=10s&" : "");
 
 	/* prepare the json query for elasticsearch, apply ranges if needed */
 	zbx_json_init(&query, ZBX_JSON_ALLOCATE);
 
+	zbx_json_adduint64(&query, "size", 0 == count ? ZBX_ELASTIC_PAGE_SIZE : MIN(count, ZBX_ELASTIC_PAGE_SIZE));
+	zbx_json_addarray(&query, "sort");
+
 	if (0 < count)
 	{
-		zbx_json_adduint64(&query, "size", count);
-		zbx_json_addarray(&query, "sort");
 		zbx_json_addobject(&query, NULL);
 		zbx_json_addobject(&query, "clock");
 		zbx_json_addstring(&query, "order", "desc", ZBX_JSON_TYPE_STRING);
 		zbx_json_close(&query);
 		zbx_json_close(&query);
-		zbx_json_close(&query);
 	}
+	else
+	{
+		/* the values are sorted after reading, so scroll in the cheapest (index) order */
+		zbx_json_addstring(&query, NULL, "_doc", ZBX_JSON_TYPE_STRING);
+	}
+
+	zbx_json_close(&query);
 
+	/* request only the fields parsed by history_parse_value() */
+	zbx_json_addarray(&query, "_source");
+	zbx_json_addstring(&query, NULL, "clock", ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(&query, NULL, "ns", ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(&query, NULL, "value", ZBX_JSON_TYPE_STRING);
+
+	if (ITEM_VALUE_TYPE_LOG == hist->value_type)
+	{
+		zbx_json_addstring(&query, NULL, "timestamp", ZBX_JSON_TYPE_STRING);
+		zbx_json_addstring(&query, NULL, "logeventid", ZBX_JSON_TYPE_STRING);
+		zbx_json_addstring(&query, NULL, "severity", ZBX_JSON_TYPE_STRING);
+		zbx_json_addstring(&query, NULL, "source", ZBX_JSON_TYPE_STRING);
+	}
+
+	zbx_json_close(&query);
+
+	/* both conditions are filters, so no relevance scores are calculated and the results can be cached */
 	zbx_json_addobject(&query, "query");
 	zbx_json_addobject(&query, "bool");
-	zbx_json_addarray(&query, "must");
+	zbx_json_addarray(&query, "filter");
 	zbx_json_addobject(&query, NULL);
-	zbx_json_addobject(&query, "match");
+	zbx_json_addobject(&query, "term");
 	zbx_json_adduint64(&query, "itemid", itemid);
 	zbx_json_close(&query);
 	zbx_json_close(&query);
-	zbx_json_close(&query);
-	zbx_json_addarray(&query, "filter");
 	zbx_json_addobject(&query, NULL);
 	zbx_json_addobject(&query, "range");
 	zbx_json_addobject(&query, "clock");
@@ -712,7 +743,6 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 	zbx_json_close(&query);
 	zbx_json_close(&query);
 	zbx_json_close(&query);
-	zbx_json_close(&query);
 
 	curl_headers = curl_slist_append(curl_headers, "Content-Type: application/json");
 
@@ -739,14 +769,18 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 		goto out;
 	}
 
-	url_offset = 0;
-	zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset, "%s/_search/scroll", data->base_url);
-
-	if (CURLE_OK != (err = curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url)))
+	if (0 != scroll)
 	{
-		zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)CURLOPT_URL,
-				curl_easy_strerror(err));
-		goto out;
+		url_offset = 0;
+		zbx_snprintf_alloc(&data->post_url, &url_alloc, &url_offset,
+				"%s/_search/scroll?filter_path=_scroll_id,hits.hits._source", data->base_url);
+
+		if (CURLE_OK != (err = curl_easy_setopt(data->handle, CURLOPT_URL, data->post_url)))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot set cURL option %d: [%s]", (int)CURLOPT_URL,
+					curl_easy_strerror(err));
+			goto out;
+		}
 	}
 
 	total = (0 == count ? -1 : count);
@@ -762,47 +796,59 @@ static int	elastic_get_values(zbx_history_iface_t *hist, zbx_uint64_t itemid, in
 
 		empty = 1;
 
-		zabbix_log(LOG_LEVEL_DEBUG, "received from elasticsearch: %s", page_r.data);
+		zabbix_log(LOG_LEVEL_DEBUG, "received from elasticsearch: %s", ZBX_NULL2EMPTY_STR(page_r.data));
 
-		zbx_json_open(page_r.data, &jp);
-		zbx_json_brackets_open(jp.start, &jp_values);
+		if (0 == page_r.offset)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "received empty response from elasticsearch");
+			break;
+		}
+
+		if (SUCCEED != zbx_json_open(page_r.data, &jp) || SUCCEED != zbx_json_brackets_open(jp.start, &jp_values))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot parse elasticsearch response: %s", zbx_json_strerror());
+			break;
+		}
 
 		/* get the scroll id immediately, for being used in subsequent queries */
-		if (SUCCEED != zbx_json_value_by_name_dyn(&jp_values, "_scroll_id", &scroll_id, &id_alloc, NULL))
+		if (0 != scroll && SUCCEED != zbx_json_value_by_name_dyn(&jp_values, "_scroll_id", &scroll_id,
+				&id_alloc, NULL))
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "elasticsearch version is not compatible with zabbix server. "
 					"_scroll_id tag is absent");
 		}
 
-		zbx_json_brackets_by_name(&jp_values, "hits", &jp_sub);
-		zbx_json_brackets_by_name(&jp_sub, "hits", &jp_hits);
-
-		while (NULL != (p = zbx_json_next(&jp_hits, p)))
+		/* the hits are omitted from the filtered response if nothing matched */
+		if (SUCCEED == zbx_json_brackets_by_name(&jp_values, "hits", &jp_sub) &&
+				SUCCEED == zbx_json_brackets_by_name(&jp_sub, "hits", &jp_hits))
 		{
-			empty = 0;
+			while (NULL != (p = zbx_json_next(&jp_hits, p)))
+			{
+				empty = 0;
 
-			if (SUCCEED != zbx_json_brackets_open(p, &jp_item))
-				continue;
+				if (SUCCEED != zbx_json_brackets_open(p, &jp_item))
+					continue;
 
-			if (SUCCEED != zbx_json_brackets_by_name(&jp_item, "_source", &jp_source))
-				continue;
+				if (SUCCEED != zbx_json_brackets_by_name(&jp_item, "_source", &jp_source))
+					continue;
 
-			if (SUCCEED != history_parse_value(&jp_source, hist->value_type, &hr))
-				continue;
+				if (SUCCEED != history_parse_value(&jp_source, hist->value_type, &hr))
+					continue;
 
-			zbx_vector_history_record_append_ptr(values, &hr);
+				zbx_vector_history_record_append_ptr(values, &hr);
 
-			if (-1 != total)
-				--total;
+				if (-1 != total)
+					--total;
 
-			if (0 == total)
-			{
-				empty = 1;
-				break;
+				if (0 == total)
+				{
+					empty = 1;
+					break;
+				}
 			}
 		}
 
-		if (1 == empty)
+		if (1 == empty || 0 == scroll)
 		{
 			ret = SUCCEED;
 			break;
@@ -355,34 +355,41 @@ static void	add_history_log(zbx_vector_ptr_t *history)
 static int	db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
 		int seconds, int end_timestamp)
 {
-	char			*sql = NULL;
+	char			*sql = NULL, itemid_str[MAX_ID_LEN + 1], clock_from[MAX_ID_LEN + 1],
+				clock_to[MAX_ID_LEN + 1];
+	const char		*params[] = {itemid_str, clock_from, clock_to};
 	size_t	 		sql_alloc = 0, sql_offset = 0;
 	DB_RESULT		result;
 	DB_ROW			row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
 
+	zbx_snprintf(itemid_str, sizeof(itemid_str), ZBX_FS_UI64, itemid);
+	zbx_snprintf(clock_from, sizeof(clock_from), "%d", end_timestamp - seconds);
+	zbx_snprintf(clock_to, sizeof(clock_to), "%d", end_timestamp);
+
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select clock,ns,%s"
 			" from %s"
-			" where itemid=" ZBX_FS_UI64,
-			table->fields, table->name, itemid);
+			" where itemid=?",
+			table->fields, table->name);
 
 	if (ZBX_JAN_2038 == end_timestamp)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d", end_timestamp - seconds);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>?");
+		result = DBselect_prepared(sql, params, 2);
 	}
 	else if (1 == seconds)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock=?");
+		params[1] = clock_to;
+		result = DBselect_prepared(sql, params, 2);
 	}
 	else
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d and clock<=%d",
-				end_timestamp - seconds, end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>? and clock<=?");
+		result = DBselect_prepared(sql, params, 3);
 	}
 
-	result = DBselect("%s", sql);
-
 	zbx_free(sql);
 
 	if (NULL == result)
@@ -431,15 +438,18 @@ out:
 static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
 		int count, int end_timestamp)
 {
-	char			*sql = NULL;
+	char			*sql = NULL, itemid_str[MAX_ID_LEN + 1], clock_to_str[MAX_ID_LEN + 1],
+				clock_from_str[MAX_ID_LEN + 1];
+	const char		*params[] = {itemid_str, clock_to_str, clock_from_str};
 	size_t	 		sql_alloc = 0, sql_offset;
-	int			clock_to, clock_from, step = 0, ret = FAIL;
+	int			clock_to, clock_from, step = 0, ret = FAIL, params_num;
 	DB_RESULT		result;
 	DB_ROW			row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
 	const int		periods[] = {SEC_PER_HOUR, SEC_PER_DAY, SEC_PER_WEEK, SEC_PER_MONTH, 0, -1};
 
 	clock_to = end_timestamp;
+	zbx_snprintf(itemid_str, sizeof(itemid_str), ZBX_FS_UI64, itemid);
 
 	while (-1 != periods[step] && 0 < count)
 	{
@@ -453,16 +463,23 @@ static int	db_read_values_by_count(zbx_uint64_t itemid, int value_type, zbx_vect
 		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 				"select clock,ns,%s"
 				" from %s"
-				" where itemid=" ZBX_FS_UI64
-					" and clock<=%d",
-				table->fields, table->name, itemid, clock_to);
+				" where itemid=?"
+					" and clock<=?",
+				table->fields, table->name);
+
+		zbx_snprintf(clock_to_str, sizeof(clock_to_str), "%d", clock_to);
+		params_num = 2;
 
 		if (clock_from != clock_to)
-			zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d", clock_from);
+		{
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>?");
+			zbx_snprintf(clock_from_str, sizeof(clock_from_str), "%d", clock_from);
+			params_num++;
+		}
 
 		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " order by clock desc");
 
-		result = DBselectN(sql, count);
+		result = DBselectN_prepared(sql, params, params_num, count);
 
 		if (NULL == result)
 			goto out;
@@ -535,30 +552,36 @@ static int	db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_type,
 		zbx_vector_history_record_t *values, int seconds, int count, int end_timestamp)
 {
 	int			ret = FAIL;
-	char			*sql = NULL;
-	size_t	 		sql_alloc = 0, sql_offset;
+	char			*sql = NULL, itemid_str[MAX_ID_LEN + 1], clock_from[MAX_ID_LEN + 1],
+				clock_to[MAX_ID_LEN + 1];
+	const char		*params[] = {itemid_str, clock_from, clock_to};
+	size_t	 		sql_alloc = 0, sql_offset = 0;
 	DB_RESULT		result;
 	DB_ROW			row;
 	zbx_vc_history_table_t	*table = &vc_history_tables[value_type];
 
+	zbx_snprintf(itemid_str, sizeof(itemid_str), ZBX_FS_UI64, itemid);
+	zbx_snprintf(clock_from, sizeof(clock_from), "%d", end_timestamp - seconds);
+	zbx_snprintf(clock_to, sizeof(clock_to), "%d", end_timestamp);
+
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
 			"select clock,ns,%s"
 			" from %s"
-			" where itemid=" ZBX_FS_UI64,
-			table->fields, table->name, itemid);
+			" where itemid=?",
+			table->fields, table->name);
 
 	if (1 == seconds)
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock=%d", end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock=?");
+		params[1] = clock_to;
+		result = DBselectN_prepared(sql, params, 2, count);
 	}
 	else
 	{
-		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock>%d and clock<=%d order by clock desc",
-				end_timestamp - seconds, end_timestamp);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and clock>? and clock<=? order by clock desc");
+		result = DBselectN_prepared(sql, params, 3, count);
 	}
 
-	result = DBselectN(sql, count);
-
 	zbx_free(sql);
 
 	if (NULL == result)
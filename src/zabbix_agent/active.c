@@ -51,6 +51,16 @@ ZBX_THREAD_LOCAL static zbx_vector_ptr_t	active_metrics;
 ZBX_THREAD_LOCAL static zbx_vector_ptr_t	regexps;
 ZBX_THREAD_LOCAL static char			*session_token;
 ZBX_THREAD_LOCAL static zbx_uint64_t		last_valueid = 0;
+ZBX_THREAD_LOCAL static char			*config_revision;	/* revision of received active checks */
+
+/* connection to server kept open between requests when the server allows it */
+ZBX_THREAD_LOCAL static zbx_socket_t		session_sock;
+ZBX_THREAD_LOCAL static int			session_sock_open = 0;
+ZBX_THREAD_LOCAL static int			session_keepalive = 0;	/* seconds the server keeps connection */
+ZBX_THREAD_LOCAL static time_t			session_lastused;
+
+#define ZBX_ACTIVE_REQUEST_CLOCK	0x01	/* add the sending time to request */
+#define ZBX_ACTIVE_REQUEST_CONFIG	0x02	/* response to active checks request, tells keep-alive support */
 
 #ifdef _WINDOWS
 LONG WINAPI	DelayLoadDllExceptionFilter(PEXCEPTION_POINTERS excpointers)
@@ -372,6 +382,15 @@ static int	parse_list_of_checks(char *str, const char *host, unsigned short port
 
 	if (SUCCEED != zbx_json_brackets_by_name(&jp, ZBX_PROTO_TAG_DATA, &jp_data))
 	{
+		/* the list is not sent if it has not changed since the revision the agent has */
+		if (NULL != config_revision && SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_CONFIG_REVISION,
+				tmp, sizeof(tmp), NULL) && 0 == strcmp(tmp, config_revision))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "list of active checks has not changed");
+			ret = SUCCEED;
+			goto out;
+		}
+
 		zabbix_log(LOG_LEVEL_ERR, "cannot parse list of active checks: %s", zbx_json_strerror());
 		goto out;
 	}
@@ -523,6 +542,11 @@ static int	parse_list_of_checks(char *str, const char *host, unsigned short port
 		}
 	}
 
+	if (SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_CONFIG_REVISION, tmp, sizeof(tmp), NULL))
+		config_revision = zbx_strdup(config_revision, tmp);
+	else
+		zbx_free(config_revision);
+
 	ret = SUCCEED;
 out:
 	zbx_vector_str_clear_ext(&received_metrics, zbx_str_free);
@@ -533,6 +557,165 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: active_session_close                                             *
+ *                                                                            *
+ * Purpose: closes connection kept open between requests                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	active_session_close(void)
+{
+	if (0 == session_sock_open)
+		return;
+
+	zbx_tcp_close(&session_sock);
+	session_sock_open = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: active_exchange                                                  *
+ *                                                                            *
+ * Purpose: sends request to Zabbix server and receives response using kept   *
+ *          connection or a new one                                           *
+ *                                                                            *
+ * Parameters: host     - [IN] IP or Hostname of Zabbix server                *
+ *             port     - [IN] port of Zabbix server                          *
+ *             timeout  - [IN] the connection timeout                         *
+ *             json     - [IN/OUT] the request                                *
+ *             flags    - [IN/OUT] ZBX_ACTIVE_REQUEST_* flags, the clock flag *
+ *                                 is cleared after adding sending time       *
+ *             response - [OUT] the response                                  *
+ *             err_step - [OUT] the failed step for diagnostics               *
+ *                                                                            *
+ * Return value: SUCCEED - the response was received                          *
+ *               FAIL - an error occurred, the connection is closed           *
+ *                                                                            *
+ ******************************************************************************/
+static int	active_exchange(const char *host, unsigned short port, int timeout, struct zbx_json *json,
+		unsigned char *flags, char **response, const char **err_step)
+{
+	char			*tls_arg1, *tls_arg2, value[MAX_ID_LEN + 1];
+	zbx_timespec_t		ts;
+	struct zbx_json_parse	jp;
+
+	if (0 == session_sock_open)
+	{
+		switch (configured_tls_connect_mode)
+		{
+			case ZBX_TCP_SEC_UNENCRYPTED:
+				tls_arg1 = NULL;
+				tls_arg2 = NULL;
+				break;
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+			case ZBX_TCP_SEC_TLS_CERT:
+				tls_arg1 = CONFIG_TLS_SERVER_CERT_ISSUER;
+				tls_arg2 = CONFIG_TLS_SERVER_CERT_SUBJECT;
+				break;
+			case ZBX_TCP_SEC_TLS_PSK:
+				tls_arg1 = CONFIG_TLS_PSK_IDENTITY;
+				tls_arg2 = NULL;	/* zbx_tls_connect() will find PSK */
+				break;
+#endif
+			default:
+				THIS_SHOULD_NEVER_HAPPEN;
+				return FAIL;
+		}
+
+		if (SUCCEED != zbx_tcp_connect(&session_sock, CONFIG_SOURCE_IP, host, port, timeout,
+				configured_tls_connect_mode, tls_arg1, tls_arg2))
+		{
+			*err_step = "[connect] ";
+			return FAIL;
+		}
+
+		session_sock_open = 1;
+	}
+
+	if (0 != (*flags & ZBX_ACTIVE_REQUEST_CLOCK))
+	{
+		zbx_timespec(&ts);
+		zbx_json_adduint64(json, ZBX_PROTO_TAG_CLOCK, ts.sec);
+		zbx_json_adduint64(json, ZBX_PROTO_TAG_NS, ts.ns);
+		*flags &= ~ZBX_ACTIVE_REQUEST_CLOCK;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "sending [%s]", json->buffer);
+
+	if (SUCCEED != zbx_tcp_send_to(&session_sock, json->buffer, timeout))
+	{
+		*err_step = "[send] ";
+		goto fail;
+	}
+
+	if (SUCCEED != zbx_tcp_recv_to(&session_sock, timeout) || NULL == session_sock.buffer)
+	{
+		*err_step = "[recv] ";
+		goto fail;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "got [%s]", session_sock.buffer);
+
+	*response = zbx_strdup(NULL, session_sock.buffer);
+
+	if (0 != (*flags & ZBX_ACTIVE_REQUEST_CONFIG))
+	{
+		if (SUCCEED == zbx_json_open(*response, &jp) &&
+				SUCCEED == zbx_json_value_by_name(&jp, ZBX_PROTO_TAG_KEEPALIVE, value, sizeof(value), NULL))
+		{
+			session_keepalive = atoi(value);
+		}
+		else
+			session_keepalive = 0;
+	}
+
+	if (0 == CONFIG_ACTIVE_KEEPALIVE || 0 == session_keepalive)
+		active_session_close();
+	else
+		session_lastused = time(NULL);
+
+	return SUCCEED;
+fail:
+	active_session_close();
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: active_request                                                   *
+ *                                                                            *
+ * Purpose: sends request to Zabbix server and receives response              *
+ *                                                                            *
+ * Comments: A kept connection might have been closed by the server, so the   *
+ *           request is repeated once over a new connection. Values resent    *
+ *           this way are filtered out by the server using the session token. *
+ *           See active_exchange() for parameters.                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	active_request(const char *host, unsigned short port, int timeout, struct zbx_json *json,
+		unsigned char flags, char **response, const char **err_step)
+{
+	int	reused;
+
+	/* do not use connections the server is about to close */
+	if (0 != session_sock_open && session_lastused + session_keepalive <= time(NULL) + 1)
+		active_session_close();
+
+	reused = session_sock_open;
+
+	if (SUCCEED == active_exchange(host, port, timeout, json, &flags, response, err_step))
+		return SUCCEED;
+
+	if (0 == reused)
+		return FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "kept connection to [%s:%hu] failed, reconnecting", host, port);
+
+	return active_exchange(host, port, timeout, json, &flags, response, err_step);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: refresh_active_checks                                            *
@@ -556,8 +739,8 @@ static int	refresh_active_checks(const char *host, unsigned short port)
 
 	ZBX_THREAD_LOCAL static int	last_ret = SUCCEED;
 	int				ret;
-	char				*tls_arg1, *tls_arg2;
-	zbx_socket_t			s;
+	char				*response = NULL;
+	const char			*err_step = "";
 	struct zbx_json			json;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' port:%hu", __function_name, host, port);
@@ -627,58 +810,29 @@ static int	refresh_active_checks(const char *host, unsigned short port)
 	if (ZBX_DEFAULT_AGENT_PORT != CONFIG_LISTEN_PORT)
 		zbx_json_adduint64(&json, ZBX_PROTO_TAG_PORT, CONFIG_LISTEN_PORT);
 
-	switch (configured_tls_connect_mode)
-	{
-		case ZBX_TCP_SEC_UNENCRYPTED:
-			tls_arg1 = NULL;
-			tls_arg2 = NULL;
-			break;
-#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-		case ZBX_TCP_SEC_TLS_CERT:
-			tls_arg1 = CONFIG_TLS_SERVER_CERT_ISSUER;
-			tls_arg2 = CONFIG_TLS_SERVER_CERT_SUBJECT;
-			break;
-		case ZBX_TCP_SEC_TLS_PSK:
-			tls_arg1 = CONFIG_TLS_PSK_IDENTITY;
-			tls_arg2 = NULL;	/* zbx_tls_connect() will find PSK */
-			break;
-#endif
-		default:
-			THIS_SHOULD_NEVER_HAPPEN;
-			ret = FAIL;
-			goto out;
-	}
+	if (0 != CONFIG_ACTIVE_KEEPALIVE)
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_KEEPALIVE, 1);
 
-	if (SUCCEED == (ret = zbx_tcp_connect(&s, CONFIG_SOURCE_IP, host, port, CONFIG_TIMEOUT,
-			configured_tls_connect_mode, tls_arg1, tls_arg2)))
-	{
-		zabbix_log(LOG_LEVEL_DEBUG, "sending [%s]", json.buffer);
+	if (NULL != config_revision)
+		zbx_json_addstring(&json, ZBX_PROTO_TAG_CONFIG_REVISION, config_revision, ZBX_JSON_TYPE_INT);
 
-		if (SUCCEED == (ret = zbx_tcp_send(&s, json.buffer)))
+	if (SUCCEED == (ret = active_request(host, port, CONFIG_TIMEOUT, &json, ZBX_ACTIVE_REQUEST_CONFIG,
+			&response, &err_step)))
+	{
+		if (SUCCEED != last_ret)
 		{
-			zabbix_log(LOG_LEVEL_DEBUG, "before read");
-
-			if (SUCCEED == (ret = zbx_tcp_recv(&s)))
-			{
-				zabbix_log(LOG_LEVEL_DEBUG, "got [%s]", s.buffer);
-
-				if (SUCCEED != last_ret)
-				{
-					zabbix_log(LOG_LEVEL_WARNING, "active check configuration update from [%s:%hu]"
-							" is working again", host, port);
-				}
-				parse_list_of_checks(s.buffer, host, port);
-			}
+			zabbix_log(LOG_LEVEL_WARNING, "active check configuration update from [%s:%hu]"
+					" is working again", host, port);
 		}
-
-		zbx_tcp_close(&s);
+		parse_list_of_checks(response, host, port);
+		zbx_free(response);
 	}
-out:
+
 	if (SUCCEED != ret && SUCCEED == last_ret)
 	{
 		zabbix_log(LOG_LEVEL_WARNING,
-				"active check configuration update from [%s:%hu] started to fail (%s)",
-				host, port, zbx_socket_strerror());
+				"active check configuration update from [%s:%hu] started to fail (%s%s)",
+				host, port, err_step, zbx_socket_strerror());
 	}
 
 	last_ret = ret;
@@ -753,10 +907,8 @@ static int	send_buffer(const char *host, unsigned short port)
 	const char			*__function_name = "send_buffer";
 	ZBX_ACTIVE_BUFFER_ELEMENT	*el;
 	int				ret = SUCCEED, i, now;
-	char				*tls_arg1, *tls_arg2;
-	zbx_timespec_t			ts;
+	char				*response = NULL;
 	const char			*err_send_step = "";
-	zbx_socket_t			s;
 	struct zbx_json 		json;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'%s' port:%d entries:%d/%d",
@@ -825,62 +977,23 @@ static int	send_buffer(const char *host, unsigned short port)
 
 	zbx_json_close(&json);
 
-	switch (configured_tls_connect_mode)
-	{
-		case ZBX_TCP_SEC_UNENCRYPTED:
-			tls_arg1 = NULL;
-			tls_arg2 = NULL;
-			break;
-#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
-		case ZBX_TCP_SEC_TLS_CERT:
-			tls_arg1 = CONFIG_TLS_SERVER_CERT_ISSUER;
-			tls_arg2 = CONFIG_TLS_SERVER_CERT_SUBJECT;
-			break;
-		case ZBX_TCP_SEC_TLS_PSK:
-			tls_arg1 = CONFIG_TLS_PSK_IDENTITY;
-			tls_arg2 = NULL;	/* zbx_tls_connect() will find PSK */
-			break;
-#endif
-		default:
-			THIS_SHOULD_NEVER_HAPPEN;
-			ret = FAIL;
-			goto out;
-	}
+	if (0 != CONFIG_ACTIVE_KEEPALIVE)
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_KEEPALIVE, 1);
 
-	if (SUCCEED == (ret = zbx_tcp_connect(&s, CONFIG_SOURCE_IP, host, port, MIN(buffer.count * CONFIG_TIMEOUT, 60),
-			configured_tls_connect_mode, tls_arg1, tls_arg2)))
+	if (SUCCEED == (ret = active_request(host, port, MIN(buffer.count * CONFIG_TIMEOUT, 60), &json,
+			ZBX_ACTIVE_REQUEST_CLOCK, &response, &err_send_step)))
 	{
-		zbx_timespec(&ts);
-		zbx_json_adduint64(&json, ZBX_PROTO_TAG_CLOCK, ts.sec);
-		zbx_json_adduint64(&json, ZBX_PROTO_TAG_NS, ts.ns);
-
-		zabbix_log(LOG_LEVEL_DEBUG, "JSON before sending [%s]", json.buffer);
-
-		if (SUCCEED == (ret = zbx_tcp_send(&s, json.buffer)))
+		if (SUCCEED != check_response(response))
 		{
-			if (SUCCEED == (ret = zbx_tcp_recv(&s)))
-			{
-				zabbix_log(LOG_LEVEL_DEBUG, "JSON back [%s]", s.buffer);
-
-				if (NULL == s.buffer || SUCCEED != check_response(s.buffer))
-				{
-					ret = FAIL;
-					zabbix_log(LOG_LEVEL_DEBUG, "NOT OK");
-				}
-				else
-					zabbix_log(LOG_LEVEL_DEBUG, "OK");
-			}
-			else
-				err_send_step = "[recv] ";
+			ret = FAIL;
+			zabbix_log(LOG_LEVEL_DEBUG, "NOT OK");
 		}
 		else
-			err_send_step = "[send] ";
+			zabbix_log(LOG_LEVEL_DEBUG, "OK");
 
-		zbx_tcp_close(&s);
+		zbx_free(response);
 	}
-	else
-		err_send_step = "[connect] ";
-out:
+
 	zbx_json_free(&json);
 
 	if (SUCCEED == ret)
@@ -1854,6 +1967,8 @@ ZBX_THREAD_ENTRY(active_checks_thread, args)
 		lastcheck = now;
 	}
 
+	active_session_close();
+	zbx_free(config_revision);
 	zbx_free(session_token);
 
 #ifdef _WINDOWS
@@ -27,6 +27,7 @@ extern char	*CONFIG_HOSTNAME;
 extern char	*CONFIG_HOST_METADATA;
 extern char	*CONFIG_HOST_METADATA_ITEM;
 extern int	CONFIG_REFRESH_ACTIVE_CHECKS;
+extern int	CONFIG_ACTIVE_KEEPALIVE;
 extern int	CONFIG_BUFFER_SEND;
 extern int	CONFIG_BUFFER_SIZE;
 extern int	CONFIG_MAX_LINES_PER_SECOND;
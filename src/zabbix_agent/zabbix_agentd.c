@@ -37,6 +37,7 @@ int	CONFIG_LOG_REMOTE_COMMANDS	= 0;
 int	CONFIG_UNSAFE_USER_PARAMETERS	= 0;
 int	CONFIG_LISTEN_PORT		= ZBX_DEFAULT_AGENT_PORT;
 int	CONFIG_REFRESH_ACTIVE_CHECKS	= 120;
+int	CONFIG_ACTIVE_KEEPALIVE		= 0;
 char	*CONFIG_LISTEN_IP		= NULL;
 char	*CONFIG_SOURCE_IP		= NULL;
 int	CONFIG_LOG_LEVEL		= LOG_LEVEL_WARNING;
@@ -83,6 +84,9 @@ char	*CONFIG_TLS_CIPHER_PSK13	= NULL;
 char	*CONFIG_TLS_CIPHER_PSK		= NULL;
 char	*CONFIG_TLS_CIPHER_ALL13	= NULL;
 char	*CONFIG_TLS_CIPHER_ALL		= NULL;
+#ifndef _WINDOWS
+int	CONFIG_TLS_SESSION_CACHE_SIZE	= 0;
+#endif
 char	*CONFIG_TLS_CIPHER_CMD13	= NULL;	/* not used in agent, defined for linking with tls.c */
 char	*CONFIG_TLS_CIPHER_CMD		= NULL;	/* not used in agent, defined for linking with tls.c */
 
@@ -677,6 +681,9 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 	err |= (FAIL == check_cfg_feature_str("TLSCipherCert13", CONFIG_TLS_CIPHER_CERT13, "OpenSSL 1.1.1 or newer"));
 	err |= (FAIL == check_cfg_feature_str("TLSCipherPSK13", CONFIG_TLS_CIPHER_PSK13, "OpenSSL 1.1.1 or newer"));
 	err |= (FAIL == check_cfg_feature_str("TLSCipherAll13", CONFIG_TLS_CIPHER_ALL13, "OpenSSL 1.1.1 or newer"));
+#ifndef _WINDOWS
+	err |= (FAIL == check_cfg_feature_int("TLSSessionCacheSize", CONFIG_TLS_SESSION_CACHE_SIZE, "OpenSSL"));
+#endif
 #endif
 
 	if (0 != err)
@@ -809,6 +816,8 @@ static void	zbx_load_config(int requirement, ZBX_TASK_EX *task)
 			PARM_OPT,	0,			100},
 		{"RefreshActiveChecks",		&CONFIG_REFRESH_ACTIVE_CHECKS,		TYPE_INT,
 			PARM_OPT,	SEC_PER_MIN,		SEC_PER_HOUR},
+		{"ActiveKeepAlive",		&CONFIG_ACTIVE_KEEPALIVE,		TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"MaxLinesPerSecond",		&CONFIG_MAX_LINES_PER_SECOND,		TYPE_INT,
 			PARM_OPT,	1,			1000},
 		{"EnableRemoteCommands",	&CONFIG_ENABLE_REMOTE_COMMANDS,		TYPE_INT,
@@ -869,6 +878,10 @@ static void	zbx_load_config(int requirement, ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"TLSCipherAll",		&CONFIG_TLS_CIPHER_ALL,			TYPE_STRING,
 			PARM_OPT,	0,			0},
+#ifndef _WINDOWS
+		{"TLSSessionCacheSize",		&CONFIG_TLS_SESSION_CACHE_SIZE,		TYPE_INT,
+			PARM_OPT,	0,			100000},
+#endif
 		{NULL}
 	};
 
@@ -1050,6 +1063,15 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	zbx_free_config();
 
 #if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+#ifndef _WINDOWS
+	if (0 != CONFIG_TLS_SESSION_CACHE_SIZE && SUCCEED != zbx_tls_init_cache(CONFIG_TLS_SESSION_CACHE_SIZE, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize TLS session cache: %s", error);
+		zbx_free(error);
+		zbx_free_service_resources(FAIL);
+		exit(EXIT_FAILURE);
+	}
+#endif
 	zbx_tls_init_parent();
 #endif
 	/* --- START THREADS ---*/
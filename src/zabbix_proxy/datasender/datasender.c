@@ -48,6 +48,105 @@ extern int		server_num, process_num;
 					ZBX_DATASENDER_AUTOREGISTRATION | ZBX_DATASENDER_TASKS |	\
 					ZBX_DATASENDER_TASKS_RECV)
 
+/* history, discovery and auto registration data of one 'proxy data' request */
+typedef struct
+{
+	struct zbx_json	j;
+	zbx_uint64_t	history_lastid;
+	zbx_uint64_t	discovery_lastid;
+	zbx_uint64_t	areg_lastid;
+	zbx_uint64_t	flags;
+	int		history_records;
+	int		discovery_records;
+	int		areg_records;
+	int		more;
+}
+zbx_datasender_batch_t;
+
+/* the next batch, prepared while the server is processing the previous one */
+static zbx_datasender_batch_t	*batch_next = NULL;
+
+static zbx_datasender_batch_t	*datasender_batch_create(void)
+{
+	zbx_datasender_batch_t	*batch;
+
+	batch = (zbx_datasender_batch_t *)zbx_malloc(NULL, sizeof(zbx_datasender_batch_t));
+	memset(batch, 0, sizeof(zbx_datasender_batch_t));
+	batch->more = ZBX_PROXY_DATA_DONE;
+
+	zbx_json_init(&batch->j, 16 * ZBX_KIBIBYTE);
+
+	zbx_json_addstring(&batch->j, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_PROXY_DATA, ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(&batch->j, ZBX_PROTO_TAG_HOST, CONFIG_HOSTNAME, ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(&batch->j, ZBX_PROTO_TAG_SESSION, zbx_dc_get_session_token(), ZBX_JSON_TYPE_STRING);
+
+	return batch;
+}
+
+static void	datasender_batch_free(zbx_datasender_batch_t *batch)
+{
+	zbx_json_free(&batch->j);
+	zbx_free(batch);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: datasender_batch_get_data                                        *
+ *                                                                            *
+ * Purpose: adds history, discovery and auto registration data to batch       *
+ *                                                                            *
+ * Parameters: batch - [IN/OUT] the batch                                     *
+ *             prev  - [IN] the batch sent before, but not yet acknowledged   *
+ *                          by server (optional). Data is read after the      *
+ *                          last records of previous batch instead of after   *
+ *                          the stored lastids.                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	datasender_batch_get_data(zbx_datasender_batch_t *batch, const zbx_datasender_batch_t *prev)
+{
+	int	more_history = ZBX_PROXY_DATA_DONE, more_discovery = ZBX_PROXY_DATA_DONE,
+		more_areg = ZBX_PROXY_DATA_DONE;
+
+	if (NULL != prev && 0 != prev->history_records)
+	{
+		batch->history_records = proxy_get_hist_data_ext(&batch->j, prev->history_lastid,
+				&batch->history_lastid, &more_history);
+	}
+	else
+		batch->history_records = proxy_get_hist_data(&batch->j, &batch->history_lastid, &more_history);
+
+	if (0 != batch->history_records)
+		batch->flags |= ZBX_DATASENDER_HISTORY;
+
+	if (NULL != prev && 0 != prev->discovery_records)
+	{
+		batch->discovery_records = proxy_get_dhis_data_ext(&batch->j, prev->discovery_lastid,
+				&batch->discovery_lastid, &more_discovery);
+	}
+	else
+		batch->discovery_records = proxy_get_dhis_data(&batch->j, &batch->discovery_lastid, &more_discovery);
+
+	if (0 != batch->discovery_records)
+		batch->flags |= ZBX_DATASENDER_DISCOVERY;
+
+	if (NULL != prev && 0 != prev->areg_records)
+	{
+		batch->areg_records = proxy_get_areg_data_ext(&batch->j, prev->areg_lastid, &batch->areg_lastid,
+				&more_areg);
+	}
+	else
+		batch->areg_records = proxy_get_areg_data(&batch->j, &batch->areg_lastid, &more_areg);
+
+	if (0 != batch->areg_records)
+		batch->flags |= ZBX_DATASENDER_AUTOREGISTRATION;
+
+	if (ZBX_PROXY_DATA_MORE == more_history || ZBX_PROXY_DATA_MORE == more_discovery ||
+			ZBX_PROXY_DATA_MORE == more_areg)
+	{
+		batch->more = ZBX_PROXY_DATA_MORE;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: proxy_data_sender                                                *
@@ -55,6 +154,13 @@ extern int		server_num, process_num;
  * Purpose: collects host availability, history, discovery, auto registration *
  *          data and sends 'proxy data' request                               *
  *                                                                            *
+ * Comments: When there is more data to send, the next batch is read from     *
+ *           database while server is processing the current one, so that     *
+ *           backlog is sent without waiting for database between requests.   *
+ *           The lastids are still stored only after server acknowledges the  *
+ *           batch. The server processes one request per connection in order, *
+ *           so at most one batch is sent ahead of the acknowledged data.     *
+ *                                                                            *
  ******************************************************************************/
 static int	proxy_data_sender(int *more, int now)
 {
@@ -63,11 +169,9 @@ static int	proxy_data_sender(int *more, int now)
 	static int		data_timestamp = 0, task_timestamp = 0, upload_state = SUCCEED;
 
 	zbx_socket_t		sock;
-	struct zbx_json		j;
+	zbx_datasender_batch_t	*batch;
 	struct zbx_json_parse	jp, jp_tasks;
-	int			availability_ts, history_records = 0, discovery_records = 0,
-				areg_records = 0, more_history = 0, more_discovery = 0, more_areg = 0;
-	zbx_uint64_t		history_lastid = 0, discovery_lastid = 0, areg_lastid = 0, flags = 0;
+	int			availability_ts, records = 0;
 	zbx_timespec_t		ts;
 	char			*error = NULL;
 	zbx_vector_ptr_t	tasks;
@@ -75,32 +179,30 @@ static int	proxy_data_sender(int *more, int now)
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
 	*more = ZBX_PROXY_DATA_DONE;
-	zbx_json_init(&j, 16 * ZBX_KIBIBYTE);
-
-	zbx_json_addstring(&j, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_PROXY_DATA, ZBX_JSON_TYPE_STRING);
-	zbx_json_addstring(&j, ZBX_PROTO_TAG_HOST, CONFIG_HOSTNAME, ZBX_JSON_TYPE_STRING);
-	zbx_json_addstring(&j, ZBX_PROTO_TAG_SESSION, zbx_dc_get_session_token(), ZBX_JSON_TYPE_STRING);
 
 	if (SUCCEED == upload_state && CONFIG_PROXYDATA_FREQUENCY <= now - data_timestamp)
 	{
-		if (SUCCEED == get_host_availability_data(&j, &availability_ts))
-			flags |= ZBX_DATASENDER_AVAILABILITY;
-
-		if  (0 != (history_records = proxy_get_hist_data(&j, &history_lastid, &more_history)))
-			flags |= ZBX_DATASENDER_HISTORY;
-
-		if  (0 != (discovery_records = proxy_get_dhis_data(&j, &discovery_lastid, &more_discovery)))
-			flags |= ZBX_DATASENDER_DISCOVERY;
+		if (NULL != batch_next)
+		{
+			batch = batch_next;
+			batch_next = NULL;
+		}
+		else
+		{
+			batch = datasender_batch_create();
+			datasender_batch_get_data(batch, NULL);
+		}
 
-		if  (0 != (areg_records = proxy_get_areg_data(&j, &areg_lastid, &more_areg)))
-			flags |= ZBX_DATASENDER_AUTOREGISTRATION;
+		if (SUCCEED == get_host_availability_data(&batch->j, &availability_ts))
+			batch->flags |= ZBX_DATASENDER_AVAILABILITY;
 
-		if (ZBX_PROXY_DATA_MORE != more_history && ZBX_PROXY_DATA_MORE != more_discovery &&
-						ZBX_PROXY_DATA_MORE != more_areg)
-		{
+		if (ZBX_PROXY_DATA_MORE != batch->more)
 			data_timestamp = now;
-		}
+
+		records = batch->history_records + batch->discovery_records + batch->areg_records;
 	}
+	else
+		batch = datasender_batch_create();
 
 	zbx_vector_ptr_create(&tasks);
 
@@ -112,77 +214,95 @@ static int	proxy_data_sender(int *more, int now)
 
 		if (0 != tasks.values_num)
 		{
-			zbx_tm_json_serialize_tasks(&j, &tasks);
-			flags |= ZBX_DATASENDER_TASKS;
+			zbx_tm_json_serialize_tasks(&batch->j, &tasks);
+			batch->flags |= ZBX_DATASENDER_TASKS;
 		}
 
-		flags |= ZBX_DATASENDER_TASKS_REQUEST;
+		batch->flags |= ZBX_DATASENDER_TASKS_REQUEST;
 	}
 
 	if (SUCCEED != upload_state)
-		flags |= ZBX_DATASENDER_TASKS_REQUEST;
+		batch->flags |= ZBX_DATASENDER_TASKS_REQUEST;
 
-	if (0 != flags)
+	if (0 != batch->flags)
 	{
-		if (ZBX_PROXY_DATA_MORE == more_history || ZBX_PROXY_DATA_MORE == more_discovery ||
-				ZBX_PROXY_DATA_MORE == more_areg)
+		if (ZBX_PROXY_DATA_MORE == batch->more)
 		{
-			zbx_json_adduint64(&j, ZBX_PROTO_TAG_MORE, ZBX_PROXY_DATA_MORE);
+			zbx_json_adduint64(&batch->j, ZBX_PROTO_TAG_MORE, ZBX_PROXY_DATA_MORE);
 			*more = ZBX_PROXY_DATA_MORE;
 		}
 
-		zbx_json_addstring(&j, ZBX_PROTO_TAG_VERSION, ZABBIX_VERSION, ZBX_JSON_TYPE_STRING);
+		zbx_json_addstring(&batch->j, ZBX_PROTO_TAG_VERSION, ZABBIX_VERSION, ZBX_JSON_TYPE_STRING);
 
 		/* retry till have a connection */
 		if (FAIL == connect_to_server(&sock, 600, CONFIG_PROXYDATA_FREQUENCY))
 			goto clean;
 
 		zbx_timespec(&ts);
-		zbx_json_adduint64(&j, ZBX_PROTO_TAG_CLOCK, ts.sec);
-		zbx_json_adduint64(&j, ZBX_PROTO_TAG_NS, ts.ns);
+		zbx_json_adduint64(&batch->j, ZBX_PROTO_TAG_CLOCK, ts.sec);
+		zbx_json_adduint64(&batch->j, ZBX_PROTO_TAG_NS, ts.ns);
 
-		if (SUCCEED != (upload_state = put_data_to_server(&sock, &j, &error)))
+		if (SUCCEED == (upload_state = send_data_to_server(&sock, &batch->j, &error)))
+		{
+			/* read the next batch while server is processing this one */
+			if (ZBX_PROXY_DATA_MORE == *more)
+			{
+				batch_next = datasender_batch_create();
+				datasender_batch_get_data(batch_next, batch);
+			}
+
+			upload_state = zbx_recv_response(&sock, 0, &error);
+		}
+
+		if (SUCCEED != upload_state)
 		{
 			*more = ZBX_PROXY_DATA_DONE;
 			zabbix_log(LOG_LEVEL_WARNING, "cannot send proxy data to server at \"%s\": %s",
 					sock.peer, error);
 			zbx_free(error);
+
+			/* the next batch follows unacknowledged data, it will be read again */
+			if (NULL != batch_next)
+			{
+				datasender_batch_free(batch_next);
+				batch_next = NULL;
+			}
 		}
 		else
 		{
-			if (0 != (flags & ZBX_DATASENDER_AVAILABILITY))
+			if (0 != (batch->flags & ZBX_DATASENDER_AVAILABILITY))
 				zbx_set_availability_diff_ts(availability_ts);
 
 			if (SUCCEED == zbx_json_open(sock.buffer, &jp))
 			{
 				if (SUCCEED == zbx_json_brackets_by_name(&jp, ZBX_PROTO_TAG_TASKS, &jp_tasks))
-					flags |= ZBX_DATASENDER_TASKS_RECV;
+					batch->flags |= ZBX_DATASENDER_TASKS_RECV;
 			}
 
-			if (0 != (flags & ZBX_DATASENDER_DB_UPDATE))
+			if (0 != (batch->flags & ZBX_DATASENDER_DB_UPDATE))
 			{
 				DBbegin();
 
-				if (0 != (flags & ZBX_DATASENDER_TASKS))
+				if (0 != (batch->flags & ZBX_DATASENDER_TASKS))
 				{
 					zbx_tm_update_task_status(&tasks, ZBX_TM_STATUS_DONE);
 					zbx_vector_ptr_clear_ext(&tasks, (zbx_clean_func_t)zbx_tm_task_free);
 				}
 
-				if (0 != (flags & ZBX_DATASENDER_TASKS_RECV))
+				if (0 != (batch->flags & ZBX_DATASENDER_TASKS_RECV))
 				{
 					zbx_tm_json_deserialize_tasks(&jp_tasks, &tasks);
 					zbx_tm_save_tasks(&tasks);
 				}
 
-				if (0 != (flags & ZBX_DATASENDER_HISTORY))
-					proxy_set_hist_lastid(history_lastid);
+				if (0 != (batch->flags & ZBX_DATASENDER_HISTORY))
+					proxy_set_hist_lastid(batch->history_lastid);
 
-				if (0 != (flags & ZBX_DATASENDER_DISCOVERY))
-					proxy_set_dhis_lastid(discovery_lastid);
+				if (0 != (batch->flags & ZBX_DATASENDER_DISCOVERY))
+					proxy_set_dhis_lastid(batch->discovery_lastid);
 
-				if (0 != (flags & ZBX_DATASENDER_AUTOREGISTRATION))
-					proxy_set_areg_lastid(areg_lastid);
+				if (0 != (batch->flags & ZBX_DATASENDER_AUTOREGISTRATION))
+					proxy_set_areg_lastid(batch->areg_lastid);
 
 				DBcommit();
 			}
@@ -194,12 +314,12 @@ clean:
 	zbx_vector_ptr_clear_ext(&tasks, (zbx_clean_func_t)zbx_tm_task_free);
 	zbx_vector_ptr_destroy(&tasks);
 
-	zbx_json_free(&j);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s more:%d flags:0x" ZBX_FS_UX64, __function_name,
-			zbx_result_string(upload_state), *more, flags);
+			zbx_result_string(upload_state), *more, batch->flags);
+
+	datasender_batch_free(batch);
 
-	return history_records + discovery_records + areg_records;
+	return records;
 }
 
 /******************************************************************************
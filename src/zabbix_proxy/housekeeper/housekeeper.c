@@ -23,6 +23,7 @@
 #include "daemon.h"
 #include "zbxself.h"
 #include "dbcache.h"
+#include "histlog.h"
 
 #include "housekeeper.h"
 
@@ -152,6 +153,13 @@ static int	housekeeping_history(int now)
         zabbix_log(LOG_LEVEL_DEBUG, "In housekeeping_history()");
 
 	records += delete_history("proxy_history", "history_lastid", now);
+
+	if (SUCCEED == zbx_is_histlog_enabled())
+	{
+		records += zbx_histlog_housekeep(now - CONFIG_PROXY_LOCAL_BUFFER * SEC_PER_HOUR,
+				now - CONFIG_PROXY_OFFLINE_BUFFER * SEC_PER_HOUR);
+	}
+
 	records += delete_history("proxy_dhistory", "dhistory_lastid", now);
 	records += delete_history("proxy_autoreg_host", "autoreg_host_lastid", now);
 
@@ -28,6 +28,7 @@
 #include "zbxgetopt.h"
 #include "mutexs.h"
 #include "proxy.h"
+#include "histlog.h"
 
 #include "sysinfo.h"
 #include "zbxmodules.h"
@@ -147,6 +148,7 @@ int		server_num		= 0;
 static int	CONFIG_PROXYMODE	= ZBX_PROXYMODE_ACTIVE;
 int	CONFIG_DATASENDER_FORKS		= 1;
 int	CONFIG_DISCOVERER_FORKS		= 1;
+int	CONFIG_DISCOVERER_CONCURRENCY	= 256;
 int	CONFIG_HOUSEKEEPER_FORKS	= 1;
 int	CONFIG_PINGER_FORKS		= 1;
 int	CONFIG_POLLER_FORKS		= 5;
@@ -175,6 +177,8 @@ int	CONFIG_LISTEN_PORT		= ZBX_DEFAULT_SERVER_PORT;
 char	*CONFIG_LISTEN_IP		= NULL;
 char	*CONFIG_SOURCE_IP		= NULL;
 int	CONFIG_TRAPPER_TIMEOUT		= 300;
+int	CONFIG_TRAPPER_IDLE_CONNECTIONS	= 0;
+int	CONFIG_TRAPPER_KEEPALIVE	= 0;
 
 int	CONFIG_HOUSEKEEPING_FREQUENCY	= 1;
 int	CONFIG_PROXY_LOCAL_BUFFER	= 0;
@@ -201,6 +205,7 @@ zbx_uint64_t	CONFIG_TRENDS_CACHE_SIZE	= 0;
 zbx_uint64_t	CONFIG_VALUE_CACHE_SIZE		= 0;
 zbx_uint64_t	CONFIG_VMWARE_CACHE_SIZE	= 8 * ZBX_MEBIBYTE;
 zbx_uint64_t	CONFIG_EXPORT_FILE_SIZE;
+zbx_uint64_t	CONFIG_HISTORY_LOG_SEGMENT_SIZE	= 16 * ZBX_MEBIBYTE;
 
 int	CONFIG_UNREACHABLE_PERIOD	= 45;
 int	CONFIG_UNREACHABLE_DELAY	= 15;
@@ -208,6 +213,7 @@ int	CONFIG_UNAVAILABLE_DELAY	= 60;
 int	CONFIG_LOG_LEVEL		= LOG_LEVEL_WARNING;
 char	*CONFIG_ALERT_SCRIPTS_PATH	= NULL;
 char	*CONFIG_EXTERNALSCRIPTS		= NULL;
+char	**CONFIG_EXTERNAL_COPROCESS	= NULL;
 char	*CONFIG_TMPDIR			= NULL;
 char	*CONFIG_FPING_LOCATION		= NULL;
 char	*CONFIG_FPING6_LOCATION		= NULL;
@@ -218,6 +224,7 @@ char	*CONFIG_DBUSER			= NULL;
 char	*CONFIG_DBPASSWORD		= NULL;
 char	*CONFIG_DBSOCKET		= NULL;
 char	*CONFIG_EXPORT_DIR		= NULL;
+char	*CONFIG_HISTORY_LOG_DIR		= NULL;
 int	CONFIG_DBPORT			= 0;
 int	CONFIG_ENABLE_REMOTE_COMMANDS	= 0;
 int	CONFIG_LOG_REMOTE_COMMANDS	= 0;
@@ -236,6 +243,7 @@ int	CONFIG_JAVA_GATEWAY_PORT	= ZBX_DEFAULT_GATEWAY_PORT;
 char	*CONFIG_SSH_KEY_LOCATION	= NULL;
 
 int	CONFIG_LOG_SLOW_QUERIES		= 0;	/* ms; 0 - disable */
+int	CONFIG_DB_PREPARED_STATEMENTS	= 1;
 
 /* zabbix server startup time */
 int	CONFIG_SERVER_STARTUP_TIME	= 0;
@@ -270,6 +278,7 @@ char	*CONFIG_TLS_CIPHER_PSK13	= NULL;
 char	*CONFIG_TLS_CIPHER_PSK		= NULL;
 char	*CONFIG_TLS_CIPHER_ALL13	= NULL;
 char	*CONFIG_TLS_CIPHER_ALL		= NULL;
+int	CONFIG_TLS_SESSION_CACHE_SIZE	= 0;
 char	*CONFIG_TLS_CIPHER_CMD13	= NULL;	/* not used in proxy, defined for linking with tls.c */
 char	*CONFIG_TLS_CIPHER_CMD		= NULL;	/* not used in proxy, defined for linking with tls.c */
 
@@ -278,6 +287,7 @@ static char	*CONFIG_SOCKET_PATH	= NULL;
 char	*CONFIG_HISTORY_STORAGE_URL		= NULL;
 char	*CONFIG_HISTORY_STORAGE_OPTS		= NULL;
 int	CONFIG_HISTORY_STORAGE_PIPELINES	= 0;
+char	*CONFIG_HISTORY_STORAGE_DIR		= NULL;
 
 char	*CONFIG_STATS_ALLOWED_IP	= NULL;
 
@@ -589,6 +599,7 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 	err |= (FAIL == check_cfg_feature_str("TLSCipherCert13", CONFIG_TLS_CIPHER_CERT13, "OpenSSL 1.1.1 or newer"));
 	err |= (FAIL == check_cfg_feature_str("TLSCipherPSK13", CONFIG_TLS_CIPHER_PSK13, "OpenSSL 1.1.1 or newer"));
 	err |= (FAIL == check_cfg_feature_str("TLSCipherAll13", CONFIG_TLS_CIPHER_ALL13, "OpenSSL 1.1.1 or newer"));
+	err |= (FAIL == check_cfg_feature_int("TLSSessionCacheSize", CONFIG_TLS_SESSION_CACHE_SIZE, "OpenSSL"));
 #endif
 
 #if !defined(HAVE_OPENIPMI)
@@ -630,6 +641,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	1,			100},
 		{"StartDiscoverers",		&CONFIG_DISCOVERER_FORKS,		TYPE_INT,
 			PARM_OPT,	0,			250},
+		{"DiscovererConcurrency",	&CONFIG_DISCOVERER_CONCURRENCY,		TYPE_INT,
+			PARM_OPT,	1,			1000},
 		{"StartHTTPPollers",		&CONFIG_HTTPPOLLER_FORKS,		TYPE_INT,
 			PARM_OPT,	0,			1000},
 		{"StartPingers",		&CONFIG_PINGER_FORKS,			TYPE_INT,
@@ -664,6 +677,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			720},
 		{"ProxyOfflineBuffer",		&CONFIG_PROXY_OFFLINE_BUFFER,		TYPE_INT,
 			PARM_OPT,	1,			720},
+		{"HistoryLogDir",		&CONFIG_HISTORY_LOG_DIR,		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"HistoryLogSegmentSize",	&CONFIG_HISTORY_LOG_SEGMENT_SIZE,	TYPE_UINT64,
+			PARM_OPT,	ZBX_MEBIBYTE,		ZBX_GIBIBYTE},
 		{"HeartbeatFrequency",		&CONFIG_HEARTBEAT_FREQUENCY,		TYPE_INT,
 			PARM_OPT,	0,			ZBX_PROXY_HEARTBEAT_FREQUENCY_MAX},
 		{"ConfigFrequency",		&CONFIG_PROXYCONFIG_FREQUENCY,		TYPE_INT,
@@ -680,6 +697,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	1,			30},
 		{"TrapperTimeout",		&CONFIG_TRAPPER_TIMEOUT,		TYPE_INT,
 			PARM_OPT,	1,			300},
+		{"TrapperIdleConnections",	&CONFIG_TRAPPER_IDLE_CONNECTIONS,	TYPE_INT,
+			PARM_OPT,	0,			1000},
+		{"TrapperKeepAlive",		&CONFIG_TRAPPER_KEEPALIVE,		TYPE_INT,
+			PARM_OPT,	0,			SEC_PER_HOUR},
 		{"UnreachablePeriod",		&CONFIG_UNREACHABLE_PERIOD,		TYPE_INT,
 			PARM_OPT,	1,			SEC_PER_HOUR},
 		{"UnreachableDelay",		&CONFIG_UNREACHABLE_DELAY,		TYPE_INT,
@@ -704,6 +725,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			1024},
 		{"ExternalScripts",		&CONFIG_EXTERNALSCRIPTS,		TYPE_STRING,
 			PARM_OPT,	0,			0},
+		{"ExternalCoprocess",		&CONFIG_EXTERNAL_COPROCESS,		TYPE_MULTISTRING,
+			PARM_OPT,	0,			0},
 		{"DBHost",			&CONFIG_DBHOST,				TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"DBName",			&CONFIG_DBNAME,				TYPE_STRING,
@@ -778,6 +801,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"TLSCipherAll",		&CONFIG_TLS_CIPHER_ALL,			TYPE_STRING,
 			PARM_OPT,	0,			0},
+		{"TLSSessionCacheSize",		&CONFIG_TLS_SESSION_CACHE_SIZE,		TYPE_INT,
+			PARM_OPT,	0,			100000},
 		{"SocketDir",			&CONFIG_SOCKET_PATH,			TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"EnableRemoteCommands",	&CONFIG_ENABLE_REMOTE_COMMANDS,		TYPE_INT,
@@ -791,6 +816,7 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 
 	/* initialize multistrings */
 	zbx_strarr_init(&CONFIG_LOAD_MODULE);
+	zbx_strarr_init(&CONFIG_EXTERNAL_COPROCESS);
 
 	parse_cfg_file(CONFIG_FILE, cfg, ZBX_CFG_FILE_REQUIRED, ZBX_CFG_STRICT);
 
@@ -1034,6 +1060,13 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
+	if (SUCCEED != zbx_histlog_init(&error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize history log: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
 	if (SUCCEED != init_configuration_cache(&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize configuration cache: %s", error);
@@ -1048,6 +1081,15 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		exit(EXIT_FAILURE);
 	}
 
+#if defined(HAVE_POLARSSL) || defined(HAVE_GNUTLS) || defined(HAVE_OPENSSL)
+	if (SUCCEED != zbx_tls_init_cache(CONFIG_TLS_SESSION_CACHE_SIZE, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize TLS session cache: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+#endif
+
 	if (0 != CONFIG_VMWARE_FORKS && SUCCEED != zbx_vmware_init(&error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize VMware cache: %s", error);
@@ -1237,6 +1279,7 @@ void	zbx_on_exit(int ret)
 
 	free_selfmon_collector();
 	free_proxy_history_lock();
+	zbx_histlog_destroy();
 
 	zbx_unload_modules();
 
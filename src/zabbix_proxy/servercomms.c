@@ -158,17 +158,19 @@ exit:
 
 /******************************************************************************
  *                                                                            *
- * Function: put_data_to_server                                               *
+ * Function: send_data_to_server                                              *
  *                                                                            *
- * Purpose: send data to server                                               *
+ * Purpose: send data to server without waiting for response                  *
  *                                                                            *
  * Return value: SUCCEED - processed successfully                             *
  *               FAIL - an error occurred                                     *
  *                                                                            *
+ * Comments: the response must be received with zbx_recv_response()          *
+ *                                                                            *
  ******************************************************************************/
-int	put_data_to_server(zbx_socket_t *sock, struct zbx_json *j, char **error)
+int	send_data_to_server(zbx_socket_t *sock, struct zbx_json *j, char **error)
 {
-	const char	*__function_name = "put_data_to_server";
+	const char	*__function_name = "send_data_to_server";
 
 	int		ret = FAIL;
 
@@ -180,6 +182,34 @@ int	put_data_to_server(zbx_socket_t *sock, struct zbx_json *j, char **error)
 		goto out;
 	}
 
+	ret = SUCCEED;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: put_data_to_server                                               *
+ *                                                                            *
+ * Purpose: send data to server                                               *
+ *                                                                            *
+ * Return value: SUCCEED - processed successfully                             *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	put_data_to_server(zbx_socket_t *sock, struct zbx_json *j, char **error)
+{
+	const char	*__function_name = "put_data_to_server";
+
+	int		ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	if (SUCCEED != send_data_to_server(sock, j, error))
+		goto out;
+
 	if (SUCCEED != zbx_recv_response(sock, 0, error))
 		goto out;
 
@@ -34,11 +34,63 @@
 #include "../../libs/zbxcrypto/tls.h"
 
 extern int		CONFIG_DISCOVERER_FORKS;
+extern int		CONFIG_DISCOVERER_CONCURRENCY;
+extern char		*CONFIG_SOURCE_IP;
 extern unsigned char	process_type, program_type;
 extern int		server_num, process_num;
 
 #define ZBX_DISCOVERER_IPRANGE_LIMIT	(1 << 16)
 
+#define ZBX_DISCOVERY_POLL_TIMEOUT	100	/* milliseconds */
+
+/* discovery rule check with expanded port list */
+typedef struct
+{
+	DB_DCHECK		dcheck;
+	zbx_vector_uint64_t	ports;
+}
+zbx_discovery_check_t;
+
+/* service found on the host */
+typedef struct
+{
+	int	check_idx;	/* index of the check in discovery rule checks */
+	int	port_idx;	/* index of the port in check port list */
+	int	unknown;	/* the port could not be probed because of a local error, */
+				/* service status is not reported in this cycle            */
+	char	*value;
+}
+zbx_discovery_service_t;
+
+typedef struct
+{
+	char			ip[INTERFACE_IP_LEN_MAX];
+	zbx_vector_ptr_t	services;	/* available services sorted by check and port indexes */
+}
+zbx_discovery_host_t;
+
+/* pending TCP connection to check if the service port is open */
+typedef struct
+{
+	int	check_idx;
+	int	port_idx;
+	int	host_idx;
+	int	fd;
+	double	deadline;
+}
+zbx_discovery_probe_t;
+
+/* iterator over (check, port, host) combinations of TCP checks */
+typedef struct
+{
+	const zbx_vector_ptr_t	*checks;
+	int			check_idx;
+	int			port_idx;
+	int			host_idx;
+	int			hosts_num;
+}
+zbx_discovery_cursor_t;
+
 /******************************************************************************
  *                                                                            *
  * Function: proxy_update_service                                             *
@@ -327,147 +379,705 @@ static int	discover_service(const DB_DCHECK *dcheck, char *ip, int port, char **
 
 /******************************************************************************
  *                                                                            *
- * Function: process_check                                                    *
+ * Function: discovery_check_is_tcp                                           *
  *                                                                            *
- * Purpose: check if service is available and update database                 *
+ * Purpose: check if the service of discovery check can be detected by        *
+ *          connecting to its TCP port                                        *
  *                                                                            *
- * Parameters: service - service info                                         *
+ ******************************************************************************/
+static int	discovery_check_is_tcp(int type)
+{
+	switch (type)
+	{
+		case SVC_SSH:
+		case SVC_LDAP:
+		case SVC_SMTP:
+		case SVC_FTP:
+		case SVC_HTTP:
+		case SVC_POP:
+		case SVC_NNTP:
+		case SVC_IMAP:
+		case SVC_TCP:
+		case SVC_HTTPS:
+		case SVC_TELNET:
+		case SVC_AGENT:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+static void	discovery_parse_ports(const char *ports, zbx_vector_uint64_t *ports_list)
+{
+	const char	*start, *comma, *dash;
+	int		port, first, last;
+
+	for (start = ports; '\0' != *start; start = comma + 1)
+	{
+		comma = strchr(start, ',');
+		first = last = atoi(start);
+
+		if (NULL != (dash = strchr(start, '-')) && (NULL == comma || dash < comma))
+			last = atoi(dash + 1);
+
+		for (port = first; port <= last; port++)
+			zbx_vector_uint64_append(ports_list, (zbx_uint64_t)port);
+
+		if (NULL == comma)
+			break;
+	}
+}
+
+static void	discovery_check_free(zbx_discovery_check_t *check)
+{
+	zbx_free(check->dcheck.key_);
+	zbx_free(check->dcheck.snmp_community);
+	zbx_free(check->dcheck.snmpv3_securityname);
+	zbx_free(check->dcheck.snmpv3_authpassphrase);
+	zbx_free(check->dcheck.snmpv3_privpassphrase);
+	zbx_free(check->dcheck.snmpv3_contextname);
+	zbx_free(check->dcheck.ports);
+	zbx_vector_uint64_destroy(&check->ports);
+	zbx_free(check);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: discovery_load_checks                                            *
+ *                                                                            *
+ * Purpose: load checks of discovery rule, the unique check goes first        *
  *                                                                            *
  ******************************************************************************/
-static void	process_check(DB_DRULE *drule, DB_DCHECK *dcheck, DB_DHOST *dhost, int *host_status, char *ip,
-		const char *dns, int now)
+static void	discovery_load_checks(const DB_DRULE *drule, zbx_vector_ptr_t *checks)
 {
-	const char	*__function_name = "process_check";
-	const char	*start;
-	char		*value = NULL;
-	size_t		value_alloc = 128;
+	DB_RESULT		result;
+	DB_ROW			row;
+	zbx_discovery_check_t	*check;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+	result = DBselect(
+			"select dcheckid,type,key_,snmp_community,snmpv3_securityname,snmpv3_securitylevel,"
+				"snmpv3_authpassphrase,snmpv3_privpassphrase,snmpv3_authprotocol,snmpv3_privprotocol,"
+				"ports,snmpv3_contextname"
+			" from dchecks"
+			" where druleid=" ZBX_FS_UI64
+			" order by dcheckid",
+			drule->druleid);
+
+	while (NULL != (row = DBfetch(result)))
+	{
+		check = (zbx_discovery_check_t *)zbx_malloc(NULL, sizeof(zbx_discovery_check_t));
+		memset(check, 0, sizeof(zbx_discovery_check_t));
+
+		ZBX_STR2UINT64(check->dcheck.dcheckid, row[0]);
+		check->dcheck.type = atoi(row[1]);
+		check->dcheck.key_ = zbx_strdup(NULL, row[2]);
+		check->dcheck.snmp_community = zbx_strdup(NULL, row[3]);
+		check->dcheck.snmpv3_securityname = zbx_strdup(NULL, row[4]);
+		check->dcheck.snmpv3_securitylevel = (unsigned char)atoi(row[5]);
+		check->dcheck.snmpv3_authpassphrase = zbx_strdup(NULL, row[6]);
+		check->dcheck.snmpv3_privpassphrase = zbx_strdup(NULL, row[7]);
+		check->dcheck.snmpv3_authprotocol = (unsigned char)atoi(row[8]);
+		check->dcheck.snmpv3_privprotocol = (unsigned char)atoi(row[9]);
+		check->dcheck.ports = zbx_strdup(NULL, row[10]);
+		check->dcheck.snmpv3_contextname = zbx_strdup(NULL, row[11]);
+
+		zbx_vector_uint64_create(&check->ports);
+		discovery_parse_ports(check->dcheck.ports, &check->ports);
+
+		zbx_vector_ptr_append(checks, check);
+
+		/* unique check must be processed first */
+		if (0 != drule->unique_dcheckid && check->dcheck.dcheckid == drule->unique_dcheckid)
+		{
+			memmove(&checks->values[1], &checks->values[0], (checks->values_num - 1) * sizeof(void *));
+			checks->values[0] = check;
+		}
+	}
+	DBfree_result(result);
+}
+
+static void	discovery_service_free(zbx_discovery_service_t *service)
+{
+	zbx_free(service->value);
+	zbx_free(service);
+}
+
+static int	discovery_service_compare(const void *d1, const void *d2)
+{
+	const zbx_discovery_service_t	*s1 = *(const zbx_discovery_service_t * const *)d1;
+	const zbx_discovery_service_t	*s2 = *(const zbx_discovery_service_t * const *)d2;
 
-	value = (char *)zbx_malloc(value, value_alloc);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->check_idx, s2->check_idx);
+	ZBX_RETURN_IF_NOT_EQUAL(s1->port_idx, s2->port_idx);
 
-	for (start = dcheck->ports; '\0' != *start;)
+	return 0;
+}
+
+static zbx_discovery_service_t	*discovery_host_add_service(zbx_discovery_host_t *host, int check_idx, int port_idx)
+{
+	zbx_discovery_service_t	*service;
+
+	service = (zbx_discovery_service_t *)zbx_malloc(NULL, sizeof(zbx_discovery_service_t));
+	service->check_idx = check_idx;
+	service->port_idx = port_idx;
+	service->unknown = 0;
+	service->value = NULL;
+	zbx_vector_ptr_append(&host->services, service);
+
+	return service;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: discovery_probe_next                                             *
+ *                                                                            *
+ * Purpose: get the next (check, port, host) combination to probe with TCP    *
+ *          connect                                                           *
+ *                                                                            *
+ * Return value: SUCCEED - the next probe was returned                        *
+ *               FAIL    - all combinations have been returned                *
+ *                                                                            *
+ ******************************************************************************/
+static int	discovery_probe_next(zbx_discovery_cursor_t *cursor, zbx_discovery_probe_t *probe)
+{
+	const zbx_discovery_check_t	*check;
+
+	for (; cursor->check_idx < cursor->checks->values_num;
+			cursor->check_idx++, cursor->port_idx = 0, cursor->host_idx = 0)
 	{
-		char	*comma, *last_port;
-		int	port, first, last;
+		check = (const zbx_discovery_check_t *)cursor->checks->values[cursor->check_idx];
 
-		if (NULL != (comma = strchr(start, ',')))
-			*comma = '\0';
+		if (SUCCEED != discovery_check_is_tcp(check->dcheck.type))
+			continue;
 
-		if (NULL != (last_port = strchr(start, '-')))
+		for (; cursor->port_idx < check->ports.values_num; cursor->port_idx++, cursor->host_idx = 0)
 		{
-			*last_port = '\0';
-			first = atoi(start);
-			last = atoi(last_port + 1);
-			*last_port = '-';
+			if (cursor->host_idx < cursor->hosts_num)
+			{
+				probe->check_idx = cursor->check_idx;
+				probe->port_idx = cursor->port_idx;
+				probe->host_idx = cursor->host_idx++;
+
+				return SUCCEED;
+			}
 		}
-		else
-			first = last = atoi(start);
+	}
 
-		for (port = first; port <= last; port++)
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: discovery_tcp_connect                                            *
+ *                                                                            *
+ * Purpose: start non-blocking connection to the specified address            *
+ *                                                                            *
+ * Parameters: ip            - [IN] the IP address                            *
+ *             port          - [IN] the port                                  *
+ *             fd            - [OUT] the socket                               *
+ *             error         - [OUT] the error message                        *
+ *             max_error_len - [IN] the size of error buffer                  *
+ *                                                                            *
+ * Return value: SUCCEED       - the connection was established or is in      *
+ *                               progress                                     *
+ *               FAIL          - the connection was refused or the host is    *
+ *                               unreachable                                  *
+ *               NETWORK_ERROR - the connection could not be started because  *
+ *                               of a local error (out of file descriptors,   *
+ *                               cannot bind to SourceIP, etc.)               *
+ *                                                                            *
+ ******************************************************************************/
+static int	discovery_tcp_connect(const char *ip, unsigned short port, int *fd, char *error, size_t max_error_len)
+{
+	struct addrinfo	hints, *ai = NULL, *ai_bind = NULL;
+	char		service[8];
+	int		ret = NETWORK_ERROR, rc;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = PF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_NUMERICHOST;
+
+	zbx_snprintf(service, sizeof(service), "%hu", port);
+
+	if (0 != (rc = getaddrinfo(ip, service, &hints, &ai)))
+	{
+		zbx_snprintf(error, max_error_len, "cannot resolve address: %s", gai_strerror(rc));
+		goto out;
+	}
+
+	if (-1 == (*fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol)))
+	{
+		zbx_snprintf(error, max_error_len, "cannot create socket: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (-1 == fcntl(*fd, F_SETFD, FD_CLOEXEC) || -1 == fcntl(*fd, F_SETFL, O_NONBLOCK))
+	{
+		zbx_snprintf(error, max_error_len, "cannot set socket flags: %s", zbx_strerror(errno));
+		goto close;
+	}
+
+	if (NULL != CONFIG_SOURCE_IP)
+	{
+		if (0 != (rc = getaddrinfo(CONFIG_SOURCE_IP, NULL, &hints, &ai_bind)))
+		{
+			zbx_snprintf(error, max_error_len, "cannot resolve source address \"%s\": %s",
+					CONFIG_SOURCE_IP, gai_strerror(rc));
+			goto close;
+		}
+
+		if (-1 == bind(*fd, ai_bind->ai_addr, ai_bind->ai_addrlen))
 		{
-			int	service_status;
+			zbx_snprintf(error, max_error_len, "cannot bind socket to \"%s\": %s", CONFIG_SOURCE_IP,
+					zbx_strerror(errno));
+			goto close;
+		}
+	}
+
+	if (-1 == connect(*fd, ai->ai_addr, ai->ai_addrlen) && EINPROGRESS != errno)
+	{
+		switch (errno)
+		{
+			case ECONNREFUSED:
+			case ETIMEDOUT:
+			case EHOSTUNREACH:
+			case ENETUNREACH:
+				ret = FAIL;
+				break;
+		}
+
+		zbx_snprintf(error, max_error_len, "cannot connect: %s", zbx_strerror(errno));
+		goto close;
+	}
+
+	ret = SUCCEED;
+close:
+	if (SUCCEED != ret)
+		close(*fd);
+out:
+	if (NULL != ai_bind)
+		freeaddrinfo(ai_bind);
+
+	if (NULL != ai)
+		freeaddrinfo(ai);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: discovery_tcp_scan                                               *
+ *                                                                            *
+ * Purpose: find ports of TCP based checks accepting connections on the hosts *
+ *                                                                            *
+ * Parameters: checks    - [IN] the discovery rule checks                     *
+ *             hosts     - [IN/OUT] the hosts, open ports are added to host   *
+ *                                  services                                  *
+ *             hosts_num - [IN] the number of hosts                           *
+ *                                                                            *
+ * Comments: Up to DiscovererConcurrency non-blocking connections are kept in *
+ *           flight, each of them is given Timeout seconds to complete.       *
+ *           Only refused, unreachable and timed out connections mean that    *
+ *           the port is closed. A probe failing because of a local error     *
+ *           (for example out of file descriptors) is retried when one of the *
+ *           connections in flight completes. If it fails with no connections *
+ *           in flight the service is marked as unknown and its status is not *
+ *           reported in this cycle.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	discovery_tcp_scan(const zbx_vector_ptr_t *checks, zbx_discovery_host_t *hosts, int hosts_num)
+{
+	const char		*__function_name = "discovery_tcp_scan";
 
-			zabbix_log(LOG_LEVEL_DEBUG, "%s() port:%d", __function_name, port);
+	zbx_discovery_cursor_t		cursor = {checks, 0, 0, 0, hosts_num};
+	zbx_discovery_probe_t		*probes, probe;
+	const zbx_discovery_check_t	*check;
+	zbx_discovery_service_t		*service;
+	struct pollfd			*pfds;
+	char				error[MAX_STRING_LEN];
+	int				probes_num = 0, connected = 0, i, err, ret, retry = FAIL;
+	socklen_t			err_len;
+	double				now;
 
-			service_status = (SUCCEED == discover_service(dcheck, ip, port, &value, &value_alloc) ?
-					DOBJECT_STATUS_UP : DOBJECT_STATUS_DOWN);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts:%d", __function_name, hosts_num);
 
-			/* update host status */
-			if (-1 == *host_status || DOBJECT_STATUS_UP == service_status)
-				*host_status = service_status;
+	probes = (zbx_discovery_probe_t *)zbx_malloc(NULL, sizeof(zbx_discovery_probe_t) *
+			CONFIG_DISCOVERER_CONCURRENCY);
+	pfds = (struct pollfd *)zbx_malloc(NULL, sizeof(struct pollfd) * CONFIG_DISCOVERER_CONCURRENCY);
 
-			DBbegin();
+	while (ZBX_IS_RUNNING())
+	{
+		now = zbx_time();
 
-			if (SUCCEED != DBlock_dcheckid(dcheck->dcheckid, drule->druleid))
+		while (probes_num < CONFIG_DISCOVERER_CONCURRENCY &&
+				(SUCCEED == retry || SUCCEED == discovery_probe_next(&cursor, &probe)))
+		{
+			retry = FAIL;
+			check = (const zbx_discovery_check_t *)checks->values[probe.check_idx];
+
+			if (SUCCEED != (ret = discovery_tcp_connect(hosts[probe.host_idx].ip,
+					(unsigned short)check->ports.values[probe.port_idx], &probe.fd, error,
+					sizeof(error))))
 			{
-				DBrollback();
+				if (NETWORK_ERROR != ret)
+					continue;
 
-				zabbix_log(LOG_LEVEL_DEBUG, "discovery check was deleted during processing, stopping");
+				/* retry the probe when some of the connections in flight complete */
+				if (0 != probes_num)
+				{
+					zabbix_log(LOG_LEVEL_DEBUG, "%s() ip:'%s' port:" ZBX_FS_UI64 " postponing probe: %s",
+							__function_name, hosts[probe.host_idx].ip,
+							check->ports.values[probe.port_idx], error);
+					retry = SUCCEED;
+					break;
+				}
 
-				goto out;
+				zabbix_log(LOG_LEVEL_WARNING, "cannot check port " ZBX_FS_UI64 " of \"%s\", service status"
+						" will not be updated: %s", check->ports.values[probe.port_idx],
+						hosts[probe.host_idx].ip, error);
+
+				service = discovery_host_add_service(&hosts[probe.host_idx], probe.check_idx,
+						probe.port_idx);
+				service->unknown = 1;
+				continue;
 			}
 
-			if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+			probe.deadline = now + CONFIG_TIMEOUT;
+			probes[probes_num] = probe;
+
+			pfds[probes_num].fd = probe.fd;
+			pfds[probes_num].events = POLLOUT;
+			pfds[probes_num].revents = 0;
+			probes_num++;
+		}
+
+		if (0 == probes_num)
+			break;
+
+		if (-1 == poll(pfds, probes_num, ZBX_DISCOVERY_POLL_TIMEOUT) && EINTR != errno)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot wait for discovery connections: %s", zbx_strerror(errno));
+			break;
+		}
+
+		now = zbx_time();
+
+		for (i = 0; i < probes_num;)
+		{
+			if (0 != pfds[i].revents)
 			{
-				discovery_update_service(drule, dcheck->dcheckid, dhost, ip, dns, port, service_status,
-						value, now);
+				err_len = sizeof(err);
+
+				if (0 == getsockopt(probes[i].fd, SOL_SOCKET, SO_ERROR, &err, &err_len) && 0 == err)
+				{
+					discovery_host_add_service(&hosts[probes[i].host_idx], probes[i].check_idx,
+							probes[i].port_idx);
+					connected++;
+				}
 			}
-			else if (0 != (program_type & ZBX_PROGRAM_TYPE_PROXY))
+			else if (probes[i].deadline > now)
 			{
-				proxy_update_service(drule->druleid, dcheck->dcheckid, ip, dns, port, service_status,
-						value, now);
+				i++;
+				continue;
 			}
 
-			DBcommit();
+			close(probes[i].fd);
+
+			probes[i] = probes[--probes_num];
+			pfds[i] = pfds[probes_num];
 		}
+	}
 
-		if (NULL != comma)
+	for (i = 0; i < probes_num; i++)
+		close(probes[i].fd);
+
+	zbx_free(pfds);
+	zbx_free(probes);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() connected:%d", __function_name, connected);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: discovery_ping_hosts                                             *
+ *                                                                            *
+ * Purpose: ping all hosts of the batch with a single fping invocation        *
+ *                                                                            *
+ ******************************************************************************/
+static void	discovery_ping_hosts(int check_idx, const zbx_discovery_check_t *check, zbx_discovery_host_t *hosts,
+		int hosts_num)
+{
+	ZBX_FPING_HOST	*fping_hosts;
+	char		error[ITEM_ERROR_LEN_MAX];
+	int		i, j;
+
+	fping_hosts = (ZBX_FPING_HOST *)zbx_malloc(NULL, sizeof(ZBX_FPING_HOST) * hosts_num);
+	memset(fping_hosts, 0, sizeof(ZBX_FPING_HOST) * hosts_num);
+
+	for (i = 0; i < hosts_num; i++)
+		fping_hosts[i].addr = hosts[i].ip;
+
+	if (SUCCEED != do_ping(fping_hosts, hosts_num, 3, 0, 0, 0, error, sizeof(error)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "discovery: cannot ping hosts: %s", error);
+	}
+	else
+	{
+		for (i = 0; i < hosts_num; i++)
 		{
-			*comma = ',';
-			start = comma + 1;
+			if (0 == fping_hosts[i].rcv)
+				continue;
+
+			for (j = 0; j < check->ports.values_num; j++)
+				discovery_host_add_service(&hosts[i], check_idx, j);
 		}
-		else
-			break;
 	}
-out:
-	zbx_free(value);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+	zbx_free(fping_hosts);
 }
 
 /******************************************************************************
  *                                                                            *
- * Function: process_checks                                                   *
+ * Function: discovery_check_hosts                                            *
+ *                                                                            *
+ * Purpose: find services available on the batch of hosts                     *
+ *                                                                            *
+ * Comments: TCP ports are probed concurrently, the protocol level checks are *
+ *           performed only on the ports accepting connections. SNMP checks   *
+ *           are performed sequentially.                                      *
  *                                                                            *
  ******************************************************************************/
-static void	process_checks(DB_DRULE *drule, DB_DHOST *dhost, int *host_status,
-		char *ip, const char *dns, int unique, int now)
+static void	discovery_check_hosts(const zbx_vector_ptr_t *checks, zbx_discovery_host_t *hosts, int hosts_num)
 {
-	DB_RESULT	result;
-	DB_ROW		row;
-	DB_DCHECK	dcheck;
-	char		sql[MAX_STRING_LEN];
-	size_t		offset = 0;
+	const zbx_discovery_check_t	*check;
+	zbx_discovery_service_t		*service;
+	char				*value;
+	size_t				value_alloc = 128;
+	int				i, j, k;
 
-	offset += zbx_snprintf(sql + offset, sizeof(sql) - offset,
-			"select dcheckid,type,key_,snmp_community,snmpv3_securityname,snmpv3_securitylevel,"
-				"snmpv3_authpassphrase,snmpv3_privpassphrase,snmpv3_authprotocol,snmpv3_privprotocol,"
-				"ports,snmpv3_contextname"
-			" from dchecks"
-			" where druleid=" ZBX_FS_UI64,
-			drule->druleid);
+	value = (char *)zbx_malloc(NULL, value_alloc);
+
+	discovery_tcp_scan(checks, hosts, hosts_num);
 
-	if (0 != drule->unique_dcheckid)
+	/* verify protocols of the services accepting connections */
+	for (i = 0; i < hosts_num; i++)
 	{
-		offset += zbx_snprintf(sql + offset, sizeof(sql) - offset, " and dcheckid%s" ZBX_FS_UI64,
-				unique ? "=" : "<>", drule->unique_dcheckid);
+		for (j = 0; j < hosts[i].services.values_num;)
+		{
+			service = (zbx_discovery_service_t *)hosts[i].services.values[j];
+			check = (const zbx_discovery_check_t *)checks->values[service->check_idx];
+
+			/* TCP check is completed by a successful connection */
+			if (SVC_TCP != check->dcheck.type && 0 == service->unknown)
+			{
+				if (SUCCEED != discover_service(&check->dcheck, hosts[i].ip,
+						(int)check->ports.values[service->port_idx], &value, &value_alloc))
+				{
+					zbx_vector_ptr_remove_noorder(&hosts[i].services, j);
+					discovery_service_free(service);
+					continue;
+				}
+
+				service->value = zbx_strdup(NULL, value);
+			}
+
+			j++;
+		}
 	}
 
-	zbx_snprintf(sql + offset, sizeof(sql) - offset, " order by dcheckid");
+	for (k = 0; k < checks->values_num && ZBX_IS_RUNNING(); k++)
+	{
+		check = (const zbx_discovery_check_t *)checks->values[k];
 
-	result = DBselect("%s", sql);
+		if (SUCCEED == discovery_check_is_tcp(check->dcheck.type))
+			continue;
 
-	while (NULL != (row = DBfetch(result)))
+		if (SVC_ICMPPING == check->dcheck.type)
+		{
+			discovery_ping_hosts(k, check, hosts, hosts_num);
+			continue;
+		}
+
+		for (i = 0; i < hosts_num; i++)
+		{
+			for (j = 0; j < check->ports.values_num; j++)
+			{
+				if (SUCCEED != discover_service(&check->dcheck, hosts[i].ip, (int)check->ports.values[j],
+						&value, &value_alloc))
+				{
+					continue;
+				}
+
+				service = discovery_host_add_service(&hosts[i], k, j);
+				service->value = zbx_strdup(NULL, value);
+			}
+		}
+	}
+
+	for (i = 0; i < hosts_num; i++)
+		zbx_vector_ptr_sort(&hosts[i].services, discovery_service_compare);
+
+	zbx_free(value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: discovery_update_hosts                                           *
+ *                                                                            *
+ * Purpose: update discovered services and hosts in database                  *
+ *                                                                            *
+ * Return value: SUCCEED - the hosts were updated                             *
+ *               FAIL    - the discovery rule was deleted during processing   *
+ *                                                                            *
+ ******************************************************************************/
+static int	discovery_update_hosts(DB_DRULE *drule, const zbx_vector_ptr_t *checks, zbx_discovery_host_t *hosts,
+		int hosts_num)
+{
+	const char			*__function_name = "discovery_update_hosts";
+
+	const zbx_discovery_check_t	*check;
+	const zbx_discovery_service_t	*service;
+	DB_DHOST			dhost;
+	char				dns[INTERFACE_DNS_LEN_MAX];
+	const char			*value;
+	int				i, j, k, host_status, service_status, now, ret = SUCCEED;
+
+	for (i = 0; i < hosts_num; i++)
+	{
+		memset(&dhost, 0, sizeof(dhost));
+		host_status = -1;
+
+		now = time(NULL);
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() ip:'%s'", __function_name, hosts[i].ip);
+
+		zbx_alarm_on(CONFIG_TIMEOUT);
+		zbx_gethost_by_ip(hosts[i].ip, dns, sizeof(dns));
+		zbx_alarm_off();
+
+		/* services are sorted in the same order as checks and ports are iterated */
+		for (k = 0, j = 0; j < checks->values_num; j++)
+		{
+			int	port_idx;
+
+			check = (const zbx_discovery_check_t *)checks->values[j];
+
+			for (port_idx = 0; port_idx < check->ports.values_num; port_idx++)
+			{
+				service = (k < hosts[i].services.values_num ?
+						(const zbx_discovery_service_t *)hosts[i].services.values[k] : NULL);
+
+				if (NULL != service && service->check_idx == j && service->port_idx == port_idx &&
+						0 != service->unknown)
+				{
+					/* the port could not be probed, keep the previous service status */
+					k++;
+					continue;
+				}
+
+				if (NULL != service && service->check_idx == j && service->port_idx == port_idx)
+				{
+					service_status = DOBJECT_STATUS_UP;
+					value = ZBX_NULL2EMPTY_STR(service->value);
+					k++;
+				}
+				else
+				{
+					service_status = DOBJECT_STATUS_DOWN;
+					value = "";
+				}
+
+				/* update host status */
+				if (-1 == host_status || DOBJECT_STATUS_UP == service_status)
+					host_status = service_status;
+
+				DBbegin();
+
+				if (SUCCEED != DBlock_dcheckid(check->dcheck.dcheckid, drule->druleid))
+				{
+					DBrollback();
+
+					zabbix_log(LOG_LEVEL_DEBUG, "discovery check was deleted during processing,"
+							" stopping");
+
+					/* skip the remaining services of the deleted check */
+					while (k < hosts[i].services.values_num && j == ((const zbx_discovery_service_t *)
+							hosts[i].services.values[k])->check_idx)
+					{
+						k++;
+					}
+
+					break;
+				}
+
+				if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+				{
+					discovery_update_service(drule, check->dcheck.dcheckid, &dhost, hosts[i].ip, dns,
+							(int)check->ports.values[port_idx], service_status, value, now);
+				}
+				else if (0 != (program_type & ZBX_PROGRAM_TYPE_PROXY))
+				{
+					proxy_update_service(drule->druleid, check->dcheck.dcheckid, hosts[i].ip, dns,
+							(int)check->ports.values[port_idx], service_status, value, now);
+				}
+
+				DBcommit();
+			}
+		}
+
+		DBbegin();
+
+		if (SUCCEED != DBlock_druleid(drule->druleid))
+		{
+			DBrollback();
+
+			zabbix_log(LOG_LEVEL_DEBUG, "discovery rule '%s' was deleted during processing, stopping",
+					drule->name);
+			ret = FAIL;
+			break;
+		}
+
+		/* host status is not known when none of its services could be probed */
+		if (-1 != host_status)
+		{
+			if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
+				discovery_update_host(&dhost, host_status, now);
+			else if (0 != (program_type & ZBX_PROGRAM_TYPE_PROXY))
+				proxy_update_host(drule->druleid, hosts[i].ip, dns, host_status, now);
+		}
+
+		DBcommit();
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: discovery_process_hosts                                          *
+ *                                                                            *
+ * Purpose: check services on the batch of hosts and update database          *
+ *                                                                            *
+ * Return value: SUCCEED - the hosts were processed                           *
+ *               FAIL    - the discovery rule was deleted during processing   *
+ *                                                                            *
+ ******************************************************************************/
+static int	discovery_process_hosts(DB_DRULE *drule, const zbx_vector_ptr_t *checks, zbx_discovery_host_t *hosts,
+		int hosts_num)
+{
+	int	i, ret;
+
+	discovery_check_hosts(checks, hosts, hosts_num);
+	ret = discovery_update_hosts(drule, checks, hosts, hosts_num);
+
+	for (i = 0; i < hosts_num; i++)
 	{
-		memset(&dcheck, 0, sizeof(dcheck));
-
-		ZBX_STR2UINT64(dcheck.dcheckid, row[0]);
-		dcheck.type = atoi(row[1]);
-		dcheck.key_ = row[2];
-		dcheck.snmp_community = row[3];
-		dcheck.snmpv3_securityname = row[4];
-		dcheck.snmpv3_securitylevel = (unsigned char)atoi(row[5]);
-		dcheck.snmpv3_authpassphrase = row[6];
-		dcheck.snmpv3_privpassphrase = row[7];
-		dcheck.snmpv3_authprotocol = (unsigned char)atoi(row[8]);
-		dcheck.snmpv3_privprotocol = (unsigned char)atoi(row[9]);
-		dcheck.ports = row[10];
-		dcheck.snmpv3_contextname = row[11];
-
-		process_check(drule, &dcheck, dhost, host_status, ip, dns, now);
+		zbx_vector_ptr_clear_ext(&hosts[i].services, (zbx_clean_func_t)discovery_service_free);
+		zbx_vector_ptr_destroy(&hosts[i].services);
 	}
-	DBfree_result(result);
+
+	return ret;
 }
 
 /******************************************************************************
@@ -476,19 +1086,28 @@ static void	process_checks(DB_DRULE *drule, DB_DHOST *dhost, int *host_status,
  *                                                                            *
  * Purpose: process single discovery rule                                     *
  *                                                                            *
+ * Comments: The IP ranges are processed in batches of DiscovererConcurrency  *
+ *           addresses, checks of a batch are performed concurrently.         *
+ *                                                                            *
  ******************************************************************************/
 static void	process_rule(DB_DRULE *drule)
 {
-	const char	*__function_name = "process_rule";
+	const char		*__function_name = "process_rule";
 
-	DB_DHOST	dhost;
-	int		host_status, now;
-	char		ip[INTERFACE_IP_LEN_MAX], *start, *comma, dns[INTERFACE_DNS_LEN_MAX];
-	int		ipaddress[8];
-	zbx_iprange_t	iprange;
+	char			*start, *comma = NULL;
+	int			ipaddress[8], hosts_num = 0;
+	zbx_iprange_t		iprange;
+	zbx_vector_ptr_t	checks;
+	zbx_discovery_host_t	*hosts, *host;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() rule:'%s' range:'%s'", __function_name, drule->name, drule->iprange);
 
+	zbx_vector_ptr_create(&checks);
+	discovery_load_checks(drule, &checks);
+
+	hosts = (zbx_discovery_host_t *)zbx_malloc(NULL, sizeof(zbx_discovery_host_t) *
+			CONFIG_DISCOVERER_CONCURRENCY);
+
 	for (start = drule->iprange; '\0' != *start;)
 	{
 		if (NULL != (comma = strchr(start, ',')))
@@ -521,57 +1140,34 @@ static void	process_rule(DB_DRULE *drule)
 
 		do
 		{
+			host = &hosts[hosts_num];
 #ifdef HAVE_IPV6
 			if (ZBX_IPRANGE_V6 == iprange.type)
 			{
-				zbx_snprintf(ip, sizeof(ip), "%x:%x:%x:%x:%x:%x:%x:%x", (unsigned int)ipaddress[0],
-						(unsigned int)ipaddress[1], (unsigned int)ipaddress[2],
-						(unsigned int)ipaddress[3], (unsigned int)ipaddress[4],
-						(unsigned int)ipaddress[5], (unsigned int)ipaddress[6],
-						(unsigned int)ipaddress[7]);
+				zbx_snprintf(host->ip, sizeof(host->ip), "%x:%x:%x:%x:%x:%x:%x:%x",
+						(unsigned int)ipaddress[0], (unsigned int)ipaddress[1],
+						(unsigned int)ipaddress[2], (unsigned int)ipaddress[3],
+						(unsigned int)ipaddress[4], (unsigned int)ipaddress[5],
+						(unsigned int)ipaddress[6], (unsigned int)ipaddress[7]);
 			}
 			else
 			{
 #endif
-				zbx_snprintf(ip, sizeof(ip), "%u.%u.%u.%u", (unsigned int)ipaddress[0],
+				zbx_snprintf(host->ip, sizeof(host->ip), "%u.%u.%u.%u", (unsigned int)ipaddress[0],
 						(unsigned int)ipaddress[1], (unsigned int)ipaddress[2],
 						(unsigned int)ipaddress[3]);
 #ifdef HAVE_IPV6
 			}
 #endif
-			memset(&dhost, 0, sizeof(dhost));
-			host_status = -1;
-
-			now = time(NULL);
-
-			zabbix_log(LOG_LEVEL_DEBUG, "%s() ip:'%s'", __function_name, ip);
-
-			zbx_alarm_on(CONFIG_TIMEOUT);
-			zbx_gethost_by_ip(ip, dns, sizeof(dns));
-			zbx_alarm_off();
-
-			if (0 != drule->unique_dcheckid)
-				process_checks(drule, &dhost, &host_status, ip, dns, 1, now);
-			process_checks(drule, &dhost, &host_status, ip, dns, 0, now);
-
-			DBbegin();
+			zbx_vector_ptr_create(&host->services);
 
-			if (SUCCEED != DBlock_druleid(drule->druleid))
+			if (CONFIG_DISCOVERER_CONCURRENCY == ++hosts_num)
 			{
-				DBrollback();
+				hosts_num = 0;
 
-				zabbix_log(LOG_LEVEL_DEBUG, "discovery rule '%s' was deleted during processing,"
-						" stopping", drule->name);
-
-				goto out;
+				if (SUCCEED != discovery_process_hosts(drule, &checks, hosts, CONFIG_DISCOVERER_CONCURRENCY))
+					goto out;
 			}
-
-			if (0 != (program_type & ZBX_PROGRAM_TYPE_SERVER))
-				discovery_update_host(&dhost, host_status, now);
-			else if (0 != (program_type & ZBX_PROGRAM_TYPE_PROXY))
-				proxy_update_host(drule->druleid, ip, dns, host_status, now);
-
-			DBcommit();
 		}
 		while (SUCCEED == iprange_next(&iprange, ipaddress));
 next:
@@ -583,7 +1179,18 @@ next:
 		else
 			break;
 	}
+
+	if (0 != hosts_num)
+		discovery_process_hosts(drule, &checks, hosts, hosts_num);
 out:
+	if (NULL != comma)
+		*comma = ',';
+
+	zbx_free(hosts);
+
+	zbx_vector_ptr_clear_ext(&checks, (zbx_clean_func_t)discovery_check_free);
+	zbx_vector_ptr_destroy(&checks);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
@@ -40,6 +40,18 @@ static int	hk_period;
 /* the maximum number of housekeeping periods to be removed per single housekeeping cycle */
 #define HK_MAX_DELETE_PERIODS		4
 
+/* the time range covered by a single history (trends) table partition */
+#define HK_PARTITION_PERIOD		SEC_PER_DAY
+
+/* the number of partitions created ahead of the current time */
+#define HK_PARTITION_PRECREATE		7
+
+/* the interval of checking that partitions exist ahead, independently of the housekeeping frequency */
+#define HK_PARTITION_CHECK_PERIOD	SEC_PER_HOUR
+
+/* set when housekeeping is forced by runtime control command */
+static int	hk_forced = 0;
+
 /* global configuration data containing housekeeping configuration */
 static zbx_config_t	cfg;
 
@@ -150,6 +162,16 @@ typedef struct
 
 	/* the item delete queue */
 	zbx_vector_ptr_t	delete_queue;
+
+	/* the longest storage period of items in the target table, updated during each housekeeping cycle */
+	int			history_max;
+
+	/* 1 if storage period of some items in the target table cannot be determined, 0 otherwise */
+	int			history_unknown;
+
+	/* The records older than this timestamp are removed by dropping partitions of */
+	/* the target table. Zero if the table is not managed in partitioning mode.    */
+	int			partition_clock;
 }
 zbx_hk_history_rule_t;
 
@@ -186,6 +208,7 @@ static void	zbx_housekeeper_sigusr_handler(int flags)
 		if (0 < zbx_sleep_get_remainder())
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "forced execution of the housekeeper");
+			hk_forced = 1;
 			zbx_wakeup();
 		}
 		else
@@ -250,6 +273,10 @@ static void	hk_history_delete_queue_append(zbx_hk_history_rule_t *rule, int now,
 
 	keep_from = now - history;
 
+	/* older records were already removed together with the dropped partitions */
+	if (item_record->min_clock < rule->partition_clock)
+		item_record->min_clock = rule->partition_clock;
+
 	if (keep_from > item_record->min_clock)
 	{
 		zbx_hk_delete_queue_t	*update_record;
@@ -396,6 +423,13 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 	DB_RESULT	result;
 	DB_ROW		row;
 	char		*tmp = NULL;
+	int		i;
+
+	for (i = 0; i < ITEM_VALUE_TYPE_MAX + HK_UPDATE_CACHE_TREND_COUNT; i++)
+	{
+		rules[i].history_max = 0;
+		rules[i].history_unknown = 0;
+	}
 
 	result = DBselect(
 			"select i.itemid,i.value_type,i.history,i.trends,h.hostid"
@@ -427,19 +461,23 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period '%s' for itemid '%s'",
 						tmp, row[0]);
-				continue;
+				rule->history_unknown = 1;
 			}
-
-			if (0 != history && (ZBX_HK_HISTORY_MIN > history || ZBX_HK_PERIOD_MAX < history))
+			else if (0 != history && (ZBX_HK_HISTORY_MIN > history || ZBX_HK_PERIOD_MAX < history))
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period for itemid '%s'", row[0]);
-				continue;
+				rule->history_unknown = 1;
 			}
+			else
+			{
+				if (0 != history && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
+					history = *rule->poption;
 
-			if (0 != history && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
-				history = *rule->poption;
+				if (rule->history_max < history)
+					rule->history_max = history;
 
-			hk_history_item_update(rules, rule, ITEM_VALUE_TYPE_MAX, now, itemid, history);
+				hk_history_item_update(rules, rule, ITEM_VALUE_TYPE_MAX, now, itemid, history);
+			}
 		}
 
 		if (ITEM_VALUE_TYPE_FLOAT == value_type || ITEM_VALUE_TYPE_UINT64 == value_type)
@@ -458,17 +496,22 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period '%s' for itemid '%s'",
 						tmp, row[0]);
+				rule->history_unknown = 1;
 				continue;
 			}
 			else if (0 != trends && (ZBX_HK_TRENDS_MIN > trends || ZBX_HK_PERIOD_MAX < trends))
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period for itemid '%s'", row[0]);
+				rule->history_unknown = 1;
 				continue;
 			}
 
 			if (0 != trends && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
 				trends = *rule->poption;
 
+			if (rule->history_max < trends)
+				rule->history_max = trends;
+
 			hk_history_item_update(rules + HK_UPDATE_CACHE_OFFSET_TREND_FLOAT, rule,
 					HK_UPDATE_CACHE_TREND_COUNT, now, itemid, trends);
 		}
@@ -536,6 +579,402 @@ static void	hk_history_delete_queue_clear(zbx_hk_history_rule_t *rule)
 	zbx_vector_ptr_clear_ext(&rule->delete_queue, zbx_ptr_free);
 }
 
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+/* history (trends) table partition */
+typedef struct
+{
+	char	*name;
+
+	/* the upper (exclusive) partition bound */
+	int	clock_to;
+}
+zbx_hk_partition_t;
+
+static void	hk_partition_free(zbx_hk_partition_t *partition)
+{
+	zbx_free(partition->name);
+	zbx_free(partition);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_get                                                *
+ *                                                                            *
+ * Purpose: reads range partitions of the specified table                     *
+ *                                                                            *
+ * Parameters: table        - [IN] the table name                             *
+ *             partitions   - [OUT] the partitions with numeric upper bounds  *
+ *             unbounded    - [OUT] 1 if the table has a partition without    *
+ *                            upper bound, 0 otherwise                        *
+ *             default_name - [OUT] the name of default partition (must be    *
+ *                            freed by caller) or NULL if there is none       *
+ *                                                                            *
+ * Return value: SUCCEED - the table is partitioned by range                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_get(const char *table, zbx_vector_ptr_t *partitions, int *unbounded,
+		char **default_name)
+{
+	DB_RESULT		result;
+	DB_ROW			row;
+	const char		*bound;
+	zbx_hk_partition_t	*partition;
+	int			ret = FAIL;
+
+	*unbounded = 0;
+	*default_name = NULL;
+
+#if defined(HAVE_POSTGRESQL)
+	result = DBselect(
+			"select c.relname,pg_get_expr(c.relpartbound,c.oid)"
+			" from pg_class p"
+				" join pg_partitioned_table t on t.partrelid=p.oid"
+				" left join pg_inherits i on i.inhparent=p.oid"
+				" left join pg_class c on c.oid=i.inhrelid"
+			" where p.relname='%s'"
+				" and pg_table_is_visible(p.oid)"
+				" and t.partstrat='r'",
+			table);
+#else
+	result = DBselect(
+			"select partition_name,partition_description"
+			" from information_schema.partitions"
+			" where table_schema=database()"
+				" and table_name='%s'"
+				" and partition_method='RANGE'",
+			table);
+#endif
+	while (NULL != (row = DBfetch(result)))
+	{
+		ret = SUCCEED;
+
+		if (NULL == row[0] || NULL == row[1])
+			continue;
+#if defined(HAVE_POSTGRESQL)
+		if (0 == strcmp(row[1], "DEFAULT"))
+		{
+			*default_name = zbx_strdup(*default_name, row[0]);
+			continue;
+		}
+
+		/* the bound expression is in format: FOR VALUES FROM (<clock>) TO (<clock>) */
+		if (NULL == (bound = strstr(row[1], " TO (")))
+			continue;
+
+		bound += ZBX_CONST_STRLEN(" TO (");
+
+		if ('\'' == *bound)
+			bound++;
+#else
+		bound = row[1];
+#endif
+		if (0 == isdigit((unsigned char)*bound))
+		{
+			*unbounded = 1;
+			continue;
+		}
+
+		partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+		partition->name = zbx_strdup(NULL, row[0]);
+		partition->clock_to = atoi(bound);
+		zbx_vector_ptr_append(partitions, partition);
+	}
+	DBfree_result(result);
+
+	return ret;
+}
+
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partition_create_pg                                           *
+ *                                                                            *
+ * Purpose: creates PostgreSQL range partition                                *
+ *                                                                            *
+ * Parameters: table        - [IN] the table name                             *
+ *             name         - [IN] the new partition name                     *
+ *             default_name - [IN] the default partition name, can be NULL    *
+ *             clock_from   - [IN] the lower (inclusive) partition bound      *
+ *             clock_to     - [IN] the upper (exclusive) partition bound      *
+ *                                                                            *
+ * Return value: SUCCEED - the partition was created                          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Partition cannot be created while the default partition holds    *
+ *           records of its range. Such records are moved into the new        *
+ *           partition with the default partition detached, in a single       *
+ *           transaction.                                                     *
+ *           Detaching the default partition takes ACCESS EXCLUSIVE lock on   *
+ *           the parent table, which is held until the records are moved and  *
+ *           the transaction is committed. History syncers cannot write into  *
+ *           the table meanwhile, so the number of moved records is logged to *
+ *           relate such stalls to the housekeeper.                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_create_pg(const char *table, const char *name, const char *default_name,
+		int clock_from, int clock_to)
+{
+	DB_RESULT	result;
+	char		*sql;
+	int		rows = 0;
+
+	if (NULL != default_name)
+	{
+		sql = zbx_dsprintf(NULL, "select null from %s where clock>=%d and clock<%d", default_name, clock_from,
+				clock_to);
+		result = DBselectN(sql, 1);
+		zbx_free(sql);
+
+		if (NULL != DBfetch(result))
+			rows = 1;
+
+		DBfree_result(result);
+	}
+
+	if (0 == rows)
+	{
+		if (ZBX_DB_OK > DBexecute("create table %s partition of %s for values from (%d) to (%d)", name, table,
+				clock_from, clock_to))
+		{
+			return FAIL;
+		}
+
+		return SUCCEED;
+	}
+
+	zabbix_log(LOG_LEVEL_WARNING, "moving records of partition %s of table %s from default partition %s", name,
+			table, default_name);
+
+	DBbegin();
+
+	if (ZBX_DB_OK > DBexecute("alter table %s detach partition %s", table, default_name) ||
+			ZBX_DB_OK > DBexecute("create table %s partition of %s for values from (%d) to (%d)", name,
+					table, clock_from, clock_to) ||
+			ZBX_DB_OK > (rows = DBexecute("insert into %s select * from %s where clock>=%d and clock<%d",
+					name, default_name, clock_from, clock_to)) ||
+			ZBX_DB_OK > DBexecute("delete from %s where clock>=%d and clock<%d", default_name, clock_from,
+					clock_to) ||
+			ZBX_DB_OK > DBexecute("alter table %s attach partition %s default", table, default_name))
+	{
+		DBrollback();
+
+		zabbix_log(LOG_LEVEL_WARNING, "cannot create partition %s of table %s", name, table);
+		return FAIL;
+	}
+
+	if (ZBX_DB_OK != DBcommit())
+		return FAIL;
+
+	zabbix_log(LOG_LEVEL_WARNING, "moved %d records of partition %s of table %s from default partition %s",
+			rows, name, table, default_name);
+
+	return SUCCEED;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_create                                             *
+ *                                                                            *
+ * Purpose: creates partitions ahead of the current time so that new history  *
+ *          (trends) records always have a partition to be written into       *
+ *                                                                            *
+ * Parameters: table        - [IN] the table name                             *
+ *             partitions   - [IN] the existing table partitions              *
+ *             default_name - [IN] the default partition name, can be NULL    *
+ *             now          - [IN] the current timestamp                      *
+ *                                                                            *
+ * Comments: Partitions are created starting from the upper bound of the last *
+ *           existing partition, each covering one period aligned to UTC      *
+ *           midnight.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partitions_create(const char *table, const zbx_vector_ptr_t *partitions, const char *default_name,
+		int now)
+{
+	int		i, clock_from, clock_to, clock_end;
+	char		name[64];
+	time_t		time_from;
+	struct tm	*tm;
+
+	clock_from = now - now % HK_PARTITION_PERIOD;
+	clock_end = clock_from + HK_PARTITION_PRECREATE * HK_PARTITION_PERIOD;
+
+	for (i = 0; i < partitions->values_num; i++)
+	{
+		const zbx_hk_partition_t	*partition = (const zbx_hk_partition_t *)partitions->values[i];
+
+		if (clock_from < partition->clock_to)
+			clock_from = partition->clock_to;
+	}
+
+	for (; clock_from < clock_end; clock_from = clock_to)
+	{
+		clock_to = clock_from - clock_from % HK_PARTITION_PERIOD + HK_PARTITION_PERIOD;
+
+		time_from = clock_from;
+		tm = gmtime(&time_from);
+#if defined(HAVE_POSTGRESQL)
+		zbx_snprintf(name, sizeof(name), "%s_p%04d%02d%02d", table, tm->tm_year + 1900, tm->tm_mon + 1,
+				tm->tm_mday);
+
+		if (SUCCEED != hk_partition_create_pg(table, name, default_name, clock_from, clock_to))
+			break;
+#else
+		ZBX_UNUSED(default_name);
+
+		zbx_snprintf(name, sizeof(name), "p%04d%02d%02d", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+
+		if (ZBX_DB_OK > DBexecute("alter table %s add partition (partition %s values less than (%d))", table,
+				name, clock_to))
+		{
+			break;
+		}
+#endif
+		zabbix_log(LOG_LEVEL_DEBUG, "created partition %s of table %s", name, table);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_partitions_drop                                               *
+ *                                                                            *
+ * Purpose: drops partitions containing only records older than cutoff        *
+ *                                                                            *
+ * Parameters: table      - [IN] the table name                               *
+ *             partitions - [IN] the existing table partitions                *
+ *             cutoff     - [IN] the records older than cutoff can be removed *
+ *                                                                            *
+ * Return value: the number of dropped partitions                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partitions_drop(const char *table, const zbx_vector_ptr_t *partitions, int cutoff)
+{
+	int	i, dropped = 0;
+
+	for (i = 0; i < partitions->values_num; i++)
+	{
+		const zbx_hk_partition_t	*partition = (const zbx_hk_partition_t *)partitions->values[i];
+
+		if (partition->clock_to > cutoff)
+			continue;
+#if defined(HAVE_POSTGRESQL)
+		if (ZBX_DB_OK > DBexecute("drop table %s", partition->name))
+			continue;
+#else
+		if (ZBX_DB_OK > DBexecute("alter table %s drop partition %s", table, partition->name))
+			continue;
+#endif
+		zabbix_log(LOG_LEVEL_WARNING, "dropped partition %s of table %s", partition->name, table);
+		dropped++;
+	}
+
+	return dropped;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_history_partitions_process                                    *
+ *                                                                            *
+ * Purpose: maintains partitions of the history (trends) table referred by    *
+ *          the housekeeping rule                                             *
+ *                                                                            *
+ * Parameters: rule - [IN/OUT] the history housekeeping rule                  *
+ *             now  - [IN] the current timestamp                              *
+ *             drop - [IN] 1 - drop expired partitions, 0 - only create       *
+ *                    partitions ahead                                        *
+ *                                                                            *
+ * Comments: Partitions are created even if housekeeping is disabled for the  *
+ *           table, while expired partitions are dropped only when it is      *
+ *           enabled. Partitions are dropped when all their records are older *
+ *           than the longest item storage period, shorter item storage       *
+ *           periods are handled by the item delete queue. Nothing is dropped *
+ *           if storage period of any item in the table cannot be determined. *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_partitions_process(zbx_hk_history_rule_t *rule, int now, int drop)
+{
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+	const char		*__function_name = "hk_history_partitions_process";
+
+	zbx_vector_ptr_t	partitions;
+	int			unbounded, dropped = 0;
+	char			*default_name;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:%s", __function_name, rule->table);
+
+	/* keep the cutoff of the last housekeeping cycle when only creating partitions */
+	if (0 != drop)
+		rule->partition_clock = 0;
+
+	zbx_vector_ptr_create(&partitions);
+
+	if (SUCCEED == hk_partitions_get(rule->table, &partitions, &unbounded, &default_name))
+	{
+		if (0 == unbounded)
+			hk_partitions_create(rule->table, &partitions, default_name, now);
+		else
+			zabbix_log(LOG_LEVEL_DEBUG, "table %s has unbounded partition", rule->table);
+
+		if (0 != drop && ZBX_HK_OPTION_ENABLED == *rule->poption_mode && 0 != rule->history_max &&
+				now > rule->history_max)
+		{
+			if (0 != rule->history_unknown)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "partitions of table %s are not dropped: storage period"
+						" of some items cannot be determined", rule->table);
+			}
+			else
+			{
+				rule->partition_clock = now - rule->history_max;
+				dropped = hk_partitions_drop(rule->table, &partitions, rule->partition_clock);
+			}
+		}
+
+		zbx_free(default_name);
+	}
+
+	zbx_vector_ptr_clear_ext(&partitions, (zbx_clean_func_t)hk_partition_free);
+	zbx_vector_ptr_destroy(&partitions);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() dropped:%d", __function_name, dropped);
+#else
+	ZBX_UNUSED(rule);
+	ZBX_UNUSED(now);
+	ZBX_UNUSED(drop);
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: hk_history_partitions_create_all                                 *
+ *                                                                            *
+ * Purpose: creates partitions ahead for all history and trends tables        *
+ *                                                                            *
+ * Comments: Called at startup and periodically between housekeeping          *
+ *           cycles, so that the partitions are available regardless of the   *
+ *           housekeeping frequency.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_partitions_create_all(void)
+{
+	zbx_hk_history_rule_t	*rule;
+	int			now;
+
+	zbx_setproctitle("%s [creating history and trends partitions]", get_process_type_string(process_type));
+
+	DBconnect(ZBX_DB_CONNECT_NORMAL);
+
+	now = time(NULL);
+
+	for (rule = hk_history_rules; NULL != rule->table; rule++)
+		hk_history_partitions_process(rule, now, 0);
+
+	DBclose();
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: housekeeping_history_and_trends                                  *
@@ -561,6 +1000,9 @@ static int	housekeeping_history_and_trends(int now)
 
 	for (rule = hk_history_rules; NULL != rule->table; rule++)
 	{
+		if (0 != CONFIG_HOUSEKEEPING_PARTITIONS)
+			hk_history_partitions_process(rule, now, 1);
+
 		if (ZBX_HK_OPTION_DISABLED == *rule->poption_mode)
 			continue;
 
@@ -572,6 +1014,13 @@ static int	housekeeping_history_and_trends(int now)
 		{
 			zbx_hk_delete_queue_t	*item_record = (zbx_hk_delete_queue_t *)rule->delete_queue.values[i];
 
+			/* records close to the partitioning cutoff are removed together with the next partitions */
+			if (0 != rule->partition_clock &&
+					item_record->min_clock <= rule->partition_clock + HK_PARTITION_PERIOD)
+			{
+				continue;
+			}
+
 			rc = DBexecute("delete from %s where itemid=" ZBX_FS_UI64 " and clock<%d",
 					rule->table, item_record->itemid, item_record->min_clock);
 			if (ZBX_DB_OK < rc)
@@ -1035,8 +1484,9 @@ static int	get_housekeeping_period(double time_slept)
 
 ZBX_THREAD_ENTRY(housekeeper_thread, args)
 {
-	int	now, d_history_and_trends, d_cleanup, d_events, d_problems, d_sessions, d_services, d_audit, sleeptime;
-	double	sec, time_slept, time_now;
+	int	now, d_history_and_trends, d_cleanup, d_events, d_problems, d_sessions, d_services, d_audit, sleeptime,
+		hk_next;
+	double	sec, time_slept, time_now, time_last;
 	char	sleeptext[25];
 
 	process_type = ((zbx_thread_args_t *)args)->process_type;
@@ -1048,14 +1498,21 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 
 	update_selfmon_counter(ZBX_PROCESS_STATE_BUSY);
 
+	/* partitions must exist before history syncers write the first values, regardless of startup delay */
+	if (0 != CONFIG_HOUSEKEEPING_PARTITIONS)
+		hk_history_partitions_create_all();
+
+	time_last = zbx_time();
+
 	if (0 == CONFIG_HOUSEKEEPING_FREQUENCY)
 	{
 		zbx_setproctitle("%s [waiting for user command]", get_process_type_string(process_type));
 		zbx_snprintf(sleeptext, sizeof(sleeptext), "waiting for user command");
+		hk_next = 0;
 	}
 	else
 	{
-		sleeptime = HOUSEKEEPER_STARTUP_DELAY * SEC_PER_MIN;
+		hk_next = (int)time_last + HOUSEKEEPER_STARTUP_DELAY * SEC_PER_MIN;
 		zbx_setproctitle("%s [startup idle for %d minutes]", get_process_type_string(process_type),
 				HOUSEKEEPER_STARTUP_DELAY);
 		zbx_snprintf(sleeptext, sizeof(sleeptext), "idle for %d hour(s)", CONFIG_HOUSEKEEPING_FREQUENCY);
@@ -1065,9 +1522,13 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 
 	while (ZBX_IS_RUNNING())
 	{
-		sec = zbx_time();
+		now = time(NULL);
 
-		if (0 == CONFIG_HOUSEKEEPING_FREQUENCY)
+		sleeptime = (hk_next > now ? hk_next - now : 0);
+
+		if (0 != CONFIG_HOUSEKEEPING_PARTITIONS && (0 == hk_next || HK_PARTITION_CHECK_PERIOD < sleeptime))
+			zbx_sleep_loop(HK_PARTITION_CHECK_PERIOD);
+		else if (0 == hk_next)
 			zbx_sleep_forever();
 		else
 			zbx_sleep_loop(sleeptime);
@@ -1076,9 +1537,22 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 			break;
 
 		time_now = zbx_time();
-		time_slept = time_now - sec;
 		zbx_update_env(time_now);
 
+		if (0 == hk_forced && (0 == hk_next || hk_next > (int)time_now))
+		{
+			if (0 != CONFIG_HOUSEKEEPING_PARTITIONS)
+				hk_history_partitions_create_all();
+
+			zbx_setproctitle("%s [%s]", get_process_type_string(process_type), sleeptext);
+			continue;
+		}
+
+		hk_forced = 0;
+
+		/* the housekeeping period is measured from the previous housekeeping, not from the last wakeup */
+		time_slept = time_now - time_last;
+
 		hk_period = get_housekeeping_period(time_slept);
 
 		zabbix_log(LOG_LEVEL_WARNING, "executing housekeeper");
@@ -1133,8 +1607,10 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 				get_process_type_string(process_type), d_history_and_trends, d_cleanup, d_events,
 				d_sessions, d_services, d_audit, sec, sleeptext);
 
+		time_last = zbx_time();
+
 		if (0 != CONFIG_HOUSEKEEPING_FREQUENCY)
-			sleeptime = CONFIG_HOUSEKEEPING_FREQUENCY * SEC_PER_HOUR;
+			hk_next = (int)time_last + CONFIG_HOUSEKEEPING_FREQUENCY * SEC_PER_HOUR;
 	}
 
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
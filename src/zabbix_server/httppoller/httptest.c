@@ -84,6 +84,49 @@ static size_t	HEADERFUNCTION2(void *ptr, size_t size, size_t nmemb, void *userda
 	return size * nmemb;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: httptest_get_share                                               *
+ *                                                                            *
+ * Purpose: get cURL share handle used by all web scenarios of the process    *
+ *                                                                            *
+ * Return value: the share handle or NULL if it cannot be initialized         *
+ *                                                                            *
+ * Comments: Only DNS cache is shared. Connections and TLS sessions are not   *
+ *           shared, because they carry state established by another          *
+ *           scenario (authentication, client certificate, proxy) and must    *
+ *           not be reused by scenarios with different settings. Cookies are  *
+ *           not shared for the same reason.                                  *
+ *                                                                            *
+ ******************************************************************************/
+static CURLSH	*httptest_get_share(void)
+{
+	static CURLSH	*share = NULL;
+	static int	initialized = 0;
+
+	if (0 != initialized)
+		return share;
+
+	initialized = 1;
+
+	if (NULL == (share = curl_share_init()))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize cURL share handle, web scenarios will not share"
+				" DNS cache");
+		return NULL;
+	}
+
+	if (CURLSHE_OK != curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot set cURL share options, web scenarios will not share"
+				" DNS cache");
+		curl_share_cleanup(share);
+		share = NULL;
+	}
+
+	return share;
+}
+
 #endif	/* HAVE_LIBCURL */
 
 /******************************************************************************
@@ -658,6 +701,7 @@ static void	process_httptest(DC_HOST *host, zbx_httptest_t *httptest)
 	zbx_httpstat_t	stat;
 	char		errbuf[CURL_ERROR_SIZE];
 	CURL		*easyhandle = NULL;
+	CURLSH		*share;
 	CURLcode	err;
 	zbx_httpstep_t	httpstep;
 #endif
@@ -696,6 +740,13 @@ static void	process_httptest(DC_HOST *host, zbx_httptest_t *httptest)
 		goto clean;
 	}
 
+	if (NULL != (share = httptest_get_share()) &&
+			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_SHARE, share)))
+	{
+		err_str = zbx_strdup(err_str, curl_easy_strerror(err));
+		goto clean;
+	}
+
 	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_PROXY, httptest->httptest.http_proxy)) ||
 			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_COOKIEFILE, "")) ||
 			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_USERAGENT, httptest->httptest.agent)) ||
@@ -66,6 +66,9 @@ typedef struct
 	int			type;		/* "Sensor Type Code", e.g. Temperature, Voltage, */
 						/* Current, Fan, Physical Security (Chassis Intrusion), etc. */
 	char			*full_name;
+	int			reading;	/* reading was requested and the callback has not been called yet */
+	int			ret;		/* result of the last reading */
+	char			*err;		/* error message of the last failed reading */
 }
 zbx_ipmi_sensor_t;
 
@@ -95,6 +98,7 @@ typedef struct zbx_ipmi_host
 	ipmi_con_t		*con;
 	int			domain_up;
 	int			done;
+	int			pending;	/* number of sensor readings in progress */
 	time_t			lastaccess;	/* Time of last access attempt. Used to detect and delete inactive */
 						/* (disabled) IPMI hosts from OpenIPMI to stop polling them. */
 	unsigned int		domain_nr;	/* Domain number. It is converted to text string and used as */
@@ -363,6 +367,9 @@ static zbx_ipmi_sensor_t	*zbx_allocate_ipmi_sensor(zbx_ipmi_host_t *h, ipmi_sens
 	memset(&s->value, 0, sizeof(s->value));
 	s->reading_type = ipmi_sensor_get_event_reading_type(sensor);
 	s->type = ipmi_sensor_get_sensor_type(sensor);
+	s->reading = 0;
+	s->ret = SUCCEED;
+	s->err = NULL;
 
 	ipmi_sensor_get_name(s->sensor, full_name, sizeof(full_name));
 	s->full_name = zbx_strdup(NULL, full_name + get_domain_offset(h, full_name));
@@ -400,6 +407,11 @@ static void	zbx_delete_ipmi_sensor(zbx_ipmi_host_t *h, const ipmi_sensor_t *sens
 				h->sensors[i].id_sz), h->ip, h->port);
 
 		zbx_free(h->sensors[i].full_name);
+		zbx_free(h->sensors[i].err);
+
+		/* the reading callback will not find the sensor, stop waiting for it */
+		if (0 != h->sensors[i].reading && 0 < h->pending && 0 == --h->pending)
+			h->done = 1;
 
 		h->sensor_count--;
 		if (h->sensor_count != i)
@@ -554,6 +566,25 @@ static void	zbx_delete_ipmi_control(zbx_ipmi_host_t *h, const ipmi_control_t *co
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_finish_ipmi_reading                                          *
+ *                                                                            *
+ * Purpose: mark sensor reading as finished and stop processing OpenIPMI      *
+ *          events when no more readings of the host are pending              *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_finish_ipmi_reading(zbx_ipmi_host_t *h, zbx_ipmi_sensor_t *s)
+{
+	if (0 == s->reading)
+		return;
+
+	s->reading = 0;
+
+	if (0 < h->pending && 0 == --h->pending)
+		h->done = 1;
+}
+
 /* callback function invoked from OpenIPMI */
 static void	zbx_got_thresh_reading_cb(ipmi_sensor_t *sensor, int err, enum ipmi_value_present_e value_present,
 		unsigned int raw_value, double val, ipmi_states_t *states, void *cb_data)
@@ -569,29 +600,26 @@ static void	zbx_got_thresh_reading_cb(ipmi_sensor_t *sensor, int err, enum ipmi_
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
+	/* the sensor might have been deleted while the reading was in progress */
+	if (NULL == (s = zbx_get_ipmi_sensor(h, sensor)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "End of %s(): sensor not found", __function_name);
+		return;
+	}
+
 	if (0 != err)
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() fail: %s", __function_name, zbx_strerror(err));
 
-		h->err = zbx_dsprintf(h->err, "error 0x%x while reading threshold sensor", (unsigned int)err);
-		h->ret = NOTSUPPORTED;
+		s->err = zbx_dsprintf(s->err, "error 0x%x while reading threshold sensor", (unsigned int)err);
+		s->ret = NOTSUPPORTED;
 		goto out;
 	}
 
 	if (0 == ipmi_is_sensor_scanning_enabled(states) || 0 != ipmi_is_initial_update_in_progress(states))
 	{
-		h->err = zbx_strdup(h->err, "sensor data is not available");
-		h->ret = NOTSUPPORTED;
-		goto out;
-	}
-
-	s = zbx_get_ipmi_sensor(h, sensor);
-
-	if (NULL == s)
-	{
-		THIS_SHOULD_NEVER_HAPPEN;
-		h->err = zbx_strdup(h->err, "fatal error");
-		h->ret = NOTSUPPORTED;
+		s->err = zbx_strdup(s->err, "sensor data is not available");
+		s->ret = NOTSUPPORTED;
 		goto out;
 	}
 
@@ -599,8 +627,8 @@ static void	zbx_got_thresh_reading_cb(ipmi_sensor_t *sensor, int err, enum ipmi_
 	{
 		case IPMI_NO_VALUES_PRESENT:
 		case IPMI_RAW_VALUE_PRESENT:
-			h->err = zbx_strdup(h->err, "no value present for threshold sensor");
-			h->ret = NOTSUPPORTED;
+			s->err = zbx_strdup(s->err, "no value present for threshold sensor");
+			s->ret = NOTSUPPORTED;
 			break;
 		case IPMI_BOTH_VALUES_PRESENT:
 			s->value.threshold = val;
@@ -645,9 +673,9 @@ static void	zbx_got_thresh_reading_cb(ipmi_sensor_t *sensor, int err, enum ipmi_
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 out:
-	h->done = 1;
+	zbx_finish_ipmi_reading(h, s);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(h->ret));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(s->ret));
 }
 
 /* callback function invoked from OpenIPMI */
@@ -663,30 +691,27 @@ static void	zbx_got_discrete_states_cb(ipmi_sensor_t *sensor, int err, ipmi_stat
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
-	if (0 == ipmi_is_sensor_scanning_enabled(states) || 0 != ipmi_is_initial_update_in_progress(states))
+	/* the sensor might have been deleted while the reading was in progress */
+	if (NULL == (s = zbx_get_ipmi_sensor(h, sensor)))
 	{
-		h->err = zbx_strdup(h->err, "sensor data is not available");
-		h->ret = NOTSUPPORTED;
-		goto out;
+		zabbix_log(LOG_LEVEL_DEBUG, "End of %s(): sensor not found", __function_name);
+		return;
 	}
 
-	s = zbx_get_ipmi_sensor(h, sensor);
-
-	if (NULL == s)
+	if (0 == ipmi_is_sensor_scanning_enabled(states) || 0 != ipmi_is_initial_update_in_progress(states))
 	{
-		THIS_SHOULD_NEVER_HAPPEN;
-		h->err = zbx_strdup(h->err, "fatal error");
-		h->ret = NOTSUPPORTED;
+		s->err = zbx_strdup(s->err, "sensor data is not available");
+		s->ret = NOTSUPPORTED;
 		goto out;
 	}
 
 	if (0 != err)
 	{
-		h->err = zbx_dsprintf(h->err, "error 0x%x while reading a discrete sensor %s@[%s]:%d",
+		s->err = zbx_dsprintf(s->err, "error 0x%x while reading a discrete sensor %s@[%s]:%d",
 				(unsigned int)err,
 				zbx_sensor_id_to_str(id_str, sizeof(id_str), s->id, s->id_type, s->id_sz), h->ip,
 				h->port);
-		h->ret = NOTSUPPORTED;
+		s->ret = NOTSUPPORTED;
 		goto out;
 	}
 
@@ -714,9 +739,9 @@ static void	zbx_got_discrete_states_cb(ipmi_sensor_t *sensor, int err, ipmi_stat
 	}
 #undef MAX_DISCRETE_STATES
 out:
-	h->done = 1;
+	zbx_finish_ipmi_reading(h, s);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(h->ret));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(s->ret));
 }
 
 /******************************************************************************
@@ -805,32 +830,54 @@ void	zbx_perform_all_openipmi_ops(int timeout)
 	}
 }
 
-static void	zbx_read_ipmi_sensor(zbx_ipmi_host_t *h, const zbx_ipmi_sensor_t *s)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_request_ipmi_sensor_reading                                  *
+ *                                                                            *
+ * Purpose: send sensor reading request without waiting for the response     *
+ *                                                                            *
+ * Parameters: h - [IN] the host                                              *
+ *             s - [IN] the sensor to read                                    *
+ *                                                                            *
+ * Comments: The result is stored in the sensor by reading callback. The      *
+ *           sensor pointer must not be used after this call because sensor   *
+ *           array can be reallocated if the domain changes.                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_request_ipmi_sensor_reading(zbx_ipmi_host_t *h, zbx_ipmi_sensor_t *s)
 {
-	const char	*__function_name = "zbx_read_ipmi_sensor";
+	const char	*__function_name = "zbx_request_ipmi_sensor_reading";
 	char		id_str[2 * IPMI_SENSOR_ID_SZ + 1];
 	int		ret;
 	const char	*s_reading_type_string;
+	ipmi_sensor_t	*sensor = s->sensor;
 
 	/* copy sensor details at start - it can go away and we won't be able to make an error message */
 	zbx_sensor_id_to_str(id_str, sizeof(id_str), s->id, s->id_type, s->id_sz);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() sensor:'%s@[%s]:%d'", __function_name, id_str, h->ip, h->port);
 
-	h->ret = SUCCEED;
-	h->done = 0;
+	s->ret = SUCCEED;
+
+	/* mark the reading as pending before the request, the callback might be called immediately */
+	s->reading = 1;
+	h->pending++;
 
 	switch (s->reading_type)
 	{
 		case IPMI_EVENT_READING_TYPE_THRESHOLD:
-			if (0 != (ret = ipmi_sensor_get_reading(s->sensor, zbx_got_thresh_reading_cb, h)))
+			if (0 != (ret = ipmi_sensor_get_reading(sensor, zbx_got_thresh_reading_cb, h)))
 			{
 				/* do not use pointer to sensor here - the sensor may have disappeared during */
 				/* ipmi_sensor_get_reading(), as domain might be closed due to communication failure */
-				h->err = zbx_dsprintf(h->err, "Cannot read sensor \"%s\"."
-						" ipmi_sensor_get_reading() return error: 0x%x", id_str,
-						(unsigned int)ret);
-				h->ret = NOTSUPPORTED;
+				if (NULL != (s = zbx_get_ipmi_sensor(h, sensor)))
+				{
+					s->err = zbx_dsprintf(s->err, "Cannot read sensor \"%s\"."
+							" ipmi_sensor_get_reading() return error: 0x%x", id_str,
+							(unsigned int)ret);
+					s->ret = NOTSUPPORTED;
+					zbx_finish_ipmi_reading(h, s);
+				}
 				goto out;
 			}
 			break;
@@ -862,29 +909,32 @@ static void	zbx_read_ipmi_sensor(zbx_ipmi_host_t *h, const zbx_ipmi_sensor_t *s)
 		case 0x7d:
 		case 0x7e:
 		case 0x7f:
-			if (0 != (ret = ipmi_sensor_get_states(s->sensor, zbx_got_discrete_states_cb, h)))
+			if (0 != (ret = ipmi_sensor_get_states(sensor, zbx_got_discrete_states_cb, h)))
 			{
 				/* do not use pointer to sensor here - the sensor may have disappeared during */
 				/* ipmi_sensor_get_states(), as domain might be closed due to communication failure */
-				h->err = zbx_dsprintf(h->err, "Cannot read sensor \"%s\"."
-						" ipmi_sensor_get_states() return error: 0x%x", id_str,
-						(unsigned int)ret);
-				h->ret = NOTSUPPORTED;
+				if (NULL != (s = zbx_get_ipmi_sensor(h, sensor)))
+				{
+					s->err = zbx_dsprintf(s->err, "Cannot read sensor \"%s\"."
+							" ipmi_sensor_get_states() return error: 0x%x", id_str,
+							(unsigned int)ret);
+					s->ret = NOTSUPPORTED;
+					zbx_finish_ipmi_reading(h, s);
+				}
 				goto out;
 			}
 			break;
 		default:
-			s_reading_type_string = ipmi_sensor_get_event_reading_type_string(s->sensor);
+			s_reading_type_string = ipmi_sensor_get_event_reading_type_string(sensor);
 
-			h->err = zbx_dsprintf(h->err, "Cannot read sensor \"%s\"."
+			s->err = zbx_dsprintf(s->err, "Cannot read sensor \"%s\"."
 					" IPMI reading type \"%s\" is not supported", id_str, s_reading_type_string);
-			h->ret = NOTSUPPORTED;
+			s->ret = NOTSUPPORTED;
+			zbx_finish_ipmi_reading(h, s);
 			goto out;
 	}
-
-	zbx_perform_openipmi_ops(h, __function_name);	/* ignore returned result */
 out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(h->ret));
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() pending:%d", __function_name, h->pending);
 }
 
 /* callback function invoked from OpenIPMI */
@@ -1299,6 +1349,9 @@ static void	zbx_free_ipmi_host(zbx_ipmi_host_t *h)
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'[%s]:%d' h:%p", __function_name, h->ip, h->port, (void *)h);
 
+	for (i = 0; i < h->sensor_count; i++)
+		zbx_free(h->sensors[i].err);
+
 	for (i = 0; i < h->control_count; i++)
 	{
 		zbx_free(h->controls[i].c_name);
@@ -1584,27 +1637,25 @@ static int	has_name_prefix(const char *str, size_t *prefix_len)
 #undef ZBX_NAME_PREFIX
 }
 
-int	get_value_ipmi(zbx_uint64_t itemid, const char *addr, unsigned short port, signed char authtype,
-		unsigned char privilege, const char *username, const char *password, const char *sensor, char **value)
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_get_ipmi_value                                               *
+ *                                                                            *
+ * Purpose: get value of a sensor read by get_values_ipmi() or read control   *
+ *                                                                            *
+ * Parameters: h      - [IN] the host                                         *
+ *             sensor - [IN] the sensor or control name, optionally prefixed  *
+ *             value  - [OUT] the value or error message                      *
+ *                                                                            *
+ * Return value: SUCCEED or the error code                                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_get_ipmi_value(zbx_ipmi_host_t *h, const char *sensor, char **value)
 {
-	const char		*__function_name = "get_value_ipmi";
-	zbx_ipmi_host_t		*h;
 	zbx_ipmi_sensor_t	*s;
 	zbx_ipmi_control_t	*c = NULL;
 	size_t			offset;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64, __function_name, itemid);
-
-	if (NULL == os_hnd)
-	{
-		*value = zbx_strdup(*value, "IPMI handler is not initialised.");
-		return CONFIG_ERROR;
-	}
-
-	h = zbx_init_ipmi_host(addr, port, authtype, privilege, username, password);
-
-	h->lastaccess = time(NULL);
-
 	if (0 == h->domain_up)
 	{
 		if (NULL != h->err)
@@ -1631,9 +1682,31 @@ int	get_value_ipmi(zbx_uint64_t itemid, const char *addr, unsigned short port, s
 	}
 
 	if (NULL != s)
-		zbx_read_ipmi_sensor(h, s);
-	else
-		zbx_read_ipmi_control(h, c);
+	{
+		if (0 != s->reading)
+		{
+			*value = zbx_dsprintf(*value, "no response to sensor %s@[%s]:%d reading request", sensor,
+					h->ip, h->port);
+			return NOTSUPPORTED;
+		}
+
+		if (SUCCEED != s->ret)
+		{
+			if (NULL != s->err)
+				*value = zbx_strdup(*value, s->err);
+
+			return s->ret;
+		}
+
+		if (IPMI_EVENT_READING_TYPE_THRESHOLD == s->reading_type)
+			*value = zbx_dsprintf(*value, ZBX_FS_DBL, s->value.threshold);
+		else
+			*value = zbx_dsprintf(*value, ZBX_FS_UI64, s->value.discrete);
+
+		return SUCCEED;
+	}
+
+	zbx_read_ipmi_control(h, c);
 
 	if (h->ret != SUCCEED)
 	{
@@ -1643,21 +1716,89 @@ int	get_value_ipmi(zbx_uint64_t itemid, const char *addr, unsigned short port, s
 		return h->ret;
 	}
 
-	if (NULL != s)
+	*value = zbx_dsprintf(*value, "%d", c->val[0]);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: get_values_ipmi                                                  *
+ *                                                                            *
+ * Purpose: get values of multiple sensors of the same host                   *
+ *                                                                            *
+ * Parameters: addr, port, authtype, privilege, username, password - [IN]     *
+ *                          the host connection parameters                    *
+ *             sensors     - [IN] the sensor or control names                 *
+ *             sensors_num - [IN] the number of sensors                       *
+ *             errcodes    - [OUT] the result codes                           *
+ *             values      - [OUT] the values or error messages, must be      *
+ *                                 initialized with NULLs                     *
+ *                                                                            *
+ * Comments: Reading requests of all sensors are sent at once and OpenIPMI    *
+ *           pipelines them over the host session, so the time to poll a host *
+ *           does not grow with one round trip per sensor. Sensor data        *
+ *           repository is read when the domain is opened and kept as long    *
+ *           as the host is polled.                                           *
+ *                                                                            *
+ ******************************************************************************/
+void	get_values_ipmi(const char *addr, unsigned short port, signed char authtype, unsigned char privilege,
+		const char *username, const char *password, const char **sensors, int sensors_num, int *errcodes,
+		char **values)
+{
+	const char		*__function_name = "get_values_ipmi";
+	zbx_ipmi_host_t		*h;
+	zbx_ipmi_sensor_t	*s;
+	size_t			offset;
+	int			i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() host:'[%s]:%d' sensors:%d", __function_name, addr, (int)port,
+			sensors_num);
+
+	if (NULL == os_hnd)
 	{
-		if (IPMI_EVENT_READING_TYPE_THRESHOLD == s->reading_type)
-			*value = zbx_dsprintf(*value, ZBX_FS_DBL, s->value.threshold);
-		else
-			*value = zbx_dsprintf(*value, ZBX_FS_UI64, s->value.discrete);
+		for (i = 0; i < sensors_num; i++)
+		{
+			values[i] = zbx_strdup(values[i], "IPMI handler is not initialised.");
+			errcodes[i] = CONFIG_ERROR;
+		}
+
+		goto out;
 	}
 
-	if (NULL != c)
-		*value = zbx_dsprintf(*value, "%d", c->val[0]);
+	h = zbx_init_ipmi_host(addr, port, authtype, privilege, username, password);
+
+	h->lastaccess = time(NULL);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s value:%s", __function_name, zbx_result_string(h->ret),
-			ZBX_NULL2EMPTY_STR(*value));
+	if (1 == h->domain_up)
+	{
+		/* readings left unanswered by the previous poll are still expected to arrive */
+		for (h->pending = 0, i = 0; i < h->sensor_count; i++)
+			h->pending += h->sensors[i].reading;
 
-	return h->ret;
+		for (i = 0; i < sensors_num; i++)
+		{
+			if (0 == has_name_prefix(sensors[i], &offset))
+				s = zbx_get_ipmi_sensor_by_id(h, sensors[i] + offset);
+			else
+				s = zbx_get_ipmi_sensor_by_full_name(h, sensors[i] + offset);
+
+			/* the same sensor can be requested by multiple items */
+			if (NULL != s && 0 == s->reading)
+				zbx_request_ipmi_sensor_reading(h, s);
+		}
+
+		if (0 != h->pending && 1 == h->domain_up)
+		{
+			h->done = 0;
+			zbx_perform_openipmi_ops(h, __function_name);	/* ignore returned result */
+		}
+	}
+
+	for (i = 0; i < sensors_num; i++)
+		errcodes[i] = zbx_get_ipmi_value(h, sensors[i], &values[i]);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 
 /* function 'zbx_parse_ipmi_command' requires 'c_name' with size 'ITEM_IPMI_SENSOR_LEN_MAX' */
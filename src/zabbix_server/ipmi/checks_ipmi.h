@@ -30,8 +30,9 @@
 int	zbx_init_ipmi_handler(void);
 void	zbx_free_ipmi_handler(void);
 
-int	get_value_ipmi(zbx_uint64_t itemid, const char *addr, unsigned short port, signed char authtype,
-		unsigned char privilege, const char *username, const char *password, const char *sensor, char **value);
+void	get_values_ipmi(const char *addr, unsigned short port, signed char authtype, unsigned char privilege,
+		const char *username, const char *password, const char **sensors, int sensors_num, int *errcodes,
+		char **values);
 
 int	zbx_parse_ipmi_command(const char *command, char *c_name, int *val, char *error, size_t max_error_len);
 
@@ -60,11 +60,14 @@ typedef struct
 	/* target host id */
 	zbx_uint64_t		hostid;
 
-	/* itemid, set for value requests */
-	zbx_uint64_t		itemid;
+	/* identifiers of the items polled by value request, all belonging to the target host */
+	zbx_uint64_t		*itemids;
 
-	/* the current item state (supported/unsupported) */
-	unsigned char		item_state;
+	/* the current item states (supported/unsupported) */
+	unsigned char		*item_states;
+
+	/* the number of items polled by value request */
+	int			items_num;
 
 	/* the request message */
 	zbx_ipc_message_t	message;
@@ -217,6 +220,8 @@ static zbx_ipmi_request_t	*ipmi_request_create(zbx_uint64_t hostid)
 static void	ipmi_request_free(zbx_ipmi_request_t *request)
 {
 	zbx_ipc_message_clean(&request->message);
+	zbx_free(request->itemids);
+	zbx_free(request->item_states);
 	zbx_free(request);
 }
 
@@ -584,7 +589,7 @@ static void	ipmi_manager_process_poller_queue(zbx_ipmi_manager_t *manager, zbx_i
 				}
 				if (now < host->disable_until)
 				{
-					zbx_dc_requeue_unreachable_items(&request->itemid, 1);
+					zbx_dc_requeue_unreachable_items(request->itemids, request->items_num);
 					ipmi_request_free(request);
 					continue;
 				}
@@ -706,108 +711,162 @@ static void	ipmi_manager_deactivate_host(zbx_ipmi_manager_t *manager, zbx_uint64
  *                                                                            *
  * Function: ipmi_manager_process_value_result                                *
  *                                                                            *
- * Purpose: processes IPMI check result received from IPMI poller             *
+ * Purpose: processes IPMI check results received from IPMI poller           *
  *                                                                            *
  * Parameters: manager   - [IN] the IPMI manager                              *
  *             client    - [IN] the client (IPMI poller)                      *
  *             message   - [IN] the received ZBX_IPC_IPMI_VALUE_RESULT message*
  *             now       - [IN] the current time                              *
  *                                                                            *
+ * Return value: The number of received values.                               *
+ *                                                                            *
  ******************************************************************************/
-static void	ipmi_manager_process_value_result(zbx_ipmi_manager_t *manager, zbx_ipc_client_t *client,
+static int	ipmi_manager_process_value_result(zbx_ipmi_manager_t *manager, zbx_ipc_client_t *client,
 		zbx_ipc_message_t *message, int now)
 {
-	char			*value;
+	char			**values;
 	zbx_timespec_t		ts;
-	unsigned char		state;
-	int			errcode;
+	unsigned char		*states;
+	int			i, values_num, *errcodes, *lastclocks, activate = -1, deactivate = -1;
 	AGENT_RESULT		result;
 	zbx_ipmi_poller_t	*poller;
-	zbx_uint64_t		itemid;
+	zbx_ipmi_request_t	*request;
 
 	if (NULL == (poller = ipmi_manager_get_poller_by_client(manager, client)))
 	{
 		THIS_SHOULD_NEVER_HAPPEN;
-		return;
+		return 0;
 	}
-	itemid = poller->request->itemid;
+	request = poller->request;
 
-	zbx_ipmi_deserialize_result(message->data, &ts, &errcode, &value);
+	zbx_ipmi_deserialize_value_result(message->data, &ts, &errcodes, &values, &values_num);
+
+	if (values_num != request->items_num)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		values_num = MIN(values_num, request->items_num);
+	}
 
-	/* update host availability */
-	switch (errcode)
+	/* update host availability, all items of the request belong to the same host */
+	for (i = 0; i < values_num; i++)
 	{
-		case SUCCEED:
-		case NOTSUPPORTED:
-		case AGENT_ERROR:
-			ipmi_manager_activate_host(manager, itemid, &ts);
-			break;
-		case NETWORK_ERROR:
-		case GATEWAY_ERROR:
-		case TIMEOUT_ERROR:
-			ipmi_manager_deactivate_host(manager, itemid, &ts, value);
-			break;
-		case CONFIG_ERROR:
-			/* nothing to do */
-			break;
+		switch (errcodes[i])
+		{
+			case SUCCEED:
+			case NOTSUPPORTED:
+			case AGENT_ERROR:
+				if (-1 == activate)
+					activate = i;
+				break;
+			case NETWORK_ERROR:
+			case GATEWAY_ERROR:
+			case TIMEOUT_ERROR:
+				if (-1 == deactivate)
+					deactivate = i;
+				break;
+			case CONFIG_ERROR:
+				/* nothing to do */
+				break;
+		}
 	}
 
+	if (-1 != deactivate)
+		ipmi_manager_deactivate_host(manager, request->itemids[deactivate], &ts, values[deactivate]);
+	else if (-1 != activate)
+		ipmi_manager_activate_host(manager, request->itemids[activate], &ts);
+
+	states = (unsigned char *)zbx_malloc(NULL, sizeof(unsigned char) * values_num);
+	lastclocks = (int *)zbx_malloc(NULL, sizeof(int) * values_num);
+
 	/* add received data to history cache */
-	switch (errcode)
+	for (i = 0; i < values_num; i++)
 	{
-		case SUCCEED:
-			state = ITEM_STATE_NORMAL;
-			if (NULL != value)
-			{
-				init_result(&result);
-				SET_TEXT_RESULT(&result, value);
-				value = NULL;
-				zbx_preprocess_item_value(itemid, ITEM_VALUE_TYPE_TEXT, 0, &result, &ts, state, NULL);
-				free_result(&result);
-			}
-			break;
-
-		case NOTSUPPORTED:
-		case AGENT_ERROR:
-		case CONFIG_ERROR:
-			state = ITEM_STATE_NOTSUPPORTED;
-			zbx_preprocess_item_value(itemid, ITEM_VALUE_TYPE_TEXT, 0, NULL, &ts, state, value);
-			break;
-		default:
-			/* don't change item's state when network related error occurs */
-			state = poller->request->item_state;
+		switch (errcodes[i])
+		{
+			case SUCCEED:
+				states[i] = ITEM_STATE_NORMAL;
+				if (NULL != values[i])
+				{
+					init_result(&result);
+					SET_TEXT_RESULT(&result, values[i]);
+					values[i] = NULL;
+					zbx_preprocess_item_value(request->itemids[i], ITEM_VALUE_TYPE_TEXT, 0, &result,
+							&ts, states[i], NULL);
+					free_result(&result);
+				}
+				break;
+
+			case NOTSUPPORTED:
+			case AGENT_ERROR:
+			case CONFIG_ERROR:
+				states[i] = ITEM_STATE_NOTSUPPORTED;
+				zbx_preprocess_item_value(request->itemids[i], ITEM_VALUE_TYPE_TEXT, 0, NULL, &ts,
+						states[i], values[i]);
+				break;
+			default:
+				/* don't change item's state when network related error occurs */
+				states[i] = request->item_states[i];
+		}
+
+		lastclocks[i] = ts.sec;
+		zbx_free(values[i]);
 	}
 
-	zbx_free(value);
+	/* put back the items in configuration cache IPMI poller queue */
+	DCrequeue_items(request->itemids, states, lastclocks, errcodes, values_num);
 
-	/* put back the item in configuration cache IPMI poller queue */
-	DCrequeue_items(&itemid, &state, &ts.sec, &errcode, 1);
+	zbx_free(lastclocks);
+	zbx_free(states);
+	zbx_free(values);
+	zbx_free(errcodes);
 
 	ipmi_poller_free_request(poller);
 	ipmi_manager_process_poller_queue(manager, poller, now);
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Function: ipmi_manager_serialize_request                                   *
+ * Function: ipmi_manager_create_value_request                                *
  *                                                                            *
- * Purpose: serializes IPMI poll request (ZBX_IPC_IPMI_VALUE_REQUEST)         *
+ * Purpose: creates IPMI poll request (ZBX_IPC_IPMI_VALUE_REQUEST) for all    *
+ *          sensors of a host due for polling                                 *
  *                                                                            *
- * Parameters: item      - [IN] the item to poll                              *
- *             command   - [IN] the command to execute                        *
- *             message   - [OUT] the message                                  *
+ * Parameters: items     - [IN] the items to poll, all with the same interface*
+ *             items_num - [IN] the number of items                           *
+ *                                                                            *
+ * Return value: The created request.                                         *
  *                                                                            *
  ******************************************************************************/
-static void	ipmi_manager_serialize_request(const DC_ITEM *item, int command, zbx_ipc_message_t *message)
+static zbx_ipmi_request_t	*ipmi_manager_create_value_request(DC_ITEM **items, int items_num)
 {
-	zbx_uint32_t	size;
+	zbx_ipmi_request_t	*request;
+	const DC_ITEM		*item = items[0];
+	const char		**sensors;
+	int			i;
+
+	request = ipmi_request_create(item->host.hostid);
+	request->items_num = items_num;
+	request->itemids = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * items_num);
+	request->item_states = (unsigned char *)zbx_malloc(NULL, sizeof(unsigned char) * items_num);
+	sensors = (const char **)zbx_malloc(NULL, sizeof(char *) * items_num);
+
+	for (i = 0; i < items_num; i++)
+	{
+		request->itemids[i] = items[i]->itemid;
+		request->item_states[i] = items[i]->state;
+		sensors[i] = items[i]->ipmi_sensor;
+	}
 
-	size = zbx_ipmi_serialize_request(&message->data, item->itemid, item->interface.addr,
+	request->message.size = zbx_ipmi_serialize_value_request(&request->message.data, item->interface.addr,
 			item->interface.port, item->host.ipmi_authtype, item->host.ipmi_privilege,
-			item->host.ipmi_username, item->host.ipmi_password, item->ipmi_sensor, command);
+			item->host.ipmi_username, item->host.ipmi_password, request->itemids, sensors, items_num);
+	request->message.code = ZBX_IPC_IPMI_VALUE_REQUEST;
 
-	message->code = ZBX_IPC_IPMI_VALUE_REQUEST;
-	message->size = size;
+	zbx_free(sensors);
+
+	return request;
 }
 
 /******************************************************************************
@@ -831,6 +890,17 @@ static void	ipmi_manager_schedule_request(zbx_ipmi_manager_t *manager, zbx_uint6
 	ipmi_poller_schedule_request(host->poller, request);
 }
 
+static int	ipmi_item_compare_interface(const void *d1, const void *d2)
+{
+	const DC_ITEM	*i1 = *(const DC_ITEM * const *)d1;
+	const DC_ITEM	*i2 = *(const DC_ITEM * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(i1->interface.interfaceid, i2->interface.interfaceid);
+	ZBX_RETURN_IF_NOT_EQUAL(i1->itemid, i2->itemid);
+
+	return 0;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: ipmi_manager_schedule_requests                                   *
@@ -843,18 +913,25 @@ static void	ipmi_manager_schedule_request(zbx_ipmi_manager_t *manager, zbx_uint6
  *             nextcheck - [OUT] time when the next IPMI check is scheduled   *
  *                         in configuration cache IPMI poller queue           *
  *                                                                            *
- * Return value: The number of requests scheduled.                            *
+ * Return value: The number of items scheduled.                               *
+ *                                                                            *
+ * Comments: Items of the same host interface are polled with a single        *
+ *           request.                                                         *
  *                                                                            *
  ******************************************************************************/
 static int	ipmi_manager_schedule_requests(zbx_ipmi_manager_t *manager, int now, int *nextcheck)
 {
-	int			i, num;
+	int			i, j, num;
 	DC_ITEM			items[MAX_POLLER_ITEMS];
+	zbx_vector_ptr_t	polled;
 	zbx_ipmi_request_t	*request;
 	char			*error = NULL;
 
 	num = DCconfig_get_ipmi_poller_items(now, items, MAX_POLLER_ITEMS, nextcheck);
 
+	zbx_vector_ptr_create(&polled);
+	zbx_vector_ptr_reserve(&polled, num);
+
 	for (i = 0; i < num; i++)
 	{
 		if (FAIL == zbx_ipmi_port_expand_macros(items[i].host.hostid, items[i].interface.port_orig,
@@ -871,13 +948,27 @@ static int	ipmi_manager_schedule_requests(zbx_ipmi_manager_t *manager, int now,
 			continue;
 		}
 
-		request = ipmi_request_create(items[i].host.hostid);
-		request->itemid = items[i].itemid;
-		request->item_state = items[i].state;
-		ipmi_manager_serialize_request(&items[i], 0, &request->message);
-		ipmi_manager_schedule_request(manager, items[i].host.hostid, request, now);
+		zbx_vector_ptr_append(&polled, &items[i]);
 	}
 
+	zbx_vector_ptr_sort(&polled, ipmi_item_compare_interface);
+
+	for (i = 0; i < polled.values_num; i = j)
+	{
+		const DC_ITEM	*item = (const DC_ITEM *)polled.values[i];
+
+		for (j = i + 1; j < polled.values_num; j++)
+		{
+			if (((const DC_ITEM *)polled.values[j])->interface.interfaceid != item->interface.interfaceid)
+				break;
+		}
+
+		request = ipmi_manager_create_value_request((DC_ITEM **)polled.values + i, j - i);
+		ipmi_manager_schedule_request(manager, item->host.hostid, request, now);
+	}
+
+	zbx_vector_ptr_destroy(&polled);
+
 	zbx_preprocessor_flush();
 	DCconfig_clean_items(items, NULL, num);
 
@@ -1039,8 +1130,8 @@ ZBX_THREAD_ENTRY(ipmi_manager_thread, args)
 					}
 					break;
 				case ZBX_IPC_IPMI_VALUE_RESULT:
-					ipmi_manager_process_value_result(&ipmi_manager, client, message, now);
-					polled_num++;
+					polled_num += ipmi_manager_process_value_result(&ipmi_manager, client, message,
+							now);
 					break;
 				case ZBX_IPC_IPMI_SCRIPT_REQUEST:
 					ipmi_manager_process_script_request(&ipmi_manager, client, message, now);
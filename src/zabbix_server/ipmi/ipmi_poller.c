@@ -85,41 +85,66 @@ static void	ipmi_poller_send_result(zbx_ipc_async_socket_t *socket, zbx_uint32_t
  *                                                                            *
  * Function: ipmi_poller_process_value_request                                *
  *                                                                            *
- * Purpose: gets IPMI sensor value from the specified host                    *
+ * Purpose: gets IPMI sensor values from the specified host                   *
  *                                                                            *
  * Parameters: socket  - [IN] the connections socket                          *
  *             message - [IN] the value request message                       *
  *                                                                            *
+ * Return value: The number of requested values.                              *
+ *                                                                            *
+ * Comments: All sensors of a request belong to the same host and are read    *
+ *           over the same session with a single result sent back.            *
+ *                                                                            *
  ******************************************************************************/
-static void	ipmi_poller_process_value_request(zbx_ipc_async_socket_t *socket, zbx_ipc_message_t *message)
+static int	ipmi_poller_process_value_request(zbx_ipc_async_socket_t *socket, zbx_ipc_message_t *message)
 {
 	const char	*__function_name = "ipmi_poller_process_value_request";
-	zbx_uint64_t	itemid;
-	char		*addr, *username, *password, *sensor, *value = NULL;
+	zbx_uint64_t	*itemids;
+	char		*addr, *username, *password, **sensors, **values;
 	signed char	authtype;
-	unsigned char	privilege;
+	unsigned char	privilege, *data;
 	unsigned short	port;
-	int		errcode, command;
+	int		i, sensors_num, *errcodes;
+	zbx_uint32_t	data_len;
+	zbx_timespec_t	ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
 
-	zbx_ipmi_deserialize_request(message->data, &itemid, &addr, &port, &authtype,
-			&privilege, &username, &password, &sensor, &command);
+	zbx_ipmi_deserialize_value_request(message->data, &addr, &port, &authtype, &privilege, &username, &password,
+			&itemids, &sensors, &sensors_num);
 
-	zabbix_log(LOG_LEVEL_TRACE, "%s() itemid:" ZBX_FS_UI64 " addr:%s port:%d authtype:%d privilege:%d username:%s"
-			" sensor:%s", __function_name, itemid, addr, (int)port, (int)authtype, (int)privilege,
-			username, sensor);
+	zabbix_log(LOG_LEVEL_TRACE, "%s() addr:%s port:%d authtype:%d privilege:%d username:%s sensors:%d",
+			__function_name, addr, (int)port, (int)authtype, (int)privilege, username, sensors_num);
+
+	errcodes = (int *)zbx_malloc(NULL, sizeof(int) * sensors_num);
+	values = (char **)zbx_malloc(NULL, sizeof(char *) * sensors_num);
+	memset(values, 0, sizeof(char *) * sensors_num);
+
+	get_values_ipmi(addr, port, authtype, privilege, username, password, (const char **)sensors, sensors_num,
+			errcodes, values);
+
+	zbx_timespec(&ts);
+	data_len = zbx_ipmi_serialize_value_result(&data, &ts, errcodes, values, sensors_num);
+	zbx_ipc_async_socket_send(socket, ZBX_IPC_IPMI_VALUE_RESULT, data, data_len);
+	zbx_free(data);
 
-	errcode = get_value_ipmi(itemid, addr, port, authtype, privilege, username, password, sensor, &value);
-	ipmi_poller_send_result(socket, ZBX_IPC_IPMI_VALUE_RESULT, errcode, value);
+	for (i = 0; i < sensors_num; i++)
+	{
+		zbx_free(values[i]);
+		zbx_free(sensors[i]);
+	}
 
-	zbx_free(value);
+	zbx_free(values);
+	zbx_free(errcodes);
+	zbx_free(sensors);
+	zbx_free(itemids);
 	zbx_free(addr);
 	zbx_free(username);
 	zbx_free(password);
-	zbx_free(sensor);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
+
+	return sensors_num;
 }
 
 /******************************************************************************
@@ -250,8 +275,7 @@ ZBX_THREAD_ENTRY(ipmi_poller_thread, args)
 		switch (message->code)
 		{
 			case ZBX_IPC_IPMI_VALUE_REQUEST:
-				ipmi_poller_process_value_request(&ipmi_socket, message);
-				polled_num++;
+				polled_num += ipmi_poller_process_value_request(&ipmi_socket, message);
 				break;
 			case ZBX_IPC_IPMI_COMMAND_REQUEST:
 				ipmi_poller_process_command_request(&ipmi_socket, message);
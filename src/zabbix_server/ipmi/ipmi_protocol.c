@@ -108,4 +108,116 @@ void	zbx_ipmi_deserialize_result(const unsigned char *data, zbx_timespec_t *ts,
 	(void)zbx_deserialize_str(data, value, value_len);
 }
 
+zbx_uint32_t	zbx_ipmi_serialize_value_request(unsigned char **data, const char *addr, unsigned short port,
+		signed char authtype, unsigned char privilege, const char *username, const char *password,
+		const zbx_uint64_t *itemids, const char **sensors, int sensors_num)
+{
+	unsigned char	*ptr;
+	zbx_uint32_t	data_len, addr_len, username_len, password_len, sensor_len;
+	int		i;
+
+	addr_len = strlen(addr) + 1;
+	username_len = strlen(username) + 1;
+	password_len = strlen(password) + 1;
+
+	data_len = sizeof(short) + sizeof(char) * 2 + addr_len + username_len + password_len +
+			sizeof(zbx_uint32_t) * 3 + sizeof(int);
+
+	for (i = 0; i < sensors_num; i++)
+		data_len += sizeof(zbx_uint64_t) + strlen(sensors[i]) + 1 + sizeof(zbx_uint32_t);
+
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+	ptr = *data;
+	ptr += zbx_serialize_str(ptr, addr, addr_len);
+	ptr += zbx_serialize_short(ptr, port);
+	ptr += zbx_serialize_char(ptr, authtype);
+	ptr += zbx_serialize_char(ptr, privilege);
+	ptr += zbx_serialize_str(ptr, username, username_len);
+	ptr += zbx_serialize_str(ptr, password, password_len);
+	ptr += zbx_serialize_int(ptr, sensors_num);
+
+	for (i = 0; i < sensors_num; i++)
+	{
+		sensor_len = strlen(sensors[i]) + 1;
+		ptr += zbx_serialize_uint64(ptr, itemids[i]);
+		ptr += zbx_serialize_str(ptr, sensors[i], sensor_len);
+	}
+
+	return data_len;
+}
+
+void	zbx_ipmi_deserialize_value_request(const unsigned char *data, char **addr, unsigned short *port,
+		signed char *authtype, unsigned char *privilege, char **username, char **password,
+		zbx_uint64_t **itemids, char ***sensors, int *sensors_num)
+{
+	zbx_uint32_t	value_len;
+	int		i;
+
+	data += zbx_deserialize_str(data, addr, value_len);
+	data += zbx_deserialize_short(data, port);
+	data += zbx_deserialize_char(data, authtype);
+	data += zbx_deserialize_char(data, privilege);
+	data += zbx_deserialize_str(data, username, value_len);
+	data += zbx_deserialize_str(data, password, value_len);
+	data += zbx_deserialize_int(data, sensors_num);
+
+	*itemids = (zbx_uint64_t *)zbx_malloc(NULL, sizeof(zbx_uint64_t) * *sensors_num);
+	*sensors = (char **)zbx_malloc(NULL, sizeof(char *) * *sensors_num);
+
+	for (i = 0; i < *sensors_num; i++)
+	{
+		data += zbx_deserialize_uint64(data, &(*itemids)[i]);
+		data += zbx_deserialize_str(data, &(*sensors)[i], value_len);
+	}
+}
+
+zbx_uint32_t	zbx_ipmi_serialize_value_result(unsigned char **data, const zbx_timespec_t *ts, const int *errcodes,
+		char **values, int values_num)
+{
+	unsigned char	*ptr;
+	zbx_uint32_t	data_len, value_len;
+	int		i;
+
+	data_len = sizeof(int) * 3;
+
+	for (i = 0; i < values_num; i++)
+		data_len += sizeof(int) + (NULL != values[i] ? strlen(values[i]) + 1 : 0) + sizeof(zbx_uint32_t);
+
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	ptr = *data;
+	ptr += zbx_serialize_int(ptr, ts->sec);
+	ptr += zbx_serialize_int(ptr, ts->ns);
+	ptr += zbx_serialize_int(ptr, values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		value_len = (NULL != values[i] ? strlen(values[i]) + 1 : 0);
+		ptr += zbx_serialize_int(ptr, errcodes[i]);
+		ptr += zbx_serialize_str(ptr, values[i], value_len);
+	}
+
+	return data_len;
+}
+
+void	zbx_ipmi_deserialize_value_result(const unsigned char *data, zbx_timespec_t *ts, int **errcodes,
+		char ***values, int *values_num)
+{
+	zbx_uint32_t	value_len;
+	int		i;
+
+	data += zbx_deserialize_int(data, &ts->sec);
+	data += zbx_deserialize_int(data, &ts->ns);
+	data += zbx_deserialize_int(data, values_num);
+
+	*errcodes = (int *)zbx_malloc(NULL, sizeof(int) * *values_num);
+	*values = (char **)zbx_malloc(NULL, sizeof(char *) * *values_num);
+
+	for (i = 0; i < *values_num; i++)
+	{
+		data += zbx_deserialize_int(data, &(*errcodes)[i]);
+		data += zbx_deserialize_str(data, &(*values)[i], value_len);
+	}
+}
+
 #endif
@@ -58,6 +58,20 @@ zbx_uint32_t	zbx_ipmi_serialize_result(unsigned char **data, const zbx_timespec_
 
 void	zbx_ipmi_deserialize_result(const unsigned char *data, zbx_timespec_t *ts, int *errcode, char **value);
 
+zbx_uint32_t	zbx_ipmi_serialize_value_request(unsigned char **data, const char *addr, unsigned short port,
+		signed char authtype, unsigned char privilege, const char *username, const char *password,
+		const zbx_uint64_t *itemids, const char **sensors, int sensors_num);
+
+void	zbx_ipmi_deserialize_value_request(const unsigned char *data, char **addr, unsigned short *port,
+		signed char *authtype, unsigned char *privilege, char **username, char **password,
+		zbx_uint64_t **itemids, char ***sensors, int *sensors_num);
+
+zbx_uint32_t	zbx_ipmi_serialize_value_result(unsigned char **data, const zbx_timespec_t *ts, const int *errcodes,
+		char **values, int values_num);
+
+void	zbx_ipmi_deserialize_value_result(const unsigned char *data, zbx_timespec_t *ts, int **errcodes,
+		char ***values, int *values_num);
+
 #endif
 
 #endif
@@ -30,10 +30,27 @@
 #include "zbxjson.h"
 #include "zbxalgo.h"
 
+/* idle pooled connections are closed after this period */
+#define ZBX_ODBC_POOL_IDLE_TIMEOUT	(5 * SEC_PER_MIN)
+
+/* the maximum number of prepared statements cached per connection */
+#define ZBX_ODBC_STMT_CACHE_SIZE	64
+
 struct zbx_odbc_data_source
 {
-	SQLHENV	henv;
-	SQLHDBC	hdbc;
+	SQLHENV		henv;
+	SQLHDBC		hdbc;
+
+	/* connection parameters, used as pool key and to reconnect */
+	char		*dsn;
+	char		*user;
+	char		*pass;
+
+	/* prepared statements, see zbx_odbc_stmt_t */
+	zbx_hashset_t	stmts;
+
+	time_t		lastaccess;
+	unsigned char	in_use;
 };
 
 struct zbx_odbc_query_result
@@ -41,8 +58,37 @@ struct zbx_odbc_query_result
 	SQLHSTMT	hstmt;
 	SQLSMALLINT	col_num;
 	char		**row;
+
+	/* the statement handle belongs to prepared statement cache */
+	unsigned char	cached;
 };
 
+typedef struct
+{
+	char		*query;
+	SQLHSTMT	hstmt;
+}
+zbx_odbc_stmt_t;
+
+/* connections kept open between checks, see zbx_odbc_pool_get() */
+static zbx_vector_ptr_t	odbc_pool;
+static int		odbc_pool_initialized = 0;
+
+static zbx_hash_t	zbx_odbc_stmt_hash(const void *data)
+{
+	const zbx_odbc_stmt_t	*stmt = (const zbx_odbc_stmt_t *)data;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(stmt->query);
+}
+
+static int	zbx_odbc_stmt_compare(const void *d1, const void *d2)
+{
+	const zbx_odbc_stmt_t	*stmt1 = (const zbx_odbc_stmt_t *)d1;
+	const zbx_odbc_stmt_t	*stmt2 = (const zbx_odbc_stmt_t *)d2;
+
+	return strcmp(stmt1->query, stmt2->query);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_odbc_rc_str                                                  *
@@ -229,6 +275,7 @@ zbx_odbc_data_source_t	*zbx_odbc_connect(const char *dsn, const char *user, cons
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() dsn:'%s' user:'%s'", __function_name, dsn, user);
 
 	data_source = (zbx_odbc_data_source_t *)zbx_malloc(data_source, sizeof(zbx_odbc_data_source_t));
+	memset(data_source, 0, sizeof(zbx_odbc_data_source_t));
 
 	if (0 != SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &data_source->henv)))
 	{
@@ -259,6 +306,12 @@ zbx_odbc_data_source_t	*zbx_odbc_connect(const char *dsn, const char *user, cons
 					if (SUCCEED == zbx_odbc_diag(SQL_HANDLE_DBC, data_source->hdbc, rc, &diag))
 					{
 						zbx_log_odbc_connection_info(__function_name, data_source->hdbc);
+
+						data_source->dsn = zbx_strdup(NULL, dsn);
+						data_source->user = zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(user));
+						data_source->pass = zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(pass));
+						zbx_hashset_create(&data_source->stmts, 0, zbx_odbc_stmt_hash,
+								zbx_odbc_stmt_compare);
 						goto out;
 					}
 
@@ -289,6 +342,30 @@ out:
 	return data_source;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_odbc_stmts_clear                                             *
+ *                                                                            *
+ * Purpose: free prepared statements of the connection                        *
+ *                                                                            *
+ * Parameters: data_source - [IN] pointer to data source structure            *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_odbc_stmts_clear(zbx_odbc_data_source_t *data_source)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_odbc_stmt_t		*stmt;
+
+	zbx_hashset_iter_reset(&data_source->stmts, &iter);
+
+	while (NULL != (stmt = (zbx_odbc_stmt_t *)zbx_hashset_iter_next(&iter)))
+	{
+		SQLFreeHandle(SQL_HANDLE_STMT, stmt->hstmt);
+		zbx_free(stmt->query);
+		zbx_hashset_iter_remove(&iter);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_odbc_data_source_free                                        *
@@ -303,12 +380,290 @@ out:
  ******************************************************************************/
 void	zbx_odbc_data_source_free(zbx_odbc_data_source_t *data_source)
 {
+	zbx_odbc_stmts_clear(data_source);
+	zbx_hashset_destroy(&data_source->stmts);
+
 	SQLDisconnect(data_source->hdbc);
 	SQLFreeHandle(SQL_HANDLE_DBC, data_source->hdbc);
 	SQLFreeHandle(SQL_HANDLE_ENV, data_source->henv);
+
+	zbx_free(data_source->dsn);
+	zbx_free(data_source->user);
+	zbx_free(data_source->pass);
 	zbx_free(data_source);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_odbc_pool_get                                                *
+ *                                                                            *
+ * Purpose: get connection to ODBC data source from the connection pool       *
+ *                                                                            *
+ * Parameters: dsn     - [IN] data source name                                *
+ *             user    - [IN] user name                                       *
+ *             pass    - [IN] password                                        *
+ *             timeout - [IN] timeout                                         *
+ *             error   - [OUT] error message                                  *
+ *                                                                            *
+ * Return value: pointer to opaque data source data structure or NULL in case *
+ *               of failure, allocated error message is returned in error     *
+ *                                                                            *
+ * Comments: The connection must be returned with zbx_odbc_pool_put() after   *
+ *           successful use or closed with zbx_odbc_pool_remove() after a     *
+ *           failure. A new connection is established only when the pool has  *
+ *           no idle connection with the same parameters, so each process     *
+ *           keeps at most one connection per data source and credentials.    *
+ *           Connections idle for longer than ZBX_ODBC_POOL_IDLE_TIMEOUT are  *
+ *           closed.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_odbc_data_source_t	*zbx_odbc_pool_get(const char *dsn, const char *user, const char *pass, int timeout,
+		char **error)
+{
+	const char		*__function_name = "zbx_odbc_pool_get";
+	zbx_odbc_data_source_t	*data_source = NULL;
+	time_t			now;
+	int			i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() dsn:'%s' user:'%s'", __function_name, dsn, user);
+
+	if (0 == odbc_pool_initialized)
+	{
+		zbx_vector_ptr_create(&odbc_pool);
+		odbc_pool_initialized = 1;
+	}
+
+	now = time(NULL);
+
+	for (i = 0; i < odbc_pool.values_num; i++)
+	{
+		zbx_odbc_data_source_t	*pooled = (zbx_odbc_data_source_t *)odbc_pool.values[i];
+
+		if (0 != pooled->in_use)
+			continue;
+
+		if (pooled->lastaccess + ZBX_ODBC_POOL_IDLE_TIMEOUT < now)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "%s() closing idle connection to dsn:'%s'", __function_name,
+					pooled->dsn);
+			zbx_odbc_data_source_free(pooled);
+			zbx_vector_ptr_remove_noorder(&odbc_pool, i--);
+			continue;
+		}
+
+		if (NULL == data_source && 0 == strcmp(pooled->dsn, dsn) && 0 == strcmp(pooled->user, user) &&
+				0 == strcmp(pooled->pass, pass))
+		{
+			data_source = pooled;
+		}
+	}
+
+	if (NULL == data_source && NULL != (data_source = zbx_odbc_connect(dsn, user, pass, timeout, error)))
+		zbx_vector_ptr_append(&odbc_pool, data_source);
+
+	if (NULL != data_source)
+		data_source->in_use = 1;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() pooled:%d", __function_name, odbc_pool.values_num);
+
+	return data_source;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_odbc_pool_put                                                *
+ *                                                                            *
+ * Purpose: return connection obtained with zbx_odbc_pool_get() to the pool   *
+ *                                                                            *
+ * Parameters: data_source - [IN] pointer to data source structure            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_odbc_pool_put(zbx_odbc_data_source_t *data_source)
+{
+	data_source->in_use = 0;
+	data_source->lastaccess = time(NULL);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_odbc_pool_remove                                             *
+ *                                                                            *
+ * Purpose: close connection obtained with zbx_odbc_pool_get() and remove it  *
+ *          from the pool                                                     *
+ *                                                                            *
+ * Parameters: data_source - [IN] pointer to data source structure            *
+ *                                                                            *
+ * Comments: Used instead of zbx_odbc_pool_put() when a query fails. Not all  *
+ *           drivers report dead connections, so the next check connects      *
+ *           again instead of reusing connection of unknown state.            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_odbc_pool_remove(zbx_odbc_data_source_t *data_source)
+{
+	int	i;
+
+	if (FAIL != (i = zbx_vector_ptr_search(&odbc_pool, data_source, ZBX_DEFAULT_PTR_COMPARE_FUNC)))
+		zbx_vector_ptr_remove_noorder(&odbc_pool, i);
+
+	zbx_odbc_data_source_free(data_source);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_odbc_reconnect                                               *
+ *                                                                            *
+ * Purpose: re-establish connection which was closed by data source           *
+ *                                                                            *
+ * Parameters: data_source - [IN] pointer to data source structure            *
+ *                                                                            *
+ * Return value: SUCCEED - connection was dead and was re-established         *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_odbc_reconnect(zbx_odbc_data_source_t *data_source)
+{
+	const char	*__function_name = "zbx_odbc_reconnect";
+	char		*diag = NULL;
+	SQLUINTEGER	dead = SQL_CD_FALSE;
+	SQLRETURN	rc;
+	int		ret;
+
+	rc = SQLGetConnectAttr(data_source->hdbc, SQL_ATTR_CONNECTION_DEAD, &dead, 0, NULL);
+
+	if (0 == SQL_SUCCEEDED(rc) || SQL_CD_TRUE != dead)
+		return FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() dsn:'%s'", __function_name, data_source->dsn);
+
+	zbx_odbc_stmts_clear(data_source);
+	SQLDisconnect(data_source->hdbc);
+
+	rc = SQLConnect(data_source->hdbc, (SQLCHAR *)data_source->dsn, SQL_NTS,
+			(SQLCHAR *)('\0' == *data_source->user ? NULL : data_source->user), SQL_NTS,
+			(SQLCHAR *)('\0' == *data_source->pass ? NULL : data_source->pass), SQL_NTS);
+
+	if (SUCCEED != (ret = zbx_odbc_diag(SQL_HANDLE_DBC, data_source->hdbc, rc, &diag)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "Cannot reconnect to ODBC DSN: %s", diag);
+		zbx_free(diag);
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_odbc_execute                                                 *
+ *                                                                            *
+ * Purpose: execute a query, reusing prepared statement if possible           *
+ *                                                                            *
+ * Parameters: data_source  - [IN] pointer to data source structure           *
+ *             query        - [IN] SQL query                                  *
+ *             query_result - [OUT] the executed statement                    *
+ *             error        - [OUT] error message                             *
+ *                                                                            *
+ * Return value: SUCCEED - the query was executed                             *
+ *               FAIL    - otherwise, allocated error message is returned in  *
+ *                         error                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_odbc_execute(zbx_odbc_data_source_t *data_source, const char *query,
+		zbx_odbc_query_result_t *query_result, char **error)
+{
+	char		*diag = NULL;
+	zbx_odbc_stmt_t	stmt_local, *stmt;
+	SQLRETURN	rc;
+	int		ret = FAIL;
+
+	stmt_local.query = (char *)query;
+
+	if (NULL != (stmt = (zbx_odbc_stmt_t *)zbx_hashset_search(&data_source->stmts, &stmt_local)))
+	{
+		rc = SQLExecute(stmt->hstmt);
+
+		if (SUCCEED == zbx_odbc_diag(SQL_HANDLE_STMT, stmt->hstmt, rc, &diag))
+		{
+			query_result->hstmt = stmt->hstmt;
+			query_result->cached = 1;
+			ret = SUCCEED;
+			goto out;
+		}
+
+		*error = zbx_dsprintf(*error, "Cannot execute ODBC query: %s", diag);
+
+		SQLFreeHandle(SQL_HANDLE_STMT, stmt->hstmt);
+		zbx_free(stmt->query);
+		zbx_hashset_remove_direct(&data_source->stmts, stmt);
+		goto out;
+	}
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, data_source->hdbc, &query_result->hstmt);
+
+	if (SUCCEED != zbx_odbc_diag(SQL_HANDLE_DBC, data_source->hdbc, rc, &diag))
+	{
+		*error = zbx_dsprintf(*error, "Cannot create ODBC statement handle: %s", diag);
+		goto out;
+	}
+
+	if (ZBX_ODBC_STMT_CACHE_SIZE > data_source->stmts.num_data)
+	{
+		rc = SQLPrepare(query_result->hstmt, (SQLCHAR *)query, SQL_NTS);
+
+		if (0 != SQL_SUCCEEDED(rc))
+			rc = SQLExecute(query_result->hstmt);
+
+		if (SUCCEED == zbx_odbc_diag(SQL_HANDLE_STMT, query_result->hstmt, rc, &diag))
+		{
+			stmt_local.query = zbx_strdup(NULL, query);
+			stmt_local.hstmt = query_result->hstmt;
+			zbx_hashset_insert(&data_source->stmts, &stmt_local, sizeof(stmt_local));
+
+			query_result->cached = 1;
+			ret = SUCCEED;
+			goto out;
+		}
+	}
+	else
+	{
+		rc = SQLExecDirect(query_result->hstmt, (SQLCHAR *)query, SQL_NTS);
+
+		if (SUCCEED == zbx_odbc_diag(SQL_HANDLE_STMT, query_result->hstmt, rc, &diag))
+		{
+			ret = SUCCEED;
+			goto out;
+		}
+	}
+
+	*error = zbx_dsprintf(*error, "Cannot execute ODBC query: %s", diag);
+	SQLFreeHandle(SQL_HANDLE_STMT, query_result->hstmt);
+out:
+	zbx_free(diag);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_odbc_stmt_release                                            *
+ *                                                                            *
+ * Purpose: release statement of the query result                             *
+ *                                                                            *
+ * Parameters: query_result - [IN] pointer to query result structure          *
+ *                                                                            *
+ * Comments: Prepared statements are kept in the cache for reuse, only their  *
+ *           cursor is closed.                                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_odbc_stmt_release(zbx_odbc_query_result_t *query_result)
+{
+	if (0 != query_result->cached)
+		SQLFreeStmt(query_result->hstmt, SQL_CLOSE);
+	else
+		SQLFreeHandle(SQL_HANDLE_STMT, query_result->hstmt);
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_odbc_select                                                  *
@@ -325,55 +680,54 @@ void	zbx_odbc_data_source_free(zbx_odbc_data_source_t *data_source)
  * Comments: It is caller's responsibility to free error buffer!              *
  *                                                                            *
  ******************************************************************************/
-zbx_odbc_query_result_t	*zbx_odbc_select(const zbx_odbc_data_source_t *data_source, const char *query, char **error)
+zbx_odbc_query_result_t	*zbx_odbc_select(zbx_odbc_data_source_t *data_source, const char *query, char **error)
 {
 	const char		*__function_name = "zbx_odbc_select";
 	char			*diag = NULL;
 	zbx_odbc_query_result_t	*query_result = NULL;
 	SQLRETURN		rc;
+	int			ret;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() query:'%s'", __function_name, query);
 
 	query_result = (zbx_odbc_query_result_t *)zbx_malloc(query_result, sizeof(zbx_odbc_query_result_t));
+	query_result->cached = 0;
 
-	rc = SQLAllocHandle(SQL_HANDLE_STMT, data_source->hdbc, &query_result->hstmt);
+	/* pooled connection might have been closed by data source, reconnect and retry once */
+	if (SUCCEED != (ret = zbx_odbc_execute(data_source, query, query_result, error)) &&
+			SUCCEED == zbx_odbc_reconnect(data_source))
+	{
+		zbx_free(*error);
+		ret = zbx_odbc_execute(data_source, query, query_result, error);
+	}
 
-	if (SUCCEED == zbx_odbc_diag(SQL_HANDLE_DBC, data_source->hdbc, rc, &diag))
+	if (SUCCEED == ret)
 	{
-		rc = SQLExecDirect(query_result->hstmt, (SQLCHAR *)query, SQL_NTS);
+		rc = SQLNumResultCols(query_result->hstmt, &query_result->col_num);
 
 		if (SUCCEED == zbx_odbc_diag(SQL_HANDLE_STMT, query_result->hstmt, rc, &diag))
 		{
-			rc = SQLNumResultCols(query_result->hstmt, &query_result->col_num);
+			SQLSMALLINT	i;
 
-			if (SUCCEED == zbx_odbc_diag(SQL_HANDLE_STMT, query_result->hstmt, rc, &diag))
-			{
-				SQLSMALLINT	i;
+			query_result->row = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)query_result->col_num);
 
-				query_result->row = (char **)zbx_malloc(NULL, sizeof(char *) * (size_t)query_result->col_num);
-
-				for (i = 0; ; i++)
+			for (i = 0; ; i++)
+			{
+				if (i == query_result->col_num)
 				{
-					if (i == query_result->col_num)
-					{
-						zabbix_log(LOG_LEVEL_DEBUG, "selected all %d columns",
-								(int)query_result->col_num);
-						goto out;
-					}
-
-					query_result->row[i] = NULL;
+					zabbix_log(LOG_LEVEL_DEBUG, "selected all %d columns",
+							(int)query_result->col_num);
+					goto out;
 				}
+
+				query_result->row[i] = NULL;
 			}
-			else
-				*error = zbx_dsprintf(*error, "Cannot get number of columns in ODBC result: %s", diag);
 		}
 		else
-			*error = zbx_dsprintf(*error, "Cannot execute ODBC query: %s", diag);
+			*error = zbx_dsprintf(*error, "Cannot get number of columns in ODBC result: %s", diag);
 
-		SQLFreeHandle(SQL_HANDLE_STMT, query_result->hstmt);
+		zbx_odbc_stmt_release(query_result);
 	}
-	else
-		*error = zbx_dsprintf(*error, "Cannot create ODBC statement handle: %s", diag);
 
 	zbx_free(query_result);
 out:
@@ -400,7 +754,7 @@ void	zbx_odbc_query_result_free(zbx_odbc_query_result_t *query_result)
 {
 	SQLSMALLINT	i;
 
-	SQLFreeHandle(SQL_HANDLE_STMT, query_result->hstmt);
+	zbx_odbc_stmt_release(query_result);
 
 	for (i = 0; i < query_result->col_num; i++)
 		zbx_free(query_result->row[i]);
@@ -648,4 +1002,98 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_odbc_query_result_to_json                                    *
+ *                                                                            *
+ * Purpose: convert all rows of ODBC SQL query result into JSON array         *
+ *                                                                            *
+ * Parameters: query_result - [IN] result of SQL query                        *
+ *             json         - [OUT] JSON array of rows, each row is an object *
+ *                                  with column names as keys                 *
+ *             error        - [OUT] error message                             *
+ *                                                                            *
+ * Return value: SUCCEED - conversion was successful and allocated JSON is    *
+ *                         returned in json parameter, error remains          *
+ *                         untouched in this case                             *
+ *               FAIL    - otherwise, allocated error message is returned in  *
+ *                         error parameter, json remains untouched            *
+ *                                                                            *
+ * Comments: It is caller's responsibility to free allocated buffers!         *
+ *           The result can be used as master item value, so that a single   *
+ *           query provides values for several dependent items.               *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_odbc_query_result_to_json(zbx_odbc_query_result_t *query_result, char **json, char **error)
+{
+	const char		*__function_name = "zbx_odbc_query_result_to_json";
+	const char		*const *row;
+	struct zbx_json		j;
+	zbx_vector_str_t	names;
+	int			ret = FAIL, i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __function_name);
+
+	zbx_vector_str_create(&names);
+	zbx_vector_str_reserve(&names, query_result->col_num);
+
+	for (i = 0; i < query_result->col_num; i++)
+	{
+		char		str[MAX_STRING_LEN];
+		SQLRETURN	rc;
+		SQLSMALLINT	len;
+
+		rc = SQLColAttribute(query_result->hstmt, i + 1, SQL_DESC_LABEL, str, sizeof(str), &len, NULL);
+
+		if (SQL_SUCCESS != rc || sizeof(str) <= (size_t)len || '\0' == *str)
+		{
+			*error = zbx_dsprintf(*error, "Cannot obtain column #%d name.", i + 1);
+			goto out;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "column #%d name:'%s'", i + 1, str);
+
+		zbx_replace_invalid_utf8(str);
+		zbx_vector_str_append(&names, zbx_strdup(NULL, str));
+	}
+
+	zbx_json_initarray(&j, ZBX_JSON_STAT_BUF_LEN);
+
+	while (NULL != (row = zbx_odbc_fetch(query_result)))
+	{
+		zbx_json_addobject(&j, NULL);
+
+		for (i = 0; i < query_result->col_num; i++)
+		{
+			char	*value = NULL;
+
+			if (NULL != row[i])
+			{
+				value = zbx_strdup(value, row[i]);
+				zbx_replace_invalid_utf8(value);
+			}
+
+			zbx_json_addstring(&j, names.values[i], value, ZBX_JSON_TYPE_STRING);
+			zbx_free(value);
+		}
+
+		zbx_json_close(&j);
+	}
+
+	zbx_json_close(&j);
+
+	*json = zbx_strdup(*json, j.buffer);
+
+	zbx_json_free(&j);
+
+	ret = SUCCEED;
+out:
+	zbx_vector_str_clear_ext(&names, zbx_str_free);
+	zbx_vector_str_destroy(&names);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+
+	return ret;
+}
+
 #endif	/* HAVE_UNIXODBC */
@@ -69,6 +69,10 @@ int	get_value_db(DC_ITEM *item, AGENT_RESULT *result)
 	{
 		query_result_to_text = zbx_odbc_query_result_to_lld_json;
 	}
+	else if (0 == strcmp(request.key, "db.odbc.get"))
+	{
+		query_result_to_text = zbx_odbc_query_result_to_json;
+	}
 	else
 	{
 		SET_MSG_RESULT(result, zbx_strdup(NULL, "Unsupported item key for this item type."));
@@ -91,7 +95,8 @@ int	get_value_db(DC_ITEM *item, AGENT_RESULT *result)
 		goto out;
 	}
 
-	if (NULL != (data_source = zbx_odbc_connect(dsn, item->username, item->password, CONFIG_TIMEOUT, &error)))
+	/* connections are kept open between checks of the same poller while queries succeed */
+	if (NULL != (data_source = zbx_odbc_pool_get(dsn, item->username, item->password, CONFIG_TIMEOUT, &error)))
 	{
 		if (NULL != (query_result = zbx_odbc_select(data_source, item->params, &error)))
 		{
@@ -104,9 +109,10 @@ int	get_value_db(DC_ITEM *item, AGENT_RESULT *result)
 			}
 
 			zbx_odbc_query_result_free(query_result);
+			zbx_odbc_pool_put(data_source);
 		}
-
-		zbx_odbc_data_source_free(data_source);
+		else
+			zbx_odbc_pool_remove(data_source);
 	}
 
 	if (SUCCEED != ret)
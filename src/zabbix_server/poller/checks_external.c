@@ -20,10 +20,329 @@
 #include "common.h"
 #include "log.h"
 #include "zbxexec.h"
+#include "zbxjson.h"
 
 #include "checks_external.h"
 
 extern char	*CONFIG_EXTERNALSCRIPTS;
+extern char	**CONFIG_EXTERNAL_COPROCESS;
+
+/* external script kept running between checks */
+typedef struct
+{
+	char	*name;
+	pid_t	pid;
+	int	fd_write;
+	int	fd_read;
+	char	*buf;
+	size_t	buf_alloc;
+	size_t	buf_offset;
+}
+zbx_coprocess_t;
+
+static zbx_vector_ptr_t	coprocesses;
+static int		coprocesses_init = 0;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: coprocess_get                                                    *
+ *                                                                            *
+ * Purpose: find coprocess configured for the specified script                *
+ *                                                                            *
+ * Parameters: name - [IN] script name                                        *
+ *                                                                            *
+ * Return value: the coprocess or NULL if script must be executed per check   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_coprocess_t	*coprocess_get(const char *name)
+{
+	zbx_coprocess_t	*cp;
+	char		**value;
+	int		i;
+
+	if (NULL == CONFIG_EXTERNAL_COPROCESS || NULL == *CONFIG_EXTERNAL_COPROCESS)
+		return NULL;
+
+	if (0 == coprocesses_init)
+	{
+		zbx_vector_ptr_create(&coprocesses);
+		coprocesses_init = 1;
+	}
+
+	for (i = 0; i < coprocesses.values_num; i++)
+	{
+		cp = (zbx_coprocess_t *)coprocesses.values[i];
+
+		if (0 == strcmp(cp->name, name))
+			return cp;
+	}
+
+	for (value = CONFIG_EXTERNAL_COPROCESS; NULL != *value; value++)
+	{
+		if (0 == strcmp(*value, name))
+			break;
+	}
+
+	if (NULL == *value)
+		return NULL;
+
+	cp = (zbx_coprocess_t *)zbx_malloc(NULL, sizeof(zbx_coprocess_t));
+	cp->name = zbx_strdup(NULL, name);
+	cp->pid = -1;
+	cp->fd_write = -1;
+	cp->fd_read = -1;
+	cp->buf_alloc = ZBX_KIBIBYTE;
+	cp->buf_offset = 0;
+	cp->buf = (char *)zbx_malloc(NULL, cp->buf_alloc);
+	zbx_vector_ptr_append(&coprocesses, cp);
+
+	return cp;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: coprocess_stop                                                   *
+ *                                                                            *
+ * Purpose: kill coprocess, it will be started again by the next check        *
+ *                                                                            *
+ ******************************************************************************/
+static void	coprocess_stop(zbx_coprocess_t *cp)
+{
+	if (-1 == cp->pid)
+		return;
+
+	zbx_coprocess_close(cp->pid, cp->fd_write, cp->fd_read);
+
+	cp->pid = -1;
+	cp->fd_write = -1;
+	cp->fd_read = -1;
+	cp->buf_offset = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: coprocess_wait                                                   *
+ *                                                                            *
+ * Purpose: wait until the coprocess pipe is ready for reading or writing     *
+ *                                                                            *
+ * Parameters: fd       - [IN] the pipe descriptor                            *
+ *             events   - [IN] POLLIN or POLLOUT                              *
+ *             deadline - [IN] the time to wait until                         *
+ *                                                                            *
+ * Return value: SUCCEED       - the pipe is ready                            *
+ *               TIMEOUT_ERROR - the deadline has passed                      *
+ *               FAIL          - poll() failed, errno is set appropriately    *
+ *                                                                            *
+ ******************************************************************************/
+static int	coprocess_wait(int fd, short events, double deadline)
+{
+	struct pollfd	pfd;
+	int		timeout_ms, rc;
+
+	pfd.fd = fd;
+	pfd.events = events;
+
+	while (1)
+	{
+		if (0 >= (timeout_ms = (int)((deadline - zbx_time()) * 1000)))
+			return TIMEOUT_ERROR;
+
+		if (0 < (rc = poll(&pfd, 1, timeout_ms)))
+			return SUCCEED;
+
+		if (-1 == rc && EINTR != errno)
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: coprocess_execute                                                *
+ *                                                                            *
+ * Purpose: pass item key parameters to the coprocess and read the result     *
+ *                                                                            *
+ * Parameters: cp      - [IN] the coprocess                                   *
+ *             command - [IN] full path of the script                         *
+ *             request - [IN] item key parameters                             *
+ *             result  - [OUT] the result line, must be freed by caller       *
+ *             error   - [OUT] error message                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the result line was read                           *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: the coprocess is stopped on any communication error or timeout   *
+ *           because the request and response streams are out of sync then.   *
+ *           Both writing the request and reading the response are limited    *
+ *           by Timeout, the request pipe is non-blocking so that a script    *
+ *           not reading its input cannot block the poller.                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	coprocess_execute(zbx_coprocess_t *cp, const char *command, const AGENT_REQUEST *request,
+		char **result, char **error)
+{
+	struct zbx_json	j;
+	const char	*data;
+	char		*eol;
+	size_t		left;
+	ssize_t		n;
+	double		deadline;
+	int		i, rc, ret = FAIL;
+
+	if (-1 == cp->pid)
+	{
+		if (SUCCEED != zbx_coprocess_open(command, &cp->pid, &cp->fd_write, &cp->fd_read))
+		{
+			*error = zbx_dsprintf(*error, "Cannot start \"%s\": %s", command, zbx_strerror(errno));
+			cp->pid = -1;
+			return FAIL;
+		}
+
+		if (-1 == fcntl(cp->fd_write, F_SETFL, O_NONBLOCK))
+		{
+			*error = zbx_dsprintf(*error, "Cannot set non-blocking mode for \"%s\" input: %s", command,
+					zbx_strerror(errno));
+			coprocess_stop(cp);
+			return FAIL;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "started external coprocess \"%s\" pid:%d", command, (int)cp->pid);
+	}
+
+	zbx_json_initarray(&j, ZBX_JSON_STAT_BUF_LEN);
+
+	for (i = 0; i < get_rparams_num(request); i++)
+		zbx_json_addstring(&j, NULL, get_rparam(request, i), ZBX_JSON_TYPE_STRING);
+
+	zbx_json_close(&j);
+	zbx_chrcpy_alloc(&j.buffer, &j.buffer_allocated, &j.buffer_size, '\n');
+
+	deadline = zbx_time() + CONFIG_TIMEOUT;
+
+	for (data = j.buffer, left = j.buffer_size; 0 < left; data += n, left -= n)
+	{
+		if (-1 != (n = write(cp->fd_write, data, left)))
+			continue;
+
+		n = 0;
+
+		if (EINTR == errno)
+			continue;
+
+		if (EAGAIN != errno && EWOULDBLOCK != errno)
+		{
+			*error = zbx_dsprintf(*error, "Cannot write to \"%s\": %s", command, zbx_strerror(errno));
+			goto out;
+		}
+
+		if (SUCCEED != (rc = coprocess_wait(cp->fd_write, POLLOUT, deadline)))
+		{
+			if (TIMEOUT_ERROR == rc)
+				*error = zbx_dsprintf(*error, "Timeout while writing request to \"%s\".", command);
+			else
+				*error = zbx_dsprintf(*error, "Cannot wait for \"%s\" input: %s", command, zbx_strerror(errno));
+
+			goto out;
+		}
+	}
+
+	while (NULL == (eol = (char *)memchr(cp->buf, '\n', cp->buf_offset)))
+	{
+		if (SUCCEED != (rc = coprocess_wait(cp->fd_read, POLLIN, deadline)))
+		{
+			if (TIMEOUT_ERROR == rc)
+			{
+				*error = zbx_dsprintf(*error, "Timeout while waiting for \"%s\" response.", command);
+			}
+			else
+			{
+				*error = zbx_dsprintf(*error, "Cannot wait for \"%s\" response: %s", command,
+						zbx_strerror(errno));
+			}
+
+			goto out;
+		}
+
+		if (MAX_EXECUTE_OUTPUT_LEN <= cp->buf_offset)
+		{
+			*error = zbx_dsprintf(*error, "Response of \"%s\" exceeded limit of %d KB.", command,
+					MAX_EXECUTE_OUTPUT_LEN / ZBX_KIBIBYTE);
+			goto out;
+		}
+
+		if (cp->buf_alloc - cp->buf_offset < PIPE_BUF)
+		{
+			cp->buf_alloc *= 2;
+			cp->buf = (char *)zbx_realloc(cp->buf, cp->buf_alloc);
+		}
+
+		if (0 >= (n = read(cp->fd_read, cp->buf + cp->buf_offset, cp->buf_alloc - cp->buf_offset)))
+		{
+			if (-1 == n && EINTR == errno)
+				continue;
+
+			if (0 == n)
+				*error = zbx_dsprintf(*error, "\"%s\" terminated unexpectedly.", command);
+			else
+			{
+				*error = zbx_dsprintf(*error, "Cannot read from \"%s\": %s", command,
+						zbx_strerror(errno));
+			}
+
+			goto out;
+		}
+
+		cp->buf_offset += n;
+	}
+
+	*eol = '\0';
+	*result = zbx_strdup(*result, cp->buf);
+
+	/* keep data the coprocess might have written ahead of the next request */
+	cp->buf_offset -= eol - cp->buf + 1;
+	memmove(cp->buf, eol + 1, cp->buf_offset);
+
+	ret = SUCCEED;
+out:
+	zbx_json_free(&j);
+
+	if (SUCCEED != ret)
+		coprocess_stop(cp);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: external_coprocesses_stop                                        *
+ *                                                                            *
+ * Purpose: kill coprocesses started by this process and free their data      *
+ *                                                                            *
+ * Comments: coprocesses run in their own process groups and are not reached  *
+ *           by the signals sent to the poller, so they must be killed when   *
+ *           the poller exits                                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	external_coprocesses_stop(void)
+{
+	zbx_coprocess_t	*cp;
+	int		i;
+
+	if (0 == coprocesses_init)
+		return;
+
+	for (i = 0; i < coprocesses.values_num; i++)
+	{
+		cp = (zbx_coprocess_t *)coprocesses.values[i];
+
+		coprocess_stop(cp);
+		zbx_free(cp->buf);
+		zbx_free(cp->name);
+		zbx_free(cp);
+	}
+
+	zbx_vector_ptr_destroy(&coprocesses);
+	coprocesses_init = 0;
+}
 
 /******************************************************************************
  *                                                                            *
@@ -48,6 +367,7 @@ int	get_value_external(DC_ITEM *item, AGENT_RESULT *result)
 	size_t		cmd_alloc = ZBX_KIBIBYTE, cmd_offset = 0;
 	int		i, ret = NOTSUPPORTED;
 	AGENT_REQUEST	request;
+	zbx_coprocess_t	*cp;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() key:'%s'", __function_name, item->key);
 
@@ -68,6 +388,33 @@ int	get_value_external(DC_ITEM *item, AGENT_RESULT *result)
 		goto out;
 	}
 
+	if (NULL != (cp = coprocess_get(get_rkey(&request))))
+	{
+		char	*errmsg = NULL;
+
+		if (SUCCEED != coprocess_execute(cp, cmd, &request, &buf, &errmsg))
+		{
+			SET_MSG_RESULT(result, errmsg);
+		}
+		else if (0 == strncmp(buf, ZBX_NOTSUPPORTED, sizeof(ZBX_NOTSUPPORTED) - 1))
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, buf + sizeof(ZBX_NOTSUPPORTED) - 1));
+			zbx_lrtrim(result->msg, ZBX_WHITESPACE ":");
+			zbx_free(buf);
+		}
+		else
+		{
+			zbx_rtrim(buf, ZBX_WHITESPACE);
+
+			set_result_type(result, ITEM_VALUE_TYPE_TEXT, buf);
+			zbx_free(buf);
+
+			ret = SUCCEED;
+		}
+
+		goto out;
+	}
+
 	for (i = 0; i < get_rparams_num(&request); i++)
 	{
 		const char	*param;
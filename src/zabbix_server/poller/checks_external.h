@@ -24,5 +24,6 @@
 #include "sysinfo.h"
 
 int     get_value_external(DC_ITEM *item, AGENT_RESULT *result);
+void	external_coprocesses_stop(void);
 
 #endif
@@ -35,6 +35,11 @@
 #define HTTP_STORE_RAW		0
 #define HTTP_STORE_JSON		1
 
+/* curl_multi_wait() is supported starting with version 7.28.0 (0x071c00) */
+#if LIBCURL_VERSION_NUM >= 0x071c00
+#	define ZBX_HTTP_MULTI
+#endif
+
 typedef struct
 {
 	char	*data;
@@ -43,6 +48,17 @@ typedef struct
 }
 zbx_http_response_t;
 
+typedef struct
+{
+	CURL			*easyhandle;
+	struct curl_slist	*headers_slist;
+	zbx_http_response_t	body;
+	zbx_http_response_t	header;
+	char			errbuf[CURL_ERROR_SIZE];
+	unsigned char		in_flight;
+}
+zbx_http_context_t;
+
 static const char	*zbx_request_string(int result)
 {
 	switch (result)
@@ -210,30 +226,33 @@ static void	http_output_json(unsigned char retrieve_mode, char **buffer, zbx_htt
 	zbx_json_free(&json);
 }
 
-int	get_value_http(const DC_ITEM *item, AGENT_RESULT *result)
+/******************************************************************************
+ *                                                                            *
+ * Function: http_context_prepare                                             *
+ *                                                                            *
+ * Purpose: prepare cURL easy handle to retrieve HTTP agent item value        *
+ *                                                                            *
+ * Parameters: item    - [IN] the HTTP agent item                             *
+ *             context - [IN/OUT] the request context                         *
+ *             error   - [OUT] the error message                              *
+ *                                                                            *
+ * Return value: SUCCEED - the request was prepared successfully              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	http_context_prepare(const DC_ITEM *item, zbx_http_context_t *context, char **error)
 {
-	const char		*__function_name = "get_value_http";
-
-	CURL			*easyhandle;
 	CURLcode		err;
-	char			url[ITEM_URL_LEN_MAX], errbuf[CURL_ERROR_SIZE], *error = NULL, *headers, *line, *buffer;
-	int			ret = NOTSUPPORTED, timeout_seconds, found = FAIL;
-	long			response_code;
-	struct curl_slist	*headers_slist = NULL;
-	struct zbx_json		json;
-	zbx_http_response_t	body = {0}, header = {0};
+	char			url[ITEM_URL_LEN_MAX], *headers, *line;
+	int			timeout_seconds, found = FAIL;
 	size_t			(*curl_body_cb)(void *ptr, size_t size, size_t nmemb, void *userdata);
 	char			application_json[] = {"Content-Type: application/json"};
 	char			application_xml[] = {"Content-Type: application/xml"};
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() request method '%s' URL '%s%s' headers '%s' message body '%s'",
-			__function_name, zbx_request_string(item->request_method), item->url, item->query_fields,
-			item->headers, item->posts);
-
-	if (NULL == (easyhandle = curl_easy_init()))
+	if (NULL == (context->easyhandle = curl_easy_init()))
 	{
-		SET_MSG_RESULT(result, zbx_strdup(NULL, "Cannot initialize cURL library"));
-		goto clean;
+		*error = zbx_strdup(*error, "Cannot initialize cURL library");
+		return FAIL;
 	}
 
 	switch (item->retrieve_mode)
@@ -247,98 +266,98 @@ int	get_value_http(const DC_ITEM *item, AGENT_RESULT *result)
 			break;
 		default:
 			THIS_SHOULD_NEVER_HAPPEN;
-			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Invalid retrieve mode"));
-			goto clean;
+			*error = zbx_strdup(*error, "Invalid retrieve mode");
+			return FAIL;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HEADERFUNCTION, curl_write_cb)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_HEADERFUNCTION, curl_write_cb)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set header function: %s",
-				curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set header function: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HEADERDATA, &header)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_HEADERDATA, &context->header)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set header callback: %s",
-				curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set header callback: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_WRITEFUNCTION, curl_body_cb)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_WRITEFUNCTION, curl_body_cb)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set write function: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set write function: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_WRITEDATA, &body)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_WRITEDATA, &context->body)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set write callback: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set write callback: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_ERRORBUFFER, errbuf)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_ERRORBUFFER, context->errbuf)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set error buffer: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set error buffer: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_PROXY, item->http_proxy)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_PRIVATE, context)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set proxy: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set private data: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_FOLLOWLOCATION,
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_PROXY, item->http_proxy)))
+	{
+		*error = zbx_dsprintf(*error, "Cannot set proxy: %s", curl_easy_strerror(err));
+		return FAIL;
+	}
+
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_FOLLOWLOCATION,
 			0 == item->follow_redirects ? 0L : 1L)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set follow redirects: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set follow redirects: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
 	if (0 != item->follow_redirects &&
-			CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_MAXREDIRS, ZBX_CURLOPT_MAXREDIRS)))
+			CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_MAXREDIRS,
+			ZBX_CURLOPT_MAXREDIRS)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set number of redirects allowed: %s",
-				curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set number of redirects allowed: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
 	if (FAIL == is_time_suffix(item->timeout, &timeout_seconds, strlen(item->timeout)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Invalid timeout: %s", item->timeout));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Invalid timeout: %s", item->timeout);
+		return FAIL;
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_TIMEOUT, (long)timeout_seconds)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_TIMEOUT, (long)timeout_seconds)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot specify timeout: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot specify timeout: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	if (SUCCEED != zbx_http_prepare_ssl(easyhandle, item->ssl_cert_file, item->ssl_key_file, item->ssl_key_password,
-			item->verify_peer, item->verify_host, &error))
+	if (SUCCEED != zbx_http_prepare_ssl(context->easyhandle, item->ssl_cert_file, item->ssl_key_file,
+			item->ssl_key_password, item->verify_peer, item->verify_host, error))
 	{
-		SET_MSG_RESULT(result, error);
-		goto clean;
+		return FAIL;
 	}
 
-	if (SUCCEED != zbx_http_prepare_auth(easyhandle, item->authtype, item->username, item->password, &error))
+	if (SUCCEED != zbx_http_prepare_auth(context->easyhandle, item->authtype, item->username, item->password,
+			error))
 	{
-		SET_MSG_RESULT(result, error);
-		goto clean;
+		return FAIL;
 	}
 
-	if (SUCCEED != http_prepare_request(easyhandle, item->posts, item->request_method, &error))
-	{
-		SET_MSG_RESULT(result, error);
-		goto clean;
-	}
+	if (SUCCEED != http_prepare_request(context->easyhandle, item->posts, item->request_method, error))
+		return FAIL;
 
 	headers = item->headers;
 	while (NULL != (line = zbx_http_get_header(&headers)))
 	{
-		headers_slist = curl_slist_append(headers_slist, line);
+		context->headers_slist = curl_slist_append(context->headers_slist, line);
 
 		if (FAIL == found && 0 == strncmp(line, "Content-Type:", ZBX_CONST_STRLEN("Content-Type:")))
 			found = SUCCEED;
@@ -349,99 +368,147 @@ int	get_value_http(const DC_ITEM *item, AGENT_RESULT *result)
 	if (FAIL == found)
 	{
 		if (ZBX_POSTTYPE_JSON == item->post_type)
-			headers_slist = curl_slist_append(headers_slist, application_json);
+			context->headers_slist = curl_slist_append(context->headers_slist, application_json);
 		else if (ZBX_POSTTYPE_XML == item->post_type)
-			headers_slist = curl_slist_append(headers_slist, application_xml);
+			context->headers_slist = curl_slist_append(context->headers_slist, application_xml);
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_HTTPHEADER, headers_slist)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_HTTPHEADER, context->headers_slist)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot specify headers: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot specify headers: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
 #if LIBCURL_VERSION_NUM >= 0x071304
 	/* CURLOPT_PROTOCOLS is supported starting with version 7.19.4 (0x071304) */
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_PROTOCOLS, CURLPROTO_HTTP | CURLPROTO_HTTPS)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_PROTOCOLS,
+			CURLPROTO_HTTP | CURLPROTO_HTTPS)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot set allowed protocols: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot set allowed protocols: %s", curl_easy_strerror(err));
+		return FAIL;
+	}
+#endif
+
+#if LIBCURL_VERSION_NUM >= 0x072f00
+	/* CURL_HTTP_VERSION_2TLS is supported starting with version 7.47.0 (0x072f00), it is negotiated with ALPN */
+	/* and falls back to HTTP/1.1 for servers without HTTP/2 support                                          */
+	if (0 != (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) &&
+			CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_HTTP_VERSION,
+			CURL_HTTP_VERSION_2TLS)))
+	{
+		*error = zbx_dsprintf(*error, "Cannot set HTTP version: %s", curl_easy_strerror(err));
+		return FAIL;
+	}
+#endif
+
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	/* CURLOPT_PIPEWAIT is supported starting with version 7.43.0 (0x072b00), it makes concurrent requests to */
+	/* the same host wait for a connection that can be multiplexed instead of opening new ones               */
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_PIPEWAIT, 1L)))
+	{
+		*error = zbx_dsprintf(*error, "Cannot set wait for multiplexing: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 #endif
 
 	zbx_snprintf(url, sizeof(url),"%s%s", item->url, item->query_fields);
-	if (CURLE_OK != (err = curl_easy_setopt(easyhandle, CURLOPT_URL, url)))
+	if (CURLE_OK != (err = curl_easy_setopt(context->easyhandle, CURLOPT_URL, url)))
 	{
-		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot specify URL: %s", curl_easy_strerror(err)));
-		goto clean;
+		*error = zbx_dsprintf(*error, "Cannot specify URL: %s", curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	*errbuf = '\0';
+	*context->errbuf = '\0';
+
+	return SUCCEED;
+}
 
-	if (CURLE_OK != (err = curl_easy_perform(easyhandle)))
+/******************************************************************************
+ *                                                                            *
+ * Function: http_context_process                                             *
+ *                                                                            *
+ * Purpose: convert completed HTTP request into HTTP agent item result        *
+ *                                                                            *
+ * Parameters: item    - [IN] the HTTP agent item                             *
+ *             context - [IN/OUT] the request context                         *
+ *             err     - [IN] the request transfer result                     *
+ *             result  - [OUT] the item result                                *
+ *                                                                            *
+ * Return value: SUCCEED      - the value was retrieved successfully          *
+ *               NOTSUPPORTED - otherwise                                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	http_context_process(const DC_ITEM *item, zbx_http_context_t *context, CURLcode err,
+		AGENT_RESULT *result)
+{
+	char		*headers, *line, *buffer;
+	long		response_code;
+	struct zbx_json	json;
+
+	if (CURLE_OK != err)
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot perform request: %s",
-				'\0' == *errbuf ? curl_easy_strerror(err) : errbuf));
-		goto clean;
+				'\0' == *context->errbuf ? curl_easy_strerror(err) : context->errbuf));
+		return NOTSUPPORTED;
 	}
 
-	if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_RESPONSE_CODE, &response_code)))
+	if (CURLE_OK != (err = curl_easy_getinfo(context->easyhandle, CURLINFO_RESPONSE_CODE, &response_code)))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Cannot get the response code: %s", curl_easy_strerror(err)));
-		goto clean;
+		return NOTSUPPORTED;
 	}
 
 	if ('\0' != *item->status_codes && FAIL == int_in_list(item->status_codes, response_code))
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Response code \"%ld\" did not match any of the"
 				" required status codes \"%s\"", response_code, item->status_codes));
-		goto clean;
+		return NOTSUPPORTED;
 	}
 
-	if (NULL == header.data)
+	if (NULL == context->header.data)
 	{
 		SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Server returned empty header"));
-		goto clean;
+		return NOTSUPPORTED;
 	}
 
 	switch (item->retrieve_mode)
 	{
 		case HTTP_RETRIEVE_MODE_CONTENT:
-			if (NULL == body.data)
+			if (NULL == context->body.data)
 			{
 				SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Server returned empty content"));
-				goto clean;
+				return NOTSUPPORTED;
 			}
 
-			if (FAIL == zbx_is_utf8(body.data))
+			if (FAIL == zbx_is_utf8(context->body.data))
 			{
 				SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Server returned invalid UTF-8 sequence"));
-				goto clean;
+				return NOTSUPPORTED;
 			}
 
 			if (HTTP_STORE_JSON == item->output_format)
 			{
-				http_output_json(item->retrieve_mode, &buffer, &header, &body);
+				http_output_json(item->retrieve_mode, &buffer, &context->header, &context->body);
 				SET_TEXT_RESULT(result, buffer);
 			}
 			else
 			{
-				SET_TEXT_RESULT(result, body.data);
-				body.data = NULL;
+				SET_TEXT_RESULT(result, context->body.data);
+				context->body.data = NULL;
 			}
 			break;
 		case HTTP_RETRIEVE_MODE_HEADERS:
-			if (FAIL == zbx_is_utf8(header.data))
+			if (FAIL == zbx_is_utf8(context->header.data))
 			{
 				SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Server returned invalid UTF-8 sequence"));
-				goto clean;
+				return NOTSUPPORTED;
 			}
 
 			if (HTTP_STORE_JSON == item->output_format)
 			{
 				zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
 				zbx_json_addobject(&json, "header");
-				headers = header.data;
+				headers = context->header.data;
 				while (NULL != (line = zbx_http_get_header(&headers)))
 				{
 					http_add_json_header(&json, line);
@@ -452,40 +519,230 @@ int	get_value_http(const DC_ITEM *item, AGENT_RESULT *result)
 			}
 			else
 			{
-				SET_TEXT_RESULT(result, header.data);
-				header.data = NULL;
+				SET_TEXT_RESULT(result, context->header.data);
+				context->header.data = NULL;
 			}
 			break;
 		case HTTP_RETRIEVE_MODE_BOTH:
-			if (FAIL == zbx_is_utf8(header.data) || (NULL != body.data && FAIL == zbx_is_utf8(body.data)))
+			if (FAIL == zbx_is_utf8(context->header.data) ||
+					(NULL != context->body.data && FAIL == zbx_is_utf8(context->body.data)))
 			{
 				SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Server returned invalid UTF-8 sequence"));
-				goto clean;
+				return NOTSUPPORTED;
 			}
 
 			if (HTTP_STORE_JSON == item->output_format)
 			{
-				http_output_json(item->retrieve_mode, &buffer, &header, &body);
+				http_output_json(item->retrieve_mode, &buffer, &context->header, &context->body);
 				SET_TEXT_RESULT(result, buffer);
 			}
 			else
 			{
-				zbx_strncpy_alloc(&header.data, &header.allocated, &header.offset,
-						body.data, body.offset);
-				SET_TEXT_RESULT(result, header.data);
-				header.data = NULL;
+				zbx_strncpy_alloc(&context->header.data, &context->header.allocated,
+						&context->header.offset, context->body.data, context->body.offset);
+				SET_TEXT_RESULT(result, context->header.data);
+				context->header.data = NULL;
+			}
+			break;
+	}
+
+	return SUCCEED;
+}
+
+static void	http_context_clean(zbx_http_context_t *context)
+{
+	if (NULL != context->easyhandle)
+		curl_easy_cleanup(context->easyhandle);
+
+	curl_slist_free_all(context->headers_slist);	/* must be called after curl_easy_cleanup() */
+	zbx_free(context->body.data);
+	zbx_free(context->header.data);
+}
+
+#ifdef ZBX_HTTP_MULTI
+/******************************************************************************
+ *                                                                            *
+ * Function: http_multi_get                                                   *
+ *                                                                            *
+ * Purpose: get cURL multi handle shared by all HTTP agent checks of the      *
+ *          poller process                                                    *
+ *                                                                            *
+ * Return value: the multi handle or NULL if it cannot be initialized         *
+ *                                                                            *
+ * Comments: The multi handle is kept for the lifetime of the process so its  *
+ *           connection cache lets subsequent checks reuse open connections.  *
+ *                                                                            *
+ ******************************************************************************/
+static CURLM	*http_multi_get(void)
+{
+	static CURLM	*multi = NULL;
+
+	if (NULL != multi)
+		return multi;
+
+	if (NULL == (multi = curl_multi_init()))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize cURL multi handle, HTTP agent checks will be"
+				" performed sequentially");
+		return NULL;
+	}
+
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	/* CURLPIPE_MULTIPLEX is supported starting with version 7.43.0 (0x072b00) */
+	if (CURLM_OK != curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX))
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot enable HTTP/2 multiplexing on cURL multi handle");
+#endif
+	return multi;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: http_multi_perform                                               *
+ *                                                                            *
+ * Purpose: run all added requests until they are completed                   *
+ *                                                                            *
+ * Parameters: multi     - [IN] the multi handle                              *
+ *             items     - [IN] the HTTP agent items                          *
+ *             contexts  - [IN/OUT] the request contexts                      *
+ *             results   - [OUT] the item results                             *
+ *             errcodes  - [OUT] the item error codes                         *
+ *             in_flight - [IN] the number of requests added to multi handle  *
+ *                                                                            *
+ * Comments: Requests are bound by their own timeouts, so the loop ends when  *
+ *           the slowest of them completes or times out.                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	http_multi_perform(CURLM *multi, const DC_ITEM *items, zbx_http_context_t *contexts,
+		AGENT_RESULT *results, int *errcodes, int in_flight)
+{
+	CURLMcode		code = CURLM_OK;
+	CURLMsg			*msg;
+	zbx_http_context_t	*context;
+	int			running, msgnum, fds, i;
+
+	while (0 < in_flight)
+	{
+		if (CURLM_OK != (code = curl_multi_perform(multi, &running)))
+			break;
+
+		while (NULL != (msg = curl_multi_info_read(multi, &msgnum)))
+		{
+			if (CURLMSG_DONE != msg->msg)
+				continue;
+
+			if (CURLE_OK != curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&context))
+			{
+				THIS_SHOULD_NEVER_HAPPEN;
+				continue;
 			}
+
+			i = (int)(context - contexts);
+			errcodes[i] = http_context_process(&items[i], context, msg->data.result, &results[i]);
+
+			curl_multi_remove_handle(multi, context->easyhandle);
+			context->in_flight = 0;
+			in_flight--;
+		}
+
+		if (0 == in_flight)
+			break;
+
+		if (CURLM_OK != (code = curl_multi_wait(multi, NULL, 0, SEC_PER_MIN * 1000, &fds)))
 			break;
 	}
 
-	ret = SUCCEED;
-clean:
-	curl_slist_free_all(headers_slist);	/* must be called after curl_easy_perform() */
-	curl_easy_cleanup(easyhandle);
-	zbx_free(body.data);
-	zbx_free(header.data);
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __function_name, zbx_result_string(ret));
+	if (0 == in_flight)
+		return;
+
+	zabbix_log(LOG_LEVEL_WARNING, "cannot perform on cURL multi handle: %s", curl_multi_strerror(code));
+
+	for (i = 0; 0 < in_flight; i++)
+	{
+		if (0 == contexts[i].in_flight)
+			continue;
+
+		SET_MSG_RESULT(&results[i], zbx_dsprintf(NULL, "Cannot perform request: %s",
+				curl_multi_strerror(code)));
+		errcodes[i] = NOTSUPPORTED;
+
+		curl_multi_remove_handle(multi, contexts[i].easyhandle);
+		contexts[i].in_flight = 0;
+		in_flight--;
+	}
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: get_values_http                                                  *
+ *                                                                            *
+ * Purpose: retrieve values of HTTP agent items                               *
+ *                                                                            *
+ * Parameters: items    - [IN] the HTTP agent items                           *
+ *             results  - [OUT] the item results                              *
+ *             errcodes - [IN/OUT] the item error codes, only items with      *
+ *                                 SUCCEED error code are processed           *
+ *             num      - [IN] the number of items                            *
+ *                                                                            *
+ * Comments: The requests are performed concurrently with cURL multi          *
+ *           interface, requests to the same host share connections and are  *
+ *           multiplexed over HTTP/2 when the server supports it.             *
+ *                                                                            *
+ ******************************************************************************/
+void	get_values_http(const DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num)
+{
+	const char		*__function_name = "get_values_http";
+
+	zbx_http_context_t	*contexts;
+	char			*error = NULL;
+	int			i;
+#ifdef ZBX_HTTP_MULTI
+	CURLM			*multi;
+	int			in_flight = 0;
+
+	multi = http_multi_get();
+#endif
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() num:%d", __function_name, num);
+
+	contexts = (zbx_http_context_t *)zbx_malloc(NULL, sizeof(zbx_http_context_t) * num);
+	memset(contexts, 0, sizeof(zbx_http_context_t) * num);
+
+	for (i = 0; i < num; i++)
+	{
+		if (SUCCEED != errcodes[i])
+			continue;
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() request method '%s' URL '%s%s' headers '%s' message body '%s'",
+				__function_name, zbx_request_string(items[i].request_method), items[i].url,
+				items[i].query_fields, items[i].headers, items[i].posts);
+
+		if (SUCCEED != http_context_prepare(&items[i], &contexts[i], &error))
+		{
+			SET_MSG_RESULT(&results[i], error);
+			errcodes[i] = NOTSUPPORTED;
+			error = NULL;
+			continue;
+		}
+#ifdef ZBX_HTTP_MULTI
+		if (NULL != multi && CURLM_OK == curl_multi_add_handle(multi, contexts[i].easyhandle))
+		{
+			contexts[i].in_flight = 1;
+			in_flight++;
+			continue;
+		}
+#endif
+		errcodes[i] = http_context_process(&items[i], &contexts[i], curl_easy_perform(contexts[i].easyhandle),
+				&results[i]);
+	}
+#ifdef ZBX_HTTP_MULTI
+	if (0 != in_flight)
+		http_multi_perform(multi, items, contexts, results, errcodes, in_flight);
+#endif
+	for (i = 0; i < num; i++)
+		http_context_clean(&contexts[i]);
+
+	zbx_free(contexts);
 
-	return ret;
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __function_name);
 }
 #endif
@@ -25,7 +25,7 @@
 #ifdef HAVE_LIBCURL
 #include "dbcache.h"
 
-int	get_value_http(const DC_ITEM *item, AGENT_RESULT *result);
+void	get_values_http(const DC_ITEM *items, AGENT_RESULT *results, int *errcodes, int num);
 #endif
 
 #endif
@@ -27,6 +27,7 @@
 #include "preproc.h"
 
 #include "../vmware/vmware.h"
+#include "../../libs/zbxcrypto/tls.h"
 #include "../../libs/zbxserver/zabbix_stats.h"
 #include "../../libs/zbxsysinfo/common/zabbix_stats.h"
 
@@ -837,6 +838,69 @@ int	get_value_internal(DC_ITEM *item, AGENT_RESULT *result)
 			goto out;
 		}
 	}
+#if defined(HAVE_OPENSSL)
+	else if (0 == strcmp(tmp, "tls"))			/* zabbix[tls,<type>,<mode>] */
+	{
+		zbx_tls_stats_t	stats;
+		zbx_uint64_t	count;
+		double		total_time;
+
+		if (2 > nparams || nparams > 3)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		if (FAIL == zbx_tls_get_stats(&stats))
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "TLS handshake statistics are not collected."));
+			goto out;
+		}
+
+		tmp = get_rparam(&request, 1);
+
+		if (0 == strcmp(tmp, "full"))
+		{
+			count = stats.full;
+			total_time = stats.full_time;
+		}
+		else if (0 == strcmp(tmp, "resumed"))
+		{
+			count = stats.resumed;
+			total_time = stats.resumed_time;
+		}
+		else if (0 == strcmp(tmp, "failed"))
+		{
+			count = stats.failed;
+			total_time = -1;
+		}
+		else
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+
+		if (NULL == (tmp = get_rparam(&request, 2)) || '\0' == *tmp || 0 == strcmp(tmp, "count"))
+		{
+			SET_UI64_RESULT(result, count);
+		}
+		else if (0 == strcmp(tmp, "avgtime") && 0 <= total_time)
+		{
+			SET_DBL_RESULT(result, 0 == count ? 0 : total_time / count);
+		}
+		else
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+			goto out;
+		}
+	}
+#else
+	else if (0 == strcmp(tmp, "tls"))			/* zabbix[tls,<type>,<mode>] */
+	{
+		SET_MSG_RESULT(result, zbx_strdup(NULL, "TLS handshake statistics are collected only with OpenSSL."));
+		goto out;
+	}
+#endif
 	else if (0 == strcmp(tmp, "preprocessing_queue"))
 	{
 		if (0 == (program_type & ZBX_PROGRAM_TYPE_SERVER))
@@ -395,14 +395,6 @@ static int	get_value(DC_ITEM *item, AGENT_RESULT *result, zbx_vector_ptr_t *add_
 		case ITEM_TYPE_CALCULATED:
 			res = get_value_calculated(item, result);
 			break;
-		case ITEM_TYPE_HTTPAGENT:
-#ifdef HAVE_LIBCURL
-			res = get_value_http(item, result);
-#else
-			SET_MSG_RESULT(result, zbx_strdup(NULL, "Support for HTTP agent checks was not compiled in."));
-			res = CONFIG_ERROR;
-#endif
-			break;
 		default:
 			SET_MSG_RESULT(result, zbx_dsprintf(NULL, "Not supported item type:%d", item->type));
 			res = CONFIG_ERROR;
@@ -495,8 +487,8 @@ static int	parse_query_fields(const DC_ITEM *item, char **query_fields)
  *                                                                            *
  * Author: Alexei Vladishev                                                   *
  *                                                                            *
- * Comments: processes single item at a time except for Java, SNMP items,     *
- *           see DCconfig_get_poller_items()                                  *
+ * Comments: processes single item at a time except for Java, SNMP and HTTP    *
+ *           agent items, see DCconfig_get_poller_items()                     *
  *                                                                            *
  ******************************************************************************/
 static int	get_values(unsigned char poller_type, int *nextcheck)
@@ -726,6 +718,23 @@ static int	get_values(unsigned char poller_type, int *nextcheck)
 		get_values_java(ZBX_JAVA_GATEWAY_REQUEST_JMX, items, results, errcodes, num);
 		zbx_alarm_off();
 	}
+	else if (ITEM_TYPE_HTTPAGENT == items[0].type)
+	{
+#ifdef HAVE_LIBCURL
+		/* HTTP agent checks use their own timeouts */
+		get_values_http(items, results, errcodes, num);
+#else
+		for (i = 0; i < num; i++)
+		{
+			if (SUCCEED != errcodes[i])
+				continue;
+
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL,
+					"Support for HTTP agent checks was not compiled in."));
+			errcodes[i] = CONFIG_ERROR;
+		}
+#endif
+	}
 	else if (1 == num)
 	{
 		if (SUCCEED == errcodes[0])
@@ -951,6 +960,8 @@ ZBX_THREAD_ENTRY(poller_thread, args)
 		zbx_sleep_loop(sleeptime);
 	}
 
+	external_coprocesses_stop();
+
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
 
 	while (1)
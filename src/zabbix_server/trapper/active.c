@@ -448,8 +448,10 @@ out:
  *                                                                            *
  * Purpose: send list of active checks to the host                            *
  *                                                                            *
- * Parameters: sock - open socket of server-agent connection                  *
- *             json - request buffer                                          *
+ * Parameters: sock      - open socket of server-agent connection             *
+ *             json      - request buffer                                     *
+ *             keepalive - number of seconds the connection is kept open for  *
+ *                         the next request, 0 if it is closed                *
  *                                                                            *
  * Return value:  SUCCEED - list of active checks sent successfully           *
  *                FAIL - an error occurred                                    *
@@ -459,15 +461,15 @@ out:
  * Comments:                                                                  *
  *                                                                            *
  ******************************************************************************/
-int	send_list_of_active_checks_json(zbx_socket_t *sock, struct zbx_json_parse *jp)
+int	send_list_of_active_checks_json(zbx_socket_t *sock, struct zbx_json_parse *jp, int keepalive)
 {
 	const char		*__function_name = "send_list_of_active_checks_json";
 
 	char			host[HOST_HOST_LEN_MAX], tmp[MAX_STRING_LEN], ip[INTERFACE_IP_LEN_MAX],
 				error[MAX_STRING_LEN], *host_metadata = NULL;
 	struct zbx_json		json;
-	int			ret = FAIL, i;
-	zbx_uint64_t		hostid;
+	int			ret = FAIL, i, send_revision = 1;
+	zbx_uint64_t		hostid, revision, agent_revision;
 	size_t			host_metadata_alloc = 1;	/* for at least NUL-termination char */
 	unsigned short		port;
 	zbx_vector_uint64_t	itemids;
@@ -516,12 +518,26 @@ int	send_list_of_active_checks_json(zbx_socket_t *sock, struct zbx_json_parse *j
 	if (FAIL == get_hostid_by_host(sock, host, ip, port, host_metadata, &hostid, error))
 		goto error;
 
+	revision = zbx_dc_get_active_checks_revision(hostid);
+
+	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
+	zbx_json_addstring(&json, ZBX_PROTO_TAG_RESPONSE, ZBX_PROTO_VALUE_SUCCESS, ZBX_JSON_TYPE_STRING);
+
+	if (0 != keepalive)
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_KEEPALIVE, keepalive);
+
+	/* the list is not sent to agents that already have its current revision */
+	if (0 != revision && SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_CONFIG_REVISION, tmp, sizeof(tmp),
+			NULL) && SUCCEED == is_uint64(tmp, &agent_revision) && agent_revision == revision)
+	{
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_CONFIG_REVISION, revision);
+		goto send;
+	}
+
 	zbx_vector_uint64_create(&itemids);
 
 	get_list_of_active_checks(hostid, &itemids);
 
-	zbx_json_init(&json, ZBX_JSON_STAT_BUF_LEN);
-	zbx_json_addstring(&json, ZBX_PROTO_TAG_RESPONSE, ZBX_PROTO_VALUE_SUCCESS, ZBX_JSON_TYPE_STRING);
 	zbx_json_addarray(&json, ZBX_PROTO_TAG_DATA);
 
 	if (0 != itemids.values_num)
@@ -544,6 +560,7 @@ int	send_list_of_active_checks_json(zbx_socket_t *sock, struct zbx_json_parse *j
 			{
 				zabbix_log(LOG_LEVEL_DEBUG, "%s() Item [" ZBX_FS_UI64 "] was not found in the"
 						" server cache. Not sending now.", __function_name, itemids.values[i]);
+				send_revision = 0;
 				continue;
 			}
 
@@ -558,6 +575,9 @@ int	send_list_of_active_checks_json(zbx_socket_t *sock, struct zbx_json_parse *j
 				if (0 == cfg.refresh_unsupported)
 					continue;
 
+				/* the list changes with time, it cannot be identified by revision */
+				send_revision = 0;
+
 				if (dc_items[i].lastclock + cfg.refresh_unsupported > now)
 					continue;
 			}
@@ -630,6 +650,9 @@ int	send_list_of_active_checks_json(zbx_socket_t *sock, struct zbx_json_parse *j
 		zbx_json_close(&json);
 	}
 
+	if (0 != revision && 0 != send_revision)
+		zbx_json_adduint64(&json, ZBX_PROTO_TAG_CONFIG_REVISION, revision);
+send:
 	zabbix_log(LOG_LEVEL_DEBUG, "%s() sending [%s]", __function_name, json.buffer);
 
 	zbx_alarm_on(CONFIG_TIMEOUT);
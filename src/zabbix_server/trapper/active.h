@@ -28,6 +28,6 @@
 extern int	CONFIG_TIMEOUT;
 
 int	send_list_of_active_checks(zbx_socket_t *sock, char *request);
-int	send_list_of_active_checks_json(zbx_socket_t *sock, struct zbx_json_parse *json);
+int	send_list_of_active_checks_json(zbx_socket_t *sock, struct zbx_json_parse *json, int keepalive);
 
 #endif
@@ -1039,7 +1039,34 @@ static void	active_passive_misconfig(zbx_socket_t *sock)
 	zbx_free(msg);
 }
 
-static int	process_trap(zbx_socket_t *sock, char *s, zbx_timespec_t *ts)
+/******************************************************************************
+ *                                                                            *
+ * Function: trapper_get_keepalive                                            *
+ *                                                                            *
+ * Purpose: checks if active agent asks to keep the connection open for the   *
+ *          following requests and if it can be done                          *
+ *                                                                            *
+ * Return value: number of seconds to keep the connection open or 0           *
+ *                                                                            *
+ ******************************************************************************/
+static int	trapper_get_keepalive(const struct zbx_json_parse *jp)
+{
+	char	value[MAX_ID_LEN + 1];
+
+	/* kept connections wait in the list of pending connections */
+	if (0 == CONFIG_TRAPPER_KEEPALIVE || 0 == CONFIG_TRAPPER_IDLE_CONNECTIONS)
+		return 0;
+
+	if (SUCCEED != zbx_json_value_by_name(jp, ZBX_PROTO_TAG_KEEPALIVE, value, sizeof(value), NULL) ||
+			0 == atoi(value))
+	{
+		return 0;
+	}
+
+	return CONFIG_TRAPPER_KEEPALIVE;
+}
+
+static int	process_trap(zbx_socket_t *sock, char *s, zbx_timespec_t *ts, int *keepalive)
 {
 	int	ret = SUCCEED;
 
@@ -1087,6 +1114,8 @@ static int	process_trap(zbx_socket_t *sock, char *s, zbx_timespec_t *ts)
 			}
 			else if (0 == strcmp(value, ZBX_PROTO_VALUE_AGENT_DATA))
 			{
+				/* values resent after a broken kept connection are filtered out by data session */
+				*keepalive = trapper_get_keepalive(&jp);
 				recv_agenthistory(sock, &jp, ts);
 			}
 			else if (0 == strcmp(value, ZBX_PROTO_VALUE_SENDER_DATA))
@@ -1133,7 +1162,12 @@ static int	process_trap(zbx_socket_t *sock, char *s, zbx_timespec_t *ts)
 			}
 			else if (0 == strcmp(value, ZBX_PROTO_VALUE_GET_ACTIVE_CHECKS))
 			{
-				ret = send_list_of_active_checks_json(sock, &jp);
+				int	timeout;
+
+				timeout = trapper_get_keepalive(&jp);
+
+				if (SUCCEED == (ret = send_list_of_active_checks_json(sock, &jp, timeout)))
+					*keepalive = timeout;
 			}
 			else if (0 == strcmp(value, ZBX_PROTO_VALUE_HOST_AVAILABILITY))
 			{
@@ -1237,19 +1271,24 @@ static int	process_trap(zbx_socket_t *sock, char *s, zbx_timespec_t *ts)
 	return ret;
 }
 
-static void	process_trapper_child(zbx_socket_t *sock, zbx_timespec_t *ts)
+static int	process_trapper_child(zbx_socket_t *sock, zbx_timespec_t *ts)
 {
+	int	keepalive = 0;
+
 	if (SUCCEED != zbx_tcp_recv_to(sock, CONFIG_TRAPPER_TIMEOUT))
-		return;
+		return 0;
+
+	process_trap(sock, sock->buffer, ts, &keepalive);
 
-	process_trap(sock, sock->buffer, ts);
+	return keepalive;
 }
 
 ZBX_THREAD_ENTRY(trapper_thread, args)
 {
-	double		sec = 0.0;
-	zbx_socket_t	s;
-	int		ret;
+	double			sec = 0.0;
+	zbx_socket_t		s;
+	zbx_tcp_pending_t	pending;
+	int			ret, keepalive;
 
 	process_type = ((zbx_thread_args_t *)args)->process_type;
 	server_num = ((zbx_thread_args_t *)args)->server_num;
@@ -1277,6 +1316,9 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 		DCsync_configuration(ZBX_DBSYNC_INIT);
 	}
 
+	if (0 != CONFIG_TRAPPER_IDLE_CONNECTIONS)
+		zbx_tcp_pending_init(&pending, CONFIG_TRAPPER_IDLE_CONNECTIONS);
+
 	while (ZBX_IS_RUNNING())
 	{
 		zbx_setproctitle("%s #%d [processed data in " ZBX_FS_DBL " sec, waiting for connection]",
@@ -1287,7 +1329,13 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 		/* Trapper has to accept all types of connections it can accept with the specified configuration. */
 		/* Only after receiving data it is known who has sent them and one can decide to accept or discard */
 		/* the data. */
-		ret = zbx_tcp_accept(&s, ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK | ZBX_TCP_SEC_UNENCRYPTED);
+		if (0 != CONFIG_TRAPPER_IDLE_CONNECTIONS)
+		{
+			ret = zbx_tcp_accept_pending(&s, &pending, ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK |
+					ZBX_TCP_SEC_UNENCRYPTED, CONFIG_TIMEOUT);
+		}
+		else
+			ret = zbx_tcp_accept(&s, ZBX_TCP_SEC_TLS_CERT | ZBX_TCP_SEC_TLS_PSK | ZBX_TCP_SEC_UNENCRYPTED);
 		zbx_update_env(zbx_time());
 
 		if (SUCCEED == ret)
@@ -1303,10 +1351,11 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 					process_num);
 
 			sec = zbx_time();
-			process_trapper_child(&s, &ts);
+			keepalive = process_trapper_child(&s, &ts);
 			sec = zbx_time() - sec;
 
-			zbx_tcp_unaccept(&s);
+			if (0 == keepalive || SUCCEED != zbx_tcp_pending_keep(&s, &pending, keepalive))
+				zbx_tcp_unaccept(&s);
 		}
 		else if (EINTR != zbx_socket_last_error())
 		{
@@ -1315,6 +1364,9 @@ ZBX_THREAD_ENTRY(trapper_thread, args)
 		}
 	}
 
+	if (0 != CONFIG_TRAPPER_IDLE_CONNECTIONS)
+		zbx_tcp_pending_destroy(&pending);
+
 	zbx_setproctitle("%s #%d [terminated]", get_process_type_string(process_type), process_num);
 
 	while (1)
@@ -25,6 +25,8 @@
 
 extern int	CONFIG_TIMEOUT;
 extern int	CONFIG_TRAPPER_TIMEOUT;
+extern int	CONFIG_TRAPPER_IDLE_CONNECTIONS;
+extern int	CONFIG_TRAPPER_KEEPALIVE;
 extern char	*CONFIG_STATS_ALLOWED_IP;
 
 ZBX_THREAD_ENTRY(trapper_thread, args);
@@ -107,6 +107,14 @@ static zbx_vmware_t	*vmware = NULL;
 #define ZBX_VPXD_STATS_MAXQUERYMETRICS	64
 #define ZBX_MAXQUERYMETRICS_UNLIMITED	1000
 
+/* the maximum number of SOAP requests performed concurrently within one vmware service session */
+#define ZBX_VMWARE_CONCURRENT_REQUESTS	8
+
+/* curl_multi_wait() was added in cURL 7.28.0 */
+#if LIBCURL_VERSION_NUM >= 0x071c00
+#	define ZBX_VMWARE_MULTI
+#endif
+
 ZBX_VECTOR_IMPL(str_uint64_pair, zbx_str_uint64_pair_t)
 ZBX_PTR_VECTOR_IMPL(vmware_datastore, zbx_vmware_datastore_t *)
 
@@ -410,28 +418,114 @@ static void	vmware_shared_strfree(char *str)
 
 typedef struct
 {
-	char	*data;
-	size_t	alloc;
-	size_t	offset;
+	/* the raw response, kept only when trace logging is enabled */
+	char			*data;
+	size_t			alloc;
+	size_t			offset;
+
+	/* the push parser building response document while it is being received */
+	xmlParserCtxtPtr	ctxt;
 }
 ZBX_HTTPPAGE;
 
+static void	libxml_handle_error(void *user_data, xmlErrorPtr err);
 static int	zbx_xml_read_values(xmlDoc *xdoc, const char *xpath, zbx_vector_str_t *values);
-static int	zbx_xml_try_read_value(const char *data, size_t len, const char *xpath, xmlDoc **xdoc, char **value,
-		char **error);
 static char	*zbx_xml_read_node_value(xmlDoc *doc, xmlNode *node, const char *xpath);
 static char	*zbx_xml_read_doc_value(xmlDoc *xdoc, const char *xpath);
+static void	vmware_connections_reset(void);
 
 static size_t	curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
 	size_t		r_size = size * nmemb;
 	ZBX_HTTPPAGE	*page_http = (ZBX_HTTPPAGE *)userdata;
 
-	zbx_strncpy_alloc(&page_http->data, &page_http->alloc, &page_http->offset, (const char *)ptr, r_size);
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_TRACE))
+		zbx_strncpy_alloc(&page_http->data, &page_http->alloc, &page_http->offset, (const char *)ptr, r_size);
+
+	xmlSetStructuredErrorFunc(NULL, &libxml_handle_error);
+
+	if (NULL == page_http->ctxt)
+	{
+		if (NULL != (page_http->ctxt = xmlCreatePushParserCtxt(NULL, NULL, NULL, 0, ZBX_VM_NONAME_XML)))
+			xmlCtxtUseOptions(page_http->ctxt, ZBX_XML_PARSE_OPTS);
+	}
+
+	if (NULL != page_http->ctxt)
+		xmlParseChunk(page_http->ctxt, (const char *)ptr, (int)r_size, 0);
+
+	xmlSetStructuredErrorFunc(NULL, NULL);
 
 	return r_size;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: vmware_page_reset                                                *
+ *                                                                            *
+ * Purpose: prepares response buffer for the next request                     *
+ *                                                                            *
+ * Parameters: page - [IN/OUT] the response buffer                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	vmware_page_reset(ZBX_HTTPPAGE *page)
+{
+	page->offset = 0;
+
+	if (NULL != page->data)
+		*page->data = '\0';
+
+	if (NULL != page->ctxt)
+	{
+		if (NULL != page->ctxt->myDoc)
+			xmlFreeDoc(page->ctxt->myDoc);
+
+		xmlFreeParserCtxt(page->ctxt);
+		page->ctxt = NULL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vmware_page_get_doc                                              *
+ *                                                                            *
+ * Purpose: finishes parsing of the received response                         *
+ *                                                                            *
+ * Parameters: page - [IN/OUT] the response buffer                            *
+ *                                                                            *
+ * Return value: The parsed xml document or NULL if the response was empty or *
+ *               was not well formed.                                         *
+ *                                                                            *
+ * Comments: The document is built by the push parser while the response is   *
+ *           received, so the response is neither buffered nor parsed again.  *
+ *                                                                            *
+ ******************************************************************************/
+static xmlDoc	*vmware_page_get_doc(ZBX_HTTPPAGE *page)
+{
+	xmlDoc	*doc;
+
+	if (NULL == page->ctxt)
+		return NULL;
+
+	xmlSetStructuredErrorFunc(NULL, &libxml_handle_error);
+	xmlParseChunk(page->ctxt, NULL, 0, 1);
+	xmlSetStructuredErrorFunc(NULL, NULL);
+
+	doc = page->ctxt->myDoc;
+	page->ctxt->myDoc = NULL;
+
+	if (0 == page->ctxt->wellFormed && NULL != doc)
+	{
+		xmlFreeDoc(doc);
+		doc = NULL;
+	}
+
+	xmlFreeParserCtxt(page->ctxt);
+	page->ctxt = NULL;
+	xmlResetLastError();
+
+	return doc;
+}
+
 static size_t	curl_header_cb(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
 	ZBX_UNUSED(ptr);
@@ -476,7 +570,7 @@ static int	zbx_http_post(CURL *easyhandle, const char *request, ZBX_HTTPPAGE **r
 		return FAIL;
 	}
 
-	resp->offset = 0;
+	vmware_page_reset(resp);
 
 	if (CURLE_OK != (err = curl_easy_perform(easyhandle)))
 	{
@@ -490,6 +584,64 @@ static int	zbx_http_post(CURL *easyhandle, const char *request, ZBX_HTTPPAGE **r
 
 	return SUCCEED;
 }
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_soap_response                                                *
+ *                                                                            *
+ * Purpose: parses vmware web service response with SOAP error validation     *
+ *                                                                            *
+ * Parameters: fn_parent  - [IN] the parent function name for Log records     *
+ *             resp       - [IN] the http response                            *
+ *             xdoc       - [OUT] the xml document response (optional)        *
+ *             error      - [OUT] the error message in the case of failure    *
+ *                                (optional)                                  *
+ *                                                                            *
+ * Return value: SUCCEED - the SOAP response contains no fault                *
+ *               FAIL    - the SOAP request has failed                        *
+ ******************************************************************************/
+static int	zbx_soap_response(const char *fn_parent, ZBX_HTTPPAGE *resp, xmlDoc **xdoc, char **error)
+{
+	xmlDoc	*doc;
+	char	*fault;
+	int	ret = SUCCEED;
+
+	if (NULL != fn_parent)
+		zabbix_log(LOG_LEVEL_TRACE, "%s() SOAP response: %s", fn_parent, ZBX_NULL2EMPTY_STR(resp->data));
+
+	if (NULL == (doc = vmware_page_get_doc(resp)))
+	{
+		if (NULL != error)
+			*error = zbx_dsprintf(*error, "Received response has no valid XML data.");
+
+		ret = FAIL;
+	}
+	else if (NULL != (fault = zbx_xml_read_doc_value(doc, ZBX_XPATH_FAULTSTRING())))
+	{
+		if (NULL != error)
+		{
+			zbx_free(*error);
+			*error = fault;
+		}
+		else
+			zbx_free(fault);
+
+		ret = FAIL;
+	}
+	else if (NULL != error && NULL != *error)
+		ret = FAIL;
+
+	if (NULL != xdoc)
+	{
+		*xdoc = doc;
+	}
+	else
+	{
+		zbx_xml_free_doc(doc);
+	}
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: zbx_soap_post                                                    *
@@ -508,32 +660,357 @@ static int	zbx_http_post(CURL *easyhandle, const char *request, ZBX_HTTPPAGE **r
  ******************************************************************************/
 static int	zbx_soap_post(const char *fn_parent, CURL *easyhandle, const char *request, xmlDoc **xdoc, char **error)
 {
-	xmlDoc		*doc;
 	ZBX_HTTPPAGE	*resp;
-	int		ret = SUCCEED;
 
 	if (SUCCEED != zbx_http_post(easyhandle, request, &resp, error))
 		return FAIL;
 
-	if (NULL != fn_parent)
-		zabbix_log(LOG_LEVEL_TRACE, "%s() SOAP response: %s", fn_parent, resp->data);
+	return zbx_soap_response(fn_parent, resp, xdoc, error);
+}
 
-	if (SUCCEED != zbx_xml_try_read_value(resp->data, resp->offset, ZBX_XPATH_FAULTSTRING(), &doc, error, error)
-			|| NULL != *error)
+#ifdef ZBX_VMWARE_MULTI
+typedef struct
+{
+	CURL		*easyhandle;
+	ZBX_HTTPPAGE	page;
+
+	/* the index of request being performed, -1 for idle connection */
+	int		index;
+}
+zbx_vmware_connection_t;
+
+/* additional connections within the session of currently updated vmware service */
+static CURLM			*vmware_multi = NULL;
+static CURL			*vmware_conns_owner = NULL;
+static zbx_vmware_connection_t	vmware_conns[ZBX_VMWARE_CONCURRENT_REQUESTS];
+static int			vmware_conns_num = 0;
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vmware_connection_init                                           *
+ *                                                                            *
+ * Purpose: creates additional connection within the session of an already    *
+ *          authenticated cURL handle                                         *
+ *                                                                            *
+ * Parameters: conn       - [OUT] the connection                              *
+ *             easyhandle - [IN] the authenticated CURL handle                *
+ *             cookies    - [IN] the session cookies of easyhandle            *
+ *                                                                            *
+ * Return value: SUCCEED - the connection was created                         *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vmware_connection_init(zbx_vmware_connection_t *conn, CURL *easyhandle,
+		const struct curl_slist *cookies)
+{
+	CURLoption	opt;
+	CURLcode	err;
+
+	memset(conn, 0, sizeof(zbx_vmware_connection_t));
+	conn->index = -1;
+
+	if (NULL == (conn->easyhandle = curl_easy_duphandle(easyhandle)))
+		return FAIL;
+
+	conn->page.alloc = ZBX_KIBIBYTE;
+	conn->page.data = (char *)zbx_malloc(NULL, conn->page.alloc);
+
+	if (CURLE_OK != (err = curl_easy_setopt(conn->easyhandle, opt = CURLOPT_WRITEDATA, &conn->page)) ||
+			CURLE_OK != (err = curl_easy_setopt(conn->easyhandle, opt = CURLOPT_PRIVATE, conn)))
 	{
-		ret = FAIL;
+		zabbix_log(LOG_LEVEL_DEBUG, "Cannot set cURL option %d: %s.", (int)opt, curl_easy_strerror(err));
+		return FAIL;
 	}
 
-	if (NULL != xdoc)
+	/* duplicated handle does not inherit cookies, copy the session cookie explicitly */
+	for (; NULL != cookies; cookies = cookies->next)
 	{
-		*xdoc = doc;
+		if (CURLE_OK != (err = curl_easy_setopt(conn->easyhandle, CURLOPT_COOKIELIST, cookies->data)))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "Cannot set session cookie: %s.", curl_easy_strerror(err));
+			return FAIL;
+		}
 	}
-	else
+
+	return SUCCEED;
+}
+
+static void	vmware_connection_clean(zbx_vmware_connection_t *conn)
+{
+	if (NULL != conn->easyhandle)
+		curl_easy_cleanup(conn->easyhandle);
+
+	vmware_page_reset(&conn->page);
+	zbx_free(conn->page.data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vmware_connections_prepare                                       *
+ *                                                                            *
+ * Purpose: creates additional connections within the session of the          *
+ *          specified cURL handle if they are not created yet                 *
+ *                                                                            *
+ * Parameters: easyhandle - [IN] the authenticated CURL handle                *
+ *                                                                            *
+ * Return value: The number of available connections.                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	vmware_connections_prepare(CURL *easyhandle)
+{
+	struct curl_slist	*cookies = NULL;
+	CURLcode		err;
+
+	if (vmware_conns_owner == easyhandle)
+		return vmware_conns_num;
+
+	vmware_connections_reset();
+
+	if (NULL == vmware_multi && NULL == (vmware_multi = curl_multi_init()))
 	{
-		zbx_xml_free_doc(doc);
+		zabbix_log(LOG_LEVEL_WARNING, "Cannot initialize cURL multi session");
+		return 0;
 	}
 
-	return ret;
+	if (CURLE_OK != (err = curl_easy_getinfo(easyhandle, CURLINFO_COOKIELIST, &cookies)))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "Cannot get session cookie: %s.", curl_easy_strerror(err));
+		return 0;
+	}
+
+	for (; vmware_conns_num < ZBX_VMWARE_CONCURRENT_REQUESTS; vmware_conns_num++)
+	{
+		if (SUCCEED != vmware_connection_init(&vmware_conns[vmware_conns_num], easyhandle, cookies))
+		{
+			vmware_connection_clean(&vmware_conns[vmware_conns_num]);
+			break;
+		}
+	}
+
+	curl_slist_free_all(cookies);
+	vmware_conns_owner = easyhandle;
+
+	return vmware_conns_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vmware_connection_start                                          *
+ *                                                                            *
+ * Purpose: adds request to the multi handle                                  *
+ *                                                                            *
+ * Parameters: conn    - [IN] the idle connection                             *
+ *             request - [IN] the http request                                *
+ *             index   - [IN] the request index                               *
+ *             error   - [OUT] the error message in the case of failure       *
+ *                                                                            *
+ * Return value: SUCCEED - the request was added                              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vmware_connection_start(zbx_vmware_connection_t *conn, const char *request, int index, char **error)
+{
+	CURLcode	err;
+	CURLMcode	merr;
+
+	if (CURLE_OK != (err = curl_easy_setopt(conn->easyhandle, CURLOPT_POSTFIELDS, request)))
+	{
+		*error = zbx_dsprintf(*error, "Cannot set cURL option %d: %s.", (int)CURLOPT_POSTFIELDS,
+				curl_easy_strerror(err));
+		return FAIL;
+	}
+
+	if (CURLM_OK != (merr = curl_multi_add_handle(vmware_multi, conn->easyhandle)))
+	{
+		*error = zbx_dsprintf(*error, "Cannot add cURL handle: %s.", curl_multi_strerror(merr));
+		return FAIL;
+	}
+
+	vmware_page_reset(&conn->page);
+	conn->index = index;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vmware_connection_next                                           *
+ *                                                                            *
+ * Purpose: starts the next pending request on an idle connection             *
+ *                                                                            *
+ * Parameters: conn         - [IN] the idle connection                        *
+ *             requests     - [IN] the http requests                          *
+ *             errors       - [OUT] the error messages                        *
+ *             requests_num - [IN] the number of requests                     *
+ *             next         - [IN/OUT] the index of next pending request      *
+ *                                                                            *
+ * Return value: SUCCEED - a request was started                              *
+ *               FAIL    - no more requests to start                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vmware_connection_next(zbx_vmware_connection_t *conn, char **requests, char **errors,
+		int requests_num, int *next)
+{
+	while (*next < requests_num)
+	{
+		int	index = (*next)++;
+
+		if (SUCCEED == vmware_connection_start(conn, requests[index], index, &errors[index]))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Function: vmware_connections_reset                                         *
+ *                                                                            *
+ * Purpose: closes additional connections created for the session being      *
+ *          finished                                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	vmware_connections_reset(void)
+{
+#ifdef ZBX_VMWARE_MULTI
+	int	i;
+
+	for (i = 0; i < vmware_conns_num; i++)
+		vmware_connection_clean(&vmware_conns[i]);
+
+	vmware_conns_num = 0;
+	vmware_conns_owner = NULL;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_soap_post_multi                                              *
+ *                                                                            *
+ * Purpose: performs several independent vmware web service calls            *
+ *          concurrently                                                      *
+ *                                                                            *
+ * Parameters: fn_parent    - [IN] the parent function name for Log records   *
+ *             easyhandle   - [IN] the authenticated CURL handle              *
+ *             requests     - [IN] the http requests                          *
+ *             xdocs        - [OUT] the xml document responses, NULL for      *
+ *                                  failed requests                           *
+ *             errors       - [OUT] the error messages, NULL for successful   *
+ *                                  requests                                  *
+ *             requests_num - [IN] the number of requests                     *
+ *                                                                            *
+ * Comments: Up to ZBX_VMWARE_CONCURRENT_REQUESTS requests are performed at   *
+ *           the same time over additional connections sharing the session   *
+ *           of easyhandle. The connections are kept until                   *
+ *           vmware_connections_reset() is called when the session ends.      *
+ *           Without cURL multi interface support or when the additional      *
+ *           connections cannot be created the requests are performed one by *
+ *           one with easyhandle.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_soap_post_multi(const char *fn_parent, CURL *easyhandle, char **requests, xmlDoc **xdocs,
+		char **errors, int requests_num)
+{
+	int				i;
+#ifdef ZBX_VMWARE_MULTI
+	zbx_vmware_connection_t		*conn;
+	CURLMcode			code = CURLM_OK;
+	CURLMsg				*msg;
+	int				next = 0, in_flight = 0, running, msgnum, fds;
+#endif
+	memset(xdocs, 0, sizeof(xmlDoc *) * requests_num);
+	memset(errors, 0, sizeof(char *) * requests_num);
+
+#ifdef ZBX_VMWARE_MULTI
+	if (1 == requests_num || 0 == vmware_connections_prepare(easyhandle))
+		goto sequential;
+
+	for (i = 0; i < vmware_conns_num; i++)
+	{
+		if (SUCCEED == vmware_connection_next(&vmware_conns[i], requests, errors, requests_num, &next))
+			in_flight++;
+	}
+
+	while (0 < in_flight)
+	{
+		if (CURLM_OK != (code = curl_multi_perform(vmware_multi, &running)))
+			break;
+
+		while (NULL != (msg = curl_multi_info_read(vmware_multi, &msgnum)))
+		{
+			if (CURLMSG_DONE != msg->msg)
+				continue;
+
+			if (CURLE_OK != curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&conn))
+			{
+				THIS_SHOULD_NEVER_HAPPEN;
+				continue;
+			}
+
+			i = conn->index;
+
+			if (CURLE_OK != msg->data.result)
+			{
+				errors[i] = zbx_strdup(NULL, curl_easy_strerror(msg->data.result));
+			}
+			else if (SUCCEED != zbx_soap_response(fn_parent, &conn->page, &xdocs[i], &errors[i]))
+			{
+				zbx_xml_free_doc(xdocs[i]);
+				xdocs[i] = NULL;
+
+				if (NULL == errors[i])
+					errors[i] = zbx_strdup(NULL, "Cannot parse SOAP response.");
+			}
+
+			curl_multi_remove_handle(vmware_multi, conn->easyhandle);
+			conn->index = -1;
+			in_flight--;
+
+			if (SUCCEED == vmware_connection_next(conn, requests, errors, requests_num, &next))
+				in_flight++;
+		}
+
+		if (0 == in_flight)
+			break;
+
+		if (CURLM_OK != (code = curl_multi_wait(vmware_multi, NULL, 0, CONFIG_VMWARE_TIMEOUT * 1000, &fds)))
+			break;
+	}
+
+	if (0 == in_flight)
+		return;
+
+	zabbix_log(LOG_LEVEL_WARNING, "cannot perform on cURL multi handle: %s", curl_multi_strerror(code));
+
+	for (i = 0; i < vmware_conns_num; i++)
+	{
+		if (-1 == vmware_conns[i].index)
+			continue;
+
+		errors[vmware_conns[i].index] = zbx_dsprintf(NULL, "Cannot perform request: %s",
+				curl_multi_strerror(code));
+		curl_multi_remove_handle(vmware_multi, vmware_conns[i].easyhandle);
+		vmware_conns[i].index = -1;
+	}
+
+	for (; next < requests_num; next++)
+		errors[next] = zbx_dsprintf(NULL, "Cannot perform request: %s", curl_multi_strerror(code));
+
+	return;
+sequential:
+#endif
+	for (i = 0; i < requests_num; i++)
+	{
+		if (SUCCEED != zbx_soap_post(fn_parent, easyhandle, requests[i], &xdocs[i], &errors[i]))
+		{
+			zbx_xml_free_doc(xdocs[i]);
+			xdocs[i] = NULL;
+
+			if (NULL == errors[i])
+				errors[i] = zbx_strdup(NULL, "Cannot parse SOAP response.");
+		}
+	}
 }
 
 /******************************************************************************
@@ -643,10 +1120,10 @@ static char	**xml_read_props(xmlDoc *xdoc, const zbx_vmware_propmap_t *propmap,
 	props = (char **)zbx_malloc(NULL, sizeof(char *) * props_num);
 	memset(props, 0, sizeof(char *) * props_num);
 
+	xpathCtx = xmlXPathNewContext(xdoc);
+
 	for (i = 0; i < props_num; i++)
 	{
-		xpathCtx = xmlXPathNewContext(xdoc);
-
 		if (NULL != (xpathObj = xmlXPathEvalExpression((const xmlChar *)propmap[i].xpath, xpathCtx)))
 		{
 			if (0 == xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
@@ -662,10 +1139,10 @@ static char	**xml_read_props(xmlDoc *xdoc, const zbx_vmware_propmap_t *propmap,
 
 			xmlXPathFreeObject(xpathObj);
 		}
-
-		xmlXPathFreeContext(xpathCtx);
 	}
 
+	xmlXPathFreeContext(xpathCtx);
+
 	return props;
 }
 
@@ -2303,24 +2780,20 @@ clean:
 
 /******************************************************************************
  *                                                                            *
- * Function: vmware_service_get_vm_data                                       *
+ * Function: vmware_service_get_vm_request                                    *
  *                                                                            *
- * Purpose: gets the virtual machine data                                     *
+ * Purpose: creates the virtual machine data request                          *
  *                                                                            *
  * Parameters: service      - [IN] the vmware service                         *
- *             easyhandle   - [IN] the CURL handle                            *
  *             vmid         - [IN] the virtual machine id                     *
  *             propmap      - [IN] the xpaths of the properties to read       *
  *             props_num    - [IN] the number of properties to read           *
- *             xdoc         - [OUT] a reference to output xml document        *
- *             error        - [OUT] the error message in the case of failure  *
  *                                                                            *
- * Return value: SUCCEED - the operation has completed successfully           *
- *               FAIL    - the operation has failed                           *
+ * Return value: The allocated SOAP request.                                  *
  *                                                                            *
  ******************************************************************************/
-static int	vmware_service_get_vm_data(zbx_vmware_service_t *service, CURL *easyhandle, const char *vmid,
-		const zbx_vmware_propmap_t *propmap, int props_num, xmlDoc **xdoc, char **error)
+static char	*vmware_service_get_vm_request(const zbx_vmware_service_t *service, const char *vmid,
+		const zbx_vmware_propmap_t *propmap, int props_num)
 {
 #	define ZBX_POST_VMWARE_VM_STATUS_EX 						\
 		ZBX_POST_VSPHERE_HEADER							\
@@ -2343,10 +2816,9 @@ static int	vmware_service_get_vm_data(zbx_vmware_service_t *service, CURL *easyh
 		"</ns0:RetrievePropertiesEx>"						\
 		ZBX_POST_VSPHERE_FOOTER
 
-	char	tmp[MAX_STRING_LEN], props[MAX_STRING_LEN], *vmid_esc;
-	int	i, ret = FAIL;
+	char	props[MAX_STRING_LEN], *vmid_esc, *request;
+	int	i;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() vmid:'%s'", __func__, vmid);
 	props[0] = '\0';
 
 	for (i = 0; i < props_num; i++)
@@ -2358,19 +2830,12 @@ static int	vmware_service_get_vm_data(zbx_vmware_service_t *service, CURL *easyh
 
 	vmid_esc = xml_escape_dyn(vmid);
 
-	zbx_snprintf(tmp, sizeof(tmp), ZBX_POST_VMWARE_VM_STATUS_EX,
+	request = zbx_dsprintf(NULL, ZBX_POST_VMWARE_VM_STATUS_EX,
 			vmware_service_objects[service->type].property_collector, props, vmid_esc);
 
 	zbx_free(vmid_esc);
 
-	if (SUCCEED != zbx_soap_post(__func__, easyhandle, tmp, xdoc, error))
-		goto out;
-
-	ret = SUCCEED;
-out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
-
-	return ret;
+	return request;
 }
 
 /******************************************************************************
@@ -2380,20 +2845,18 @@ out:
  * Purpose: create virtual machine object                                     *
  *                                                                            *
  * Parameters: service      - [IN] the vmware service                         *
- *             easyhandle   - [IN] the CURL handle                            *
  *             id           - [IN] the virtual machine id                     *
- *             error        - [OUT] the error message in the case of failure  *
+ *             details      - [IN] the virtual machine data                   *
  *                                                                            *
  * Return value: The created virtual machine object or NULL if an error was   *
  *               detected.                                                    *
  *                                                                            *
  ******************************************************************************/
-static zbx_vmware_vm_t	*vmware_service_create_vm(zbx_vmware_service_t *service,  CURL *easyhandle,
-		const char *id, char **error)
+static zbx_vmware_vm_t	*vmware_service_create_vm(const zbx_vmware_service_t *service, const char *id,
+		xmlDoc *details)
 {
 	zbx_vmware_vm_t	*vm;
 	char		*value;
-	xmlDoc		*details = NULL;
 	const char	*uuid_xpath[3] = {NULL, ZBX_XPATH_VM_UUID(), ZBX_XPATH_VM_INSTANCE_UUID()};
 	int		ret = FAIL;
 
@@ -2405,12 +2868,6 @@ static zbx_vmware_vm_t	*vmware_service_create_vm(zbx_vmware_service_t *service,
 	zbx_vector_ptr_create(&vm->devs);
 	zbx_vector_ptr_create(&vm->file_systems);
 
-	if (SUCCEED != vmware_service_get_vm_data(service, easyhandle, id, vm_propmap,
-			ZBX_VMWARE_VMPROPS_NUM, &details, error))
-	{
-		goto out;
-	}
-
 	if (NULL == (value = zbx_xml_read_doc_value(details, uuid_xpath[service->type])))
 		goto out;
 
@@ -2426,8 +2883,6 @@ static zbx_vmware_vm_t	*vmware_service_create_vm(zbx_vmware_service_t *service,
 
 	ret = SUCCEED;
 out:
-	zbx_xml_free_doc(details);
-
 	if (SUCCEED != ret)
 	{
 		vmware_vm_free(vm);
@@ -2439,6 +2894,68 @@ out:
 	return vm;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Function: vmware_service_create_vms                                        *
+ *                                                                            *
+ * Purpose: create virtual machine objects                                    *
+ *                                                                            *
+ * Parameters: service      - [IN] the vmware service                         *
+ *             easyhandle   - [IN] the CURL handle                            *
+ *             ids          - [IN] the virtual machine ids                    *
+ *             vms          - [OUT] the created virtual machine objects       *
+ *             error        - [OUT] the error message in the case of failure  *
+ *                                                                            *
+ * Comments: The virtual machine data is requested concurrently, the number  *
+ *           of responses kept in memory is limited by ZBX_VMWARE_VMS_BATCH.  *
+ *                                                                            *
+ ******************************************************************************/
+static void	vmware_service_create_vms(const zbx_vmware_service_t *service, CURL *easyhandle,
+		const zbx_vector_str_t *ids, zbx_vector_ptr_t *vms, char **error)
+{
+#	define ZBX_VMWARE_VMS_BATCH	(ZBX_VMWARE_CONCURRENT_REQUESTS * 8)
+
+	char		*requests[ZBX_VMWARE_VMS_BATCH], *errors[ZBX_VMWARE_VMS_BATCH];
+	xmlDoc		*docs[ZBX_VMWARE_VMS_BATCH];
+	zbx_vmware_vm_t	*vm;
+	int		i, j, num;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() vms:%d", __func__, ids->values_num);
+
+	for (i = 0; i < ids->values_num; i += num)
+	{
+		num = MIN(ids->values_num - i, ZBX_VMWARE_VMS_BATCH);
+
+		for (j = 0; j < num; j++)
+		{
+			requests[j] = vmware_service_get_vm_request(service, ids->values[i + j], vm_propmap,
+					ZBX_VMWARE_VMPROPS_NUM);
+		}
+
+		zbx_soap_post_multi(__func__, easyhandle, requests, docs, errors, num);
+
+		for (j = 0; j < num; j++)
+		{
+			if (NULL != errors[j])
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "%s(): cannot get virtual machine \"%s\" data: %s",
+						__func__, ids->values[i + j], errors[j]);
+				*error = zbx_strdup(*error, errors[j]);
+			}
+			else if (NULL != (vm = vmware_service_create_vm(service, ids->values[i + j], docs[j])))
+				zbx_vector_ptr_append(vms, vm);
+
+			zbx_xml_free_doc(docs[j]);
+			zbx_free(errors[j]);
+			zbx_free(requests[j]);
+		}
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() created:%d", __func__, vms->values_num);
+
+#	undef ZBX_VMWARE_VMS_BATCH
+}
+
 /******************************************************************************
  *                                                                            *
  * Function: vmware_service_refresh_datastore_info                            *
@@ -2921,13 +3438,7 @@ static int	vmware_service_init_hv(zbx_vmware_service_t *service, CURL *easyhandl
 	zbx_xml_read_values(details, ZBX_XPATH_HV_VMS(), &vms);
 	zbx_vector_ptr_reserve(&hv->vms, vms.values_num + hv->vms.values_alloc);
 
-	for (i = 0; i < vms.values_num; i++)
-	{
-		zbx_vmware_vm_t	*vm;
-
-		if (NULL != (vm = vmware_service_create_vm(service, easyhandle, vms.values[i], error)))
-			zbx_vector_ptr_append(&hv->vms, vm);
-	}
+	vmware_service_create_vms(service, easyhandle, &vms, &hv->vms, error);
 
 	ret = SUCCEED;
 out:
@@ -4263,6 +4774,8 @@ static void	vmware_service_update(zbx_vmware_service_t *service)
 	data = (zbx_vmware_data_t *)zbx_malloc(NULL, sizeof(zbx_vmware_data_t));
 	memset(data, 0, sizeof(zbx_vmware_data_t));
 	page.alloc = 0;
+	page.offset = 0;
+	page.ctxt = NULL;
 
 	zbx_hashset_create(&data->hvs, 1, vmware_hv_hash, vmware_hv_compare);
 	zbx_vector_ptr_create(&data->clusters);
@@ -4378,8 +4891,10 @@ static void	vmware_service_update(zbx_vmware_service_t *service)
 
 	ret = SUCCEED;
 clean:
+	vmware_connections_reset();
 	curl_slist_free_all(headers);
 	curl_easy_cleanup(easyhandle);
+	vmware_page_reset(&page);
 	zbx_free(page.data);
 
 	zbx_vector_str_clear_ext(&hvs, zbx_str_free);
@@ -4665,121 +5180,145 @@ static void	vmware_service_copy_perf_data(zbx_vmware_service_t *service, zbx_vec
 static void	vmware_service_retrieve_perf_counters(zbx_vmware_service_t *service, CURL *easyhandle,
 		zbx_vector_ptr_t *entities, int counters_max, zbx_vector_ptr_t *perfdata)
 {
-	char				*tmp = NULL, *error = NULL;
-	size_t				tmp_alloc = 0, tmp_offset;
-	int				i, j, start_counter = 0;
+	char				*tmp, *requests[ZBX_VMWARE_CONCURRENT_REQUESTS];
+	char				*errors[ZBX_VMWARE_CONCURRENT_REQUESTS];
+	size_t				tmp_alloc, tmp_offset;
+	int				i, j, k, requests_num, failed, start_counter = 0;
+	int				bounds[ZBX_VMWARE_CONCURRENT_REQUESTS + 1];
 	zbx_vmware_perf_entity_t	*entity;
-	xmlDoc				*doc = NULL;
+	xmlDoc				*docs[ZBX_VMWARE_CONCURRENT_REQUESTS];
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() counters_max:%d", __func__, counters_max);
 
 	while (0 != entities->values_num)
 	{
-		int	counters_num = 0;
-
-		tmp_offset = 0;
-		zbx_strcpy_alloc(&tmp, &tmp_alloc, &tmp_offset, ZBX_POST_VSPHERE_HEADER);
-		zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "<ns0:QueryPerf>"
-				"<ns0:_this type=\"PerformanceManager\">%s</ns0:_this>",
-				vmware_service_objects[service->type].performance_manager);
+		/* Prepare up to ZBX_VMWARE_CONCURRENT_REQUESTS queries to be performed concurrently. */
+		/* Query k requests entities with indexes (bounds[k + 1], bounds[k]].                 */
+		i = entities->values_num - 1;
+		bounds[0] = i;
 
 		zbx_vmware_lock();
 
-		for (i = entities->values_num - 1; 0 <= i && counters_num < counters_max;)
+		for (requests_num = 0; 0 <= i && requests_num < ZBX_VMWARE_CONCURRENT_REQUESTS; requests_num++)
 		{
-			char	*id_esc;
+			int	counters_num = 0;
 
-			entity = (zbx_vmware_perf_entity_t *)entities->values[i];
+			tmp = NULL;
+			tmp_alloc = 0;
+			tmp_offset = 0;
+			zbx_strcpy_alloc(&tmp, &tmp_alloc, &tmp_offset, ZBX_POST_VSPHERE_HEADER);
+			zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "<ns0:QueryPerf>"
+					"<ns0:_this type=\"PerformanceManager\">%s</ns0:_this>",
+					vmware_service_objects[service->type].performance_manager);
 
-			id_esc = xml_escape_dyn(entity->id);
+			for (; 0 <= i && counters_num < counters_max;)
+			{
+				char	*id_esc;
 
-			/* add entity performance counter request */
-			zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "<ns0:querySpec>"
-					"<ns0:entity type=\"%s\">%s</ns0:entity>", entity->type, id_esc);
+				entity = (zbx_vmware_perf_entity_t *)entities->values[i];
 
-			zbx_free(id_esc);
+				id_esc = xml_escape_dyn(entity->id);
 
-			if (ZBX_VMWARE_PERF_INTERVAL_NONE == entity->refresh)
-			{
-				time_t	st_raw;
-				struct	tm st;
-				char	st_str[ZBX_XML_DATETIME];
-
-				/* add startTime for entity performance counter request for decrease XML data load */
-				st_raw = zbx_time() - SEC_PER_HOUR;
-				gmtime_r(&st_raw, &st);
-				strftime(st_str, sizeof(st_str), "%Y-%m-%dT%TZ", &st);
-				zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "<ns0:startTime>%s</ns0:startTime>",
-						st_str);
-			}
+				/* add entity performance counter request */
+				zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "<ns0:querySpec>"
+						"<ns0:entity type=\"%s\">%s</ns0:entity>", entity->type, id_esc);
 
-			zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "<ns0:maxSample>1</ns0:maxSample>");
+				zbx_free(id_esc);
 
-			for (j = start_counter; j < entity->counters.values_num && counters_num < counters_max; j++)
-			{
-				zbx_vmware_perf_counter_t	*counter;
+				if (ZBX_VMWARE_PERF_INTERVAL_NONE == entity->refresh)
+				{
+					time_t	st_raw;
+					struct	tm st;
+					char	st_str[ZBX_XML_DATETIME];
+
+					/* add startTime for entity performance counter request to decrease XML */
+					/* data load                                                             */
+					st_raw = zbx_time() - SEC_PER_HOUR;
+					gmtime_r(&st_raw, &st);
+					strftime(st_str, sizeof(st_str), "%Y-%m-%dT%TZ", &st);
+					zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset,
+							"<ns0:startTime>%s</ns0:startTime>", st_str);
+				}
 
-				counter = (zbx_vmware_perf_counter_t *)entity->counters.values[j];
+				zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "<ns0:maxSample>1</ns0:maxSample>");
 
-				zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset,
-						"<ns0:metricId><ns0:counterId>" ZBX_FS_UI64
-						"</ns0:counterId><ns0:instance>%s</ns0:instance></ns0:metricId>",
-						counter->counterid, entity->query_instance);
+				for (j = start_counter; j < entity->counters.values_num && counters_num < counters_max;
+						j++)
+				{
+					zbx_vmware_perf_counter_t	*counter;
 
-				counter->state |= ZBX_VMWARE_COUNTER_UPDATING;
+					counter = (zbx_vmware_perf_counter_t *)entity->counters.values[j];
 
-				counters_num++;
-			}
+					zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset,
+							"<ns0:metricId><ns0:counterId>" ZBX_FS_UI64
+							"</ns0:counterId><ns0:instance>%s</ns0:instance></ns0:metricId>",
+							counter->counterid, entity->query_instance);
 
-			if (j == entity->counters.values_num)
-			{
-				start_counter = 0;
-				i--;
-			}
-			else
-				start_counter = j;
+					counter->state |= ZBX_VMWARE_COUNTER_UPDATING;
 
+					counters_num++;
+				}
 
-			if (ZBX_VMWARE_PERF_INTERVAL_NONE != entity->refresh)
-			{
-				zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "<ns0:intervalId>%d</ns0:intervalId>",
-					entity->refresh);
+				if (j == entity->counters.values_num)
+				{
+					start_counter = 0;
+					i--;
+				}
+				else
+					start_counter = j;
+
+				if (ZBX_VMWARE_PERF_INTERVAL_NONE != entity->refresh)
+				{
+					zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset,
+							"<ns0:intervalId>%d</ns0:intervalId>", entity->refresh);
+				}
+
+				zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "</ns0:querySpec>");
 			}
 
-			zbx_snprintf_alloc(&tmp, &tmp_alloc, &tmp_offset, "</ns0:querySpec>");
+			zbx_strcpy_alloc(&tmp, &tmp_alloc, &tmp_offset, "</ns0:QueryPerf>");
+			zbx_strcpy_alloc(&tmp, &tmp_alloc, &tmp_offset, ZBX_POST_VSPHERE_FOOTER);
+
+			zabbix_log(LOG_LEVEL_TRACE, "%s() SOAP request: %s", __func__, tmp);
+
+			requests[requests_num] = tmp;
+			bounds[requests_num + 1] = i;
 		}
 
 		zbx_vmware_unlock();
-		zbx_xml_free_doc(doc);
-		doc = NULL;
 
-		zbx_strcpy_alloc(&tmp, &tmp_alloc, &tmp_offset, "</ns0:QueryPerf>");
-		zbx_strcpy_alloc(&tmp, &tmp_alloc, &tmp_offset, ZBX_POST_VSPHERE_FOOTER);
+		zbx_soap_post_multi(__func__, easyhandle, requests, docs, errors, requests_num);
 
-		zabbix_log(LOG_LEVEL_TRACE, "%s() SOAP request: %s", __func__, tmp);
-
-		if (SUCCEED != zbx_soap_post(__func__, easyhandle, tmp, &doc, &error))
+		for (k = 0, failed = 0; k < requests_num; k++)
 		{
-			for (j = i + 1; j < entities->values_num; j++)
+			if (NULL != errors[k])
+			{
+				for (j = bounds[k + 1] + 1; j <= bounds[k]; j++)
+				{
+					entity = (zbx_vmware_perf_entity_t *)entities->values[j];
+					vmware_perf_data_add_error(perfdata, entity->type, entity->id, errors[k]);
+				}
+
+				failed = 1;
+			}
+			else
 			{
-				entity = (zbx_vmware_perf_entity_t *)entities->values[j];
-				vmware_perf_data_add_error(perfdata, entity->type, entity->id, error);
+				/* parse performance data into local memory */
+				vmware_service_parse_perf_data(perfdata, docs[k]);
 			}
 
-			zbx_free(error);
-			break;
+			zbx_xml_free_doc(docs[k]);
+			zbx_free(errors[k]);
+			zbx_free(requests[k]);
 		}
 
-		/* parse performance data into local memory */
-		vmware_service_parse_perf_data(perfdata, doc);
+		if (0 != failed)
+			break;
 
 		while (entities->values_num > i + 1)
 			zbx_vector_ptr_remove_noorder(entities, entities->values_num - 1);
 	}
 
-	zbx_free(tmp);
-	zbx_xml_free_doc(doc);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -4911,8 +5450,10 @@ static void	vmware_service_update_perf(zbx_vmware_service_t *service)
 
 	ret = SUCCEED;
 clean:
+	vmware_connections_reset();
 	curl_slist_free_all(headers);
 	curl_easy_cleanup(easyhandle);
+	vmware_page_reset(&page);
 	zbx_free(page.data);
 out:
 	zbx_vmware_lock();
@@ -5485,80 +6026,6 @@ static void	libxml_handle_error(void *user_data, xmlErrorPtr err)
 	ZBX_UNUSED(err);
 }
 
-/******************************************************************************
- *                                                                            *
- * Function: zbx_xml_try_read_value                                           *
- *                                                                            *
- * Purpose: retrieve a value from xml data and return status of operation     *
- *                                                                            *
- * Parameters: data   - [IN] XML data                                         *
- *             len    - [IN] XML data length (optional)                       *
- *             xpath  - [IN] XML XPath                                        *
- *             xdoc   - [OUT] parsed xml document                             *
- *             value  - [OUT] selected xml node value                         *
- *             error  - [OUT] error of xml or xpath formats                   *
- *                                                                            *
- * Return: SUCCEED - select xpath successfully, result stored in 'value'      *
- *         FAIL - failed select xpath expression                              *
- *                                                                            *
- ******************************************************************************/
-static int	zbx_xml_try_read_value(const char *data, size_t len, const char *xpath, xmlDoc **xdoc, char **value,
-		char **error)
-{
-	xmlXPathContext	*xpathCtx;
-	xmlXPathObject	*xpathObj;
-	xmlNodeSetPtr	nodeset;
-	xmlChar		*val;
-	int		ret = FAIL;
-
-	if (NULL == data)
-		goto out;
-
-	xmlSetStructuredErrorFunc(NULL, &libxml_handle_error);
-
-	if (NULL == (*xdoc = xmlReadMemory(data, (0 == len ? strlen(data) : len), ZBX_VM_NONAME_XML, NULL,
-			ZBX_XML_PARSE_OPTS)))
-	{
-		if (NULL != error)
-			*error = zbx_dsprintf(*error, "Received response has no valid XML data.");
-
-		xmlSetStructuredErrorFunc(NULL, NULL);
-		goto out;
-	}
-
-	xpathCtx = xmlXPathNewContext(*xdoc);
-
-	if (NULL == (xpathObj = xmlXPathEvalExpression((const xmlChar *)xpath, xpathCtx)))
-	{
-		if (NULL != error)
-			*error = zbx_dsprintf(*error, "Invalid xpath expression: \"%s\".", xpath);
-
-		goto clean;
-	}
-
-	ret = SUCCEED;
-
-	if (0 != xmlXPathNodeSetIsEmpty(xpathObj->nodesetval))
-		goto clean;
-
-	nodeset = xpathObj->nodesetval;
-
-	if (NULL != (val = xmlNodeListGetString(*xdoc, nodeset->nodeTab[0]->xmlChildrenNode, 1)))
-	{
-		*value = zbx_strdup(*value, (const char *)val);
-		xmlFree(val);
-	}
-clean:
-	if (NULL != xpathObj)
-		xmlXPathFreeObject(xpathObj);
-
-	xmlSetStructuredErrorFunc(NULL, NULL);
-	xmlXPathFreeContext(xpathCtx);
-	xmlResetLastError();
-out:
-	return ret;
-}
-
 /******************************************************************************
  *                                                                            *
  * Function: zbx_xml_read_node_value                                          *
@@ -0,0 +1,457 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2020 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "common.h"
+#include "log.h"
+#include "zbxalgo.h"
+#include "dbcache.h"
+#include "zbxhistory.h"
+#include "history.h"
+
+extern char	*CONFIG_HISTORY_STORAGE_DIR;
+
+void	__wrap_zbx_sleep_loop(int sleeptime);
+zbx_uint64_t	__wrap_DCget_nextid(const char *table_name, int num);
+int	__wrap_zbx_host_availability_is_set(const zbx_host_availability_t *ha);
+int	__wrap_zbx_add_event(unsigned char source, unsigned char object, zbx_uint64_t objectid,
+		const zbx_timespec_t *timespec, int value, const char *trigger_description,
+		const char *trigger_expression, const char *trigger_recovery_expression, unsigned char trigger_priority,
+		unsigned char trigger_type, const zbx_vector_ptr_t *trigger_tags,
+		unsigned char trigger_correlation_mode, const char *trigger_correlation_tag,
+		unsigned char trigger_value, const char *error);
+int	__wrap_zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *triggerids_lock);
+void	__wrap_zbx_clean_events(void);
+
+void	__wrap_zbx_sleep_loop(int sleeptime)
+{
+	ZBX_UNUSED(sleeptime);
+}
+
+zbx_uint64_t	__wrap_DCget_nextid(const char *table_name, int num)
+{
+	ZBX_UNUSED(table_name);
+	ZBX_UNUSED(num);
+	return 0;
+}
+
+int	__wrap_zbx_host_availability_is_set(const zbx_host_availability_t *ha)
+{
+	ZBX_UNUSED(ha);
+	return SUCCEED;
+}
+
+int	__wrap_zbx_add_event(unsigned char source, unsigned char object, zbx_uint64_t objectid,
+		const zbx_timespec_t *timespec, int value, const char *trigger_description,
+		const char *trigger_expression, const char *trigger_recovery_expression, unsigned char trigger_priority,
+		unsigned char trigger_type, const zbx_vector_ptr_t *trigger_tags,
+		unsigned char trigger_correlation_mode, const char *trigger_correlation_tag,
+		unsigned char trigger_value, const char *error)
+{
+	ZBX_UNUSED(source);
+	ZBX_UNUSED(object);
+	ZBX_UNUSED(objectid);
+	ZBX_UNUSED(timespec);
+	ZBX_UNUSED(value);
+	ZBX_UNUSED(trigger_description);
+	ZBX_UNUSED(trigger_expression);
+	ZBX_UNUSED(trigger_recovery_expression);
+	ZBX_UNUSED(trigger_priority);
+	ZBX_UNUSED(trigger_type);
+	ZBX_UNUSED(trigger_tags);
+	ZBX_UNUSED(trigger_correlation_mode);
+	ZBX_UNUSED(trigger_correlation_tag);
+	ZBX_UNUSED(trigger_value);
+	ZBX_UNUSED(error);
+	return SUCCEED;
+}
+
+int	__wrap_zbx_process_events(zbx_vector_ptr_t *trigger_diff, zbx_vector_uint64_t *triggerids_lock)
+{
+	ZBX_UNUSED(trigger_diff);
+	ZBX_UNUSED(triggerids_lock);
+	return SUCCEED;
+}
+
+void	__wrap_zbx_clean_events(void)
+{
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: colmock_read_value                                               *
+ *                                                                            *
+ * Purpose: reads history value and timestamp from input data                 *
+ *                                                                            *
+ * Comments: Floating point values are parsed with strtod(), so special       *
+ *           values like nan, inf and -0 can be used.                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	colmock_read_value(zbx_mock_handle_t hvalue, unsigned char value_type, history_value_t *value,
+		zbx_timespec_t *ts)
+{
+	const char		*data;
+	zbx_mock_error_t	err;
+
+	data = zbx_mock_get_object_member_string(hvalue, "value");
+
+	if (ITEM_VALUE_TYPE_UINT64 == value_type)
+	{
+		if (FAIL == is_uint64(data, &value->ui64))
+			fail_msg("Invalid uint64 value \"%s\"", data);
+	}
+	else
+		value->dbl = strtod(data, NULL);
+
+	data = zbx_mock_get_object_member_string(hvalue, "ts");
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(data, ts)))
+		fail_msg("Invalid value timestamp \"%s\": %s", data, zbx_mock_error_string(err));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: colmock_write_batch                                              *
+ *                                                                            *
+ * Purpose: writes one batch of values through the history interface, the     *
+ *          same way history syncer flushes the values of one sync cycle      *
+ *                                                                            *
+ ******************************************************************************/
+static void	colmock_write_batch(zbx_history_iface_t *hist, zbx_uint64_t itemid, zbx_mock_handle_t hbatch)
+{
+	zbx_mock_handle_t	hvalue;
+	zbx_vector_ptr_t	history;
+	ZBX_DC_HISTORY		*h;
+
+	zbx_vector_ptr_create(&history);
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hbatch, &hvalue))
+	{
+		h = (ZBX_DC_HISTORY *)zbx_malloc(NULL, sizeof(ZBX_DC_HISTORY));
+		memset(h, 0, sizeof(ZBX_DC_HISTORY));
+
+		h->itemid = itemid;
+		h->value_type = hist->value_type;
+		h->ttl = SEC_PER_DAY;
+		colmock_read_value(hvalue, hist->value_type, &h->value, &h->ts);
+
+		zbx_vector_ptr_append(&history, h);
+	}
+
+	hist->add_values(hist, &history);
+	zbx_mock_assert_result_eq("flush()", SUCCEED, hist->flush(hist));
+
+	zbx_vector_ptr_clear_ext(&history, zbx_ptr_free);
+	zbx_vector_ptr_destroy(&history);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: colmock_write_sequence                                           *
+ *                                                                            *
+ * Purpose: writes generated values one by one, each with a separate flush    *
+ *                                                                            *
+ * Comments: The value number is used as value and values are timestamped     *
+ *           with the specified step starting with the specified timestamp.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	colmock_write_sequence(zbx_history_iface_t *hist, zbx_uint64_t itemid, zbx_mock_handle_t hsequence)
+{
+	zbx_vector_ptr_t	history;
+	ZBX_DC_HISTORY		h;
+	zbx_timespec_t		ts;
+	const char		*data;
+	int			i, num, step;
+	zbx_mock_error_t	err;
+
+	data = zbx_mock_get_object_member_string(hsequence, "ts");
+
+	if (ZBX_MOCK_SUCCESS != (err = zbx_strtime_to_timespec(data, &ts)))
+		fail_msg("Invalid sequence timestamp \"%s\": %s", data, zbx_mock_error_string(err));
+
+	num = atoi(zbx_mock_get_object_member_string(hsequence, "count"));
+	step = atoi(zbx_mock_get_object_member_string(hsequence, "step"));
+
+	zbx_vector_ptr_create(&history);
+
+	for (i = 0; i < num; i++)
+	{
+		memset(&h, 0, sizeof(h));
+		h.itemid = itemid;
+		h.value_type = hist->value_type;
+		h.ttl = SEC_PER_DAY;
+		h.ts.sec = ts.sec + i * step;
+		h.ts.ns = ts.ns;
+
+		if (ITEM_VALUE_TYPE_UINT64 == hist->value_type)
+			h.value.ui64 = i;
+		else
+			h.value.dbl = i;
+
+		zbx_vector_ptr_append(&history, &h);
+		hist->add_values(hist, &history);
+		zbx_mock_assert_result_eq("flush()", SUCCEED, hist->flush(hist));
+		zbx_vector_ptr_clear(&history);
+	}
+
+	zbx_vector_ptr_destroy(&history);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: colmock_item_file                                                *
+ *                                                                            *
+ * Purpose: gets path of the item history file in the input partition         *
+ *                                                                            *
+ ******************************************************************************/
+static char	*colmock_item_file(const char *dir, unsigned char value_type, zbx_uint64_t itemid)
+{
+	zbx_timespec_t	ts;
+
+	if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(zbx_mock_get_parameter_string("in.partition"), &ts))
+		fail_msg("Invalid partition timestamp");
+
+	return zbx_dsprintf(NULL, "%s/%s/%d/" ZBX_FS_UI64, dir, ITEM_VALUE_TYPE_UINT64 == value_type ? "uint" : "dbl",
+			ts.sec, itemid);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: colmock_append_garbage                                           *
+ *                                                                            *
+ * Purpose: appends data to the item history file, simulating interrupted     *
+ *          write                                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	colmock_append_garbage(const char *path, const char *data)
+{
+	int	fd;
+
+	if (-1 == (fd = open(path, O_WRONLY | O_APPEND)))
+		fail_msg("cannot open \"%s\": %s", path, zbx_strerror(errno));
+
+	if ((ssize_t)strlen(data) != write(fd, data, strlen(data)))
+		fail_msg("cannot write \"%s\": %s", path, zbx_strerror(errno));
+
+	close(fd);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: colmock_check_blocks                                             *
+ *                                                                            *
+ * Purpose: checks the number of values in each block of item history file    *
+ *          and that the last block ends at the end of file                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	colmock_check_blocks(const char *path, zbx_mock_handle_t hblocks)
+{
+	zbx_mock_handle_t	hblock;
+	zbx_col_block_t		block;
+	struct stat		st;
+	off_t			offset = 0;
+	int			fd, num = 0;
+	const char		*data;
+
+	if (-1 == (fd = open(path, O_RDONLY)) || 0 != fstat(fd, &st))
+		fail_msg("cannot open \"%s\": %s", path, zbx_strerror(errno));
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hblocks, &hblock))
+	{
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hblock, &data))
+			fail_msg("Invalid block value count");
+
+		if (sizeof(block) != pread(fd, &block, sizeof(block), offset))
+			fail_msg("expected more than %d blocks", num);
+
+		zbx_mock_assert_uint64_eq("block magic", ZBX_COL_BLOCK_MAGIC, block.magic);
+		zbx_mock_assert_uint64_eq("block offset", (zbx_uint64_t)offset, block.offset);
+		zbx_mock_assert_int_eq("block value count", atoi(data), block.num);
+
+		offset += sizeof(block) + block.size + sizeof(zbx_uint32_t);
+		num++;
+	}
+
+	zbx_mock_assert_uint64_eq("file size", (zbx_uint64_t)offset, (zbx_uint64_t)st.st_size);
+
+	close(fd);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: colmock_check_values                                             *
+ *                                                                            *
+ * Purpose: compares returned values with the expected ones                   *
+ *                                                                            *
+ * Comments: Floating point values are compared bit by bit to check that NaN  *
+ *           and negative zero are restored exactly.                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	colmock_check_values(unsigned char value_type, zbx_mock_handle_t hvalues,
+		const zbx_vector_history_record_t *values)
+{
+	zbx_mock_handle_t	hvalue;
+	history_value_t		value;
+	zbx_timespec_t		ts;
+	zbx_uint64_t		expected, returned;
+	int			i = 0;
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hvalues, &hvalue))
+	{
+		if (i >= values->values_num)
+			fail_msg("expected more than %d values", values->values_num);
+
+		colmock_read_value(hvalue, value_type, &value, &ts);
+
+		zbx_mock_assert_timespec_eq("value timestamp", &ts, &values->values[i].timestamp);
+
+		if (ITEM_VALUE_TYPE_UINT64 == value_type)
+		{
+			zbx_mock_assert_uint64_eq("value", value.ui64, values->values[i].value.ui64);
+		}
+		else
+		{
+			memcpy(&expected, &value.dbl, sizeof(expected));
+			memcpy(&returned, &values->values[i].value.dbl, sizeof(returned));
+			zbx_mock_assert_uint64_eq("value bits", expected, returned);
+		}
+
+		i++;
+	}
+
+	zbx_mock_assert_int_eq("number of values", i, values->values_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: colmock_remove                                                   *
+ *                                                                            *
+ * Purpose: removes directory with all its contents                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	colmock_remove(const char *path)
+{
+	DIR		*dir;
+	struct dirent	*d;
+	struct stat	st;
+	char		*file;
+
+	if (NULL != (dir = opendir(path)))
+	{
+		while (NULL != (d = readdir(dir)))
+		{
+			if (0 == strcmp(d->d_name, ".") || 0 == strcmp(d->d_name, ".."))
+				continue;
+
+			file = zbx_dsprintf(NULL, "%s/%s", path, d->d_name);
+
+			if (0 == lstat(file, &st) && S_ISDIR(st.st_mode))
+				colmock_remove(file);
+			else
+				unlink(file);
+
+			zbx_free(file);
+		}
+
+		closedir(dir);
+	}
+
+	rmdir(path);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Function: zbx_mock_test_entry                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_mock_test_entry(void **state)
+{
+	char				*error = NULL, *path, dir[] = "/tmp/zbx_history_columnar_XXXXXX";
+	int				start, end, count;
+	zbx_uint64_t			itemid;
+	zbx_timespec_t			ts;
+	zbx_mock_handle_t		hbatches, hbatch, handle;
+	zbx_history_iface_t		hist;
+	zbx_vector_history_record_t	values;
+	unsigned char			value_type;
+
+	ZBX_UNUSED(state);
+
+	if (NULL == mkdtemp(dir))
+		fail_msg("cannot create temporary directory: %s", zbx_strerror(errno));
+
+	CONFIG_HISTORY_STORAGE_DIR = dir;
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in['value type']"));
+
+	if (SUCCEED != zbx_history_columnar_init(&hist, value_type, &error))
+		fail_msg("cannot initialize columnar history storage: %s", error);
+
+	if (FAIL == is_uint64(zbx_mock_get_parameter_string("in.itemid"), &itemid))
+		fail_msg("Invalid itemid value");
+
+	hbatches = zbx_mock_get_parameter_handle("in.batches");
+
+	while (ZBX_MOCK_END_OF_VECTOR != zbx_mock_vector_element(hbatches, &hbatch))
+		colmock_write_batch(&hist, itemid, hbatch);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.garbage", &handle))
+	{
+		path = colmock_item_file(dir, value_type, itemid);
+		colmock_append_garbage(path, zbx_mock_get_parameter_string("in.garbage"));
+		zbx_free(path);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.sequence", &handle))
+		colmock_write_sequence(&hist, itemid, handle);
+
+	zbx_strtime_to_timespec(zbx_mock_get_parameter_string("in.start"), &ts);
+	start = ts.sec;
+	zbx_strtime_to_timespec(zbx_mock_get_parameter_string("in.end"), &ts);
+	end = ts.sec;
+	count = atoi(zbx_mock_get_parameter_string("in.count"));
+
+	zbx_history_record_vector_create(&values);
+
+	zbx_mock_assert_result_eq("get_values()", SUCCEED, hist.get_values(&hist, itemid, start, count, end,
+			&values));
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.values", &handle))
+		colmock_check_values(value_type, handle, &values);
+	else
+		zbx_mock_assert_int_eq("number of values", atoi(zbx_mock_get_parameter_string("out.returned")),
+				values.values_num);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.blocks", &handle))
+	{
+		path = colmock_item_file(dir, value_type, itemid);
+		colmock_check_blocks(path, handle);
+		zbx_free(path);
+	}
+
+	zbx_history_record_vector_destroy(&values, value_type);
+	hist.destroy(&hist);
+
+	colmock_remove(dir);
+	CONFIG_HISTORY_STORAGE_DIR = NULL;
+}
@@ -69,6 +69,7 @@ struct zbx_db_result
 
 DB_RESULT	__fwd_zbx_db_select(const char *fmt, ...);
 DB_RESULT	__wrap_zbx_db_select_n(const char *query, int n);
+DB_RESULT	__wrap_zbx_db_select_prepared(const char *query, const char **params, int params_num, int n);
 int	__wrap___zbx_DBexecute(const char *fmt, ...);
 
 /* zbx_mockdb_t:queries hashset support */
@@ -198,6 +199,32 @@ DB_RESULT	__wrap_zbx_db_select_n(const char *query, int n)
 	return __fwd_zbx_db_select("%s limit %d", query, n);
 }
 
+DB_RESULT	__wrap_zbx_db_select_prepared(const char *query, const char **params, int params_num, int n)
+{
+	char		*sql = NULL;
+	size_t		sql_alloc = 0, sql_offset = 0;
+	const char	*ptr;
+	int		i = 0;
+	DB_RESULT	result;
+
+	for (ptr = query; '\0' != *ptr; ptr++)
+	{
+		if ('?' == *ptr && i < params_num)
+			zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, params[i++]);
+		else
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, *ptr);
+	}
+
+	if (0 != n)
+		result = __wrap_zbx_db_select_n(sql, n);
+	else
+		result = __fwd_zbx_db_select("%s", sql);
+
+	zbx_free(sql);
+
+	return result;
+}
+
 DB_ROW	__wrap_zbx_db_fetch(DB_RESULT result)
 {
 	zbx_mock_error_t	error;